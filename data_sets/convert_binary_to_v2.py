@@ -0,0 +1,64 @@
+# @author Marcel Breyer
+# @date 2020-12-22
+# @brief Python3 script for converting a file in the binary format to the versioned, chunked binary v2 format.
+
+
+import argparse
+import numpy as np
+import sys
+
+
+real_type = np.float32
+size_type = np.uint32
+
+# the codecs of the binary v2 format
+codecs = { "raw": 0, "fp16": 1, "lz4": 2 }
+# the value type tags of the binary v2 format
+value_types = { np.dtype(np.float32): 0, np.dtype(np.float64): 1, np.dtype(np.uint32): 2, np.dtype(np.int32): 3,
+                np.dtype(np.uint64): 4, np.dtype(np.int64): 5 }
+
+
+def encode_chunk(chunk, codec):
+    if codec == "raw":
+        return chunk.tobytes()
+    elif codec == "fp16":
+        return chunk.astype(np.float16).tobytes()
+    else:
+        import lz4.block
+        # shuffle the bytes: first all first bytes, then all second bytes, ...
+        shuffled = chunk.reshape(-1).view(np.uint8).reshape(-1, chunk.itemsize).T.tobytes()
+        return lz4.block.compress(shuffled, store_size=False)
+
+
+# setup command line arguments parser
+parser = argparse.ArgumentParser()
+parser.add_argument("--input_file", help="the file in the binary format to convert", type=str, required=True)
+parser.add_argument("--output_file", help="the file to write the binary v2 representation to", type=str, required=True)
+parser.add_argument("--codec", help="the encoding of the chunks", choices=codecs.keys(), default="raw")
+parser.add_argument("--chunk_size", help="the number of data points per chunk", type=int, default=65536)
+args = parser.parse_args()
+
+if args.chunk_size <= 0:
+    raise ValueError("The chunk size must be greater than 0!")
+
+# read the binary file
+with open(args.input_file, 'rb') as file:
+    total_size = int(np.frombuffer(file.read(np.dtype(size_type).itemsize), dtype=size_type)[0])
+    dims = int(np.frombuffer(file.read(np.dtype(size_type).itemsize), dtype=size_type)[0])
+    data = np.frombuffer(file.read(), dtype=real_type).reshape(total_size, dims)
+
+# encode all chunks
+chunks = [encode_chunk(data[i:i + args.chunk_size], args.codec) for i in range(0, total_size, args.chunk_size)]
+
+# write header, chunk index and chunks
+header = np.zeros(1, dtype=[("magic", "S8"), ("version", np.uint32), ("value_type", np.uint32), ("total_size", np.uint64),
+                            ("dims", np.uint64), ("chunk_size", np.uint64), ("codec", np.uint32), ("reserved", np.uint32)])
+header[0] = (b"SYCLLSH2", 2, value_types[np.dtype(real_type)], total_size, dims, args.chunk_size, codecs[args.codec], 0)
+offsets = np.cumsum([header.nbytes + (len(chunks) + 1) * 8] + [len(chunk) for chunk in chunks], dtype=np.uint64)
+with open(args.output_file, 'wb') as file:
+    file.write(header.tobytes())
+    file.write(offsets.tobytes())
+    for chunk in chunks:
+        file.write(chunk)
+
+print("Wrote {} data points with {} dimensions in {} chunks ({} bytes).".format(total_size, dims, len(chunks), int(offsets[-1])), file=sys.stderr)
@@ -28,20 +28,41 @@ namespace sycl_lsh {
      * |:-----------------------|:---------------------------------------------------------------------------------------------------------|
      * | help                   | Prints the help screen.                                                                                  |
      * | data_file              | Path to the data file (**required**).                                                                    |
+     * | query_file             | Path to the query file (if not present, the nearest-neighbors of all data points are searched).          |
      * | file_parser            | The type of the file parser to parse the data file (one off 'arff_parser' or 'binary_parser' (default)). |
+     * | mpi_io_hints           | Comma separated `key=value` MPI IO hints used for all files (e.g. `cb_nodes=4,cb_buffer_size=16777216`). |
      * | k                      | The number of nearest-neighbors to search for (**required**).                                            |
      * | options_file           | Path to the options file to load.                                                                        |
      * | options_save_file      | Path to the file to save the currently used options to.                                                  |
+     * | options_sweep_files    | Comma separated list of options files evaluated one after another on the already loaded data set.        |
+     * | hash_tables_save_file  | Path to the file to save the created hash functions and hash tables to.                                  |
+     * | hash_tables_load_file  | Path to the file to load the hash functions and hash tables from (instead of creating them).             |
      * | knn_save_file          | Path to the file to save the found k-nearest-neighbors to.                                               |
      * | knn_dist_save_file     | Path to the file to save the distances of the found k-nearest-neighbors to.                              |
+     * | knn_tuning_file        | Path to the file caching the tuned work-group and blocking sizes of the kNN kernel per device.           |
+     * | device_memory_budget   | The maximum device memory per MPI rank in MiB (0 means the global memory size of the device).            |
+     * | exact_knn              | Calculate the exact k-nearest-neighbors using a brute-force search (see @ref sycl_lsh::brute_force).     |
      * | evaluate_knn_file      | Path to the file containing the correct k-nearest-neighbors.                                             |
      * | evaluate_knn_dist_file | Path to the file containing the correct k-nearest-neighbor distances.                                    |
+     * | evaluate_recall_at     | Comma separated additional k' <= k to also calculate the recall@k' for (e.g. "1,10").                    |
      * | hash_pool_size         | The number of hash functions in the hash pool.                                                           |
      * | num_hash_functions     | The number of hash functions to calculate the hash values with.                                          |
      * | num_hash_tables        | The number of used hash tables.                                                                          |
      * | hash_table_size        | The size of each hash table.                                                                             |
      * | w                      | The segment size for the random projections hash functions: \f$h_{a, b} = \frac{a \cdot x + b}{w}\f$.    |
      * | num_cut_off_points     | The number of cut-off points for the entropy-based hash functions.                                       |
+     * | max_bucket_size        | The maximum number of data points per hash bucket (oversized buckets are subsampled, 0 means unlimited). |
+     * | num_probes             | The number of additionally probed neighboring hash buckets per hash table (multi-probe LSH).             |
+     * | max_hamming_distance   | The maximum number of differing signature bits of a query and a candidate (simhash, 0 disables).         |
+     * | early_termination_tables | Stop searching further hash tables after this many consecutive hash tables without changes (0 disables). |
+     * | early_termination_distance | Stop searching further hash tables once the k-th nearest-neighbor is closer than this (0 disables).      |
+     * | seed                   | The seed to generate identical hash functions on all MPI ranks (0 means random hash functions).          |
+     * | server_port            | Keep the hash tables alive and answer queries sent to this TCP port (see @ref sycl_lsh::query_server).   |
+     * | server_max_batch_size  | The maximum number of queries per batch of the query server (default: 4096).                             |
+     * | server_max_delay       | The maximum time in milliseconds a request waits for further requests to batch with (default: 5).        |
+     * | autotune_num_trials    | Search the options for a good recall/time trade-off in this many trials (see @ref sycl_lsh::autotuner).  |
+     * | autotune_sample_size   | The number of data points sampled as queries during the autotuning (default: 1000).                      |
+     * | autotune_save_prefix   | Save the Pareto optimal options of the autotuning to `prefix_i` (default: "autotune_options").           |
      */
     class argv_parser {
     public:
@@ -0,0 +1,338 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-10-28
+ *
+ * @brief Implements the @ref sycl_lsh::autotuner class searching the runtime options for a good recall/time trade-off.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_AUTOTUNER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_AUTOTUNER_HPP
+
+#include <sycl_lsh/argv_parser.hpp>
+#include <sycl_lsh/brute_force.hpp>
+#include <sycl_lsh/data.hpp>
+#include <sycl_lsh/detail/get_linear_id.hpp>
+#include <sycl_lsh/detail/hamming_filter.hpp>
+#include <sycl_lsh/detail/multi_probe.hpp>
+#include <sycl_lsh/hash_functions/hash_functions.hpp>
+#include <sycl_lsh/hash_tables.hpp>
+#include <sycl_lsh/knn.hpp>
+#include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <fmt/format.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sycl_lsh {
+
+    /**
+     * @brief Searches the runtime options (`hash_pool_size`, `num_hash_functions`, `num_hash_tables`, `hash_table_size`, `w` and
+     *        `num_cut_off_points`) for a good trade-off between the recall and the k-nearest-neighbor search time.
+     * @details A sample of the data points is used as query set. Its exact k-nearest-neighbors are calculated once using a single hash
+     *          table with a single hash bucket (i.e. an exhaustive search). Afterwards, randomly drawn options (the first trial always
+     *          uses the given options) are evaluated by creating the hash tables of the already loaded data set and searching the
+     *          k-nearest-neighbors of the sample. The options of all trials on the Pareto front (no other trial has a higher recall
+     *          **and** a lower search time) are saved using @ref sycl_lsh::options::save().
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     */
+    template <memory_layout layout, typename Options>
+    class autotuner {
+    public:
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                type aliases                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /// The type of the @ref sycl_lsh::options object.
+        using options_type = Options;
+        /// The used floating point type.
+        using real_type = typename options_type::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename options_type::index_type;
+        /// The used unsigned type (used for hash values).
+        using hash_value_type = typename options_type::hash_value_type;
+
+        /// The type of the @ref sycl_lsh::data object.
+        using data_type = data<layout, options_type>;
+        /// The type of the @ref sycl_lsh::data_attributes object.
+        using data_attributes_type = typename data_type::data_attributes_type;
+        /// The type of the @ref sycl_lsh::knn object as the result of the k-nearest-neighbor search.
+        using knn_type = knn<layout, options_type, data_type>;
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                constructor                                                 //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Construct a new @ref sycl_lsh::autotuner object using the command line arguments `k`, `autotune_num_trials`,
+         *        `autotune_sample_size` (default: 1000) and `autotune_save_prefix` (default: "autotune_options").
+         * @param[in] parser the used @ref sycl_lsh::argv_parser
+         * @param[in] opt the used @ref sycl_lsh::options (the first trial and the starting point for all other trials)
+         * @param[in] data the used @ref sycl_lsh::data representing the used data set
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if the command line argument `autotune_num_trials` isn't present in @p parser.
+         * @throws std::invalid_argument if `autotune_num_trials` or `autotune_sample_size` is `0`.
+         */
+        autotuner(const argv_parser& parser, const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                   tuning                                                   //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Evaluates all trials and saves the options of the trials on the Pareto front to `autotune_save_prefix_<i>`. Must be called
+         *        on **all** MPI ranks.
+         */
+        void run();
+
+    private:
+        /// The result of a single evaluated set of options.
+        struct trial {
+            /// The evaluated options.
+            options_type opt;
+            /// The achieved recall (in percent).
+            real_type recall;
+            /// The time needed to search the k-nearest-neighbors of the sample (maximum over all MPI ranks, in milliseconds).
+            double time;
+        };
+
+        /**
+         * @brief Draws the options of all trials (identical on all MPI ranks).
+         */
+        void draw_trials();
+        /**
+         * @brief Samples the query set from the data points of all MPI ranks.
+         * @return the queries in *Array of Structs* layout (identical on all MPI ranks) (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        std::vector<real_type> sample_queries() const;
+        /**
+         * @brief Calculates the recall of the k-nearest-neighbors @p knns using the exact k-nearest-neighbors @p exact_knns.
+         * @param[in] knns the calculated k-nearest-neighbors
+         * @param[in] exact_knns the exact k-nearest-neighbors
+         * @return the recall in percent (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        real_type recall(knn_type& knns, knn_type& exact_knns) const;
+
+        const options_type& options_;
+        data_type& data_;
+        const mpi::communicator& comm_;
+        const mpi::logger& logger_;
+
+        const index_type k_;
+        const index_type num_trials_;
+        const index_type sample_size_;
+        const std::string save_prefix_;
+
+        std::vector<trial> trials_;
+    };
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                constructor                                                 //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options>
+    autotuner<layout, Options>::autotuner(const argv_parser& parser, const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger)
+            : options_(opt), data_(data), comm_(comm), logger_(logger),
+              k_(parser.argv_as<index_type>("k")),
+              num_trials_(parser.has_argv("autotune_num_trials") ? parser.argv_as<index_type>("autotune_num_trials") : 0),
+              sample_size_(parser.has_argv("autotune_sample_size") ? parser.argv_as<index_type>("autotune_sample_size") : 1000),
+              save_prefix_(parser.has_argv("autotune_save_prefix") ? parser.argv_as<std::string>("autotune_save_prefix") : "autotune_options")
+    {
+        // check if the required command line argument is present
+        if (!parser.has_argv("autotune_num_trials")) {
+            throw std::invalid_argument("Required command line argument 'autotune_num_trials' not provided!");
+        }
+        if (num_trials_ == 0) {
+            throw std::invalid_argument("autotune_num_trials must be greater than 0!");
+        }
+        if (sample_size_ == 0) {
+            throw std::invalid_argument("autotune_sample_size must be greater than 0!");
+        }
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                   tuning                                                   //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options>
+    void autotuner<layout, Options>::run() {
+        using clock = std::chrono::steady_clock;
+
+        // sample the query set
+        const std::vector<real_type> sample = this->sample_queries();
+        auto queries = make_query_data(sample, options_, data_, comm_, logger_);
+
+        // calculate the exact k-nearest-neighbors using a brute-force search
+        knn_type exact_knns = [&]() {
+            brute_force exact(options_, data_, comm_, logger_);
+            return exact.get_k_nearest_neighbors(queries, k_);
+        }();
+        logger_.log("\nCalculated the exact {}-nearest-neighbors of {} sampled queries.\n\n", k_, queries.get_attributes().total_size);
+
+        // evaluate all trials
+        this->draw_trials();
+        for (std::size_t i = 0; i < trials_.size(); ++i) {
+            trial& tr = trials_[i];
+            logger_.log("Autotuning trial {}/{}:\n{}\n", i + 1, trials_.size(), tr.opt);
+
+            auto tables = make_hash_tables<layout>(tr.opt, data_, comm_, logger_);
+            const auto start = clock::now();
+            knn_type knns = tables.get_k_nearest_neighbors(queries, k_);
+            tr.time = mpi::max(std::chrono::duration<double, std::milli>(clock::now() - start).count(), comm_);
+            tr.recall = this->recall(knns, exact_knns);
+
+            logger_.log("Autotuning trial {}/{}: recall {:.2f}%, time {:.2f}ms\n\n", i + 1, trials_.size(), tr.recall, tr.time);
+        }
+
+        // the Pareto front: sorted by time, each trial must achieve a higher recall than all faster trials
+        std::vector<const trial*> sorted(trials_.size());
+        std::transform(trials_.cbegin(), trials_.cend(), sorted.begin(), [](const trial& tr) { return &tr; });
+        std::sort(sorted.begin(), sorted.end(), [](const trial* lhs, const trial* rhs) {
+            return lhs->time < rhs->time || (lhs->time == rhs->time && lhs->recall > rhs->recall);
+        });
+        std::vector<const trial*> pareto_front;
+        for (const trial* tr : sorted) {
+            if (pareto_front.empty() || tr->recall > pareto_front.back()->recall) {
+                pareto_front.push_back(tr);
+            }
+        }
+
+        logger_.log("Pareto front of {} trials:\n", trials_.size());
+        for (std::size_t i = 0; i < pareto_front.size(); ++i) {
+            const std::string file_name = fmt::format("{}_{}", save_prefix_, i);
+            logger_.log("  recall {:.2f}%, time {:.2f}ms: '{}'\n", pareto_front[i]->recall, pareto_front[i]->time, file_name);
+            pareto_front[i]->opt.save(file_name, comm_, logger_);
+        }
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                              helper functions                                              //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options>
+    void autotuner<layout, Options>::draw_trials() {
+        // only options fulfilling the sanity checks of the options and the restrictions of the enabled features are drawn
+        const auto is_legal = [&](const options_type& opt) {
+            if (options_type::used_hash_functions_type == hash_functions_type::simhash
+                && static_cast<std::size_t>(opt.num_hash_functions) > sizeof(hash_value_type) * CHAR_BIT) {
+                return false;
+            }
+            if (opt.num_probes > 0 && (opt.num_probes > 2 * opt.num_hash_functions
+                                       || static_cast<std::size_t>(opt.num_hash_functions) > detail::max_probe_hash_functions)) {
+                return false;
+            }
+            if (opt.max_hamming_distance > 0 && static_cast<std::size_t>(opt.num_hash_tables) > detail::max_hamming_filter_hash_tables) {
+                return false;
+            }
+            return true;
+        };
+
+        const std::vector<index_type> hash_pool_sizes{ 16, 32, 64, 128 };
+        const std::vector<index_type> num_hash_functions{ 4, 8, 12, 16, 24, 32 };
+        const std::vector<index_type> num_hash_tables{ 1, 2, 4, 8, 16, 32 };
+        const std::vector<double> hash_table_size_factors{ 0.25, 0.5, 1.0, 2.0, 4.0 };
+        const std::vector<real_type> w_factors{ 0.25, 0.5, 1.0, 2.0, 4.0 };
+        const std::vector<index_type> num_cut_off_points{ 2, 3, 4, 6, 8 };
+
+        // identically seeded on all MPI ranks -> identical trials without communication
+        std::mt19937 gen;
+        const auto draw = [&](const auto& values) {
+            return values[std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(gen)];
+        };
+
+        trials_.clear();
+        trials_.push_back(trial{ options_, 0.0, 0.0 });
+        // limit the number of draws in case (nearly) all options are illegal
+        for (index_type draws = 0; trials_.size() < num_trials_ && draws < 100 * num_trials_; ++draws) {
+            options_type opt = options_;
+            opt.hash_pool_size = draw(hash_pool_sizes);
+            opt.num_hash_functions = draw(num_hash_functions);
+            opt.num_hash_tables = draw(num_hash_tables);
+            opt.hash_table_size = std::max<hash_value_type>(options_.hash_table_size * draw(hash_table_size_factors), 1);
+            opt.w = options_.w * draw(w_factors);
+            opt.num_cut_off_points = draw(num_cut_off_points);
+            if (is_legal(opt)) {
+                trials_.push_back(trial{ opt, 0.0, 0.0 });
+            }
+        }
+    }
+
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    std::vector<typename Options::real_type> autotuner<layout, Options>::sample_queries() const {
+        const data_attributes_type& attr = data_.get_attributes();
+        // the queries are given using the original number of dimensions
+        const index_type dims = data_.get_original_dims();
+        const index_type rank_size = attr.correct_rank_size(comm_.rank());
+
+        // each MPI rank samples its share of the queries from its own (real) data points
+        const index_type rank_sample_size = std::min<index_type>(sample_size_ / comm_.size() + (comm_.rank() < static_cast<int>(sample_size_ % comm_.size()) ? 1 : 0), rank_size);
+        std::vector<index_type> points(rank_size);
+        std::iota(points.begin(), points.end(), 0);
+        std::vector<index_type> sampled_points;
+        std::sample(points.begin(), points.end(), std::back_inserter(sampled_points), rank_sample_size, std::mt19937(comm_.rank()));
+
+        std::vector<real_type> rank_sample;
+        rank_sample.reserve(rank_sample_size * dims);
+        for (const index_type point : sampled_points) {
+            for (index_type dim = 0; dim < dims; ++dim) {
+                rank_sample.push_back(data_.get_original_value(point, dim));
+            }
+        }
+
+        // all MPI ranks need the whole query set
+        std::vector<int> counts(comm_.size());
+        std::vector<int> displs(comm_.size());
+        const int count = rank_sample.size();
+        MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, comm_.get());
+        std::exclusive_scan(counts.begin(), counts.end(), displs.begin(), 0);
+        std::vector<real_type> sample(displs.back() + counts.back());
+        MPI_Allgatherv(rank_sample.data(), count, mpi::type_cast<real_type>(), sample.data(), counts.data(), displs.data(),
+                       mpi::type_cast<real_type>(), comm_.get());
+        return sample;
+    }
+
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    typename Options::real_type autotuner<layout, Options>::recall(knn_type& knns, knn_type& exact_knns) const {
+        const data_attributes_type attr = knns.get_attributes();
+        const index_type rank_size = attr.correct_rank_size(comm_.rank());
+        const get_linear_id<knn_type> get_linear_id_knn{};
+
+        index_type count = 0;
+        for (index_type point = 0; point < rank_size; ++point) {
+            for (index_type nn = 0; nn < k_; ++nn) {
+                // check if the calculated ID is contained in the exact IDs
+                const typename knn_type::id_type calculated_id = knns.get_knn_host_buffer()[get_linear_id_knn(point, nn, attr, k_)];
+                for (index_type i = 0; i < k_; ++i) {
+                    if (calculated_id == exact_knns.get_knn_host_buffer()[get_linear_id_knn(point, i, attr, k_)]) {
+                        ++count;
+                        break;
+                    }
+                }
+            }
+        }
+        return (static_cast<real_type>(mpi::sum(count, comm_)) / (attr.total_size * k_)) * 100.0;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_AUTOTUNER_HPP
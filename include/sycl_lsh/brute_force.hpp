@@ -0,0 +1,417 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-22
+ *
+ * @brief Implements the @ref sycl_lsh::brute_force class calculating the exact k-nearest-neighbors (e.g. as ground truth or baseline).
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BRUTE_FORCE_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BRUTE_FORCE_HPP
+
+#include <sycl_lsh/argv_parser.hpp>
+#include <sycl_lsh/data.hpp>
+#include <sycl_lsh/data_attributes.hpp>
+#include <sycl_lsh/detail/gemm.hpp>
+#include <sycl_lsh/detail/get_linear_id.hpp>
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/detail/top_k.hpp>
+#include <sycl_lsh/device_selector.hpp>
+#include <sycl_lsh/knn.hpp>
+#include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/timer.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace sycl_lsh {
+
+    // SYCL kernel name needed to silence ComputeCpp warnings
+    class kernel_calculate_squared_norms;
+    class kernel_calculate_brute_force_distances;
+    class kernel_select_brute_force_knn;
+
+    namespace detail {
+
+        /// The maximum number of query/data point distances calculated at once (bounds the size of the intermediate distances buffer).
+        constexpr std::size_t brute_force_max_distances = 1 << 26;
+
+    }
+
+
+    /**
+     * @brief Calculates the exact k-nearest-neighbors using a brute-force search, **SYCL** and **MPI**.
+     * @details Uses the same ring exchange as @ref sycl_lsh::hash_tables: in each of the `comm.size()` rounds, the distances of the
+     *          currently received queries to all data points of the current MPI rank are calculated chunk-wise as
+     *          \f$\|q\|^2 + \|x\|^2 - 2 q \cdot x\f$ using a tiled matrix product in local memory, followed by a kernel selecting the
+     *          nearest-neighbors. A query is never its own nearest-neighbor. Only the first device of each MPI rank is used. \n
+     *          If a reduced precision storage type is used, the distances are calculated using the stored data points.
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     */
+    template <memory_layout layout, typename Options>
+    class brute_force {
+    public:
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                type aliases                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /// The type of the @ref sycl_lsh::options object.
+        using options_type = Options;
+        /// The used floating point type.
+        using real_type = typename options_type::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename options_type::index_type;
+        /// The used integral type for global IDs.
+        using id_type = typename options_type::id_type;
+
+        /// The type of the @ref sycl_lsh::data object.
+        using data_type = data<layout, options_type>;
+        /// The type of the @ref sycl_lsh::data_attributes object.
+        using data_attributes_type = typename data_type::data_attributes_type;
+        /// The type of the device buffer used in the @ref sycl_lsh::data object.
+        using data_device_buffer_type = typename data_type::device_buffer_type;
+        /// The type of the @ref sycl_lsh::knn object as the result of the k-nearest-neighbor search.
+        using knn_type = knn<layout, options_type, data_type>;
+        using knn_device_buffer_type = sycl::buffer<id_type, 1>;
+        using knn_dist_device_buffer_type = sycl::buffer<real_type, 1>;
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                constructor                                                 //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Construct a new @ref sycl_lsh::brute_force object and calculates the squared norms of the own data points.
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data representing the used data set
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         */
+        brute_force(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                       calculate k-nearest-neighbors                                        //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Calculate the exact k-nearest-neighbors.
+         * @details If the command line argument `query_file` is present, the k-nearest-neighbors of the separate query set are calculated
+         *          instead of the all-k-nearest-neighbors of the data set.
+         * @param[in] parser the used @ref sycl_lsh::argv_parser to get the number of nearest-neighbors to search for from
+         * @return the exact k-nearest-neighbors (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if the number of nearest-neighbors @p k is less or equal than `0` or greater and equal than `rank_size`.
+         */
+        [[nodiscard]]
+        knn_type get_k_nearest_neighbors(const argv_parser& parser);
+        /**
+         * @brief Calculate the exact k-nearest-neighbors of the queries @p queries. If less than @p k nearest-neighbors exist for a query
+         *        of a separate query set, the remaining IDs are `std::numeric_limits<id_type>::max()`.
+         * @param[in] queries the queries created using @ref sycl_lsh::make_query_data() (if @p queries is the data set, the
+         *                    all-k-nearest-neighbors are calculated)
+         * @param[in] k the number of nearest-neighbors to search for
+         * @return the exact k-nearest-neighbors of @p queries (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if the number of nearest-neighbors @p k is less or equal than `0` or greater and equal than `rank_size`.
+         */
+        [[nodiscard]]
+        knn_type get_k_nearest_neighbors(data_type& queries, const index_type k);
+
+    private:
+        /**
+         * @brief Calculates the exact k-nearest-neighbors of the queries in @p data_buffer among the data points of the current MPI rank.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the queries of the current round
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knns the (already partially) calculated nearest-neighbors
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank; `false` otherwise
+         */
+        void calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                 const index_type num_queries, knn_type& knns, const bool is_own_data);
+
+        const options_type& options_;
+        data_type& data_;
+        const data_attributes_type attr_;
+        const mpi::communicator& comm_;
+        const mpi::logger& logger_;
+
+        sycl::queue queue_;
+        /// The squared norms of the own data points.
+        knn_dist_device_buffer_type norms_buffer_;
+    };
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                constructor                                                 //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options>
+    brute_force<layout, Options>::brute_force(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger)
+            : options_(opt), data_(data), attr_(data.get_attributes()), comm_(comm), logger_(logger),
+              queue_(detail::select_devices(comm).front(), sycl::async_handler(&sycl_exception_handler)),
+              norms_buffer_(attr_.rank_size)
+    {
+        mpi::timer t(comm_);
+
+        queue_.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_data = data_.get_device_accessor(data_.get_device_buffer(), attr_, cgh);
+            auto acc_norms = norms_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+            // get additional information
+            auto attr = attr_;
+            // get get_linear_id functor instantiation
+            const get_linear_id<data_type> get_linear_id_data{};
+
+            cgh.parallel_for<kernel_calculate_squared_norms>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                const index_type idx = item.get_linear_id();
+
+                real_type norm = 0.0;
+                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                    const real_type x = acc_data[get_linear_id_data(idx, dim, attr)];
+                    norm += x * x;
+                }
+                acc_norms[idx] = norm;
+            });
+        });
+        queue_.wait_and_throw();
+
+        logger_.log("Calculated the squared norms of the data points in {}.\n", t.elapsed());
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                       calculate k-nearest-neighbors                                        //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    typename brute_force<layout, Options>::knn_type brute_force<layout, Options>::get_k_nearest_neighbors(const argv_parser& parser) {
+        if (parser.has_argv("query_file")) {
+            // search the nearest-neighbors of a separate query set
+            data_type queries = make_query_data<layout>(parser, options_, data_, comm_, logger_);
+            logger_.log("\nUsed query set:\n{}\n", queries);
+            return get_k_nearest_neighbors(queries, parser.argv_as<index_type>("k"));
+        }
+        return get_k_nearest_neighbors(data_, parser.argv_as<index_type>("k"));
+    }
+
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    typename brute_force<layout, Options>::knn_type brute_force<layout, Options>::get_k_nearest_neighbors(data_type& queries, const index_type k) {
+        mpi::timer t(comm_);
+
+        if (k < 1 || k > attr_.rank_size) {
+            throw std::invalid_argument(fmt::format("k ({}) must be in the range [1, number of data point per MPI rank ({}))!", k, attr_.rank_size));
+        }
+        // the queries are the data points -> all-k-nearest-neighbors
+        const bool is_self_join = &queries == &data_;
+        const data_attributes_type query_attr = queries.get_attributes();
+
+        knn_type knns = make_knn<layout>(k, options_, queries, comm_, logger_);
+        knns.set_queue(queue_);
+        if (!is_self_join) {
+            // the IDs of the queries aren't valid placeholders (they may be the ID of any data point) -> use an invalid ID instead
+            std::fill(knns.get_knn_host_buffer().begin(), knns.get_knn_host_buffer().end(), std::numeric_limits<id_type>::max());
+        }
+
+        data_device_buffer_type data_device_buffer = queries.get_device_buffer();
+        // the device buffer containing the data received from the previous rank (reused in all rounds)
+        data_device_buffer_type received_data_device_buffer(queries.get_host_buffer().size());
+
+        for (int round = 0; round < comm_.size(); ++round) {
+            mpi::timer rt(comm_);
+            // the MPI rank owning the data points of the current round
+            const int data_rank = (comm_.rank() + comm_.size() - round) % comm_.size();
+
+            logger_.log("Round {} of {} ... ", round + 1, comm_.size());
+
+            // start sending the data of the current round to the next rank while calculating the k-nearest-neighbors
+            queries.start_send_receive_host_buffer();
+
+            // calculate k-nearest-neighbors on current MPI rank
+            this->calculate_knn_round(k, data_device_buffer, query_attr, query_attr.correct_rank_size(data_rank), knns, is_self_join && round == 0);
+
+            // start sending the calculated k-nearest-neighbors and distances to next rank
+            knns.start_send_receive_host_buffer();
+
+            // wait for the data of the next round and copy it to the device while the k-nearest-neighbors are still being sent
+            auto wait_start = std::chrono::steady_clock::now();
+            queries.finish_send_receive_host_buffer();
+            auto wait_time = std::chrono::steady_clock::now() - wait_start;
+            if (round + 1 < comm_.size()) {
+                queue_.submit([&](sycl::handler& cgh) {
+                    auto acc = received_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.copy(queries.get_host_buffer().data(), acc);
+                });
+                data_device_buffer = received_data_device_buffer;
+            }
+
+            // wait until the k-nearest-neighbors of the next round have been received
+            wait_start = std::chrono::steady_clock::now();
+            knns.finish_send_receive_host_buffer();
+            wait_time += std::chrono::steady_clock::now() - wait_start;
+
+            logger_.log("finished in {} (waited {} for MPI communication).\n",
+                        rt.elapsed(), std::chrono::duration_cast<std::chrono::milliseconds>(wait_time));
+        }
+
+        logger_.log("Calculated exact {}-nearest-neighbors in {}.\n\n", k, t.elapsed());
+        return knns;
+    }
+
+    template <memory_layout layout, typename Options>
+    void brute_force<layout, Options>::calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                                           const index_type num_queries, knn_type& knns, const bool is_own_data) {
+        const index_type num_points = attr_.correct_rank_size(comm_.rank());
+        if (num_queries == 0 || num_points == 0) {
+            // only dummy points -> nothing to do
+            return;
+        }
+
+        // create SYCL buffers for knn class
+        knn_device_buffer_type knn_buffer(knns.get_knn_host_buffer().data(), knns.get_knn_host_buffer().size());
+        knn_dist_device_buffer_type knn_dist_buffer(knns.get_distance_host_buffer().data(), knns.get_distance_host_buffer().size());
+
+        // the distances to the data points are calculated chunk-wise (the number of data points per chunk is a multiple of the tile size)
+        constexpr index_type tile_size = detail::gemm_tile_size;
+        const index_type max_chunk_size = std::max<index_type>(detail::brute_force_max_distances / num_queries / tile_size, 1) * tile_size;
+        const index_type chunk_size = std::min<index_type>(max_chunk_size, ((num_points + tile_size - 1) / tile_size) * tile_size);
+        const index_type num_row_tiles = (num_queries + tile_size - 1) / tile_size;
+        knn_dist_device_buffer_type distances(sycl::range<>(num_queries * chunk_size));
+
+        // the work-group size of the selection kernel is limited by the local memory needed for the nearest-neighbors
+        const index_type local_mem_size = queue_.get_device().template get_info<sycl::info::device::local_mem_size>();
+        const index_type max_local_size = local_mem_size / (k * (sizeof(id_type) + sizeof(real_type)));
+        const index_type max_work_group_size = queue_.get_device().template get_info<sycl::info::device::max_work_group_size>();
+        index_type local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
+        if (max_local_size == local_size) {
+            local_size /= 2;
+        }
+        const index_type global_size = ((num_queries + local_size - 1) / local_size) * local_size;
+
+        for (index_type chunk_first = 0; chunk_first < num_points; chunk_first += chunk_size) {
+            const index_type chunk_points = std::min<index_type>(chunk_size, num_points - chunk_first);
+            const index_type num_column_tiles = (chunk_points + tile_size - 1) / tile_size;
+
+            // calculate the (shifted) squared distances ||x||^2 - 2 q * x of all queries to the data points of the current chunk
+            queue_.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_distances = distances.template get_access<sycl::access::mode::discard_write>(cgh);
+                auto acc_queries = data_.get_device_accessor(data_buffer, query_attr, cgh);
+                auto acc_data = data_.get_device_accessor(data_.get_device_buffer(), attr_, cgh);
+                auto acc_norms = norms_buffer_.template get_access<sycl::access::mode::read>(cgh);
+                // get additional information
+                auto attr = attr_;
+                auto q_attr = query_attr;
+                // get get_linear_id functor instantiation
+                const get_linear_id<data_type> get_linear_id_data{};
+
+                // create local memory accessors
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        tile_a(sycl::range<>(tile_size * tile_size), cgh);
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        tile_b(sycl::range<>(tile_size * tile_size), cgh);
+
+                const auto execution_range = sycl::nd_range<>(sycl::range<>(num_row_tiles * num_column_tiles * tile_size * tile_size),
+                                                               sycl::range<>(tile_size * tile_size));
+
+                cgh.parallel_for<kernel_calculate_brute_force_distances>(execution_range, [=](sycl::nd_item<> item) {
+                    const index_type group = item.get_group_linear_id();
+                    const index_type local_row = item.get_local_linear_id() / tile_size;
+                    const index_type local_col = item.get_local_linear_id() % tile_size;
+                    const index_type row = (group / num_column_tiles) * tile_size + local_row;
+                    const index_type col = (group % num_column_tiles) * tile_size + local_col;
+
+                    // work-items outside of the matrix stage the values of the last query or data point (no early return because of the barriers)
+                    const index_type query = row < num_queries ? row : num_queries - 1;
+                    const index_type point = chunk_first + (col < chunk_points ? col : chunk_points - 1);
+
+                    const real_type dot_product = detail::tiled_gemm_entry(item, row, col, local_row, local_col, tile_a, tile_b, attr.dims, real_type{ 0.0 },
+                            [&](const index_type, const index_type dim) -> real_type {
+                                return acc_queries[get_linear_id_data(query, dim, q_attr)];
+                            },
+                            [&](const index_type dim, const index_type) -> real_type {
+                                return acc_data[get_linear_id_data(point, dim, attr)];
+                            });
+
+                    if (row < num_queries && col < chunk_points) {
+                        acc_distances[row * chunk_size + col] = acc_norms[point] - 2 * dot_product;
+                    }
+                });
+            });
+
+            // update the nearest-neighbors of all queries with the data points of the current chunk
+            queue_.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_distances = distances.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_queries = data_.get_device_accessor(data_buffer, query_attr, cgh);
+                auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+                auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+                // get additional information
+                auto attr = query_attr;
+                const id_type base_id = attr_.first_id(comm_.rank());
+                // get get_linear_id functor instantiation
+                const get_linear_id<data_type> get_linear_id_data{};
+                const get_linear_id<knn_type> get_linear_id_knn{};
+
+                // create local memory accessors
+                sycl::accessor<id_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        knn_local_mem(sycl::range<>(local_size * k), cgh);
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        knn_dist_local_mem(sycl::range<>(local_size * k), cgh);
+
+                const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+
+                cgh.parallel_for<kernel_select_brute_force_knn>(execution_range, [=](sycl::nd_item<> item) {
+                    const index_type global_idx = item.get_global_linear_id();
+                    const index_type local_idx  = item.get_local_linear_id();
+
+                    // immediately return if global_idx is out-of-range or a dummy point
+                    if (global_idx >= num_queries) return;
+
+                    // the squared norm of the query completes the squared distances
+                    real_type query_norm = 0.0;
+                    for (index_type dim = 0; dim < attr.dims; ++dim) {
+                        const real_type x = acc_queries[get_linear_id_data(global_idx, dim, attr)];
+                        query_norm += x * x;
+                    }
+
+                    // initialize local memory arrays
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        knn_local_mem[local_idx * k + nn] = acc_knn[get_linear_id_knn(global_idx, nn, attr, k)];
+                        knn_dist_local_mem[local_idx * k + nn] = acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)];
+                    }
+                    auto knn_list = detail::make_top_k<options_type>(knn_local_mem, knn_dist_local_mem, local_idx * k, k);
+
+                    for (index_type col = 0; col < chunk_points; ++col) {
+                        // a query can only be its own nearest-neighbor if it's part of the own data
+                        if (is_own_data && chunk_first + col == global_idx) continue;
+                        // the expanded form may be slightly negative due to cancellation
+                        const real_type dist = sycl::fmax(query_norm + acc_distances[global_idx * chunk_size + col], real_type{ 0.0 });
+                        if (dist < knn_list.max_distance()) {
+                            knn_list.add(base_id + chunk_first + col, dist);
+                        }
+                    }
+                    knn_list.finalize();
+
+                    // write back to global buffer
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        acc_knn[get_linear_id_knn(global_idx, nn, attr, k)] = knn_local_mem[local_idx * k + nn];
+                        acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)] = knn_dist_local_mem[local_idx * k + nn];
+                    }
+                });
+            });
+        }
+        queue_.wait_and_throw();
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BRUTE_FORCE_HPP
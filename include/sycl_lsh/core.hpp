@@ -17,6 +17,7 @@
 #include <sycl_lsh/hash_functions/hash_functions.hpp>
 #include <sycl_lsh/hash_functions/mixed_hash_functions.hpp>
 #include <sycl_lsh/hash_functions/random_projections.hpp>
+#include <sycl_lsh/hash_functions/simhash.hpp>
 
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/errhandler.hpp>
@@ -25,10 +26,13 @@
 #include <sycl_lsh/mpi/timer.hpp>
 
 #include <sycl_lsh/argv_parser.hpp>
+#include <sycl_lsh/autotuner.hpp>
+#include <sycl_lsh/brute_force.hpp>
 #include <sycl_lsh/data.hpp>
 #include <sycl_lsh/hash_tables.hpp>
 #include <sycl_lsh/knn.hpp>
 #include <sycl_lsh/options.hpp>
+#include <sycl_lsh/query_server.hpp>
 
 /// The main namespace. Nearly all functions are located in this namespace.
 namespace sycl_lsh { }
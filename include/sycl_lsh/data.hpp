@@ -12,9 +12,14 @@
 #include <sycl_lsh/argv_parser.hpp>
 #include <sycl_lsh/data_attributes.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
 #include <sycl_lsh/detail/get_linear_id.hpp>
+#include <sycl_lsh/detail/philox.hpp>
+#include <sycl_lsh/detail/storage.hpp>
 #include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/file.hpp>
 #include <sycl_lsh/mpi/file_parser/file_parser.hpp>
@@ -26,14 +31,25 @@
 #include <fmt/ostream.h>
 #include <mpi.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace sycl_lsh {
 
+    // SYCL kernel name needed to silence ComputeCpp warnings
+    class kernel_transpose_data;
+    class kernel_generate_projection_matrix;
+    class kernel_reduce_dimensions;
+
     // forward declare data class
     template <memory_layout layout, typename Options>
     class data;
@@ -54,7 +70,74 @@ namespace sycl_lsh {
         using options_type = Options;
         using real_type = typename options_type::real_type;
         auto file_parser = mpi::make_file_parser<real_type, options_type>(parser.argv_as<std::string>("data_file"), parser, mpi::file::mode::read, comm, logger);
-        return data<layout, options_type>(*file_parser, comm, logger);
+        return data<layout, options_type>(*file_parser, nullptr, comm, logger);
+    }
+    /**
+     * @brief Factory function for the @ref sycl_lsh::data class representing a separate query set given by the command line argument `query_file`.
+     * @details Used to be able to automatically deduce the @ref sycl_lsh::options type. The queries are stored in the same representation
+     *          as the data points of @p reference (i.e. reduced precision data points are quantized using the parameters of @p reference).
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @param[in] parser the used @ref sycl_lsh::argv_parser
+     * @param[in] reference the data set the queries are searched in
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @param[in] logger the used @ref sycl_lsh::mpi::logger
+     * @return the @ref sycl_lsh::data object representing the query set (`[[nodiscard]]`)
+     *
+     * @throws std::invalid_argument if the command line argument `query_file` isn't present in @p parser.
+     */
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    inline auto make_query_data(const argv_parser& parser, const Options&, const data<layout, Options>& reference, const mpi::communicator& comm, const mpi::logger& logger) {
+        using options_type = Options;
+        using real_type = typename options_type::real_type;
+        // check if the required command line argument is present
+        if (!parser.has_argv("query_file")) {
+            throw std::invalid_argument("Required command line argument 'query_file' not provided!");
+        }
+        auto file_parser = mpi::make_file_parser<real_type, options_type>(parser.argv_as<std::string>("query_file"), parser, mpi::file::mode::read, comm, logger);
+        return data<layout, options_type>(*file_parser, &reference, comm, logger);
+    }
+    /**
+     * @brief Factory function for the @ref sycl_lsh::data class representing a separate query set already present in main memory.
+     * @details Used to be able to automatically deduce the @ref sycl_lsh::options type. The queries are distributed like the data points
+     *          of a parsed file, i.e. each MPI rank keeps its share of @p queries and the last MPI rank(s) are filled with dummy points.
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @param[in] queries **all** queries in *Array of Structs* layout (must be the same on all MPI ranks)
+     * @param[in] reference the data set the queries are searched in
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @param[in] logger the used @ref sycl_lsh::mpi::logger
+     * @return the @ref sycl_lsh::data object representing the query set (`[[nodiscard]]`)
+     *
+     * @throws std::invalid_argument if @p queries is empty or its size isn't a multiple of the number of dimensions of @p reference.
+     */
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    inline auto make_query_data(const std::vector<typename Options::real_type>& queries, const Options&, const data<layout, Options>& reference,
+                                const mpi::communicator& comm, const mpi::logger& logger) {
+        using options_type = Options;
+        using index_type = typename options_type::index_type;
+        using id_type = typename options_type::id_type;
+        using data_attributes_type = typename data<layout, options_type>::data_attributes_type;
+
+        const index_type dims = reference.get_original_dims();
+        if (queries.empty() || queries.size() % dims != 0) {
+            throw std::invalid_argument(fmt::format("The number of query values ({}) must be a non-zero multiple of the number of dimensions ({})!",
+                                                    queries.size(), dims));
+        }
+        const id_type total_size = queries.size() / dims;
+        const index_type rank_size = (total_size + comm.size() - 1) / comm.size();
+        const data_attributes_type attr(total_size, rank_size, dims);
+
+        // copy the own queries; the dummy points are copies of the last real query
+        typename data<layout, options_type>::original_host_buffer_type rank_queries(static_cast<std::size_t>(rank_size) * dims);
+        const id_type first_query = attr.first_id(comm.rank());
+        for (index_type point = 0; point < rank_size; ++point) {
+            const std::size_t query = std::min<id_type>(first_query + point, total_size - 1);
+            std::copy_n(queries.begin() + query * dims, dims, rank_queries.begin() + point * dims);
+        }
+        return data<layout, options_type>(attr, std::move(rank_queries), &reference, comm, logger);
     }
 
     /**
@@ -90,7 +173,7 @@ namespace sycl_lsh {
 
             if constexpr (layout == memory_layout::aos) {
                 // Array of Structs
-                return point * attr.dims + dim;
+                return point * detail::get_dims<typename data_type::options_type>(attr) + dim;
             } else {
                 // Struct of Arrays
                 return point + dim * attr.rank_size;
@@ -102,6 +185,10 @@ namespace sycl_lsh {
 
     /**
      * @brief Class which represents the used data set.
+     * @details If `SYCL_LSH_REDUCED_DIMS` is defined, the data points are projected to `SYCL_LSH_REDUCED_DIMS` dimensions using a
+     *          Johnson-Lindenstrauss random projection on the device. The projected data points are used for the hash tables, the
+     *          k-nearest-neighbor search and the MPI communication, i.e. @ref get_attributes() reports the reduced number of dimensions,
+     *          while the original data points are kept on the host for the exact re-ranking.
      * @tparam layout the @ref sycl_lsh::memory_layout type
      * @tparam Options the used @ref sycl_lsh::options type
      */
@@ -121,23 +208,40 @@ namespace sycl_lsh {
         using real_type = typename options_type::real_type;
         /// The used integral type for indices.
         using index_type = typename options_type::index_type;
+        /// The used integral type for global IDs.
+        using id_type = typename options_type::id_type;
         
         /// The type of the @ref sycl_lsh::data_attributes object representing the attributes of the used data set.
-        using data_attributes_type = data_attributes<layout, index_type>;
+        using data_attributes_type = data_attributes<layout, index_type, id_type>;
+
+        /// The type used to store the data points on the device and in the host buffer (may have a reduced precision).
+        using storage_type = detail::storage_type<real_type>;
 
         /// The type of the device buffer used by SYCL.
-        using device_buffer_type = sycl::buffer<real_type, 1>;
+        using device_buffer_type = sycl::buffer<storage_type, 1>;
         /// The type of the host buffer used to hide the MPI communications.
-        using host_buffer_type = std::vector<real_type>;
+        using host_buffer_type = std::vector<storage_type>;
+        /// The type of the host buffer containing the original data points of the current MPI rank.
+        using original_host_buffer_type = std::vector<real_type>;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
         //                                             update host buffer                                             //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
-         * @brief Send the elements of the host buffer to the neighboring host buffer replacing its content using a ring like send pattern.
+         * @brief Starts to send the elements of the host buffer to the next MPI rank and to receive the elements of the previous MPI rank
+         *        using a ring like send pattern.
+         * @details Uses non-blocking MPI communication, i.e. the host buffer **must not** be changed until
+         *          @ref finish_send_receive_host_buffer() has been called. \n
+         *          For the @ref sycl_lsh::memory_layout::aos layout only the real data points are sent, i.e. the dummy points padding the
+         *          last MPI rank aren't.
+         */
+        void start_send_receive_host_buffer();
+        /**
+         * @brief Waits until the communication started by @ref start_send_receive_host_buffer() has been finished and replaces the content
+         *        of the host buffer with the received elements.
          */
-        void send_receive_host_buffer();
+        void finish_send_receive_host_buffer();
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -155,6 +259,13 @@ namespace sycl_lsh {
          */
         [[nodiscard]]
         data_attributes_type get_attributes() const noexcept { return data_attributes_; }
+        /**
+         * @brief Returns the number of dimensions of the original data points, i.e. before reducing their number of dimensions.
+         * @details Equal to `get_attributes().dims` if `SYCL_LSH_REDUCED_DIMS` isn't defined.
+         * @return the number of original dimensions (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        index_type get_original_dims() const noexcept { return original_dims_; }
 
         /**
          * @brief Returns the device buffer used in the SYCL kernels.
@@ -168,10 +279,81 @@ namespace sycl_lsh {
          */
         [[nodiscard]]
         host_buffer_type& get_host_buffer() noexcept { return host_buffer_; }
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        /**
+         * @brief Returns the host buffer containing the original (full precision) data points of the current MPI rank.
+         * @details Used to re-rank the k-nearest-neighbors found using the reduced precision or reduced dimensions data points. If
+         *          `SYCL_LSH_REDUCED_DIMS` is defined, the original data points are stored in *Array of Structs* layout, otherwise in the
+         *          used @ref sycl_lsh::memory_layout. Use @ref get_original_value() to be independent of it.
+         * @return the original host buffer (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        const original_host_buffer_type& get_original_host_buffer() const noexcept { return original_host_buffer_; }
+#endif
+        /**
+         * @brief Returns the original (full precision and all dimensions) value of the dimension @p dim of the data point @p point of the
+         *        current MPI rank.
+         * @details If no original data points are kept, the value is read from the host buffer, i.e. the result is only valid as long as
+         *          the host buffer contains the data points of the current MPI rank.
+         * @param[in] point the data point
+         * @param[in] dim the dimension (in the range `[0, get_original_dims())`)
+         * @return the original value (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        real_type get_original_value(const index_type point, const index_type dim) const {
+#if defined(SYCL_LSH_REDUCED_DIMS)
+            return original_host_buffer_[static_cast<std::size_t>(point) * original_dims_ + dim];
+#elif defined(SYCL_LSH_EXACT_RERANKING)
+            return original_host_buffer_[get_linear_id<data>{}(point, dim, data_attributes_)];
+#else
+            return host_buffer_[get_linear_id<data>{}(point, dim, data_attributes_)];
+#endif
+        }
+
+        /**
+         * @brief Returns an accessor to @p buffer, a device buffer containing data points of this data set, for the use in SYCL kernels.
+         * @details The accessor always returns `real_type` values independent of the used `storage_type`.
+         * @param[in] buffer the device buffer to access
+         * @param[in] cgh the SYCL handler of the current command group
+         * @return the (read-only) accessor (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        auto get_device_accessor(device_buffer_type& buffer, sycl::handler& cgh) { return this->get_device_accessor(buffer, data_attributes_, cgh); }
+        /**
+         * @brief Returns an accessor to @p buffer, a device buffer containing a subset of the data points of this data set described by
+         *        @p attr, for the use in SYCL kernels.
+         * @details The accessor always returns `real_type` values independent of the used `storage_type`.
+         * @param[in] buffer the device buffer to access
+         * @param[in] attr the attributes of the data points in @p buffer (may differ from @ref get_attributes() in the number of data points)
+         * @param[in] cgh the SYCL handler of the current command group
+         * @return the (read-only) accessor (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        auto get_device_accessor(device_buffer_type& buffer, [[maybe_unused]] const data_attributes_type& attr, sycl::handler& cgh) {
+            auto acc = buffer.template get_access<sycl::access::mode::read>(cgh);
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_FLOAT
+            return acc;
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_HALF
+            return detail::converting_accessor<options_type, decltype(acc)>(acc);
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_INT8
+            auto acc_params = quantization_buffer_.template get_access<sycl::access::mode::read>(cgh);
+            return detail::dequantizing_accessor<layout, options_type, data_attributes_type, decltype(acc), decltype(acc_params)>(acc, acc_params, attr);
+#endif
+        }
+        /**
+         * @brief Returns an accessor to the device buffer of this data set for the use in SYCL kernels.
+         * @details The accessor always returns `real_type` values independent of the used `storage_type`.
+         * @param[in] cgh the SYCL handler of the current command group
+         * @return the (read-only) accessor (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        auto get_device_accessor(sycl::handler& cgh) { return this->get_device_accessor(device_buffer_, cgh); }
 
     private:
-        // befriend the factory function
+        // befriend the factory functions
         friend auto make_data<layout, Options>(const argv_parser&, const Options&, const mpi::communicator&, const mpi::logger&);
+        friend auto make_query_data<layout, Options>(const argv_parser&, const Options&, const data&, const mpi::communicator&, const mpi::logger&);
+        friend auto make_query_data<layout, Options>(const std::vector<real_type>&, const Options&, const data&, const mpi::communicator&, const mpi::logger&);
 
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                constructor                                                 //
@@ -179,17 +361,75 @@ namespace sycl_lsh {
         /**
          * @brief Construct a new @ref sycl_lsh::data object representing the used data set parsed by the file parser @p parser.
          * @param[in] parser the file parser used to parse the given data file
+         * @param[in] reference if not `nullptr`, the parsed data points are queries searched in @p reference and stored in the same representation
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if the number of dimensions is known at compile time and doesn't match the parsed one.
+         * @throws std::invalid_argument if the number of dimensions doesn't match the one of @p reference.
+         * @throws std::invalid_argument if `SYCL_LSH_REDUCED_DIMS` isn't less than the parsed number of dimensions.
+         */
+        data(const mpi::file_parser<options_type, real_type>& parser, const data* reference, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Construct a new @ref sycl_lsh::data object representing the data points @p parsed_host_buffer of the current MPI rank.
+         * @param[in] attr the attributes of the data set
+         * @param[in] parsed_host_buffer the `attr.rank_size` data points of the current MPI rank in *Array of Structs* layout
+         * @param[in] reference if not `nullptr`, the data points are queries searched in @p reference and stored in the same representation
          * @param[in] comm the used @ref sycl_lsh::mpi::communicator
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if the number of dimensions is known at compile time and doesn't match the one of @p attr.
+         * @throws std::invalid_argument if the number of dimensions doesn't match the one of @p reference.
+         * @throws std::invalid_argument if `SYCL_LSH_REDUCED_DIMS` isn't less than the number of dimensions of @p attr.
+         */
+        data(const data_attributes_type& attr, original_host_buffer_type parsed_host_buffer, const data* reference,
+             const mpi::communicator& comm, const mpi::logger& logger);
+#if defined(SYCL_LSH_REDUCED_DIMS)
+        /**
+         * @brief Projects the data points @p parsed_host_buffer to `SYCL_LSH_REDUCED_DIMS` dimensions using the random projection matrix on
+         *        the device.
+         * @details The projection matrix is generated using a fixed seed (i.e. identical on all MPI ranks without any communication) or
+         *          copied from @p reference. Its values are standard normal distributed and scaled by `1 / sqrt(SYCL_LSH_REDUCED_DIMS)` such
+         *          that the squared euclidean distances are preserved in expectation.
+         * @param[in] parsed_host_buffer the original data points of the current MPI rank in *Array of Structs* layout
+         * @param[in] reference if not `nullptr`, the data points are queries projected using the projection matrix of @p reference
+         * @param[in] queue the queue used to generate the projection matrix and to project the data points
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         * @return the projected data points in *Array of Structs* layout (`[[nodiscard]]`)
          */
-        data(const mpi::file_parser<options_type, real_type>& parser, const mpi::communicator& comm, const mpi::logger& logger);
+        [[nodiscard]]
+        original_host_buffer_type reduce_dimensions(const original_host_buffer_type& parsed_host_buffer, const data* reference, sycl::queue& queue,
+                                                    const mpi::logger& logger);
+
+        /// The seed of the random projection matrix.
+        static constexpr std::uint64_t projection_seed = 0x5245'4455'4345'4453;   // "REDUCEDS"
+#endif
 
         const mpi::communicator& comm_;
 
         const data_attributes_type data_attributes_;
+        const index_type original_dims_;
 
         device_buffer_type device_buffer_;
         host_buffer_type host_buffer_;
+        // the second host buffer used to receive the elements of the previous MPI rank while the host buffer is being sent
+        host_buffer_type receive_buffer_;
+        std::array<MPI_Request, 2> requests_ = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+        // the start of the currently running send/receive (used to measure the transfer time)
+        mpi::communication_profiler::clock::time_point send_receive_start_;
+        // the MPI rank owning the data points currently stored in the host buffer
+        int host_buffer_rank_ = comm_.rank();
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        original_host_buffer_type original_host_buffer_;
+#endif
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_INT8
+        // the per dimension offsets (first dims values) and scales (last dims values) used to dequantize the data points
+        sycl::buffer<real_type, 1> quantization_buffer_;
+#endif
+#if defined(SYCL_LSH_REDUCED_DIMS)
+        // the SYCL_LSH_REDUCED_DIMS x original dims random projection matrix (row-major)
+        sycl::buffer<real_type, 1> projection_buffer_;
+#endif
     };
     
 
@@ -215,52 +455,259 @@ namespace sycl_lsh {
     // ---------------------------------------------------------------------------------------------------------- //
     template <memory_layout layout, typename Options>
     data<layout, Options>::data(const mpi::file_parser<options_type, real_type>& parser,
+                                const data* reference,
+                                const mpi::communicator& comm,
+                                const mpi::logger& logger)
+            : data(data_attributes_type(parser.parse_total_size(), parser.parse_rank_size(), parser.parse_dims()),
+                   parser.parse_content(), reference, comm, logger) { }
+
+    template <memory_layout layout, typename Options>
+    data<layout, Options>::data(const data_attributes_type& attr,
+                                original_host_buffer_type parsed_host_buffer,
+                                const data* reference,
                                 const mpi::communicator& comm,
                                 const mpi::logger& logger)
             : comm_(comm),
-              data_attributes_(parser.parse_total_size(), parser.parse_rank_size(), parser.parse_dims()),
-              device_buffer_(data_attributes_.rank_size * data_attributes_.dims),
-              host_buffer_(parser.parse_content())
+#if defined(SYCL_LSH_REDUCED_DIMS)
+              data_attributes_(attr.total_size, attr.rank_size, SYCL_LSH_REDUCED_DIMS),
+#else
+              data_attributes_(attr),
+#endif
+              original_dims_(attr.dims),
+              device_buffer_(data_attributes_.rank_size * data_attributes_.dims)
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_INT8
+              , quantization_buffer_(2 * data_attributes_.dims)
+#endif
+#if defined(SYCL_LSH_REDUCED_DIMS)
+              , projection_buffer_(data_attributes_.dims * original_dims_)
+#endif
     {
         mpi::timer t(comm_);
 
-        // change memory layout from aos to soa if requested
+        // the number of dimensions must match the one provided at compile time (if any)
+        if constexpr (options_type::dims != 0) {
+            if (data_attributes_.dims != options_type::dims) {
+                throw std::invalid_argument(fmt::format("The number of dimensions of the data set ({}) doesn't match the number of dimensions of the options type ({})!",
+                                                        data_attributes_.dims, options_type::dims));
+            }
+        }
+        // the queries must have the same number of dimensions as the data set they are searched in
+        if (reference != nullptr && original_dims_ != reference->original_dims_) {
+            throw std::invalid_argument(fmt::format("The number of dimensions of the query set ({}) doesn't match the number of dimensions of the data set ({})!",
+                                                    original_dims_, reference->original_dims_));
+        }
+
+        // the queue used to transpose the data points and to copy them to the device
+        sycl::queue queue(device_selector{ comm_ }, sycl::async_handler(&sycl_exception_handler));
+
+#if defined(SYCL_LSH_REDUCED_DIMS)
+        if (data_attributes_.dims >= original_dims_) {
+            throw std::invalid_argument(fmt::format("The reduced number of dimensions ({}) must be less than the number of dimensions of the data set ({})!",
+                                                    data_attributes_.dims, original_dims_));
+        }
+        // keep the original data points for the exact re-ranking and continue with the projected ones
+        original_host_buffer_ = std::move(parsed_host_buffer);
+        parsed_host_buffer = this->reduce_dimensions(original_host_buffer_, reference, queue, logger);
+#endif
+
+        // change memory layout from aos to soa if requested (on the device and in-place in the host buffer)
         if constexpr (layout == memory_layout::soa) {
-            host_buffer_type soa_host_buffer(data_attributes_.rank_size * data_attributes_.dims);
-            data_attributes<memory_layout::aos, index_type> parsed_data_attributes(data_attributes_);
+            sycl::buffer<real_type, 1> soa_buffer(sycl::range<>(parsed_host_buffer.size()));
+            {
+                sycl::buffer<real_type, 1> aos_buffer(parsed_host_buffer.data(), sycl::range<>(parsed_host_buffer.size()),
+                                                      { sycl::property::buffer::use_host_ptr() });
+                aos_buffer.set_final_data(nullptr);
+
+                queue.submit([&](sycl::handler& cgh) {
+                    auto acc_aos = aos_buffer.template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_soa = soa_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    const data_attributes_type attr = data_attributes_;
+                    const get_linear_id<data<memory_layout::soa, options_type>> get_linear_id_soa{};
+
+                    cgh.parallel_for<kernel_transpose_data>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                        const index_type point = item.get_linear_id();
+                        for (index_type dim = 0; dim < attr.dims; ++dim) {
+                            acc_soa[get_linear_id_soa(point, dim, attr)] = acc_aos[point * attr.dims + dim];
+                        }
+                    });
+                });
+                // the destruction of aos_buffer waits until the transposition has been finished
+            }
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_soa = soa_buffer.template get_access<sycl::access::mode::read>(cgh);
+                cgh.copy(acc_soa, parsed_host_buffer.data());
+            });
+            queue.wait_and_throw();
+        }
 
-            const get_linear_id<data<memory_layout::soa, options_type>> get_linear_id_soa;
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_FLOAT
+        host_buffer_ = std::move(parsed_host_buffer);
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_HALF
+        // convert the data points to half precision
+        host_buffer_.resize(parsed_host_buffer.size());
+        std::transform(parsed_host_buffer.begin(), parsed_host_buffer.end(), host_buffer_.begin(),
+                       [](const real_type val) { return static_cast<storage_type>(val); });
+#if !defined(SYCL_LSH_REDUCED_DIMS)
+        original_host_buffer_ = std::move(parsed_host_buffer);
+#endif
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_INT8
+        {
+            const get_linear_id<data> get_linear_id_functor{};
+            constexpr real_type max_quantized_value = std::numeric_limits<storage_type>::max();
+            auto acc_params = quantization_buffer_.template get_access<sycl::access::mode::discard_write>();
+            if (reference != nullptr) {
+                // queries must be quantized exactly like the data set they are searched in
+                sycl::buffer<real_type, 1> reference_quantization_buffer = reference->quantization_buffer_;
+                auto acc_reference_params = reference_quantization_buffer.template get_access<sycl::access::mode::read>();
+                for (index_type i = 0; i < 2 * data_attributes_.dims; ++i) {
+                    acc_params[i] = acc_reference_params[i];
+                }
+            } else {
+                // calculate the value range of each dimension over ALL data points
+                std::vector<real_type> min_values(data_attributes_.dims, std::numeric_limits<real_type>::max());
+                std::vector<real_type> max_values(data_attributes_.dims, std::numeric_limits<real_type>::lowest());
+                for (index_type point = 0; point < data_attributes_.rank_size; ++point) {
+                    for (index_type dim = 0; dim < data_attributes_.dims; ++dim) {
+                        const real_type val = parsed_host_buffer[get_linear_id_functor(point, dim, data_attributes_)];
+                        min_values[dim] = std::min(min_values[dim], val);
+                        max_values[dim] = std::max(max_values[dim], val);
+                    }
+                }
+                MPI_Allreduce(MPI_IN_PLACE, min_values.data(), min_values.size(), mpi::type_cast<real_type>(), MPI_MIN, comm_.get());
+                MPI_Allreduce(MPI_IN_PLACE, max_values.data(), max_values.size(), mpi::type_cast<real_type>(), MPI_MAX, comm_.get());
 
+                // quantize each dimension to [0, 255]
+                for (index_type dim = 0; dim < data_attributes_.dims; ++dim) {
+                    acc_params[dim] = min_values[dim];
+                    acc_params[data_attributes_.dims + dim] = (max_values[dim] - min_values[dim]) / max_quantized_value;
+                }
+            }
+            host_buffer_.resize(parsed_host_buffer.size());
             for (index_type point = 0; point < data_attributes_.rank_size; ++point) {
                 for (index_type dim = 0; dim < data_attributes_.dims; ++dim) {
-                    soa_host_buffer[get_linear_id_soa(point, dim, data_attributes_)]
-                            = host_buffer_[point * data_attributes_.dims + dim];
+                    const index_type idx = get_linear_id_functor(point, dim, data_attributes_);
+                    const real_type scale = acc_params[data_attributes_.dims + dim];
+                    const real_type val = scale == 0.0 ? 0.0 : std::round((parsed_host_buffer[idx] - acc_params[dim]) / scale);
+                    host_buffer_[idx] = static_cast<storage_type>(std::clamp<real_type>(val, 0.0, max_quantized_value));
                 }
             }
-
-            host_buffer_ = std::move(soa_host_buffer);
         }
+#if !defined(SYCL_LSH_REDUCED_DIMS)
+        original_host_buffer_ = std::move(parsed_host_buffer);
+#endif
+#endif
+
+        // copy data to device buffer (without an additional host copy managed by the SYCL runtime)
+        queue.submit([&](sycl::handler& cgh) {
+            auto acc = device_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+            cgh.copy(host_buffer_.data(), acc);
+        });
+        queue.wait_and_throw();
+        receive_buffer_.resize(host_buffer_.size());
+
+        logger.log("Created data object in {}.\n", t.elapsed());
+    }
+
+
+#if defined(SYCL_LSH_REDUCED_DIMS)
+    template <memory_layout layout, typename Options>
+    [[nodiscard]]
+    typename data<layout, Options>::original_host_buffer_type data<layout, Options>::reduce_dimensions(const original_host_buffer_type& parsed_host_buffer,
+                                                                                                       const data* reference, sycl::queue& queue,
+                                                                                                       const mpi::logger& logger) {
+        mpi::timer t(comm_);
 
-        // copy data to device buffer
-        auto acc = device_buffer_.template get_access<sycl::access::mode::discard_write>();
-        for (index_type i = 0; i < acc.get_count(); ++i) {
-            acc[i] = host_buffer_[i];
+        if (reference != nullptr) {
+            // queries must be projected exactly like the data set they are searched in
+            sycl::buffer<real_type, 1> reference_projection_buffer = reference->projection_buffer_;
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_reference_projection = reference_projection_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_projection = projection_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(acc_reference_projection, acc_projection);
+            });
+        } else {
+            // generate the projection matrix directly on the device (identical on all MPI ranks, i.e. no broadcast necessary)
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_projection = projection_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+                const detail::philox rng(projection_seed);
+                const real_type scale = real_type{ 1.0 } / std::sqrt(static_cast<real_type>(data_attributes_.dims));
+
+                cgh.parallel_for<kernel_generate_projection_matrix>(sycl::range<>(projection_buffer_.get_count()), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    acc_projection[idx] = rng.normal<real_type>(idx, detail::philox_stream::dimensionality_reduction) * scale;
+                });
+            });
         }
 
-        logger.log("Created data object in {}.\n", t.elapsed());
+        // project all data points (in Array of Structs layout)
+        original_host_buffer_type reduced_host_buffer(static_cast<std::size_t>(data_attributes_.rank_size) * data_attributes_.dims);
+        sycl::buffer<real_type, 1> reduced_buffer(sycl::range<>(reduced_host_buffer.size()));
+        {
+            sycl::buffer<real_type, 1> original_buffer(parsed_host_buffer.data(), sycl::range<>(parsed_host_buffer.size()));
+            original_buffer.set_final_data(nullptr);
+
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_original = original_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_projection = projection_buffer_.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_reduced = reduced_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                const index_type reduced_dims = data_attributes_.dims;
+                const index_type dims = original_dims_;
+
+                cgh.parallel_for<kernel_reduce_dimensions>(sycl::range<>(reduced_host_buffer.size()), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type point = idx / reduced_dims;
+                    const index_type reduced_dim = idx % reduced_dims;
+                    real_type value = 0.0;
+                    for (index_type dim = 0; dim < dims; ++dim) {
+                        value += acc_projection[reduced_dim * dims + dim] * acc_original[point * dims + dim];
+                    }
+                    acc_reduced[idx] = value;
+                });
+            });
+            // the destruction of original_buffer waits until the projection has been finished
+        }
+        queue.submit([&](sycl::handler& cgh) {
+            auto acc_reduced = reduced_buffer.template get_access<sycl::access::mode::read>(cgh);
+            cgh.copy(acc_reduced, reduced_host_buffer.data());
+        });
+        queue.wait_and_throw();
+
+        logger.log("Reduced the number of dimensions from {} to {} in {}.\n", original_dims_, data_attributes_.dims, t.elapsed());
+        return reduced_host_buffer;
     }
+#endif
 
 
     // ---------------------------------------------------------------------------------------------------------- //
     //                                             update host buffer                                             //
     // ---------------------------------------------------------------------------------------------------------- //
     template <memory_layout layout, typename Options>
-    void data<layout, Options>::send_receive_host_buffer() {
+    void data<layout, Options>::start_send_receive_host_buffer() {
         const int destination = (comm_.rank() + 1) % comm_.size();
         const int source = (comm_.size() + (comm_.rank() - 1) % comm_.size()) % comm_.size();
 
-        MPI_Sendrecv_replace(host_buffer_.data(), host_buffer_.size(), mpi::type_cast<typename host_buffer_type::value_type>(),
-                             destination, 0, source, 0, comm_.get(), MPI_STATUS_IGNORE);
+        // the dummy points are only stored contiguously at the end of the host buffer for the AoS layout
+        const std::size_t send_count = layout == memory_layout::aos
+                                       ? data_attributes_.correct_rank_size(host_buffer_rank_) * data_attributes_.dims : host_buffer_.size();
+
+        send_receive_start_ = mpi::communication_profiler::clock::now();
+        MPI_Irecv(receive_buffer_.data(), receive_buffer_.size(), mpi::type_cast<storage_type>(), source, 0, comm_.get(), &requests_[0]);
+        MPI_Isend(host_buffer_.data(), send_count, mpi::type_cast<storage_type>(), destination, 0, comm_.get(), &requests_[1]);
+        const double mpi_time = mpi::communication_profiler::elapsed(send_receive_start_);
+        mpi::communication_profiler::record(mpi::communication_kind::ring_data, send_count * sizeof(storage_type), 0, mpi_time, 0.0, 0.0);
+    }
+
+    template <memory_layout layout, typename Options>
+    void data<layout, Options>::finish_send_receive_host_buffer() {
+        const auto wait_start = mpi::communication_profiler::clock::now();
+        std::array<MPI_Status, 2> statuses;
+        MPI_Waitall(requests_.size(), requests_.data(), statuses.data());
+        const double wait_time = mpi::communication_profiler::elapsed(wait_start);
+        mpi::communication_profiler::record(mpi::communication_kind::ring_data, 0, mpi::communication_profiler::received_bytes<storage_type>(statuses[0]),
+                                            wait_time, wait_time, mpi::communication_profiler::elapsed(send_receive_start_));
+        // the received elements are the new content of the host buffer
+        std::swap(host_buffer_, receive_buffer_);
+        host_buffer_rank_ = (host_buffer_rank_ + comm_.size() - 1) % comm_.size();
     }
 
 }
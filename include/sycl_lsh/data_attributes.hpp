@@ -23,13 +23,15 @@ namespace sycl_lsh {
      * @brief Class containing and managing the attributes of the data set represented by a @ref sycl_lsh::data object.
      * @tparam layout the @ref sycl_lsh::memory_layout type
      * @tparam index_type an integral type (used for indices)
+     * @tparam id_type an integral type at least as wide as @p index_type (used for global IDs and the total size)
      */
-    template <memory_layout layout, typename index_type>
+    template <memory_layout layout, typename index_type, typename id_type = index_type>
     struct data_attributes {
         // ---------------------------------------------------------------------------------------------------------- //
         //                                      template parameter sanity check                                       //
         // ---------------------------------------------------------------------------------------------------------- //
-        static_assert(std::is_integral_v<index_type>, "The template parameter must be an integer type!");
+        static_assert(std::is_integral_v<index_type>, "The second template parameter must be an integer type!");
+        static_assert(std::is_integral_v<id_type> && sizeof(id_type) >= sizeof(index_type), "The third template parameter must be an integer type at least as wide as the second!");
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -41,23 +43,53 @@ namespace sycl_lsh {
          * @param[in] rank_size the number of data points on the current MPI rank
          * @param[in] dims the number of dimensions per data point
          */
-        data_attributes(const index_type total_size, const index_type rank_size, const index_type dims)
+        data_attributes(const id_type total_size, const index_type rank_size, const index_type dims)
                 : total_size(total_size), rank_size(rank_size), dims(dims) { }
         /**
          * @brief Construct a new @ref sycl_lsh::data_attributes object as a copy from @p other.
-         * @details The @ref sycl_lsh::memory_layout my differ, but the index_type must be the same.
+         * @details The @ref sycl_lsh::memory_layout my differ, but the index_type and id_type must be the same.
          * @param[in] other the other @ref sycl_lsh::data_attributes object
          */
         template <memory_layout other_layout>
-        data_attributes(const data_attributes<other_layout, index_type>& other)
+        data_attributes(const data_attributes<other_layout, index_type, id_type>& other)
                 : total_size(other.total_size), rank_size(other.rank_size), dims(other.dims) { }
 
 
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                   sizes                                                    //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Returns the number of **real** data points on the MPI rank @p rank, i.e. without the dummy points padding the last MPI rank
+         *        to `rank_size` data points.
+         * @details The dummy points are neither inserted into the hash tables nor are their k-nearest-neighbors calculated.
+         * @param[in] rank the MPI rank
+         * @return the number of real data points on @p rank (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        constexpr index_type correct_rank_size(const index_type rank) const noexcept {
+            // the global position may exceed the index_type
+            const id_type first_point = static_cast<id_type>(rank) * rank_size;
+            if (first_point >= total_size) {
+                return 0;
+            }
+            return total_size - first_point < rank_size ? static_cast<index_type>(total_size - first_point) : rank_size;
+        }
+        /**
+         * @brief Returns the global ID of the first data point on the MPI rank @p rank.
+         * @param[in] rank the MPI rank
+         * @return the first global ID (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        constexpr id_type first_id(const index_type rank) const noexcept {
+            return static_cast<id_type>(rank) * rank_size;
+        }
+
+
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                 attributes                                                 //
         // ---------------------------------------------------------------------------------------------------------- //
         /// The **total** number of data points of the used data set.
-        const index_type total_size;
+        const id_type total_size;
         /// The number of data points on **the current** MPI rank.
         const index_type rank_size;
         /// The number of dimensions of each data point of the used data set.
@@ -69,12 +101,13 @@ namespace sycl_lsh {
      * @brief Print all attributes set in @p data_attr to the output stream @p out.
      * @tparam layout the @ref sycl_lsh::memory_layout type
      * @tparam index_type an integral type (used for indices)
+     * @tparam id_type an integral type (used for global IDs and the total size)
      * @param[in,out] out the output stream
      * @param[in] data_attr the @ref sycl_lsh::data_attributes
      * @return the output stream
      */
-    template <memory_layout layout, typename index_type>
-    std::ostream& operator<<(std::ostream& out, const data_attributes<layout, index_type>& data_attr) {
+    template <memory_layout layout, typename index_type, typename id_type>
+    std::ostream& operator<<(std::ostream& out, const data_attributes<layout, index_type, id_type>& data_attr) {
         out << fmt::format("memory_layout '{}'\n", layout);
         out << fmt::format("total_size {}\n", data_attr.total_size);
         out << fmt::format("rank_size {}\n", data_attr.rank_size);
@@ -0,0 +1,205 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-22
+ *
+ * @brief Implements the header, the codecs and the value type tags of the versioned, chunked binary file format (v2).
+ * @details File layout (native byte order):
+ *          1. the 48 byte @ref sycl_lsh::detail::binary_v2_header
+ *          2. the chunk index: `num_chunks + 1` absolute byte offsets (`std::uint64_t`), i.e. chunk `i` is stored in `[offset[i], offset[i + 1])`
+ *          3. the chunks, each containing `chunk_size` data points (the last one possibly less) in *Array of Structs* layout encoded
+ *             using the codec of the header
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BINARY_FORMAT_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BINARY_FORMAT_HPP
+
+#if defined(SYCL_LSH_ENABLE_LZ4)
+#include <lz4.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace sycl_lsh::detail {
+
+    /// The magic bytes at the beginning of a binary v2 file.
+    constexpr std::string_view binary_v2_magic = "SYCLLSH2";
+
+    /**
+     * @brief The type of the values stored in a binary v2 file.
+     */
+    enum class binary_value_type : std::uint32_t {
+        /** `float` */
+        float32 = 0,
+        /** `double` */
+        float64 = 1,
+        /** `std::uint32_t` */
+        uint32 = 2,
+        /** `std::int32_t` */
+        int32 = 3,
+        /** `std::uint64_t` */
+        uint64 = 4,
+        /** `std::int64_t` */
+        int64 = 5
+    };
+
+    /**
+     * @brief Returns the @ref sycl_lsh::detail::binary_value_type tag of the type @p T.
+     * @tparam T the value type
+     * @return the type tag (`[[nodiscard]]`)
+     */
+    template <typename T>
+    [[nodiscard]]
+    constexpr binary_value_type binary_value_type_of() noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            return binary_value_type::float32;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return binary_value_type::float64;
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+            return std::is_signed_v<T> ? binary_value_type::int32 : binary_value_type::uint32;
+        } else {
+            static_assert(std::is_integral_v<T> && sizeof(T) == 8, "Unsupported value type for the binary v2 file format!");
+            return std::is_signed_v<T> ? binary_value_type::int64 : binary_value_type::uint64;
+        }
+    }
+
+    /**
+     * @brief The encoding of the chunks of a binary v2 file.
+     */
+    enum class binary_codec : std::uint32_t {
+        /** the raw values */
+        raw = 0,
+        /** the values as IEEE 754 half precision floating point values (floating point values only) */
+        fp16 = 1,
+        /** the bytes of the values are shuffled (first all first bytes, then all second bytes, ...) and compressed using a raw LZ4 block */
+        shuffle_lz4 = 2
+    };
+
+    /**
+     * @brief The header of a binary v2 file.
+     */
+    struct binary_v2_header {
+        /// The magic bytes (@ref sycl_lsh::detail::binary_v2_magic).
+        char magic[8];
+        /// The version of the file format (currently always `2`).
+        std::uint32_t version;
+        /// The type of the stored values (@ref sycl_lsh::detail::binary_value_type).
+        std::uint32_t value_type;
+        /// The total number of data points.
+        std::uint64_t total_size;
+        /// The number of dimensions of each data point.
+        std::uint64_t dims;
+        /// The number of data points per chunk.
+        std::uint64_t chunk_size;
+        /// The encoding of the chunks (@ref sycl_lsh::detail::binary_codec).
+        std::uint32_t codec;
+        /// Reserved for future use.
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(binary_v2_header) == 48, "Unexpected padding in the binary v2 header!");
+
+    /**
+     * @brief Converts the IEEE 754 half precision floating point value @p bits to a `float`.
+     * @param[in] bits the bits of the half precision value
+     * @return the converted value (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    inline float half_bits_to_float(const std::uint16_t bits) noexcept {
+        const std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000u) << 16;
+        std::uint32_t exponent = (bits >> 10) & 0x1Fu;
+        std::uint32_t mantissa = bits & 0x3FFu;
+        std::uint32_t result;
+        if (exponent == 0x1Fu) {
+            // infinity or NaN
+            result = sign | 0x7F800000u | (mantissa << 13);
+        } else if (exponent != 0) {
+            // normalized value
+            result = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        } else if (mantissa == 0) {
+            // signed zero
+            result = sign;
+        } else {
+            // subnormal value -> normalize
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            result = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+        float value;
+        std::memcpy(&value, &result, sizeof(float));
+        return value;
+    }
+
+    /**
+     * @brief Decodes the chunk @p src encoded using @p codec to the @p num_values values @p dst.
+     * @tparam T the type of the values
+     * @param[in] codec the encoding of the chunk
+     * @param[in] src the encoded chunk
+     * @param[in] src_size the number of bytes of the encoded chunk
+     * @param[in] num_values the number of values in the chunk
+     * @param[out] dst the decoded values
+     * @param[in,out] scratch a scratch buffer (reused between calls)
+     * @return `true` if the chunk could be decoded, `false` if it's broken or the codec isn't supported (`[[nodiscard]]`)
+     */
+    template <typename T>
+    [[nodiscard]]
+    inline bool decode_binary_chunk(const binary_codec codec, const char* src, const std::size_t src_size, const std::size_t num_values,
+                                    T* dst, [[maybe_unused]] std::vector<unsigned char>& scratch)
+    {
+        switch (codec) {
+            case binary_codec::raw:
+                if (src_size != num_values * sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(dst, src, src_size);
+                return true;
+            case binary_codec::fp16:
+                if constexpr (std::is_floating_point_v<T>) {
+                    if (src_size != num_values * sizeof(std::uint16_t)) {
+                        return false;
+                    }
+                    for (std::size_t i = 0; i < num_values; ++i) {
+                        std::uint16_t bits;
+                        std::memcpy(&bits, src + i * sizeof(std::uint16_t), sizeof(std::uint16_t));
+                        dst[i] = static_cast<T>(half_bits_to_float(bits));
+                    }
+                    return true;
+                } else {
+                    return false;
+                }
+            case binary_codec::shuffle_lz4:
+#if defined(SYCL_LSH_ENABLE_LZ4)
+            {
+                const std::size_t num_bytes = num_values * sizeof(T);
+                scratch.resize(num_bytes);
+                const int decompressed = LZ4_decompress_safe(src, reinterpret_cast<char*>(scratch.data()), static_cast<int>(src_size), static_cast<int>(num_bytes));
+                if (decompressed < 0 || static_cast<std::size_t>(decompressed) != num_bytes) {
+                    return false;
+                }
+                // undo the byte shuffle
+                unsigned char* bytes = reinterpret_cast<unsigned char*>(dst);
+                for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+                    for (std::size_t i = 0; i < num_values; ++i) {
+                        bytes[i * sizeof(T) + byte] = scratch[byte * num_values + i];
+                    }
+                }
+                return true;
+            }
+#else
+                return false;
+#endif
+        }
+        return false;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BINARY_FORMAT_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-18
+ *
+ * @brief Implements the lookup of a hash bucket in the compact offsets representation of the hash tables.
+ * @details The compact representation only stores the non-empty hash buckets of each hash table as (hash value, offset) pairs sorted by
+ *          the hash values. Each hash table is terminated by a sentinel with the hash value `hash_table_size` and the end of the hash
+ *          table as offset, i.e. the end of a hash bucket is always the offset of the following entry.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMPACT_OFFSETS_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMPACT_OFFSETS_HPP
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief The range `[begin, end)` of the data points of a hash bucket in its hash table.
+     * @tparam index_type an integral type (used for indices)
+     */
+    template <typename index_type>
+    struct bucket_range {
+        /// The offset of the first data point of the hash bucket.
+        index_type begin;
+        /// The offset one past the last data point of the hash bucket.
+        index_type end;
+    };
+
+    /**
+     * @brief Searches the hash bucket @p hash_value of the hash table @p hash_table in the compact offsets using a binary search.
+     * @details If the hash bucket is empty, an empty range starting at the next non-empty hash bucket is returned, i.e. the begin of
+     *          the range of the first and the end of the range of the last hash bucket of a sequence of hash buckets enclose all of their
+     *          data points.
+     * @tparam index_type an integral type (used for indices)
+     * @tparam hash_value_type an integral type (used for the hash values)
+     * @tparam AccDirectory the type of the directory `sycl::accessor`
+     * @tparam AccHashValues the type of the hash values `sycl::accessor`
+     * @tparam AccOffsets the type of the offsets `sycl::accessor`
+     * @param[in] acc_directory the position of the first entry of each hash table (`num_hash_tables + 1` values)
+     * @param[in] acc_hash_values the sorted hash values of the non-empty hash buckets (including the sentinel of each hash table)
+     * @param[in] acc_offsets the offsets of the non-empty hash buckets (including the sentinel of each hash table)
+     * @param[in] hash_table the hash table to search in
+     * @param[in] hash_value the hash value (= hash bucket) to search for
+     * @return the range of the data points in the hash bucket (`[[nodiscard]]`)
+     */
+    template <typename index_type, typename hash_value_type, typename AccDirectory, typename AccHashValues, typename AccOffsets>
+    [[nodiscard]]
+    inline bucket_range<index_type> find_hash_bucket(const AccDirectory& acc_directory, const AccHashValues& acc_hash_values, const AccOffsets& acc_offsets,
+                                                     const index_type hash_table, const hash_value_type hash_value) {
+        // search the first entry with a hash value not less than hash_value (the sentinel is never less)
+        index_type first = acc_directory[hash_table];
+        index_type last = acc_directory[hash_table + 1] - 1;
+        while (first < last) {
+            const index_type mid = first + (last - first) / 2;
+            if (acc_hash_values[mid] < hash_value) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        const index_type begin = acc_offsets[first];
+        return bucket_range<index_type>{ begin, acc_hash_values[first] == hash_value ? static_cast<index_type>(acc_offsets[first + 1]) : begin };
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMPACT_OFFSETS_HPP
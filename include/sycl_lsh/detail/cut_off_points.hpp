@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-22
+ *
+ * @brief Implements the calculation of the cut-off points used in the entropy-based hash functions.
+ * @details The cut-off points are either calculated exactly using a distributed sort or approximated using a histogram whose size is
+ *          specified at compile time using the `SYCL_LSH_CUT_OFF_POINTS_HISTOGRAM_SIZE` CMake option.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_CUT_OFF_POINTS_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_CUT_OFF_POINTS_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/sort.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace sycl_lsh {
+
+    // SYCL kernel name needed to silence ComputeCpp warnings
+    class kernel_cut_off_points_histogram;
+
+}
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Calculates the `opt.num_cut_off_points - 1` cut-off points splitting the @p values of all MPI ranks into
+     *        `opt.num_cut_off_points` equally sized parts.
+     * @details If `SYCL_LSH_CUT_OFF_POINTS_HISTOGRAM_SIZE` is defined, the values are counted in a histogram with equally sized bins
+     *          spanning the global value range on the device. The histograms of all MPI ranks are combined using a single `MPI_Allreduce`
+     *          and the cut-off points are linearly interpolated inside their bins. \n
+     *          Otherwise the values are sorted exactly using a distributed odd-even sort.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam DataAttributes the used @ref sycl_lsh::data_attributes type
+     * @param[in] queue the SYCL queue used to calculate the histogram
+     * @param[in] values the values of the current MPI rank (`rank_size` values)
+     * @param[in] opt the used @ref sycl_lsh::options
+     * @param[in] attr the used @ref sycl_lsh::data_attributes
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @return the cut-off points (identical on all MPI ranks) (`[[nodiscard]]`)
+     */
+    template <typename Options, typename DataAttributes>
+    [[nodiscard]]
+    std::vector<typename Options::real_type> calculate_cut_off_points([[maybe_unused]] sycl::queue& queue, sycl::buffer<typename Options::real_type, 1>& values,
+                                                                      const Options& opt, const DataAttributes& attr, const mpi::communicator& comm)
+    {
+        using real_type = typename Options::real_type;
+        using index_type = typename Options::index_type;
+        using id_type = typename Options::id_type;
+
+        std::vector<real_type> cut_off_points(opt.num_cut_off_points - 1, 0.0);
+
+        // the positions of the cut-off points in the globally sorted values
+        std::vector<id_type> cut_off_points_idx(cut_off_points.size());
+        const id_type jump = attr.first_id(comm.size()) / opt.num_cut_off_points;
+        for (index_type cop = 0; cop < cut_off_points_idx.size(); ++cop) {
+            cut_off_points_idx[cop] = (cop + 1) * jump;
+        }
+
+#if defined(SYCL_LSH_CUT_OFF_POINTS_HISTOGRAM_SIZE)
+        constexpr index_type num_bins = SYCL_LSH_CUT_OFF_POINTS_HISTOGRAM_SIZE;
+
+        // calculate the global value range
+        real_type range[2] = { std::numeric_limits<real_type>::max(), std::numeric_limits<real_type>::max() };
+        {
+            auto acc_values = values.template get_access<sycl::access::mode::read>();
+            for (index_type idx = 0; idx < attr.rank_size; ++idx) {
+                range[0] = std::min(range[0], acc_values[idx]);
+                // negated to get the maximum with the same MPI_MIN reduction
+                range[1] = std::min(range[1], -acc_values[idx]);
+            }
+        }
+        auto allreduce_start = mpi::communication_profiler::clock::now();
+        MPI_Allreduce(MPI_IN_PLACE, range, 2, mpi::type_cast<real_type>(), MPI_MIN, comm.get());
+        mpi::communication_profiler::record_blocking(mpi::communication_kind::allreduce, sizeof(range), sizeof(range), allreduce_start);
+        const real_type min_value = range[0];
+        const real_type bin_width = (-range[1] - min_value) / num_bins;
+        if (bin_width <= 0.0) {
+            // all values are identical
+            std::fill(cut_off_points.begin(), cut_off_points.end(), min_value);
+            return cut_off_points;
+        }
+
+        // count the values per bin (the counts of the current MPI rank fit into the index_type, the global counts may not)
+        std::vector<index_type> rank_histogram(num_bins, 0);
+        {
+            sycl::buffer<index_type, 1> histogram_buffer(rank_histogram.data(), rank_histogram.size());
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_values = values.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_histogram = histogram_buffer.template get_access<sycl::access::mode::atomic>(cgh);
+
+                cgh.parallel_for<kernel_cut_off_points_histogram>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    const index_type bin = static_cast<index_type>((acc_values[idx] - min_value) / bin_width);
+                    acc_histogram[bin < num_bins ? bin : num_bins - 1].fetch_add(1);
+                });
+            });
+        }
+        std::vector<id_type> histogram(rank_histogram.begin(), rank_histogram.end());
+        allreduce_start = mpi::communication_profiler::clock::now();
+        MPI_Allreduce(MPI_IN_PLACE, histogram.data(), histogram.size(), mpi::type_cast<id_type>(), MPI_SUM, comm.get());
+        mpi::communication_profiler::record_blocking(mpi::communication_kind::allreduce, histogram.size() * sizeof(id_type),
+                                                     histogram.size() * sizeof(id_type), allreduce_start);
+
+        // linearly interpolate the cut-off points inside their bins
+        index_type bin = 0;
+        id_type bin_begin = 0;
+        for (index_type cop = 0; cop < cut_off_points.size(); ++cop) {
+            while (bin + 1 < num_bins && bin_begin + histogram[bin] <= cut_off_points_idx[cop]) {
+                bin_begin += histogram[bin];
+                ++bin;
+            }
+            const real_type fraction = histogram[bin] == 0 ? 0.0 : (cut_off_points_idx[cop] - bin_begin + 0.5) / histogram[bin];
+            cut_off_points[cop] = min_value + (bin + fraction) * bin_width;
+        }
+#else
+        std::vector<real_type> sorted_values(attr.rank_size);
+        {
+            auto acc_values = values.template get_access<sycl::access::mode::read>();
+            for (index_type idx = 0; idx < attr.rank_size; ++idx) {
+                sorted_values[idx] = acc_values[idx];
+            }
+        }
+
+        // sort the values in a distributed fashion
+        mpi::sort(sorted_values, comm);
+
+        // fill cut-off points which are located on the current MPI rank
+        for (index_type cop = 0; cop < cut_off_points.size(); ++cop) {
+            // check if index belongs to current MPI rank
+            if (cut_off_points_idx[cop] >= attr.first_id(comm.rank()) && cut_off_points_idx[cop] < attr.first_id(comm.rank() + 1)) {
+                cut_off_points[cop] = sorted_values[cut_off_points_idx[cop] % attr.rank_size];
+            }
+        }
+
+        // combine to final cut-off points on all MPI ranks
+        const auto allreduce_start = mpi::communication_profiler::clock::now();
+        MPI_Allreduce(MPI_IN_PLACE, cut_off_points.data(), cut_off_points.size(), mpi::type_cast<real_type>(), MPI_SUM, comm.get());
+        mpi::communication_profiler::record_blocking(mpi::communication_kind::allreduce, cut_off_points.size() * sizeof(real_type),
+                                                     cut_off_points.size() * sizeof(real_type), allreduce_start);
+#endif
+
+        return cut_off_points;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_CUT_OFF_POINTS_HPP
@@ -25,6 +25,27 @@
 #define SYCL_LSH_NON_BLOCKING_TIMER 1
 #define SYCL_LSH_BLOCKING_TIMER 2
 
+// defines values to test against the SYCL_LSH_KNN_KERNEL
+#define SYCL_LSH_KNN_KERNEL_QUERY 0
+#define SYCL_LSH_KNN_KERNEL_BUCKET 1
+
+// defines values to test against the SYCL_LSH_TOP_K
+#define SYCL_LSH_TOP_K_BUBBLE 0
+#define SYCL_LSH_TOP_K_SORTED 1
+#define SYCL_LSH_TOP_K_HEAP 2
+#define SYCL_LSH_TOP_K_MERGE 3
+
+// defines values to test against the SYCL_LSH_STORAGE
+#define SYCL_LSH_STORAGE_FLOAT 0
+#define SYCL_LSH_STORAGE_HALF 1
+#define SYCL_LSH_STORAGE_INT8 2
+
+// defines values to test against the SYCL_LSH_DISTRIBUTION
+#define SYCL_LSH_DISTRIBUTION_RING 0
+#define SYCL_LSH_DISTRIBUTION_ROUTING 1
+#define SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING 2
+#define SYCL_LSH_DISTRIBUTION_STATIONARY_RING 3
+
 namespace sycl_lsh::detail {
 
     /**
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-30
+ *
+ * @brief Implements the @ref sycl_lsh::detail::device_memory_tracker class accounting the device memory used by the SYCL buffers.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_MEMORY_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_MEMORY_HPP
+
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Converts @p bytes to MiB.
+     * @param[in] bytes the number of bytes
+     * @return the number of MiB (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    inline double to_mib(const std::size_t bytes) noexcept {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    /**
+     * @brief Accounts the device memory of the named SYCL buffers of the current MPI rank (summed over all its devices).
+     * @details The tracker only knows the sizes reported via @ref allocate() and @ref release(), i.e. memory allocated internally by the SYCL
+     *          runtime isn't accounted.
+     */
+    class device_memory_tracker {
+    public:
+        /**
+         * @brief Construct a new @ref sycl_lsh::detail::device_memory_tracker.
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         */
+        device_memory_tracker(const mpi::communicator& comm, const mpi::logger& logger) : comm_(comm), logger_(logger) { }
+
+        /**
+         * @brief Accounts the buffer @p name with a size of @p bytes (replaces the previous size if @p name is already accounted).
+         * @param[in] name the name of the buffer
+         * @param[in] bytes the size of the buffer in bytes
+         */
+        void allocate(const std::string& name, const std::size_t bytes) {
+            this->release(name);
+            allocated_[name] = bytes;
+            current_ += bytes;
+            peak_ = std::max(peak_, current_);
+            largest_[name] = std::max(largest_[name], bytes);
+        }
+        /**
+         * @brief Removes the buffer @p name from the accounted buffers (nop if @p name isn't accounted).
+         * @param[in] name the name of the buffer
+         */
+        void release(const std::string& name) {
+            const auto it = allocated_.find(name);
+            if (it != allocated_.end()) {
+                current_ -= it->second;
+                allocated_.erase(it);
+            }
+        }
+
+        /**
+         * @brief Returns the currently accounted device memory of the current MPI rank.
+         * @return the number of bytes (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        std::size_t current() const noexcept { return current_; }
+        /**
+         * @brief Returns the peak accounted device memory of the current MPI rank.
+         * @return the number of bytes (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        std::size_t peak() const noexcept { return peak_; }
+
+        /**
+         * @brief Logs the largest size of each buffer on MPI rank 0 and the current and peak usage of each MPI rank (collective operation).
+         * @param[in] phase the description of the finished phase
+         */
+        void report(const std::string_view phase) const {
+            logger_.log("Device memory usage after {} (buffers of MPI rank 0):\n", phase);
+            for (const auto& [name, bytes] : largest_) {
+                logger_.log("  {:<40} {:10.2f} MiB{}\n", name, to_mib(bytes), allocated_.count(name) > 0 ? "" : " (released)");
+            }
+            logger_.log_on_all("  [{}] current: {:.2f} MiB, peak: {:.2f} MiB\n", comm_.rank(), to_mib(current_), to_mib(peak_));
+        }
+
+    private:
+        const mpi::communicator& comm_;
+        const mpi::logger& logger_;
+
+        /// The sizes of the currently allocated buffers.
+        std::map<std::string, std::size_t> allocated_;
+        /// The largest size each buffer ever had.
+        std::map<std::string, std::size_t> largest_;
+        std::size_t current_ = 0;
+        std::size_t peak_ = 0;
+    };
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_MEMORY_HPP
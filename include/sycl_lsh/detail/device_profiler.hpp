@@ -0,0 +1,181 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-28
+ *
+ * @brief Implements the @ref sycl_lsh::detail::device_profiler class measuring the device times of the submitted kernels and transfers.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_PROFILER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_PROFILER_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief The commands whose device times are measured by the @ref sycl_lsh::detail::device_profiler.
+     */
+    enum class profiled_command {
+        /** the kernel `kernel_calculate_hash_values` */
+        calculate_hash_values = 0,
+        /** the kernel `kernel_count_hash_values` */
+        count_hash_values = 1,
+        /** the kernel `kernel_calculate_offsets` */
+        calculate_offsets = 2,
+        /** the kernel `kernel_fill_hash_tables` */
+        fill_hash_tables = 3,
+        /** the k-nearest-neighbor kernels (`kernel_calculate_knn` or `kernel_calculate_knn_bucket_cooperative`) */
+        calculate_knn = 4,
+        /** a transfer from the host to the device */
+        copy_to_device = 5,
+        /** a transfer from the device to the host */
+        copy_to_host = 6
+    };
+
+    /// The names of the @ref sycl_lsh::detail::profiled_command values (in the same order).
+    constexpr std::array<std::string_view, 7> profiled_command_names = { "kernel_calculate_hash_values", "kernel_count_hash_values",
+                                                                         "kernel_calculate_offsets", "kernel_fill_hash_tables",
+                                                                         "kernel_calculate_knn", "copy to device", "copy to host" };
+
+    /**
+     * @brief Measures the device times of the submitted kernels and transfers using the profiling information of their SYCL events.
+     * @details Only enabled if the [CMake](https://cmake.org/) option *SYCL_LSH_ENABLE_PROFILING* is set, otherwise all member functions
+     *          are no-ops. \n
+     *          Recording an event doesn't synchronize anything. The device times are only queried in @ref report() after the profiled
+     *          phase has been finished, summed per MPI rank, command and round and aggregated over all MPI ranks (min/avg/max).
+     */
+    class device_profiler {
+    public:
+        /**
+         * @brief Construct a new @ref sycl_lsh::detail::device_profiler.
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         */
+        device_profiler(const mpi::communicator& comm [[maybe_unused]], const mpi::logger& logger [[maybe_unused]])
+#if defined(SYCL_LSH_PROFILING)
+            : comm_(comm), logger_(logger)
+#endif
+        { }
+
+        /**
+         * @brief Returns the properties all profiled SYCL queues must be created with.
+         * @return the `sycl::property_list` (containing `sycl::property::queue::enable_profiling` if profiling is enabled) (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        static sycl::property_list queue_properties() {
+#if defined(SYCL_LSH_PROFILING)
+            return sycl::property_list{ sycl::property::queue::enable_profiling() };
+#else
+            return sycl::property_list{};
+#endif
+        }
+
+        /**
+         * @brief Sets the round (e.g. of the k-nearest-neighbor ring) all following recorded events belong to.
+         * @param[in] round the current round
+         */
+        void set_round(const std::size_t round [[maybe_unused]]) noexcept {
+#if defined(SYCL_LSH_PROFILING)
+            round_ = round;
+#endif
+        }
+        /**
+         * @brief Records the @p event of the @p command submitted in the current round.
+         * @param[in] command the submitted command
+         * @param[in] event the SYCL event returned by `sycl::queue::submit`
+         */
+        void record(const profiled_command command [[maybe_unused]], const sycl::event& event [[maybe_unused]]) {
+#if defined(SYCL_LSH_PROFILING)
+            events_.push_back(recorded_event{ command, round_, event });
+#endif
+        }
+        /**
+         * @brief Logs the device times of all recorded events aggregated over all MPI ranks and clears them (collective operation).
+         * @details Waits only for the recorded events.
+         * @param[in] phase the description of the profiled phase
+         */
+        void report(const std::string_view phase [[maybe_unused]]) {
+#if defined(SYCL_LSH_PROFILING)
+            constexpr std::size_t num_commands = profiled_command_names.size();
+            std::uint64_t num_rounds = 0;
+            for (const recorded_event& e : events_) {
+                num_rounds = std::max<std::uint64_t>(num_rounds, e.round + 1);
+            }
+            num_rounds = mpi::max(num_rounds, comm_);
+            if (num_rounds == 0) {
+                return;
+            }
+
+            // sum the device times of the current MPI rank per command and round
+            std::vector<double> times(num_commands * num_rounds, 0.0);
+            std::vector<int> recorded(num_commands * num_rounds, 0);
+            for (recorded_event& e : events_) {
+                e.event.wait();
+                const auto start = e.event.get_profiling_info<sycl::info::event_profiling::command_start>();
+                const auto end = e.event.get_profiling_info<sycl::info::event_profiling::command_end>();
+                const std::size_t idx = static_cast<std::size_t>(e.command) * num_rounds + e.round;
+                times[idx] += static_cast<double>(end - start) / 1'000'000.0;
+                recorded[idx] = 1;
+            }
+            events_.clear();
+
+            // aggregate over all MPI ranks (MPI ranks without the command in a round are ignored)
+            std::vector<double> min_times(times.size());
+            std::vector<double> max_times(times.size());
+            std::vector<double> sum_times(times.size());
+            std::vector<int> num_ranks(times.size());
+            for (std::size_t i = 0; i < times.size(); ++i) {
+                min_times[i] = recorded[i] ? times[i] : std::numeric_limits<double>::max();
+                max_times[i] = recorded[i] ? times[i] : std::numeric_limits<double>::lowest();
+            }
+            MPI_Allreduce(MPI_IN_PLACE, min_times.data(), min_times.size(), mpi::type_cast<double>(), MPI_MIN, comm_.get());
+            MPI_Allreduce(MPI_IN_PLACE, max_times.data(), max_times.size(), mpi::type_cast<double>(), MPI_MAX, comm_.get());
+            MPI_Allreduce(times.data(), sum_times.data(), times.size(), mpi::type_cast<double>(), MPI_SUM, comm_.get());
+            MPI_Allreduce(recorded.data(), num_ranks.data(), recorded.size(), mpi::type_cast<int>(), MPI_SUM, comm_.get());
+
+            logger_.log("Device times of {} in ms (min/avg/max over all MPI ranks):\n", phase);
+            for (std::size_t command = 0; command < num_commands; ++command) {
+                for (std::uint64_t round = 0; round < num_rounds; ++round) {
+                    const std::size_t idx = command * num_rounds + round;
+                    if (num_ranks[idx] == 0) continue;
+                    logger_.log("  {:<30} round {:>4}: {:10.3f} / {:10.3f} / {:10.3f}\n", profiled_command_names[command], round + 1,
+                                min_times[idx], sum_times[idx] / num_ranks[idx], max_times[idx]);
+                }
+            }
+#endif
+        }
+
+    private:
+#if defined(SYCL_LSH_PROFILING)
+        /// A recorded SYCL event together with its command and round.
+        struct recorded_event {
+            profiled_command command;
+            std::size_t round;
+            sycl::event event;
+        };
+
+        const mpi::communicator& comm_;
+        const mpi::logger& logger_;
+        std::size_t round_ = 0;
+        std::vector<recorded_event> events_;
+#endif
+    };
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_PROFILER_HPP
@@ -0,0 +1,122 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-20
+ *
+ * @brief Implements a pair of USM device allocations used to directly send and receive device data using a CUDA/ROCm-aware MPI implementation.
+ * @details Only available if the `SYCL_LSH_GPU_AWARE_MPI` CMake option is enabled.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_RING_BUFFER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_RING_BUFFER_HPP
+
+#if defined(SYCL_LSH_GPU_AWARE_MPI)
+
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <array>
+#include <cstddef>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Sends the content of a SYCL buffer to the next MPI rank and receives the content of the previous MPI rank using a ring like
+     *        send pattern **without** staging the data in host memory.
+     * @details The content is copied (device to device) into a USM device allocation which is directly passed to `MPI_Isend`. The receive
+     *          happens into a second USM device allocation, i.e. the used MPI implementation **must** be CUDA/ROCm-aware.
+     * @tparam T the type of the elements
+     */
+    template <typename T>
+    class device_ring_buffer {
+    public:
+        /**
+         * @brief Construct a new @ref sycl_lsh::detail::device_ring_buffer of size @p size allocating two USM device buffers.
+         * @param[in] size the number of elements
+         * @param[in] queue the SYCL queue used to allocate the USM device memory
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] tag the MPI tag used to distinguish the messages of different ring buffers
+         * @param[in] kind the kind of the communication recorded by the @ref sycl_lsh::mpi::communication_profiler
+         */
+        device_ring_buffer(const std::size_t size, sycl::queue& queue, const mpi::communicator& comm, const int tag,
+                           const mpi::communication_kind kind)
+            : size_(size), queue_(queue), comm_(comm), tag_(tag), kind_(kind),
+              send_buffer_(sycl::malloc_device<T>(size, queue)), receive_buffer_(sycl::malloc_device<T>(size, queue)) { }
+        // device memory can't be copied
+        device_ring_buffer(const device_ring_buffer&) = delete;
+        device_ring_buffer& operator=(const device_ring_buffer&) = delete;
+        /**
+         * @brief Destruct the @ref sycl_lsh::detail::device_ring_buffer freeing the USM device allocations.
+         */
+        ~device_ring_buffer() {
+            sycl::free(send_buffer_, queue_);
+            sycl::free(receive_buffer_, queue_);
+        }
+
+        /**
+         * @brief Copies the content of @p buffer to the device send buffer and starts to send it to the next MPI rank and to receive the content
+         *        of the previous MPI rank.
+         * @tparam Buffer the type of the SYCL buffer
+         * @param[in] buffer the SYCL buffer to send (can be changed directly after this function returns)
+         */
+        template <typename Buffer>
+        void start_send_receive(Buffer& buffer) {
+            const int destination = (comm_.rank() + 1) % comm_.size();
+            const int source = (comm_.size() + (comm_.rank() - 1) % comm_.size()) % comm_.size();
+
+            queue_.submit([&](sycl::handler& cgh) {
+                auto acc = buffer.template get_access<sycl::access::mode::read>(cgh);
+                cgh.copy(acc, send_buffer_);
+            });
+            // MPI may only read the send buffer after the copy has been finished
+            queue_.wait_and_throw();
+
+            send_receive_start_ = mpi::communication_profiler::clock::now();
+            MPI_Irecv(receive_buffer_, size_, mpi::type_cast<T>(), source, tag_, comm_.get(), &requests_[0]);
+            MPI_Isend(send_buffer_, size_, mpi::type_cast<T>(), destination, tag_, comm_.get(), &requests_[1]);
+            mpi::communication_profiler::record(kind_, size_ * sizeof(T), 0, mpi::communication_profiler::elapsed(send_receive_start_), 0.0, 0.0);
+        }
+        /**
+         * @brief Waits until the communication started by @ref start_send_receive() has been finished and copies the received content to
+         *        @p buffer.
+         * @tparam Buffer the type of the SYCL buffer
+         * @param[out] buffer the SYCL buffer to copy the received content to
+         */
+        template <typename Buffer>
+        void finish_send_receive(Buffer& buffer) {
+            const auto wait_start = mpi::communication_profiler::clock::now();
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+            const double wait_time = mpi::communication_profiler::elapsed(wait_start);
+            mpi::communication_profiler::record(kind_, 0, size_ * sizeof(T), wait_time, wait_time, mpi::communication_profiler::elapsed(send_receive_start_));
+
+            queue_.submit([&](sycl::handler& cgh) {
+                auto acc = buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(receive_buffer_, acc);
+            });
+            // the receive buffer may only be reused after the copy has been finished
+            queue_.wait_and_throw();
+        }
+
+    private:
+        const std::size_t size_;
+        sycl::queue& queue_;
+        const mpi::communicator& comm_;
+        const int tag_;
+        const mpi::communication_kind kind_;
+
+        T* send_buffer_;
+        T* receive_buffer_;
+        std::array<MPI_Request, 2> requests_ = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+        // the start of the currently running send/receive (used to measure the transfer time)
+        mpi::communication_profiler::clock::time_point send_receive_start_;
+    };
+
+}
+
+#endif
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DEVICE_RING_BUFFER_HPP
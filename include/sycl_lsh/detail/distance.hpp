@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-18
+ *
+ * @brief Implements helper functions to exploit the number of dimensions if it is known at compile time.
+ * @details The number of dimensions is set using the last template parameter of the @ref sycl_lsh::options class.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DISTANCE_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DISTANCE_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Returns the number of dimensions of each data point.
+     * @details Returns the compile time constant `Options::dims` if available, enabling the compiler to fully unroll all loops over the
+     *          dimensions. Otherwise falls back to the runtime value `attr.dims`.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam DataAttributes the used @ref sycl_lsh::data_attributes type
+     * @param[in] attr the used @ref sycl_lsh::data_attributes
+     * @return the number of dimensions (`[[nodiscard]]`)
+     */
+    template <typename Options, typename DataAttributes>
+    [[nodiscard]]
+    constexpr typename Options::index_type get_dims(const DataAttributes& attr) noexcept {
+        if constexpr (Options::dims != 0) {
+            return Options::dims;
+        } else {
+            return attr.dims;
+        }
+    }
+
+    /**
+     * @brief The number of consecutive dimensions loaded at once using a `sycl::vec`.
+     * @details Must evenly divide the number of dimensions in order to guarantee aligned loads for all data points. `1` if the number of
+     *          dimensions isn't known at compile time.
+     * @tparam Options the used @ref sycl_lsh::options type
+     */
+    template <typename Options>
+    constexpr typename Options::index_type vector_width = Options::dims == 0 ? 1
+                                                        : Options::dims % 4 == 0 ? 4
+                                                        : Options::dims % 2 == 0 ? 2
+                                                        : 1;
+
+#if defined(SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE)
+    /**
+     * @brief The number of consecutive dimensions accumulated before the partial distance is compared to the current k-th nearest-neighbor
+     *        distance (early abandoning).
+     * @details `SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE` rounded up to a multiple of @ref sycl_lsh::detail::vector_width.
+     * @tparam Options the used @ref sycl_lsh::options type
+     */
+    template <typename Options>
+    constexpr typename Options::index_type early_abandon_chunk_size = (SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE + vector_width<Options> - 1)
+                                                                      / vector_width<Options> * vector_width<Options>;
+#endif
+
+    /**
+     * @brief Calculates the squared euclidean distance between the data point starting at @p x_first in @p acc_x and the data point
+     *        starting at @p y_first in @p acc_y.
+     * @details The dimensions of both data points must be stored contiguously (i.e. @ref sycl_lsh::memory_layout::aos) and the number of
+     *          dimensions must be known at compile time. The loop is fully unrolled and uses `sycl::vec` loads of
+     *          @ref sycl_lsh::detail::vector_width values. \n
+     *          If `SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE` is defined, the distance is accumulated in chunks of
+     *          @ref sycl_lsh::detail::early_abandon_chunk_size dimensions and the calculation stops as soon as the partial distance reaches
+     *          @p bound. In this case the returned value is only a lower bound of the real distance (but not less than @p bound).
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam AccX the type of the first accessor
+     * @tparam AccY the type of the second accessor
+     * @param[in] acc_x the accessor to the first data point
+     * @param[in] x_first the position of the first dimension of the first data point
+     * @param[in] acc_y the accessor to the second data point
+     * @param[in] y_first the position of the first dimension of the second data point
+     * @param[in] bound the distance above which the exact distance isn't needed (e.g. the current k-th nearest-neighbor distance)
+     * @return the squared euclidean distance (`[[nodiscard]]`)
+     *
+     * @pre @p x_first and @p y_first must be multiples of @ref sycl_lsh::detail::vector_width.
+     */
+    template <typename Options, typename AccX, typename AccY>
+    [[nodiscard]]
+    inline typename Options::real_type squared_euclidean_distance(const AccX& acc_x, const typename Options::index_type x_first,
+                                                                  const AccY& acc_y, const typename Options::index_type y_first,
+                                                                  [[maybe_unused]] const typename Options::real_type bound)
+    {
+        static_assert(Options::dims != 0, "The number of dimensions must be known at compile time!");
+
+        using real_type = typename Options::real_type;
+        using index_type = typename Options::index_type;
+        constexpr index_type width = vector_width<Options>;
+#if defined(SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE)
+        constexpr index_type chunk_size = early_abandon_chunk_size<Options>;
+#else
+        constexpr index_type chunk_size = Options::dims;
+#endif
+
+        real_type dist = 0.0;
+        for (index_type chunk = 0; chunk < Options::dims; chunk += chunk_size) {
+            const index_type chunk_end = chunk + chunk_size < Options::dims ? chunk + chunk_size : Options::dims;
+            if constexpr (width == 1) {
+                for (index_type dim = chunk; dim < chunk_end; ++dim) {
+                    const real_type diff = acc_x[x_first + dim] - acc_y[y_first + dim];
+                    dist += diff * diff;
+                }
+            } else {
+                using vec_type = sycl::vec<real_type, width>;
+                for (index_type dim = chunk; dim < chunk_end; dim += width) {
+                    vec_type x, y;
+                    x.load((x_first + dim) / width, acc_x.get_pointer());
+                    y.load((y_first + dim) / width, acc_y.get_pointer());
+                    const vec_type diff = x - y;
+                    dist += sycl::dot(diff, diff);
+                }
+            }
+#if defined(SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE)
+            // the remaining dimensions can only increase the distance
+            if (dist >= bound) {
+                break;
+            }
+#endif
+        }
+        return dist;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_DISTANCE_HPP
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2021-01-04
+ *
+ * @brief Implements the hash fingerprints used to skip candidates which only share the hash bucket with a query due to the modulo with
+ *        the hash table size.
+ * @details The hash bucket of a data point is its combined hash value modulo the hash table size, i.e. data points with different
+ *          combined hash values may end up in the same hash bucket. The fingerprint condenses the remaining bits of the combined hash value
+ *          (the quotient), such that most of these false collisions are detected without calculating the distances. Enabled using the
+ *          `SYCL_LSH_FINGERPRINT_FILTER` CMake option.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_FINGERPRINT_FILTER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_FINGERPRINT_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sycl_lsh::detail {
+
+    /// The type of the hash fingerprint stored per data point and hash table.
+    using fingerprint_type = std::uint8_t;
+
+    /**
+     * @brief Calculates the fingerprint of the combined (i.e. not yet reduced) hash value @p combined_hash.
+     * @details Two data points in the same hash bucket with different fingerprints have different combined hash values. Two data points with
+     *          the same fingerprint may still have different combined hash values (false positives only cost the distance calculation).
+     * @tparam hash_value_type an unsigned type (used for hash values)
+     * @param[in] combined_hash the combined hash value
+     * @param[in] hash_table_size the size of the hash tables
+     * @return the fingerprint (`[[nodiscard]]`)
+     */
+    template <typename hash_value_type>
+    [[nodiscard]]
+    inline fingerprint_type hash_fingerprint(const hash_value_type combined_hash, const hash_value_type hash_table_size) noexcept {
+        // the remainder selects the hash bucket -> only the quotient distinguishes the combined hash values inside a hash bucket
+        hash_value_type quotient = combined_hash / hash_table_size;
+        // fold all bits of the quotient into the fingerprint
+        for (std::size_t shift = sizeof(hash_value_type) * 4; shift >= sizeof(fingerprint_type) * 8; shift /= 2) {
+            quotient ^= quotient >> shift;
+        }
+        return static_cast<fingerprint_type>(quotient);
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_FINGERPRINT_FILTER_HPP
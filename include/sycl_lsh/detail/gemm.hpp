@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-19
+ *
+ * @brief Implements the per work-item part of a tiled dense matrix multiplication using local memory (used for the batched hashing).
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_GEMM_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_GEMM_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+
+#include <cstddef>
+
+namespace sycl_lsh::detail {
+
+    /// The size of the square tiles staged in local memory (a work-group consists of `gemm_tile_size * gemm_tile_size` work-items).
+    constexpr std::size_t gemm_tile_size = 16;
+    /// The maximum number of data points hashed at once (bounds the size of the intermediate dot products buffer).
+    constexpr std::size_t gemm_chunk_size = 65536;
+
+    /**
+     * @brief Calculates the entry `C[row, col] = init + sum_i A[row, i] * B[i, col]` of the matrix product of the `M x K` matrix `A` and the
+     *        `K x N` matrix `B`.
+     * @details The work-group computes the `gemm_tile_size x gemm_tile_size` tile of `C` containing the entry, the current work-item
+     *          is at position (@p local_row, @p local_col) inside this tile.
+     *          All work-items of a work-group cooperatively stage `gemm_tile_size x gemm_tile_size` tiles of `A` and `B` in local memory.
+     *          The products are accumulated in ascending order of `i`, i.e. the result is the same as the one of a sequential loop. \n
+     *          Must be called by all work-items of the work-group (contains barriers), work-items outside of `C` must map their
+     *          out-of-range rows and columns to valid ones in @p load_a and @p load_b.
+     * @tparam real_type a floating point type
+     * @tparam index_type an integral type (used for indices)
+     * @tparam LocalAcc the type of the local memory `sycl::accessor`
+     * @tparam LoadA the type of the function returning `A[row, i]`
+     * @tparam LoadB the type of the function returning `B[i, col]`
+     * @param[in] item the current `sycl::nd_item`
+     * @param[in] row the row of the calculated entry
+     * @param[in] col the column of the calculated entry
+     * @param[in] local_row the row of the calculated entry inside the tile of the work-group
+     * @param[in] local_col the column of the calculated entry inside the tile of the work-group
+     * @param[in] tile_a local memory for one tile of `A` (at least `gemm_tile_size * gemm_tile_size` values)
+     * @param[in] tile_b local memory for one tile of `B` (at least `gemm_tile_size * gemm_tile_size` values)
+     * @param[in] k the inner dimension `K`
+     * @param[in] init the initial value of the accumulation
+     * @param[in] load_a the function returning `A[row, i]`
+     * @param[in] load_b the function returning `B[i, col]`
+     * @return the entry `C[row, col]` (`[[nodiscard]]`)
+     */
+    template <typename real_type, typename index_type, typename LocalAcc, typename LoadA, typename LoadB>
+    [[nodiscard]]
+    inline real_type tiled_gemm_entry(const sycl::nd_item<>& item, const index_type row, const index_type col, const index_type local_row, const index_type local_col,
+                                      LocalAcc& tile_a, LocalAcc& tile_b, const index_type k, const real_type init, const LoadA& load_a, const LoadB& load_b) {
+        real_type sum = init;
+        for (index_type tile = 0; tile < k; tile += gemm_tile_size) {
+            // each work-item stages one value of both tiles
+            tile_a[local_row * gemm_tile_size + local_col] = tile + local_col < k ? load_a(row, tile + local_col) : real_type{ 0.0 };
+            tile_b[local_row * gemm_tile_size + local_col] = tile + local_row < k ? load_b(tile + local_row, col) : real_type{ 0.0 };
+            item.barrier(sycl::access::fence_space::local_space);
+
+            // only accumulate the valid values of the last tile (same result as a sequential loop)
+            const index_type tile_end = k - tile < gemm_tile_size ? k - tile : gemm_tile_size;
+            for (index_type i = 0; i < tile_end; ++i) {
+                sum += tile_a[local_row * gemm_tile_size + i] * tile_b[i * gemm_tile_size + local_col];
+            }
+            item.barrier(sycl::access::fence_space::local_space);
+        }
+        return sum;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_GEMM_HPP
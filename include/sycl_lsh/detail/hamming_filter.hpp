@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-21
+ *
+ * @brief Implements the Hamming distance prefilter of the candidates used together with the @ref sycl_lsh::simhash hash functions.
+ * @details The fraction of differing signature bits of two data points estimates the angle between them. Candidates whose signatures
+ *          (of all hash tables) differ from the ones of the query in more than `max_hamming_distance` bits are skipped without
+ *          calculating their distances.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_HAMMING_FILTER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_HAMMING_FILTER_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+
+#include <cstddef>
+
+namespace sycl_lsh::detail {
+
+    /// The maximum number of hash tables supported by the Hamming distance prefilter (the size of the per query array holding the
+    /// signatures of the query).
+    constexpr std::size_t max_hamming_filter_hash_tables = 32;
+
+    /**
+     * @brief Calculates the number of differing bits of the signatures @p lhs and @p rhs.
+     * @tparam hash_value_type an unsigned type (used for the signatures)
+     * @param[in] lhs the first signature
+     * @param[in] rhs the second signature
+     * @return the Hamming distance (`[[nodiscard]]`)
+     */
+    template <typename hash_value_type>
+    [[nodiscard]]
+    inline hash_value_type hamming_distance(const hash_value_type lhs, const hash_value_type rhs) {
+        return sycl::popcount(static_cast<hash_value_type>(lhs ^ rhs));
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_HAMMING_FILTER_HPP
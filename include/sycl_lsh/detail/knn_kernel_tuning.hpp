@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-22
+ *
+ * @brief Implements the cache file of the tuned work-group and blocking sizes of the per query k-nearest-neighbor kernel.
+ * @details Each line of the cache file contains one tuned configuration: `device name|k|dims|local_size|blocking_size`. The blocking
+ *          size of the kernel is a template parameter, i.e. only the pre-instantiated @ref sycl_lsh::detail::knn_blocking_sizes can be
+ *          selected at runtime. The same holds for the numbers of nearest-neighbors kept in private memory (@ref sycl_lsh::detail::knn_static_ks).
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_KNN_KERNEL_TUNING_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_KNN_KERNEL_TUNING_HPP
+
+#include <sycl_lsh/detail/utility.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sycl_lsh::detail {
+
+    /// The pre-instantiated blocking sizes of the per query k-nearest-neighbor kernel (additionally to the compile time `blocking_size`).
+    /// Only blocking sizes less or equal than the compile time `blocking_size` can be used (the hash tables are padded by it).
+    constexpr std::size_t knn_blocking_sizes[] = { 1, 2, 4, 8, 16, 32 };
+
+    /**
+     * @brief Returns all blocking sizes of the per query k-nearest-neighbor kernel usable with the compile time @p max_blocking_size.
+     * @tparam max_blocking_size the compile time `blocking_size`
+     * @return the usable blocking sizes (`[[nodiscard]]`)
+     */
+    template <std::size_t max_blocking_size>
+    [[nodiscard]]
+    inline std::vector<std::size_t> usable_knn_blocking_sizes() {
+        std::vector<std::size_t> blocking_sizes;
+        for (const std::size_t blocking_size : knn_blocking_sizes) {
+            if (blocking_size < max_blocking_size) {
+                blocking_sizes.push_back(blocking_size);
+            }
+        }
+        blocking_sizes.push_back(max_blocking_size);
+        return blocking_sizes;
+    }
+
+    /**
+     * @brief Calls @p func with the pre-instantiated blocking size @p blocking_size as `std::integral_constant`.
+     * @details Falls back to @p max_blocking_size if @p blocking_size isn't one of the @ref usable_knn_blocking_sizes().
+     * @tparam max_blocking_size the compile time `blocking_size`
+     * @tparam Func the type of the functor
+     * @param[in] blocking_size the requested blocking size
+     * @param[in] func the functor
+     */
+    template <std::size_t max_blocking_size, typename Func>
+    inline void dispatch_knn_blocking_size(const std::size_t blocking_size, Func&& func) {
+        const auto dispatch = [&](auto... candidates) {
+            // only blocking sizes less than the compile time blocking_size are instantiated
+            const bool found = ((blocking_size == decltype(candidates)::value
+                                 && (func(std::integral_constant<std::size_t, std::min(decltype(candidates)::value, max_blocking_size)>{}), true)) || ...);
+            if (!found) {
+                func(std::integral_constant<std::size_t, max_blocking_size>{});
+            }
+        };
+        dispatch(std::integral_constant<std::size_t, knn_blocking_sizes[0]>{}, std::integral_constant<std::size_t, knn_blocking_sizes[1]>{},
+                 std::integral_constant<std::size_t, knn_blocking_sizes[2]>{}, std::integral_constant<std::size_t, knn_blocking_sizes[3]>{},
+                 std::integral_constant<std::size_t, knn_blocking_sizes[4]>{}, std::integral_constant<std::size_t, knn_blocking_sizes[5]>{});
+    }
+
+    /// The pre-instantiated numbers of nearest-neighbors of the per query k-nearest-neighbor kernel keeping the nearest-neighbors in
+    /// private memory (registers) instead of local memory.
+    constexpr std::size_t knn_static_ks[] = { 1, 10, 32, 64, 100 };
+
+    /**
+     * @brief Checks whether the per query k-nearest-neighbor kernel is pre-instantiated for @p k nearest-neighbors.
+     * @param[in] k the number of nearest-neighbors
+     * @return `true` if @p k is one of the @ref knn_static_ks, otherwise `false` (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    constexpr bool is_static_knn_k(const std::size_t k) noexcept {
+        for (const std::size_t static_k : knn_static_ks) {
+            if (k == static_k) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Calls @p func with the pre-instantiated number of nearest-neighbors @p k as `std::integral_constant`.
+     * @details Falls back to `0`, i.e. the number of nearest-neighbors only known at runtime, if @p k isn't one of the @ref knn_static_ks.
+     * @tparam Func the type of the functor
+     * @param[in] k the number of nearest-neighbors
+     * @param[in] func the functor
+     */
+    template <typename Func>
+    inline void dispatch_knn_k(const std::size_t k, Func&& func) {
+        const auto dispatch = [&](auto... candidates) {
+            const bool found = ((k == decltype(candidates)::value && (func(candidates), true)) || ...);
+            if (!found) {
+                func(std::integral_constant<std::size_t, 0>{});
+            }
+        };
+        dispatch(std::integral_constant<std::size_t, knn_static_ks[0]>{}, std::integral_constant<std::size_t, knn_static_ks[1]>{},
+                 std::integral_constant<std::size_t, knn_static_ks[2]>{}, std::integral_constant<std::size_t, knn_static_ks[3]>{},
+                 std::integral_constant<std::size_t, knn_static_ks[4]>{});
+    }
+
+    /// The smallest work-group size tried during the tuning of the per query k-nearest-neighbor kernel.
+    constexpr std::size_t min_knn_tuning_local_size = 16;
+
+    /// The maximum number of queries used to time a single configuration of the per query k-nearest-neighbor kernel.
+    constexpr std::size_t knn_tuning_num_queries = 8192;
+
+    /**
+     * @brief A tuned configuration of the per query k-nearest-neighbor kernel.
+     * @tparam index_type an integral type (used for indices)
+     */
+    template <typename index_type>
+    struct knn_kernel_config {
+        /// The used work-group size.
+        index_type local_size;
+        /// The used blocking size.
+        index_type blocking_size;
+    };
+
+    /**
+     * @brief Creates the key of a cached configuration.
+     * @param[in] device_name the name of the device
+     * @param[in] k the number of nearest-neighbors
+     * @param[in] dims the number of dimensions of each data point
+     * @return the key (`[[nodiscard]]`)
+     */
+    template <typename index_type>
+    [[nodiscard]]
+    inline std::string knn_kernel_config_key(const std::string_view device_name, const index_type k, const index_type dims) {
+        return fmt::format("{}|{}|{}", device_name, k, dims);
+    }
+
+    /**
+     * @brief Reads all configurations from the stream @p in and adds them to @p configs (replacing configurations with the same key).
+     * @tparam index_type an integral type (used for indices)
+     * @param[in] in the stream to read the configurations from
+     * @param[in] source the name of the stream (used in error messages)
+     * @param[in,out] configs the configurations
+     *
+     * @throws std::invalid_argument if a line of @p in is illegal.
+     */
+    template <typename index_type>
+    inline void read_knn_kernel_configs(std::istream& in, const std::string_view source, std::map<std::string, knn_kernel_config<index_type>>& configs) {
+        std::string line;
+        int lineno = 0;
+        while (std::getline(in, line)) {
+            ++lineno;
+            // ignore empty lines
+            if (line.empty()) {
+                continue;
+            }
+            // the device name may contain arbitrary characters -> split at the last two separators
+            const std::size_t blocking_pos = line.rfind('|');
+            const std::size_t local_pos = blocking_pos == std::string::npos || blocking_pos == 0 ? std::string::npos : line.rfind('|', blocking_pos - 1);
+            if (local_pos == std::string::npos) {
+                throw std::invalid_argument(fmt::format("Illegal line ({}) '{}' in '{}'!", lineno, line, source));
+            }
+            configs.insert_or_assign(line.substr(0, local_pos),
+                                     knn_kernel_config<index_type>{ convert_to<index_type>(line.substr(local_pos + 1, blocking_pos - local_pos - 1)),
+                                                                    convert_to<index_type>(line.substr(blocking_pos + 1)) });
+        }
+    }
+
+    /**
+     * @brief Formats the configuration @p config with the key @p key as a single line of the cache file.
+     * @tparam index_type an integral type (used for indices)
+     * @param[in] key the key of the configuration
+     * @param[in] config the configuration
+     * @return the line (including the trailing newline) (`[[nodiscard]]`)
+     */
+    template <typename index_type>
+    [[nodiscard]]
+    inline std::string format_knn_kernel_config(const std::string_view key, const knn_kernel_config<index_type>& config) {
+        return fmt::format("{}|{}|{}\n", key, config.local_size, config.blocking_size);
+    }
+
+    /**
+     * @brief Writes the configurations @p configs to the file @p file_name (replacing its content).
+     * @tparam index_type an integral type (used for indices)
+     * @param[in] file_name the cache file
+     * @param[in] configs the configurations to write
+     *
+     * @throws std::runtime_error if the file couldn't be written.
+     */
+    template <typename index_type>
+    inline void write_knn_kernel_configs(const std::string& file_name, const std::map<std::string, knn_kernel_config<index_type>>& configs) {
+        std::ofstream out(file_name, std::ofstream::trunc);
+        if (!out) {
+            throw std::runtime_error(fmt::format("Can't write to file '{}'!", file_name));
+        }
+        for (const auto& [key, config] : configs) {
+            out << format_knn_kernel_config(key, config);
+        }
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_KNN_KERNEL_TUNING_HPP
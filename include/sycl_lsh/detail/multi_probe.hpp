@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-17
+ *
+ * @brief Implements the generation of the neighboring hash buckets visited by the multi-probe LSH querying.
+ * @details The neighboring hash buckets are generated by shifting the quantized value of a single hash function by one. The shifts are
+ *          visited in ascending order of the distance of the unquantized hash function value to the respective segment boundary, i.e. the
+ *          most likely neighboring hash buckets are probed first.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_MULTI_PROBE_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_MULTI_PROBE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sycl_lsh::detail {
+
+    /// The maximum number of hash functions per hash table supported by the multi-probe querying (the size of the per query array
+    /// holding the unquantized hash function values).
+    constexpr std::size_t max_probe_hash_functions = 32;
+
+    /**
+     * @brief A shift of the quantized value of a single hash function by @ref delta.
+     * @tparam index_type an integral type (used for indices)
+     * @tparam real_type a floating point type
+     */
+    template <typename index_type, typename real_type>
+    struct perturbation {
+        /// The shifted hash function.
+        index_type hash_function;
+        /// The shift of the quantized hash function value (`-1` or `+1`).
+        int delta;
+        /// The distance of the unquantized hash function value to the crossed segment boundary (in units of the segment size).
+        real_type score;
+    };
+
+    /**
+     * @brief Returns the perturbation following @p prev in ascending order of the scores.
+     * @details The perturbations with equal scores are ordered by their hash function and shift. Uses no additional memory, i.e.
+     *          each call iterates over all `2 * num_hash_functions` perturbations.
+     * @tparam index_type an integral type (used for indices)
+     * @tparam real_type a floating point type
+     * @param[in] projections the unquantized hash function values (segment size already divided out)
+     * @param[in] num_hash_functions the number of hash functions
+     * @param[in] prev the previously visited perturbation (its `delta` must be `0` to request the first perturbation)
+     * @return the next perturbation (`[[nodiscard]]`)
+     *
+     * @pre There must be a next perturbation, i.e. at most `2 * num_hash_functions` perturbations can be requested.
+     */
+    template <typename index_type, typename real_type>
+    [[nodiscard]]
+    inline perturbation<index_type, real_type> next_perturbation(const real_type* projections, const index_type num_hash_functions,
+                                                                 const perturbation<index_type, real_type>& prev) {
+        // the position of a perturbation in the tie-breaking order
+        const auto order = [](const index_type hash_function, const int delta) { return 2 * hash_function + (delta > 0 ? 1 : 0); };
+        const index_type prev_order = order(prev.hash_function, prev.delta);
+
+        perturbation<index_type, real_type> next{ 0, 0, 0.0 };
+        for (index_type hash_function = 0; hash_function < num_hash_functions; ++hash_function) {
+            // position of the value inside its segment (without calling floor in the kernel)
+            real_type frac = projections[hash_function] - static_cast<real_type>(static_cast<std::int64_t>(projections[hash_function]));
+            if (frac < 0) {
+                frac += 1;
+            }
+            for (int delta = -1; delta <= 1; delta += 2) {
+                const real_type score = delta < 0 ? frac : 1 - frac;
+                const index_type current_order = order(hash_function, delta);
+                // skip all perturbations up to (and including) the previous one
+                if (prev.delta != 0 && (score < prev.score || (score == prev.score && current_order <= prev_order))) {
+                    continue;
+                }
+                if (next.delta == 0 || score < next.score || (score == next.score && current_order < order(next.hash_function, next.delta))) {
+                    next = perturbation<index_type, real_type>{ hash_function, delta, score };
+                }
+            }
+        }
+        return next;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_MULTI_PROBE_HPP
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-20
+ *
+ * @brief Implements the counter-based Philox4x32-10 random number generator used to create the hash functions from a seed.
+ * @details Each random number only depends on the seed, a stream and a counter (no internal state), i.e. the same values can be
+ *          generated independently on every MPI rank, on the host as well as on the device, without any communication.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_PHILOX_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_PHILOX_HPP
+
+#include <cstdint>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Enumeration class for the different random number streams used to create the hash functions (random numbers of different
+     *        streams are independent even if the counter is the same).
+     */
+    enum class philox_stream : std::uint32_t {
+        /** the values of the hash functions in the hash pool */
+        hash_pool = 0,
+        /** the offsets of the random projections hash functions in the hash pool */
+        hash_pool_offset = 1,
+        /** the selection of the hash functions from the hash pool */
+        selection = 2,
+        /** the values used to combine the hash values of the mixed hash functions */
+        hash_combine = 3,
+        /** the values of the random projection matrix reducing the number of dimensions of the data points */
+        dimensionality_reduction = 4
+    };
+
+    /**
+     * @brief The four 32-bit random values generated for one counter.
+     */
+    struct philox_block {
+        /// The random values.
+        std::uint32_t values[4];
+    };
+
+    /**
+     * @brief Counter-based random number generator Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+     */
+    class philox {
+    public:
+        /**
+         * @brief Construct a new random number generator using the @p seed.
+         * @param[in] seed the seed
+         */
+        explicit philox(const std::uint64_t seed) noexcept
+            : key_lo_(static_cast<std::uint32_t>(seed)), key_hi_(static_cast<std::uint32_t>(seed >> 32)) { }
+
+        /**
+         * @brief Generates the four random values of the counter (@p counter, @p stream, @p block).
+         * @param[in] counter the counter
+         * @param[in] stream the random number stream
+         * @param[in] block an additional counter if more than four random values are needed per @p counter
+         * @return the random values (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        philox_block operator()(const std::uint64_t counter, const philox_stream stream, const std::uint32_t block = 0) const noexcept {
+            std::uint32_t c0 = static_cast<std::uint32_t>(counter);
+            std::uint32_t c1 = static_cast<std::uint32_t>(counter >> 32);
+            std::uint32_t c2 = static_cast<std::uint32_t>(stream);
+            std::uint32_t c3 = block;
+            std::uint32_t k0 = key_lo_;
+            std::uint32_t k1 = key_hi_;
+            for (int round = 0; round < 10; ++round) {
+                const std::uint64_t product_0 = static_cast<std::uint64_t>(0xD2511F53U) * c0;
+                const std::uint64_t product_1 = static_cast<std::uint64_t>(0xCD9E8D57U) * c2;
+                const std::uint32_t hi_0 = static_cast<std::uint32_t>(product_0 >> 32);
+                const std::uint32_t hi_1 = static_cast<std::uint32_t>(product_1 >> 32);
+                c0 = hi_1 ^ c1 ^ k0;
+                c1 = static_cast<std::uint32_t>(product_1);
+                c2 = hi_0 ^ c3 ^ k1;
+                c3 = static_cast<std::uint32_t>(product_0);
+                // bump the key
+                k0 += 0x9E3779B9U;
+                k1 += 0xBB67AE85U;
+            }
+            return philox_block{ { c0, c1, c2, c3 } };
+        }
+
+        /**
+         * @brief Generates an uniformly distributed random number in the interval `[0, 1)`.
+         * @tparam real_type a floating point type
+         * @param[in] counter the counter
+         * @param[in] stream the random number stream
+         * @return the random number (`[[nodiscard]]`)
+         */
+        template <typename real_type>
+        [[nodiscard]]
+        real_type uniform(const std::uint64_t counter, const philox_stream stream) const noexcept {
+            return to_uniform<real_type>(this->operator()(counter, stream).values[0]);
+        }
+
+        /**
+         * @brief Generates an (approximately) standard normal distributed random number.
+         * @details Uses the sum of twelve uniformly distributed random numbers (Irwin-Hall distribution) instead of a transformation
+         *          based on transcendental functions: only exactly representable values are summed up, i.e. the result is bitwise
+         *          identical on all host and device compilers.
+         * @tparam real_type a floating point type
+         * @param[in] counter the counter
+         * @param[in] stream the random number stream
+         * @return the random number (`[[nodiscard]]`)
+         */
+        template <typename real_type>
+        [[nodiscard]]
+        real_type normal(const std::uint64_t counter, const philox_stream stream) const noexcept {
+            real_type sum = 0.0;
+            for (std::uint32_t block = 0; block < 3; ++block) {
+                const philox_block random = this->operator()(counter, stream, block);
+                for (const std::uint32_t value : random.values) {
+                    sum += to_uniform<real_type>(value);
+                }
+            }
+            return sum - real_type{ 6.0 };
+        }
+
+        /**
+         * @brief Generates an uniformly distributed random index in the interval `[0, bound)`.
+         * @tparam index_type an integral type (used for indices)
+         * @param[in] counter the counter
+         * @param[in] stream the random number stream
+         * @param[in] bound the upper bound
+         * @return the random index (`[[nodiscard]]`)
+         */
+        template <typename index_type>
+        [[nodiscard]]
+        index_type index(const std::uint64_t counter, const philox_stream stream, const index_type bound) const noexcept {
+            const std::uint64_t value = this->operator()(counter, stream).values[0];
+            return static_cast<index_type>((value * static_cast<std::uint64_t>(bound)) >> 32);
+        }
+
+    private:
+        template <typename real_type>
+        [[nodiscard]]
+        static real_type to_uniform(const std::uint32_t value) noexcept {
+            // use the upper 24 bits (exactly representable in single precision)
+            return static_cast<real_type>(value >> 8) * real_type{ 1.0 / 16777216.0 };
+        }
+
+        std::uint32_t key_lo_;
+        std::uint32_t key_hi_;
+    };
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_PHILOX_HPP
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-14
+ *
+ * @brief Implements a work-efficient device-wide (segmented) exclusive prefix sum.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SCAN_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SCAN_HPP
+
+#include <sycl_lsh/detail/sycl.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace sycl_lsh {
+
+    // SYCL kernel name needed to silence ComputeCpp warnings
+    template <typename T>
+    class kernel_scan_tiles;
+    template <typename T>
+    class kernel_scan_add_tile_offsets;
+
+}
+
+namespace sycl_lsh::detail {
+
+    /// The number of consecutive values each work-item sequentially reduces before the work-group scan.
+    constexpr std::size_t scan_values_per_work_item = 8;
+
+    /**
+     * @brief Calculates the exclusive prefix sum of each of the @p num_segments consecutive segments of size @p segment_size
+     *        in @p input and saves the result in @p output.
+     * @details Each segment is split into tiles of `local_size * scan_values_per_work_item` values. Each work-group scans one tile
+     *          in local memory (*Blelloch* up- and down-sweep) and saves its tile sum. If a segment consists of more than one tile, the
+     *          tile sums are scanned recursively and added back to all values of the respective tiles. \n
+     *          The value at position `i` of segment `s` is saved at `output[s * output_stride + output_offset + i]`, all other values
+     *          in @p output remain untouched.
+     * @tparam T the type of the values to scan
+     * @param[in] queue the SYCL queue to submit the kernels to
+     * @param[in] input the values to scan (at least `num_segments * segment_size` values)
+     * @param[out] output the buffer to write the exclusive prefix sums to
+     * @param[in] num_segments the number of independent segments
+     * @param[in] segment_size the number of values per segment
+     * @param[in] output_stride the distance between the first values of two consecutive segments in @p output
+     * @param[in] output_offset the additional offset of the first value of each segment in @p output
+     *
+     * @pre @p output must be able to hold at least `(num_segments - 1) * output_stride + output_offset + segment_size` values.
+     */
+    template <typename T>
+    void exclusive_scan(sycl::queue& queue, sycl::buffer<T, 1>& input, sycl::buffer<T, 1>& output,
+                        const std::size_t num_segments, const std::size_t segment_size,
+                        const std::size_t output_stride, const std::size_t output_offset)
+    {
+        if (num_segments == 0 || segment_size == 0) return;
+
+        // the work-group size must be a power of two for the up- and down-sweep
+        const std::size_t max_work_group_size = queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+        std::size_t local_size = 1;
+        while (local_size * 2 <= std::min<std::size_t>(max_work_group_size, 256)) {
+            local_size *= 2;
+        }
+        const std::size_t tile_size = local_size * scan_values_per_work_item;
+        const std::size_t num_tiles = (segment_size + tile_size - 1) / tile_size;
+
+        // the sum of all values of each tile
+        sycl::buffer<T, 1> tile_sums(num_segments * num_tiles);
+
+        queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_input = input.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_output = output.template get_access<sycl::access::mode::write>(cgh);
+            auto acc_tile_sums = tile_sums.template get_access<sycl::access::mode::discard_write>(cgh);
+            // create local memory accessor
+            sycl::accessor<T, 1, sycl::access::mode::read_write, sycl::access::target::local> local_mem(sycl::range<>(local_size), cgh);
+
+            const auto execution_range = sycl::nd_range<>(sycl::range<>(num_segments * num_tiles * local_size), sycl::range<>(local_size));
+
+            cgh.parallel_for<kernel_scan_tiles<T>>(execution_range, [=](sycl::nd_item<> item) {
+                const std::size_t local_idx = item.get_local_linear_id();
+                const std::size_t group_idx = item.get_group_linear_id();
+                const std::size_t segment = group_idx / num_tiles;
+                const std::size_t first = (group_idx % num_tiles) * tile_size + local_idx * scan_values_per_work_item;
+                const std::size_t last = first + scan_values_per_work_item < segment_size ? first + scan_values_per_work_item : segment_size;
+
+                // sequentially reduce the values of the current work-item
+                T work_item_sum = 0;
+                for (std::size_t i = first; i < last; ++i) {
+                    work_item_sum += acc_input[segment * segment_size + i];
+                }
+                local_mem[local_idx] = work_item_sum;
+                item.barrier(sycl::access::fence_space::local_space);
+
+                // up-sweep
+                for (std::size_t stride = 1; stride < local_size; stride *= 2) {
+                    const std::size_t idx = (local_idx + 1) * stride * 2 - 1;
+                    if (idx < local_size) {
+                        local_mem[idx] += local_mem[idx - stride];
+                    }
+                    item.barrier(sycl::access::fence_space::local_space);
+                }
+                // save tile sum and clear last value
+                if (local_idx == 0) {
+                    acc_tile_sums[group_idx] = local_mem[local_size - 1];
+                    local_mem[local_size - 1] = 0;
+                }
+                item.barrier(sycl::access::fence_space::local_space);
+                // down-sweep
+                for (std::size_t stride = local_size / 2; stride > 0; stride /= 2) {
+                    const std::size_t idx = (local_idx + 1) * stride * 2 - 1;
+                    if (idx < local_size) {
+                        const T tmp = local_mem[idx - stride];
+                        local_mem[idx - stride] = local_mem[idx];
+                        local_mem[idx] += tmp;
+                    }
+                    item.barrier(sycl::access::fence_space::local_space);
+                }
+
+                // sequentially write the exclusive prefix sums of the current work-item
+                T running_sum = local_mem[local_idx];
+                for (std::size_t i = first; i < last; ++i) {
+                    const T val = acc_input[segment * segment_size + i];
+                    acc_output[segment * output_stride + output_offset + i] = running_sum;
+                    running_sum += val;
+                }
+            });
+        });
+
+        // only one tile per segment -> already finished
+        if (num_tiles == 1) return;
+
+        // scan the tile sums of each segment
+        sycl::buffer<T, 1> tile_offsets(num_segments * num_tiles);
+        exclusive_scan(queue, tile_sums, tile_offsets, num_segments, num_tiles, num_tiles, 0);
+
+        // add the tile offsets to each value of the respective tile
+        queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_output = output.template get_access<sycl::access::mode::read_write>(cgh);
+            auto acc_tile_offsets = tile_offsets.template get_access<sycl::access::mode::read>(cgh);
+
+            cgh.parallel_for<kernel_scan_add_tile_offsets<T>>(sycl::range<>(num_segments * segment_size), [=](sycl::item<> item) {
+                const std::size_t idx = item.get_linear_id();
+                const std::size_t segment = idx / segment_size;
+                const std::size_t i = idx % segment_size;
+
+                acc_output[segment * output_stride + output_offset + i] += acc_tile_offsets[segment * num_tiles + i / tile_size];
+            });
+        });
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SCAN_HPP
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-17
+ *
+ * @brief Implements a small per query filter to detect candidates that have already been evaluated in a previous hash table.
+ * @details The size of the filter is specified at compile time using the `SYCL_LSH_SEEN_FILTER_SIZE` CMake option.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SEEN_FILTER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SEEN_FILTER_HPP
+
+#include <cstddef>
+#include <limits>
+
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+
+namespace sycl_lsh::detail {
+
+    /// The number of candidate IDs the seen filter of each query can hold.
+    constexpr std::size_t seen_filter_size = SYCL_LSH_SEEN_FILTER_SIZE;
+
+    /**
+     * @brief A direct-mapped cache of the candidate IDs already evaluated for a single query.
+     * @details Each candidate ID is mapped to exactly one of the @ref seen_filter_size slots. A new candidate replaces a previous one mapped to the
+     *          same slot. Since the **full** ID is stored, a candidate is **never** falsely reported as seen (in contrast to e.g. a
+     *          bloom filter), i.e. skipping the seen candidates doesn't change the found k-nearest-neighbors: \n
+     *          A seen candidate either already is a nearest-neighbor or its distance was already rejected (and the greatest
+     *          nearest-neighbor distance only decreases). Evicted candidates are simply evaluated again.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam Accessor the type of the accessor to the filter's memory
+     */
+    template <typename Options, typename Accessor>
+    class seen_filter {
+    public:
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+
+        /// The number of slots per query.
+        static constexpr index_type size = seen_filter_size;
+        /// The value of an empty slot (can't be a valid candidate ID).
+        static constexpr index_type empty_slot = std::numeric_limits<index_type>::max();
+
+        /**
+         * @brief Construct a new seen filter using the slots at `[offset, offset + size)`.
+         * @param[in] slots the accessor to the filter's memory
+         * @param[in] offset the position of the first slot of the current query
+         */
+        seen_filter(Accessor slots, const index_type offset) : slots_(slots), offset_(offset) { }
+
+        /**
+         * @brief Removes all candidates from the filter.
+         */
+        void clear() {
+            for (index_type slot = 0; slot < size; ++slot) {
+                slots_[offset_ + slot] = empty_slot;
+            }
+        }
+        /**
+         * @brief Checks whether the candidate @p id has already been seen and marks it as seen otherwise.
+         * @param[in] id the ID of the candidate
+         * @return `true` if @p id has already been seen, `false` otherwise
+         */
+        bool test_and_set(const index_type id) {
+            const index_type pos = offset_ + id % size;
+            if (slots_[pos] == id) {
+                return true;
+            }
+            slots_[pos] = id;
+            return false;
+        }
+
+    private:
+        Accessor slots_;
+        const index_type offset_;
+    };
+
+    /**
+     * @brief Factory function for a @ref sycl_lsh::detail::seen_filter (deduces the accessor type).
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam Accessor the type of the accessor to the filter's memory
+     * @param[in] slots the accessor to the filter's memory
+     * @param[in] offset the position of the first slot of the current query
+     * @return the @ref sycl_lsh::detail::seen_filter (`[[nodiscard]]`)
+     */
+    template <typename Options, typename Accessor>
+    [[nodiscard]]
+    inline seen_filter<Options, Accessor> make_seen_filter(Accessor slots, const typename Options::index_type offset) {
+        return seen_filter<Options, Accessor>(slots, offset);
+    }
+
+}
+
+#endif
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SEEN_FILTER_HPP
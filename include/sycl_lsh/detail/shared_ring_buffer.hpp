@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-21
+ *
+ * @brief Implements a node-local shared memory window used to exchange the data of all MPI ranks on the same node without copies and to
+ *        send it around a ring of all nodes.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SHARED_RING_BUFFER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SHARED_RING_BUFFER_HPP
+
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Holds one slot of @p size elements per MPI rank of the current node in a shared memory window (`MPI_Win_allocate_shared`),
+     *        i.e. all MPI ranks on the same node can directly access the slots of each other.
+     * @details The own slot is sent to the MPI rank with the same node-local rank on the next node, i.e. the slots of all MPI ranks on a
+     *          node are sent around the inter-node ring in parallel.
+     * @tparam T the type of the elements
+     */
+    template <typename T>
+    class shared_ring_buffer {
+    public:
+        /**
+         * @brief Construct a new @ref sycl_lsh::detail::shared_ring_buffer with slots of size @p size.
+         * @param[in] size the number of elements per slot
+         * @param[in] node_comm the @ref sycl_lsh::mpi::communicator containing all MPI ranks of the current node
+         * @param[in] inter_comm the @ref sycl_lsh::mpi::communicator containing the MPI ranks with the same node-local rank on all nodes
+         * @param[in] tag the MPI tag used to distinguish the messages of different ring buffers
+         * @param[in] kind the kind of the communication recorded by the @ref sycl_lsh::mpi::communication_profiler
+         */
+        shared_ring_buffer(const std::size_t size, const mpi::communicator& node_comm, const mpi::communicator& inter_comm, const int tag,
+                           const mpi::communication_kind kind)
+            : size_(size), node_comm_(node_comm), inter_comm_(inter_comm), tag_(tag), kind_(kind), slots_(node_comm.size()), receive_buffer_(size)
+        {
+            T* own_slot;
+            MPI_Win_allocate_shared(size * sizeof(T), sizeof(T), MPI_INFO_NULL, node_comm_.get(), &own_slot, &win_);
+            for (int rank = 0; rank < node_comm_.size(); ++rank) {
+                MPI_Aint slot_size;
+                int disp_unit;
+                MPI_Win_shared_query(win_, rank, &slot_size, &disp_unit, &slots_[rank]);
+            }
+            // passive target epoch during the whole lifetime (synchronized using MPI_Win_sync and barriers)
+            MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+        }
+        // the shared memory window can't be copied
+        shared_ring_buffer(const shared_ring_buffer&) = delete;
+        shared_ring_buffer& operator=(const shared_ring_buffer&) = delete;
+        /**
+         * @brief Destruct the @ref sycl_lsh::detail::shared_ring_buffer freeing the shared memory window.
+         */
+        ~shared_ring_buffer() {
+            MPI_Win_unlock_all(win_);
+            MPI_Win_free(&win_);
+        }
+
+        /**
+         * @brief Returns the slot of the MPI rank @p rank on the current node.
+         * @param[in] rank the node-local rank
+         * @return the pointer to the first element of the slot (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        T* slot(const int rank) noexcept { return slots_[rank]; }
+        /**
+         * @brief Returns the slot of the current MPI rank.
+         * @return the pointer to the first element of the slot (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        T* own_slot() noexcept { return slots_[node_comm_.rank()]; }
+
+        /**
+         * @brief Waits until all MPI ranks on the current node reached this point and makes all previous writes to the slots visible.
+         */
+        void synchronize() {
+            MPI_Win_sync(win_);
+            MPI_Barrier(node_comm_.get());
+            MPI_Win_sync(win_);
+        }
+
+        /**
+         * @brief Starts to send the own slot to the next node and to receive the slot of the previous node.
+         * @details The own slot may only be read until @ref finish_send_receive() has been called.
+         */
+        void start_send_receive() {
+            const int destination = (inter_comm_.rank() + 1) % inter_comm_.size();
+            const int source = (inter_comm_.size() + (inter_comm_.rank() - 1) % inter_comm_.size()) % inter_comm_.size();
+
+            send_receive_start_ = mpi::communication_profiler::clock::now();
+            MPI_Irecv(receive_buffer_.data(), size_, mpi::type_cast<T>(), source, tag_, inter_comm_.get(), &requests_[0]);
+            MPI_Isend(this->own_slot(), size_, mpi::type_cast<T>(), destination, tag_, inter_comm_.get(), &requests_[1]);
+            mpi::communication_profiler::record(kind_, size_ * sizeof(T), 0, mpi::communication_profiler::elapsed(send_receive_start_), 0.0, 0.0);
+        }
+        /**
+         * @brief Waits until the communication started by @ref start_send_receive() has been finished and replaces the own slot with
+         *        the received one.
+         * @details The new content is only visible to the other MPI ranks of the current node after the next @ref synchronize().
+         *
+         * @pre No other MPI rank on the current node may access the own slot at the same time.
+         */
+        void finish_send_receive() {
+            const auto wait_start = mpi::communication_profiler::clock::now();
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+            const double wait_time = mpi::communication_profiler::elapsed(wait_start);
+            mpi::communication_profiler::record(kind_, 0, size_ * sizeof(T), wait_time, wait_time, mpi::communication_profiler::elapsed(send_receive_start_));
+            std::copy(receive_buffer_.begin(), receive_buffer_.end(), this->own_slot());
+        }
+
+    private:
+        const std::size_t size_;
+        const mpi::communicator& node_comm_;
+        const mpi::communicator& inter_comm_;
+        const int tag_;
+        const mpi::communication_kind kind_;
+
+        MPI_Win win_;
+        std::vector<T*> slots_;
+        std::vector<T> receive_buffer_;
+        std::array<MPI_Request, 2> requests_ = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+        // the start of the currently running send/receive (used to measure the transfer time)
+        mpi::communication_profiler::clock::time_point send_receive_start_;
+    };
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SHARED_RING_BUFFER_HPP
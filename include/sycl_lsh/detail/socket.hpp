@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-10-28
+ *
+ * @brief Minimal wrapper functions around POSIX TCP sockets used by the @ref sycl_lsh::query_server.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SOCKET_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Opens a TCP socket listening on all interfaces on port @p port.
+     * @param[in] port the port to listen on
+     * @return the file descriptor of the listening socket (`[[nodiscard]]`)
+     *
+     * @throws std::runtime_error if the socket can't be created, bound or put into listening mode.
+     */
+    [[nodiscard]]
+    int open_listening_socket(std::uint16_t port);
+    /**
+     * @brief Accepts a new connection on the listening socket @p listening_fd.
+     * @param[in] listening_fd the file descriptor of the listening socket
+     * @return the file descriptor of the new connection or `-1` if no connection could be accepted (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    int accept_connection(int listening_fd) noexcept;
+    /**
+     * @brief Closes the socket @p fd.
+     * @param[in] fd the file descriptor of the socket to close
+     */
+    void close_socket(int fd) noexcept;
+
+    /**
+     * @brief Waits at most @p timeout_ms milliseconds until at least one of the sockets @p fds is readable.
+     * @param[in] fds the file descriptors of the sockets to wait for
+     * @param[in] timeout_ms the maximum time to wait in milliseconds (a negative value waits indefinitely)
+     * @return the file descriptors of all readable (or closed) sockets (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    std::vector<int> wait_readable(const std::vector<int>& fds, int timeout_ms);
+
+    /**
+     * @brief Receives exactly @p size bytes from the socket @p fd into @p buffer (blocking for at most @p timeout_ms milliseconds in total).
+     * @param[in] fd the file descriptor of the socket
+     * @param[out] buffer the buffer to receive to
+     * @param[in] size the number of bytes to receive
+     * @param[in] timeout_ms the maximum time to wait for all bytes in milliseconds (a negative value waits indefinitely)
+     * @return `true` if all bytes have been received, `false` if the connection has been closed, the timeout expired or an error
+     *         occurred (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    bool receive_all(int fd, void* buffer, std::size_t size, int timeout_ms = -1) noexcept;
+    /**
+     * @brief Sends exactly @p size bytes from @p buffer to the socket @p fd (blocking for at most @p timeout_ms milliseconds in total).
+     * @param[in] fd the file descriptor of the socket
+     * @param[in] buffer the buffer to send
+     * @param[in] size the number of bytes to send
+     * @param[in] timeout_ms the maximum time to wait until all bytes have been sent in milliseconds (a negative value waits indefinitely)
+     * @return `true` if all bytes have been sent, `false` if the connection has been closed, the timeout expired or an error
+     *         occurred (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    bool send_all(int fd, const void* buffer, std::size_t size, int timeout_ms = -1) noexcept;
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SOCKET_HPP
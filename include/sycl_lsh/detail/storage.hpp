@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-19
+ *
+ * @brief Implements the reduced precision storage types of the data points.
+ * @details The used storage type is selected at compile time using the `SYCL_LSH_STORAGE` CMake option.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_STORAGE_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_STORAGE_HPP
+
+#include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// the k-nearest-neighbors are searched using approximated data points and re-ranked using the original data points
+#if SYCL_LSH_STORAGE != SYCL_LSH_STORAGE_FLOAT || defined(SYCL_LSH_REDUCED_DIMS)
+#define SYCL_LSH_EXACT_RERANKING
+#endif
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief The type used to store the data points on the device and in the MPI ring buffer.
+     * @tparam real_type the used floating point type
+     */
+    template <typename real_type>
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_FLOAT
+    using storage_type = real_type;
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_HALF
+    using storage_type = sycl::half;
+#elif SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_INT8
+    using storage_type = std::uint8_t;
+#endif
+
+    /// The factor by which the number of searched nearest-neighbors is increased if the data points are stored with reduced precision or
+    /// a reduced number of dimensions (the additional candidates are discarded during the exact re-ranking).
+    constexpr std::size_t rerank_factor = 2;
+
+
+    /**
+     * @brief Accessor wrapper converting the stored `sycl::half` values to `real_type`.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam Accessor the type of the wrapped accessor
+     */
+    template <typename Options, typename Accessor>
+    class converting_accessor {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+
+        /**
+         * @brief Construct a new converting accessor wrapping @p acc.
+         * @param[in] acc the wrapped accessor
+         */
+        explicit converting_accessor(Accessor acc) : acc_(acc) { }
+
+        /**
+         * @brief Returns the value at position @p idx converted to `real_type`.
+         * @param[in] idx the position of the requested value
+         * @return the converted value (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        real_type operator[](const index_type idx) const { return static_cast<real_type>(acc_[idx]); }
+
+    private:
+        Accessor acc_;
+    };
+
+    /**
+     * @brief Accessor wrapper dequantizing the stored, scalar quantized 8-bit values to `real_type`.
+     * @details A dimension `dim` is dequantized using `offset[dim] + scale[dim] * value` with the offsets and scales stored in
+     *          `[0, dims)` and `[dims, 2 * dims)` of the parameter accessor respectively.
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam DataAttributes the used @ref sycl_lsh::data_attributes type
+     * @tparam Accessor the type of the wrapped accessor
+     * @tparam ParamAccessor the type of the accessor to the quantization parameters
+     */
+    template <memory_layout layout, typename Options, typename DataAttributes, typename Accessor, typename ParamAccessor>
+    class dequantizing_accessor {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+
+        /**
+         * @brief Construct a new dequantizing accessor wrapping @p acc.
+         * @param[in] acc the wrapped accessor
+         * @param[in] params the accessor to the quantization parameters
+         * @param[in] attr the attributes of the used data set
+         */
+        dequantizing_accessor(Accessor acc, ParamAccessor params, const DataAttributes& attr) : acc_(acc), params_(params), attr_(attr) { }
+
+        /**
+         * @brief Returns the dequantized value at position @p idx.
+         * @param[in] idx the position of the requested value
+         * @return the dequantized value (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        real_type operator[](const index_type idx) const {
+            const index_type dims = detail::get_dims<Options>(attr_);
+            const index_type dim = layout == memory_layout::aos ? idx % dims : idx / attr_.rank_size;
+            return params_[dim] + params_[dims + dim] * static_cast<real_type>(acc_[idx]);
+        }
+
+    private:
+        Accessor acc_;
+        ParamAccessor params_;
+        const DataAttributes attr_;
+    };
+
+}
+
+#if SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_HALF
+namespace sycl_lsh::mpi {
+
+    // sycl::half has no MPI equivalent -> send the raw bits
+    static_assert(sizeof(sycl::half) == sizeof(std::uint16_t), "Unexpected size of sycl::half!");
+    template <>
+    [[nodiscard]]
+    inline MPI_Datatype type_cast<sycl::half>() noexcept { return MPI_UINT16_T; }
+
+}
+#endif
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_STORAGE_HPP
@@ -0,0 +1,422 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-16
+ *
+ * @brief Implements different data structures to maintain the k-nearest-neighbors of a single query inside a SYCL kernel.
+ * @details The currently used data structure is selected at compile time using the `SYCL_LSH_TOP_K` CMake option.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
+
+#include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/utility.hpp>
+
+#include <limits>
+
+namespace sycl_lsh::detail {
+
+    /**
+     * @brief Maintains the k-nearest-neighbors using a single bubble sort pass after each replacement of the currently greatest
+     *        distance. Duplicates are detected using a linear search over all k entries.
+     * @details The k-nearest-neighbors are stored in descending order of their distances, i.e. the greatest distance is at position `0`.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam IdAccessor the type of the accessor to the nearest-neighbor IDs
+     * @tparam DistAccessor the type of the accessor to the nearest-neighbor distances
+     */
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    class top_k_bubble {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+        /// The used integral type for the (global) nearest-neighbor IDs.
+        using id_type = typename Options::id_type;
+
+        /**
+         * @brief Construct a new top-k object representing the k-nearest-neighbors at `[offset, offset + k)`.
+         * @param[in] ids the accessor to the nearest-neighbor IDs
+         * @param[in] dists the accessor to the nearest-neighbor distances
+         * @param[in] offset the position of the first nearest-neighbor of the current query
+         * @param[in] k the number of nearest-neighbors
+         */
+        top_k_bubble(IdAccessor ids, DistAccessor dists, const index_type offset, const index_type k)
+                : ids_(ids), dists_(dists), offset_(offset), k_(k) { }
+
+        /**
+         * @brief Returns the currently greatest distance, i.e. the distance a new candidate must fall below.
+         * @return the greatest distance (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        real_type max_distance() const { return dists_[offset_]; }
+        /**
+         * @brief Adds the candidate @p id with the distance @p dist if it isn't already a nearest-neighbor.
+         * @param[in] id the ID of the candidate
+         * @param[in] dist the distance of the candidate
+         *
+         * @pre @p dist must be less than @ref max_distance().
+         */
+        void add(const id_type id, const real_type dist) {
+            for (index_type nn = 0; nn < k_; ++nn) {
+                if (ids_[offset_ + nn] == id) return;
+            }
+
+            ids_[offset_] = id;
+            dists_[offset_] = dist;
+
+            // ensure that the greatest distance is at pos 0
+            for (index_type nn = 0; nn < k_ - 1; ++nn) {
+                if (dists_[offset_ + nn] < dists_[offset_ + nn + 1]) {
+                    detail::swap(ids_[offset_ + nn], ids_[offset_ + nn + 1]);
+                    detail::swap(dists_[offset_ + nn], dists_[offset_ + nn + 1]);
+                }
+            }
+        }
+        /**
+         * @brief Must be called after all candidates have been added (no-op for this data structure).
+         */
+        void finalize() { }
+
+    private:
+        IdAccessor ids_;
+        DistAccessor dists_;
+        const index_type offset_;
+        const index_type k_;
+    };
+
+
+    /**
+     * @brief Maintains the k-nearest-neighbors in a sorted array.
+     * @details The k-nearest-neighbors are stored in descending order of their distances, i.e. the greatest distance is at position `0`.
+     *          Duplicates are detected using a binary search since a duplicate must have exactly the same distance. A new candidate
+     *          only shifts the nearest-neighbors with a **greater** distance, i.e. the costs decrease the better the nearest-neighbors get.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam IdAccessor the type of the accessor to the nearest-neighbor IDs
+     * @tparam DistAccessor the type of the accessor to the nearest-neighbor distances
+     */
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    class top_k_sorted {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+        /// The used integral type for the (global) nearest-neighbor IDs.
+        using id_type = typename Options::id_type;
+
+        /**
+         * @copydoc top_k_bubble::top_k_bubble
+         */
+        top_k_sorted(IdAccessor ids, DistAccessor dists, const index_type offset, const index_type k)
+                : ids_(ids), dists_(dists), offset_(offset), k_(k) { }
+
+        /**
+         * @copydoc top_k_bubble::max_distance
+         */
+        [[nodiscard]]
+        real_type max_distance() const { return dists_[offset_]; }
+        /**
+         * @copydoc top_k_bubble::add
+         */
+        void add(const id_type id, const real_type dist) {
+            // binary search the first position with a distance not greater than dist
+            index_type pos = 0;
+            index_type count = k_;
+            while (count > 0) {
+                const index_type step = count / 2;
+                if (dists_[offset_ + pos + step] > dist) {
+                    pos += step + 1;
+                    count -= step + 1;
+                } else {
+                    count = step;
+                }
+            }
+            // check for duplicates
+            for (index_type nn = pos; nn < k_ && dists_[offset_ + nn] == dist; ++nn) {
+                if (ids_[offset_ + nn] == id) return;
+            }
+
+            // shift all greater distances (except the greatest one) one position to the front
+            for (index_type nn = 1; nn < pos; ++nn) {
+                ids_[offset_ + nn - 1] = ids_[offset_ + nn];
+                dists_[offset_ + nn - 1] = dists_[offset_ + nn];
+            }
+            ids_[offset_ + pos - 1] = id;
+            dists_[offset_ + pos - 1] = dist;
+        }
+        /**
+         * @copydoc top_k_bubble::finalize
+         */
+        void finalize() { }
+
+    private:
+        IdAccessor ids_;
+        DistAccessor dists_;
+        const index_type offset_;
+        const index_type k_;
+    };
+
+
+    /**
+     * @brief Maintains the k-nearest-neighbors in a binary max-heap.
+     * @details The greatest distance is at position `0` (the root of the heap). Replacing the greatest distance costs `O(log k)`.
+     *          Duplicates are detected using a depth-first search that skips all subtrees whose root already has a smaller distance.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam IdAccessor the type of the accessor to the nearest-neighbor IDs
+     * @tparam DistAccessor the type of the accessor to the nearest-neighbor distances
+     */
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    class top_k_heap {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+        /// The used integral type for the (global) nearest-neighbor IDs.
+        using id_type = typename Options::id_type;
+
+        /**
+         * @copydoc top_k_bubble::top_k_bubble
+         */
+        top_k_heap(IdAccessor ids, DistAccessor dists, const index_type offset, const index_type k)
+                : ids_(ids), dists_(dists), offset_(offset), k_(k) { }
+
+        /**
+         * @copydoc top_k_bubble::max_distance
+         */
+        [[nodiscard]]
+        real_type max_distance() const { return dists_[offset_]; }
+        /**
+         * @copydoc top_k_bubble::add
+         */
+        void add(const id_type id, const real_type dist) {
+            if (this->contains(id, dist)) return;
+
+            // replace root and restore heap property
+            index_type pos = 0;
+            while (true) {
+                const index_type left = 2 * pos + 1;
+                if (left >= k_) break;
+                const index_type child = left + 1 < k_ && dists_[offset_ + left + 1] > dists_[offset_ + left] ? left + 1 : left;
+                if (dists_[offset_ + child] <= dist) break;
+                ids_[offset_ + pos] = ids_[offset_ + child];
+                dists_[offset_ + pos] = dists_[offset_ + child];
+                pos = child;
+            }
+            ids_[offset_ + pos] = id;
+            dists_[offset_ + pos] = dist;
+        }
+        /**
+         * @copydoc top_k_bubble::finalize
+         */
+        void finalize() { }
+
+    private:
+        /*
+         * @brief Checks whether the candidate @p id with distance @p dist is already contained in the heap.
+         * @details Stackless pre-order traversal of the implicit heap: a subtree can only contain @p dist if its root's distance
+         *          isn't smaller.
+         */
+        [[nodiscard]]
+        bool contains(const id_type id, const real_type dist) const {
+            index_type node = 0;
+            while (true) {
+                if (dists_[offset_ + node] >= dist) {
+                    if (dists_[offset_ + node] == dist && ids_[offset_ + node] == id) return true;
+                    // descend into the left child
+                    if (2 * node + 1 < k_) {
+                        node = 2 * node + 1;
+                        continue;
+                    }
+                }
+                // ascend until a right sibling exists
+                while (node != 0 && (node % 2 == 0 || node + 1 >= k_)) {
+                    node = (node - 1) / 2;
+                }
+                if (node == 0) return false;
+                ++node;
+            }
+        }
+
+        IdAccessor ids_;
+        DistAccessor dists_;
+        const index_type offset_;
+        const index_type k_;
+    };
+
+
+    /// The number of candidates buffered in private memory by the @ref sycl_lsh::detail::top_k_merge data structure (must be a power of two).
+    constexpr int top_k_merge_queue_size = 16;
+
+    /**
+     * @brief Maintains the k-nearest-neighbors in a sorted array and buffers new candidates in a small queue in private memory.
+     * @details If the queue is full (or @ref finalize() gets called), the queue gets sorted using a bitonic sorting network and merged into
+     *          the sorted array in a single pass. \n
+     *          The k-nearest-neighbors are stored in descending order of their distances, i.e. the greatest distance is at position `0`.
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam IdAccessor the type of the accessor to the nearest-neighbor IDs
+     * @tparam DistAccessor the type of the accessor to the nearest-neighbor distances
+     */
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    class top_k_merge {
+    public:
+        /// The used floating point type.
+        using real_type = typename Options::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename Options::index_type;
+        /// The used integral type for the (global) nearest-neighbor IDs.
+        using id_type = typename Options::id_type;
+
+        /**
+         * @copydoc top_k_bubble::top_k_bubble
+         */
+        top_k_merge(IdAccessor ids, DistAccessor dists, const index_type offset, const index_type k)
+                : ids_(ids), dists_(dists), offset_(offset), k_(k) { }
+
+        /**
+         * @copydoc top_k_bubble::max_distance
+         */
+        [[nodiscard]]
+        real_type max_distance() const { return dists_[offset_]; }
+        /**
+         * @copydoc top_k_bubble::add
+         */
+        void add(const id_type id, const real_type dist) {
+            // check for duplicates in the queue
+            for (int q = 0; q < queue_size_; ++q) {
+                if (queue_ids_[q] == id) return;
+            }
+            // check for duplicates in the sorted array (a duplicate must have the same distance)
+            index_type pos = 0;
+            index_type count = k_;
+            while (count > 0) {
+                const index_type step = count / 2;
+                if (dists_[offset_ + pos + step] > dist) {
+                    pos += step + 1;
+                    count -= step + 1;
+                } else {
+                    count = step;
+                }
+            }
+            for (index_type nn = pos; nn < k_ && dists_[offset_ + nn] == dist; ++nn) {
+                if (ids_[offset_ + nn] == id) return;
+            }
+
+            queue_ids_[queue_size_] = id;
+            queue_dists_[queue_size_] = dist;
+            if (++queue_size_ == top_k_merge_queue_size) {
+                this->merge();
+            }
+        }
+        /**
+         * @brief Must be called after all candidates have been added. Merges the remaining candidates in the queue.
+         */
+        void finalize() {
+            if (queue_size_ > 0) {
+                this->merge();
+            }
+        }
+
+    private:
+        /*
+         * @brief Sorts the queue and merges the queue into the sorted array keeping only the k smallest distances.
+         */
+        void merge() {
+            // pad the queue
+            for (int q = queue_size_; q < top_k_merge_queue_size; ++q) {
+                queue_ids_[q] = 0;
+                queue_dists_[q] = std::numeric_limits<real_type>::max();
+            }
+            // bitonic sort in descending order -> padded values are at the front
+            for (int size = 2; size <= top_k_merge_queue_size; size *= 2) {
+                for (int stride = size / 2; stride > 0; stride /= 2) {
+                    for (int q = 0; q < top_k_merge_queue_size; ++q) {
+                        const int partner = q ^ stride;
+                        if (partner > q && ((queue_dists_[q] < queue_dists_[partner]) == ((q & size) == 0))) {
+                            detail::swap(queue_ids_[q], queue_ids_[partner]);
+                            detail::swap(queue_dists_[q], queue_dists_[partner]);
+                        }
+                    }
+                }
+            }
+
+            // merge in descending order and drop the queue_size_ greatest distances
+            // (in-place since the write position is never greater than the read position)
+            const index_type num_dropped = queue_size_;
+            index_type nn = 0;
+            int q = top_k_merge_queue_size - queue_size_;
+            for (index_type rank = 0; rank < k_ + num_dropped; ++rank) {
+                id_type id;
+                real_type dist;
+                if (q >= top_k_merge_queue_size || (nn < k_ && dists_[offset_ + nn] >= queue_dists_[q])) {
+                    id = ids_[offset_ + nn];
+                    dist = dists_[offset_ + nn];
+                    ++nn;
+                } else {
+                    id = queue_ids_[q];
+                    dist = queue_dists_[q];
+                    ++q;
+                }
+                if (rank >= num_dropped) {
+                    ids_[offset_ + rank - num_dropped] = id;
+                    dists_[offset_ + rank - num_dropped] = dist;
+                }
+            }
+            queue_size_ = 0;
+        }
+
+        IdAccessor ids_;
+        DistAccessor dists_;
+        const index_type offset_;
+        const index_type k_;
+
+        id_type queue_ids_[top_k_merge_queue_size];
+        real_type queue_dists_[top_k_merge_queue_size];
+        int queue_size_ = 0;
+    };
+
+
+#if SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_BUBBLE
+    /// The used data structure to maintain the k-nearest-neighbors inside the SYCL kernels.
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    using top_k = top_k_bubble<Options, IdAccessor, DistAccessor>;
+#elif SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_SORTED
+    /// The used data structure to maintain the k-nearest-neighbors inside the SYCL kernels.
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    using top_k = top_k_sorted<Options, IdAccessor, DistAccessor>;
+#elif SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_HEAP
+    /// The used data structure to maintain the k-nearest-neighbors inside the SYCL kernels.
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    using top_k = top_k_heap<Options, IdAccessor, DistAccessor>;
+#elif SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_MERGE
+    /// The used data structure to maintain the k-nearest-neighbors inside the SYCL kernels.
+    template <typename Options, typename IdAccessor, typename DistAccessor>
+    using top_k = top_k_merge<Options, IdAccessor, DistAccessor>;
+#endif
+
+    /**
+     * @brief Factory function for the top-k data structures.
+     * @details Used to be able to automatically deduce the accessor types.
+     * @tparam TopK the top-k data structure (defaults to the one selected at compile time)
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam IdAccessor the type of the accessor to the nearest-neighbor IDs
+     * @tparam DistAccessor the type of the accessor to the nearest-neighbor distances
+     * @param[in] ids the accessor to the nearest-neighbor IDs
+     * @param[in] dists the accessor to the nearest-neighbor distances
+     * @param[in] offset the position of the first nearest-neighbor of the current query
+     * @param[in] k the number of nearest-neighbors
+     * @return the top-k data structure (`[[nodiscard]]`)
+     */
+    template <typename Options, template <typename, typename, typename> typename TopK = top_k, typename IdAccessor, typename DistAccessor>
+    [[nodiscard]]
+    TopK<Options, IdAccessor, DistAccessor> make_top_k(IdAccessor ids, DistAccessor dists,
+                                                       const typename Options::index_type offset, const typename Options::index_type k)
+    {
+        return TopK<Options, IdAccessor, DistAccessor>(ids, dists, offset, k);
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
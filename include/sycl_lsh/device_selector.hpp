@@ -13,22 +13,45 @@
 #include <sycl_lsh/detail/sycl.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 
 namespace sycl_lsh {
 
     namespace detail {
 
+        /// The maximum number of devices used per MPI rank (specified using the `SYCL_LSH_DEVICES_PER_RANK` CMake option).
+#if defined(SYCL_LSH_DEVICES_PER_RANK)
+        constexpr std::size_t devices_per_rank = SYCL_LSH_DEVICES_PER_RANK;
+#else
+        constexpr std::size_t devices_per_rank = 1;
+#endif
+
         /**
-         * @brief Select exactly one NVIDIA GPU device per MPI rank.
+         * @brief Select exactly @ref sycl_lsh::detail::devices_per_rank GPU devices per MPI rank.
+         * @details The MPI rank with the node local rank `r` gets the devices `[r * devices_per_rank, (r + 1) * devices_per_rank)`.
          * @param[in] comm the used @ref sycl_lsh::mpi::communicator
          * @param[in] env_var_name the name of the environmental variable used to control the GPU selection
          *
-         * @note Only supports NVIDIA GPUs!
+         * @note Only supports NVIDIA and AMD GPUs!
          */
         void setup_devices(const sycl_lsh::mpi::communicator& comm, const std::string& env_var_name);
 
+        /**
+         * @brief Returns the devices used by the current MPI rank.
+         * @details If more than one device per MPI rank is requested, returns the first (at most)
+         *          @ref sycl_lsh::detail::devices_per_rank devices accepted by the @ref sycl_lsh::device_selector. Otherwise returns the
+         *          device with the highest score.
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @return the devices (`[[nodiscard]]`)
+         *
+         * @throws std::runtime_error if no device is accepted by the @ref sycl_lsh::device_selector.
+         */
+        [[nodiscard]]
+        std::vector<sycl::device> select_devices(const sycl_lsh::mpi::communicator& comm);
+
         /**
          * @brief Compares the two devices @p lhs and @p rhs on equality.
          * @param[in] lhs a SYCL device
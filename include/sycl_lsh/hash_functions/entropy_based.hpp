@@ -11,22 +11,27 @@
 
 #include <sycl_lsh/data.hpp>
 #include <sycl_lsh/detail/assert.hpp>
+#include <sycl_lsh/detail/cut_off_points.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
 #include <sycl_lsh/detail/get_linear_id.hpp>
 #include <sycl_lsh/detail/hash_combine.hpp>
 #include <sycl_lsh/detail/lsh_hash.hpp>
+#include <sycl_lsh/detail/philox.hpp>
 #include <sycl_lsh/detail/sycl.hpp>
 #include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
-#include <sycl_lsh/mpi/sort.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
 #include <sycl_lsh/options.hpp>
 
+#include <fmt/format.h>
 #include <mpi.h>
 
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 namespace sycl_lsh {
@@ -144,25 +149,110 @@ namespace sycl_lsh {
                                    AccData& acc_data, AccHashFunctions& acc_hash_functions,
                                    const options_type& opt, const data_attributes_type& attr) const
         {
+            return this->combined_hash_value(hash_table, point, acc_data, acc_hash_functions, opt, attr) % opt.hash_table_size;
+        }
+        /**
+         * @brief Calculates the combined hash value of the data point @p point in hash table @p hash_tables using entropy based hash functions, i.e. the
+         *        hash value before it is reduced modulo the hash table size (used for the hash fingerprints).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the combined hash value (`[[nodiscard]]`)
+         *
+         * @pre @p hash_table must be in the range `[0, number of hash tables)` (currently disabled).
+         * @pre @p hash_function must be in the range `[0, number of hash functions)` (currently disabled).
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combined_hash_value(const index_type hash_table, const index_type point,
+                                            AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                            const options_type& opt, const data_attributes_type& attr) const
+        {
 //            SYCL_LSH_DEBUG_ASSERT(0 <= hash_table && hash_table < opt.num_hash_tables, "Out-of-bounce access for hash tables!\n");
 //            SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr.rank_size, "Out-of-bounce access for data point!");
 
             // get indexing functions
             const get_linear_id<hash_function_type> get_linear_id_hash_function{};
             const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
 
             hash_value_type combined_hash = opt.num_hash_functions;
             for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
                 // calculate dot product for current hash function
                 real_type hash = 0.0;
-                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                for (index_type dim = 0; dim < dims; ++dim) {
                     hash += acc_data[get_linear_id_data(point, dim, attr)]
                             * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
                 }
                 // calculate entropy hash for current hash function
                 hash_value_type entropy_hash = 0;
                 for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
-                    entropy_hash += hash > acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, attr.dims + cop, opt, attr)];
+                    entropy_hash += hash > acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims + cop, opt, attr)];
+                }
+                // combine hashes
+                combined_hash = detail::hash_combine(combined_hash, entropy_hash);
+            }
+            return combined_hash;
+        }
+        /**
+         * @brief Returns the coefficient of dimension @p dim of the hash function @p hash_function of hash table @p hash_table, i.e. one
+         *        entry of the `dims x (num_hash_tables * num_hash_functions)` matrix multiplied with the data points during the batched hashing.
+         * @details The entropy-based hash functions have no offset, i.e. `0` is returned for `dim == dims`.
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] hash_function the provided hash function
+         * @param[in] dim the dimension (`dims` for the offset)
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the coefficient (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        real_type coefficient(const index_type hash_table, const index_type hash_function, const index_type dim,
+                              AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            // the values following the last dimension are the cut-off points
+            return dim < detail::get_dims<options_type>(attr) ? acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)] : real_type{ 0.0 };
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the precalculated dot products @p acc_dot_products of a data
+         *        point with all hash functions (see @ref coefficient()).
+         * @details Results in the same hash value as @ref operator()() if the dot products are accumulated in the same order.
+         * @tparam AccDotProducts the type of the dot products `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] acc_dot_products the dot products `sycl::accessor`
+         * @param[in] first the position of the dot product of the first hash function of hash table @p hash_table in @p acc_dot_products
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccDotProducts, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine_dot_products(const index_type hash_table, AccDotProducts& acc_dot_products, const index_type first,
+                                             AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
+
+            hash_value_type combined_hash = opt.num_hash_functions;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                const real_type hash = acc_dot_products[first + hash_function];
+                // calculate entropy hash for current hash function
+                hash_value_type entropy_hash = 0;
+                for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
+                    entropy_hash += hash > acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims + cop, opt, attr)];
                 }
                 // combine hashes
                 combined_hash = detail::hash_combine(combined_hash, entropy_hash);
@@ -218,6 +308,15 @@ namespace sycl_lsh {
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
          */
         entropy_based(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Construct a new @ref sycl_lsh::entropy_based object from previously created hash functions (e.g. loaded from a file).
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data
+         * @param[in] host_buffer the values of the hash functions
+         *
+         * @throws std::invalid_argument if the number of values in @p host_buffer doesn't match the used @ref sycl_lsh::options and @p data.
+         */
+        entropy_based(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer);
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -269,7 +368,11 @@ namespace sycl_lsh {
             }
         };
 
-        if (comm.master_rank()) {
+        // if a seed is given, all MPI ranks generate the identical hash functions themselves
+        const bool seeded = opt.seed != 0;
+        const detail::philox rng(opt.seed);
+
+        if (seeded || comm.master_rank()) {
             // create random generator
             #if SYCL_LSH_DEBUG
                 // don't seed random engine in debug mode
@@ -284,13 +387,20 @@ namespace sycl_lsh {
             // fill hash functions
             for (index_type hash_function = 0; hash_function < opt.hash_pool_size; ++hash_function) {
                 for (index_type dim = 0; dim < attr.dims; ++dim) {
-                    hash_functions_pool[get_linear_id_hash_pool(hash_function, dim, opt, attr)] = rnd_normal_dist(rnd_normal_pool_gen);
+                    hash_functions_pool[get_linear_id_hash_pool(hash_function, dim, opt, attr)] = seeded
+                            ? rng.normal<real_type>(hash_function * attr.dims + dim, detail::philox_stream::hash_pool)
+                            : rnd_normal_dist(rnd_normal_pool_gen);
                 }
             }
         }
 
         // broadcast pool hash functions to other MPI ranks
-        MPI_Bcast(hash_functions_pool.data(), hash_functions_pool.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        if (!seeded) {
+            const auto broadcast_start = mpi::communication_profiler::clock::now();
+            MPI_Bcast(hash_functions_pool.data(), hash_functions_pool.size(), mpi::type_cast<real_type>(), 0, comm.get());
+            mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? hash_functions_pool.size() * sizeof(real_type) : 0,
+                                                         comm.master_rank() ? 0 : hash_functions_pool.size() * sizeof(real_type), broadcast_start);
+        }
 
         std::vector<real_type> cut_off_points_pool(opt.hash_pool_size * (opt.num_cut_off_points - 1));
 
@@ -299,53 +409,30 @@ namespace sycl_lsh {
             sycl::queue queue(device_selector{comm}, sycl::async_handler(&sycl_exception_handler));
             sycl::buffer<real_type, 1> hash_functions_pool_buffer(hash_functions_pool.data(), hash_functions_pool.size());
 
-            std::vector<real_type> hash_values(attr.rank_size);
+            sycl::buffer<real_type, 1> hash_values_buffer{ sycl::range<>(attr.rank_size) };
             for (index_type hash_function = 0; hash_function < opt.hash_pool_size; ++hash_function) {
-                {
-                    sycl::buffer<real_type, 1> hash_values_buffer(hash_values.data(), hash_values.size());
-                    queue.submit([&](sycl::handler& cgh) {
-                        auto acc_data = data.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-                        auto acc_hash_functions = hash_functions_pool_buffer.template get_access<sycl::access::mode::read>(cgh);
-                        auto acc_hash_values = hash_values_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
-                        
-                        const options_type options = opt;
-                        get_linear_id<data_type> get_linear_id_data{};
-
-                        cgh.parallel_for<kernel_cut_off_points_unsorted>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
-                            const index_type idx = item.get_linear_id();
-
-                            real_type value = 0.0;
-                            for (index_type dim = 0; dim < attr.dims; ++dim) {
-                                value += acc_data[get_linear_id_data(idx, dim, attr)]
-                                        * acc_hash_functions[get_linear_id_hash_pool(hash_function, dim, options, attr)];
-                            }
-                            acc_hash_values[idx] = value;
-                        });
+                queue.submit([&](sycl::handler& cgh) {
+                    auto acc_data = data.get_device_accessor(cgh);
+                    auto acc_hash_functions = hash_functions_pool_buffer.template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_hash_values = hash_values_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    
+                    const options_type options = opt;
+                    get_linear_id<data_type> get_linear_id_data{};
+
+                    cgh.parallel_for<kernel_cut_off_points_unsorted>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                        const index_type idx = item.get_linear_id();
+
+                        real_type value = 0.0;
+                        for (index_type dim = 0; dim < attr.dims; ++dim) {
+                            value += acc_data[get_linear_id_data(idx, dim, attr)]
+                                    * acc_hash_functions[get_linear_id_hash_pool(hash_function, dim, options, attr)];
+                        }
+                        acc_hash_values[idx] = value;
                     });
-                }
-
-                // sort hash_values vector in a distributed fashion
-                mpi::sort(hash_values, comm);
-                
-                std::vector<real_type> cut_off_points(opt.num_cut_off_points - 1, 0.0);
-
-                // calculate cut-off points indices
-                std::vector<index_type> cut_off_points_idx(cut_off_points.size());
-                const index_type jump = (attr.rank_size * comm.size()) / opt.num_cut_off_points;
-                for (index_type cop = 0; cop < cut_off_points_idx.size(); ++cop) {
-                    cut_off_points_idx[cop] = (cop + 1) * jump;
-                }
-
-                // fill cut-off points which are located on the current MPI rank
-                for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
-                    // check if index belongs to current MPI rank
-                    if (cut_off_points_idx[cop] >= attr.rank_size * comm.rank() && cut_off_points_idx[cop] < attr.rank_size * (comm.rank() + 1)) {
-                        cut_off_points[cop] = hash_values[cut_off_points_idx[cop] % attr.rank_size];
-                    }
-                }
+                });
 
-                // combine to final cut-off points on all MPI ranks
-                MPI_Allreduce(MPI_IN_PLACE, cut_off_points.data(), cut_off_points.size(), mpi::type_cast<real_type>(), MPI_SUM, comm.get());
+                // calculate the cut-off points of the current hash function (identical on all MPI ranks)
+                const std::vector<real_type> cut_off_points = detail::calculate_cut_off_points(queue, hash_values_buffer, opt, attr, comm);
 
                 // copy current cut-off points to pool
                 std::copy(cut_off_points.begin(), cut_off_points.end(), cut_off_points_pool.begin() + hash_function * cut_off_points.size());
@@ -354,7 +441,7 @@ namespace sycl_lsh {
 
         // select actual hash functions
         std::vector<real_type> host_buffer(device_buffer_.get_count());
-        if (comm.master_rank()) {
+        if (seeded || comm.master_rank()) {
             // create random generator
             #if SYCL_LSH_DEBUG
                 // don't seed random engine in debug mode
@@ -370,7 +457,9 @@ namespace sycl_lsh {
 
             for (index_type hash_table = 0; hash_table < opt.num_hash_tables; ++hash_table) {
                 for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
-                    const index_type pool_hash_function = rnd_uniform_dist(rnd_uniform_gen);
+                    const index_type pool_hash_function = seeded
+                            ? rng.index<index_type>(hash_table * opt.num_hash_functions + hash_function, detail::philox_stream::selection, opt.hash_pool_size)
+                            : rnd_uniform_dist(rnd_uniform_gen);
                     for (index_type dim = 0; dim < attr.dims; ++dim) {
                         host_buffer[get_linear_id_functor(hash_table, hash_function, dim, opt, attr)]
                             = hash_functions_pool[get_linear_id_hash_pool(pool_hash_function, dim, opt, attr)];
@@ -384,17 +473,29 @@ namespace sycl_lsh {
         }
 
         // broadcast hash function to other MPI ranks
-        MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        if (!seeded) {
+            const auto broadcast_start = mpi::communication_profiler::clock::now();
+            MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+            mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? host_buffer.size() * sizeof(real_type) : 0,
+                                                         comm.master_rank() ? 0 : host_buffer.size() * sizeof(real_type), broadcast_start);
+        }
 
         // copy data to device buffer
-        auto acc = device_buffer_.template get_access<sycl::access::mode::discard_write>();
-        for (index_type i = 0; i < acc.get_count(); ++i) {
-            acc[i] = host_buffer[i];
-        }
+        device_buffer_ = device_buffer_type(host_buffer.begin(), host_buffer.end());
 
         logger.log("Created 'entropy_based' hash functions in {}.\n", t.elapsed());
     }
 
+    template <memory_layout layout, typename Options, typename Data>
+    entropy_based<layout, Options, Data>::entropy_based(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer)
+            : device_buffer_(host_buffer.begin(), host_buffer.end())
+    {
+        const std::size_t expected_size = opt.num_hash_tables * opt.num_hash_functions * (data.get_attributes().dims + opt.num_cut_off_points - 1);
+        if (host_buffer.size() != expected_size) {
+            throw std::invalid_argument(fmt::format("Illegal number of hash function values ({})! Expected {}.", host_buffer.size(), expected_size));
+        }
+    }
+
 }
 
 #endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_ENTROPY_BASED_HPP
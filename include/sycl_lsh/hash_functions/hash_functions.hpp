@@ -26,7 +26,9 @@ namespace sycl_lsh {
         /** entropy based hash functions */
         entropy_based,
         /** mixed hash functions (random projections + entropy-based as hash combine) */
-        mixed_hash_functions
+        mixed_hash_functions,
+        /** sign random projections (SimHash) hash functions for the angular distance */
+        simhash
     };
 
     /**
@@ -46,10 +48,24 @@ namespace sycl_lsh {
             case hash_functions_type::mixed_hash_functions:
                 out << "mixed_hash_functions";
                 break;
+            case hash_functions_type::simhash:
+                out << "simhash";
+                break;
         }
         return out;
     }
 
+    /**
+     * @brief Checks whether the hash functions of type @p type support multi-probe querying (i.e. the quantized values of their hash
+     *        functions can be shifted to neighboring hash buckets).
+     * @param[in] type the hash functions type
+     * @return `true` if multi-probe querying is supported, otherwise `false` (`[[nodiscard]]`)
+     */
+    [[nodiscard]]
+    constexpr bool supports_multi_probe(const hash_functions_type type) noexcept {
+        return type == hash_functions_type::random_projections || type == hash_functions_type::mixed_hash_functions;
+    }
+
 
     // forward declare hash functions classes
     template <memory_layout layout, typename Options, typename Data>
@@ -58,6 +74,8 @@ namespace sycl_lsh {
     class entropy_based;
     template <memory_layout layout, typename Options, typename Data>
     class mixed_hash_functions;
+    template <memory_layout layout, typename Options, typename Data>
+    class simhash;
 
     namespace detail {
 
@@ -104,6 +122,17 @@ namespace sycl_lsh {
             using type = mixed_hash_functions<layout, Options, Data>;
         };
 
+        /**
+         * @brief Type trait specialization for the @ref sycl_lsh::simhash hash functions class.
+         * @tparam layout the used @ref sycl_lsh::memory_layout type
+         * @tparam Options the used @ref sycl_lsh::options type
+         * @tparam Data the used @ref sycl_lsh::data type
+         */
+        template <memory_layout layout, typename Options, typename Data>
+        struct get_hash_functions_type<layout, Options, Data, hash_functions_type::simhash> {
+            using type = simhash<layout, Options, Data>;
+        };
+
         /**
          * @brief Type alias for the @ref sycl_lsh::detail::get_hash_functions_type type trait class.
          */
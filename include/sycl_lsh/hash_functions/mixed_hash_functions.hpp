@@ -3,21 +3,26 @@
 
 #include <sycl_lsh/data.hpp>
 #include <sycl_lsh/detail/assert.hpp>
+#include <sycl_lsh/detail/cut_off_points.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
 #include <sycl_lsh/detail/get_linear_id.hpp>
 #include <sycl_lsh/detail/lsh_hash.hpp>
+#include <sycl_lsh/detail/philox.hpp>
 #include <sycl_lsh/detail/sycl.hpp>
 #include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
-#include <sycl_lsh/mpi/sort.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
 #include <sycl_lsh/options.hpp>
 
+#include <fmt/format.h>
 #include <mpi.h>
 
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 namespace sycl_lsh {
@@ -187,6 +192,30 @@ namespace sycl_lsh {
                                    AccData& acc_data, AccHashFunctions& acc_hash_functions,
                                    const options_type& opt, const data_attributes_type& attr) const
         {
+            return this->combined_hash_value(hash_table, point, acc_data, acc_hash_functions, opt, attr) % opt.hash_table_size;
+        }
+        /**
+         * @brief Calculates the combined hash value of the data point @p point in hash table @p hash_tables using mixed hash functions, i.e. the
+         *        hash value before it is reduced modulo the hash table size (used for the hash fingerprints).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the combined hash value (`[[nodiscard]]`)
+         *
+         * @pre @p hash_table must be in the range `[0, number of hash tables)` (currently disabled).
+         * @pre @p hash_function must be in the range `[0, number of hash functions)` (currently disabled).
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combined_hash_value(const index_type hash_table, const index_type point,
+                                            AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                            const options_type& opt, const data_attributes_type& attr) const
+        {
 //            SYCL_LSH_DEBUG_ASSERT(0 <= hash_table && hash_table < opt.num_hash_tables, "Out-of-bounce access for hash tables!\n");
 //            SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr.rank_size, "Out-of-bounce access for data point!");
 
@@ -194,12 +223,14 @@ namespace sycl_lsh {
             // get indexing functions
             const get_linear_id<hash_function_type> get_linear_id_hash_function{};
             const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
 
             real_type value = 0.0;
             for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
                 // calculate hash value using random projections
-                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, attr.dims, opt, attr, hash_function_type::buffer_part::hash_functions)];
-                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims, opt, attr, hash_function_type::buffer_part::hash_functions)];
+                for (index_type dim = 0; dim < dims; ++dim) {
                     hash += acc_data[get_linear_id_data(point, dim, attr)]
                             * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr, hash_function_type::buffer_part::hash_functions)];
                 }
@@ -212,6 +243,134 @@ namespace sycl_lsh {
             for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
                 combined_hash += value > acc_hash_functions[get_linear_id_hash_function(hash_table, cop, opt, attr, hash_function_type::buffer_part::cut_off_points)];
             }
+            return combined_hash;
+        }
+
+        /**
+         * @brief Calculates the unquantized values \f$\frac{a \cdot x + b}{w}\f$ of all random projections of hash table @p hash_table for
+         *        the data point @p point (used for multi-probe querying).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @param[out] projections the `opt.num_hash_functions` unquantized random projection values
+         */
+        template <typename AccData, typename AccHashFunctions>
+        void projections(const index_type hash_table, const index_type point,
+                         AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                         const options_type& opt, const data_attributes_type& attr, real_type* projections) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
+
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims, opt, attr, hash_function_type::buffer_part::hash_functions)];
+                for (index_type dim = 0; dim < dims; ++dim) {
+                    hash += acc_data[get_linear_id_data(point, dim, attr)]
+                            * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr, hash_function_type::buffer_part::hash_functions)];
+                }
+                projections[hash_function] = hash / opt.w;
+            }
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the unquantized random projection values @p projections, where
+         *        the quantized value of the random projection @p perturbed_hash_function is shifted by @p delta (used for multi-probe querying).
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] projections the unquantized random projection values calculated by @ref projections()
+         * @param[in] perturbed_hash_function the random projection whose quantized value is shifted
+         * @param[in] delta the shift (`0` results in the same hash value as @ref operator()())
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine(const index_type hash_table, const real_type* projections,
+                                const index_type perturbed_hash_function, const int delta, AccHashFunctions& acc_hash_functions,
+                                const options_type& opt, const data_attributes_type& attr) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+
+            real_type value = 0.0;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                hash_value_type quantized = static_cast<hash_value_type>(projections[hash_function]);
+                if (hash_function == perturbed_hash_function) {
+                    quantized += static_cast<hash_value_type>(delta);
+                }
+                // combine hash values using the entropy-based hash functions
+                value += quantized * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, opt, attr, hash_function_type::buffer_part::hash_combine)];
+            }
+            // calculate final hash value using the cut-off points of the combined hash values
+            hash_value_type combined_hash = 0;
+            for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
+                combined_hash += value > acc_hash_functions[get_linear_id_hash_function(hash_table, cop, opt, attr, hash_function_type::buffer_part::cut_off_points)];
+            }
+            return combined_hash % opt.hash_table_size;
+        }
+        /**
+         * @brief Returns the coefficient of dimension @p dim of the hash function @p hash_function of hash table @p hash_table, i.e. one
+         *        entry of the `dims x (num_hash_tables * num_hash_functions)` matrix multiplied with the data points during the batched hashing.
+         * @details The offset \f$b\f$ of the random projection is returned for `dim == dims`.
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] hash_function the provided hash function
+         * @param[in] dim the dimension (`dims` for the offset)
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the coefficient (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        real_type coefficient(const index_type hash_table, const index_type hash_function, const index_type dim,
+                              AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            return acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr, hash_function_type::buffer_part::hash_functions)];
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the precalculated dot products @p acc_dot_products of a data
+         *        point with all hash functions (see @ref coefficient()).
+         * @details Results in the same hash value as @ref operator()() if the dot products are accumulated in the same order.
+         * @tparam AccDotProducts the type of the dot products `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] acc_dot_products the dot products `sycl::accessor`
+         * @param[in] first the position of the dot product of the first hash function of hash table @p hash_table in @p acc_dot_products
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccDotProducts, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine_dot_products(const index_type hash_table, AccDotProducts& acc_dot_products, const index_type first,
+                                             AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+
+            real_type value = 0.0;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                // combine hash values using the entropy-based hash functions
+                value += static_cast<hash_value_type>(acc_dot_products[first + hash_function] / opt.w)
+                         * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, opt, attr, hash_function_type::buffer_part::hash_combine)];
+            }
+            // calculate final hash value using the cut-off points of the combined hash values
+            hash_value_type combined_hash = 0;
+            for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
+                combined_hash += value > acc_hash_functions[get_linear_id_hash_function(hash_table, cop, opt, attr, hash_function_type::buffer_part::cut_off_points)];
+            }
             return combined_hash % opt.hash_table_size;
         }
     };
@@ -276,6 +435,15 @@ namespace sycl_lsh {
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
          */
         mixed_hash_functions(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Construct a new @ref sycl_lsh::mixed_hash_functions object from previously created hash functions (e.g. loaded from a file).
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data
+         * @param[in] host_buffer the values of the hash functions
+         *
+         * @throws std::invalid_argument if the number of values in @p host_buffer doesn't match the used @ref sycl_lsh::options and @p data.
+         */
+        mixed_hash_functions(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer);
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -316,12 +484,16 @@ namespace sycl_lsh {
         std::vector<real_type> host_buffer(device_buffer_.get_count());
         const get_linear_id<mixed_hash_functions<layout, options_type, data_type>> get_linear_id_functor{};
 
+        // if a seed is given, all MPI ranks generate the identical hash functions themselves
+        const bool seeded = opt.seed != 0;
+        const detail::philox rng(opt.seed);
+
         //
         // CREATE RANDOM PROJECTIONS HASH FUNCTIONS
         //
 
-        // create hash pool only on MPI master rank
-        if (comm.master_rank()) {
+        // create hash pool only on MPI master rank (or on all MPI ranks if a seed is given)
+        if (seeded || comm.master_rank()) {
             // create random generators
             #if SYCL_LSH_DEBUG
                 // don't seed random engine in debug mode
@@ -340,9 +512,13 @@ namespace sycl_lsh {
             std::vector<real_type> hash_pool(opt.hash_pool_size * (attr.dims + 1));
             for (index_type hash_function = 0; hash_function < opt.hash_pool_size; ++hash_function) {
                 for (index_type dim = 0; dim < attr.dims; ++dim) {
-                    hash_pool[hash_function * (attr.dims + 1) + dim] = std::abs(rnd_normal_pool_dist(rnd_normal_pool_gen));
+                    hash_pool[hash_function * (attr.dims + 1) + dim] = std::abs(seeded
+                            ? rng.normal<real_type>(hash_function * attr.dims + dim, detail::philox_stream::hash_pool)
+                            : rnd_normal_pool_dist(rnd_normal_pool_gen));
                 }
-                hash_pool[hash_function * (attr.dims + 1) + attr.dims] = rnd_uniform_pool_dist(rnd_uniform_pool_gen);
+                hash_pool[hash_function * (attr.dims + 1) + attr.dims] = seeded
+                        ? rng.uniform<real_type>(hash_function, detail::philox_stream::hash_pool_offset) * opt.w
+                        : rnd_uniform_pool_dist(rnd_uniform_pool_gen);
             }
 
             // select actual hash functions
@@ -358,7 +534,9 @@ namespace sycl_lsh {
 
             for (index_type hash_table = 0; hash_table < opt.num_hash_tables; ++hash_table) {
                 for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
-                    const index_type pool_hash_function = rnd_uniform_dist(rnd_uniform_gen);
+                    const index_type pool_hash_function = seeded
+                            ? rng.index<index_type>(hash_table * opt.num_hash_functions + hash_function, detail::philox_stream::selection, opt.hash_pool_size)
+                            : rnd_uniform_dist(rnd_uniform_gen);
                     for (index_type dim = 0; dim <= attr.dims; ++dim) {
                         host_buffer[get_linear_id_functor(hash_table, hash_function, dim, opt, attr, buffer_part::hash_functions)]
                                 = hash_pool[pool_hash_function * (attr.dims + 1) + dim];
@@ -372,7 +550,7 @@ namespace sycl_lsh {
         // CREATE ENTROPY-BASED HASH FUNCTIONS
         //
 
-        if (comm.master_rank()) {
+        if (seeded || comm.master_rank()) {
             // create random generator
             #if SYCL_LSH_DEBUG
                 // don't seed random engine in debug mode
@@ -388,13 +566,20 @@ namespace sycl_lsh {
             for (index_type hash_table = 0; hash_table < opt.num_hash_tables; ++hash_table) {
                 for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
                     host_buffer[get_linear_id_functor(hash_table, hash_function, opt, attr, buffer_part::hash_combine)]
-                            = rnd_normal_dist(rnd_normal_pool_gen);
+                            = seeded
+                            ? rng.normal<real_type>(hash_table * opt.num_hash_functions + hash_function, detail::philox_stream::hash_combine)
+                            : rnd_normal_dist(rnd_normal_pool_gen);
                 }
             }
         }
 
         // broadcast random projections hash functions to other MPI ranks
-        MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        if (!seeded) {
+            const auto broadcast_start = mpi::communication_profiler::clock::now();
+            MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+            mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? host_buffer.size() * sizeof(real_type) : 0,
+                                                         comm.master_rank() ? 0 : host_buffer.size() * sizeof(real_type), broadcast_start);
+        }
 
 
         // calculate cut-off points
@@ -402,60 +587,37 @@ namespace sycl_lsh {
             sycl::queue queue(device_selector{comm}, sycl::async_handler(&sycl_exception_handler));
             sycl::buffer<real_type, 1> hash_functions_buffer(host_buffer.data(), host_buffer.size());
 
-            std::vector<real_type> hash_values(attr.rank_size);
+            sycl::buffer<real_type, 1> hash_values_buffer{ sycl::range<>(attr.rank_size) };
             for (index_type hash_table = 0; hash_table < opt.num_hash_tables; ++hash_table) {
-                {
-                    sycl::buffer<real_type, 1> hash_values_buffer(hash_values.data(), hash_values.size());
-                    queue.submit([&](sycl::handler& cgh) {
-                        auto acc_data = data.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-                        auto acc_hash_functions = hash_functions_buffer.template get_access<sycl::access::mode::read>(cgh);
-                        auto acc_hash_values = hash_values_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
-
-                        const options_type options = opt;
-                        const data_attributes_type attributes = attr;
-                        const get_linear_id<data_type> get_linear_id_data{};
-                        const get_linear_id<mixed_hash_functions<layout, options_type, data_type>> get_linear_id_hash_functions{};
-
-                        cgh.parallel_for<kernel_cut_off_points_unsorted>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
-                            const index_type idx = item.get_linear_id();
-
-                            real_type value = 0.0;
-                            for (index_type hash_function = 0; hash_function < options.num_hash_functions; ++hash_function) {
-                                real_type hash = acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, attributes.dims, options, attributes, buffer_part::hash_functions)];
-                                for (index_type dim = 0; dim < attributes.dims; ++dim) {
-                                    hash += acc_data[get_linear_id_data(idx, dim, attributes)]
-                                            * acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, dim, options, attributes, buffer_part::hash_functions)];
-                                }
-                                value += static_cast<hash_value_type>(hash / options.w)
-                                         * acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, options, attributes, buffer_part::hash_combine)];
+                queue.submit([&](sycl::handler& cgh) {
+                    auto acc_data = data.get_device_accessor(cgh);
+                    auto acc_hash_functions = hash_functions_buffer.template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_hash_values = hash_values_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+
+                    const options_type options = opt;
+                    const data_attributes_type attributes = attr;
+                    const get_linear_id<data_type> get_linear_id_data{};
+                    const get_linear_id<mixed_hash_functions<layout, options_type, data_type>> get_linear_id_hash_functions{};
+
+                    cgh.parallel_for<kernel_cut_off_points_unsorted>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                        const index_type idx = item.get_linear_id();
+
+                        real_type value = 0.0;
+                        for (index_type hash_function = 0; hash_function < options.num_hash_functions; ++hash_function) {
+                            real_type hash = acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, attributes.dims, options, attributes, buffer_part::hash_functions)];
+                            for (index_type dim = 0; dim < attributes.dims; ++dim) {
+                                hash += acc_data[get_linear_id_data(idx, dim, attributes)]
+                                        * acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, dim, options, attributes, buffer_part::hash_functions)];
                             }
-                            acc_hash_values[idx] = value;
-                        });
+                            value += static_cast<hash_value_type>(hash / options.w)
+                                     * acc_hash_functions[get_linear_id_hash_functions(hash_table, hash_function, options, attributes, buffer_part::hash_combine)];
+                        }
+                        acc_hash_values[idx] = value;
                     });
-                }
-
-                // sort hash_values vector in a distributed fashion
-                mpi::sort(hash_values, comm);
-
-                std::vector<real_type> cut_off_points(opt.num_cut_off_points - 1, 0.0);
-
-                // calculate cut-off points indices
-                std::vector<index_type> cut_off_points_idx(cut_off_points.size());
-                const index_type jump = (attr.rank_size * comm.size()) / opt.num_cut_off_points;
-                for (index_type cop = 0; cop < cut_off_points_idx.size(); ++cop) {
-                    cut_off_points_idx[cop] = (cop + 1) * jump;
-                }
-
-                // fill cut-off points which are located on the current MPI rank
-                for (index_type cop = 0; cop < opt.num_cut_off_points - 1; ++cop) {
-                    // check if index belongs to current MPI rank
-                    if (cut_off_points_idx[cop] >= attr.rank_size * comm.rank() && cut_off_points_idx[cop] < attr.rank_size * (comm.rank() + 1)) {
-                        cut_off_points[cop] = hash_values[cut_off_points_idx[cop] % attr.rank_size];
-                    }
-                }
+                });
 
-                // combine to final cut-off points on all MPI ranks
-                MPI_Allreduce(MPI_IN_PLACE, cut_off_points.data(), cut_off_points.size(), mpi::type_cast<real_type>(), MPI_SUM, comm.get());
+                // calculate the cut-off points of the current hash table (identical on all MPI ranks)
+                const std::vector<real_type> cut_off_points = detail::calculate_cut_off_points(queue, hash_values_buffer, opt, attr, comm);
 
                 // copy current cut-off points to hash functions
                 const get_linear_id<mixed_hash_functions<layout, options_type, data_type>> get_linear_id_functor;
@@ -465,19 +627,32 @@ namespace sycl_lsh {
             }
         }
 
-        // broadcast hash function to other MPI ranks
-        MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        // broadcast hash function to other MPI ranks (the cut-off points are already identical if the hash functions were generated from the seed)
+        if (!seeded) {
+            const auto broadcast_start = mpi::communication_profiler::clock::now();
+            MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+            mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? host_buffer.size() * sizeof(real_type) : 0,
+                                                         comm.master_rank() ? 0 : host_buffer.size() * sizeof(real_type), broadcast_start);
+        }
 
 
         // copy data to device buffer
-        auto acc = device_buffer_.template get_access<sycl::access::mode::discard_write>();
-        for (index_type i = 0; i < acc.get_count(); ++i) {
-            acc[i] = host_buffer[i];
-        }
+        device_buffer_ = device_buffer_type(host_buffer.begin(), host_buffer.end());
 
         logger.log("Created 'mixed_hash_functions' hash functions in {}.\n", t.elapsed());
     }
 
+    template <memory_layout layout, typename Options, typename Data>
+    mixed_hash_functions<layout, Options, Data>::mixed_hash_functions(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer)
+            : device_buffer_(host_buffer.begin(), host_buffer.end())
+    {
+        const std::size_t expected_size = opt.num_hash_tables * opt.num_hash_functions * (data.get_attributes().dims + 1)
+                                         + opt.num_hash_tables * (opt.num_hash_functions + opt.num_cut_off_points - 1);
+        if (host_buffer.size() != expected_size) {
+            throw std::invalid_argument(fmt::format("Illegal number of hash function values ({})! Expected {}.", host_buffer.size(), expected_size));
+        }
+    }
+
 }
 
 #endif // DISTRIBUTED_K_NEAREST_NEIGHBORS_USING_LOCALITY_SENSITIVE_HASHING_AND_SYCL_MIXED_HASH_FUNCTIONS_HPP
@@ -11,24 +11,33 @@
 
 #include <sycl_lsh/detail/assert.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
 #include <sycl_lsh/detail/get_linear_id.hpp>
 #include <sycl_lsh/detail/hash_combine.hpp>
 #include <sycl_lsh/detail/lsh_hash.hpp>
+#include <sycl_lsh/detail/philox.hpp>
 #include <sycl_lsh/detail/sycl.hpp>
 #include <sycl_lsh/data.hpp>
+#include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
 #include <sycl_lsh/options.hpp>
 
+#include <fmt/format.h>
 #include <mpi.h>
 
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 namespace sycl_lsh {
 
+    // SYCL kernel name needed to silence ComputeCpp warning
+    class kernel_generate_random_projections;
+
     // forward declare random projections class
     template <memory_layout layout, typename Options, typename Data>
     class random_projections;
@@ -133,7 +142,30 @@ namespace sycl_lsh {
         hash_value_type operator()(const index_type hash_table, const index_type point,
                                    AccData& acc_data, AccHashFunctions& acc_hash_functions,
                                    const options_type& opt, const data_attributes_type& attr) const
-
+        {
+            return this->combined_hash_value(hash_table, point, acc_data, acc_hash_functions, opt, attr) % opt.hash_table_size;
+        }
+        /**
+         * @brief Calculates the combined hash value of the data point @p point in hash table @p hash_tables using random projections, i.e. the
+         *        hash value before it is reduced modulo the hash table size (used for the hash fingerprints).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the combined hash value (`[[nodiscard]]`)
+         *
+         * @pre @p hash_table must be in the range `[0, number of hash tables)` (currently disabled).
+         * @pre @p hash_function must be in the range `[0, number of hash functions)` (currently disabled).
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combined_hash_value(const index_type hash_table, const index_type point,
+                                            AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                            const options_type& opt, const data_attributes_type& attr) const
         {
 //            SYCL_LSH_DEBUG_ASSERT(0 <= hash_table && hash_table < opt.num_hash_tables, "Out-of-bounce access for hash tables!\n");
 //            SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr.rank_size, "Out-of-bounce access for data point!");
@@ -141,18 +173,129 @@ namespace sycl_lsh {
             // get indexing functions
             const get_linear_id<hash_function_type> get_linear_id_hash_function{};
             const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
 
             hash_value_type combined_hash = opt.num_hash_functions;
             for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
                 // calculate hash for current hash function
-                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, attr.dims, opt, attr)];
-                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims, opt, attr)];
+                for (index_type dim = 0; dim < dims; ++dim) {
                     hash += acc_data[get_linear_id_data(point, dim, attr)]
                             * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
                 }
                 // combine hashes
                 combined_hash = detail::hash_combine(combined_hash, static_cast<hash_value_type>(hash / opt.w));
             }
+            return combined_hash;
+        }
+
+        /**
+         * @brief Calculates the unquantized values \f$\frac{a \cdot x + b}{w}\f$ of all hash functions of hash table @p hash_table for the
+         *        data point @p point (used for multi-probe querying).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @param[out] projections the `opt.num_hash_functions` unquantized hash function values
+         */
+        template <typename AccData, typename AccHashFunctions>
+        void projections(const index_type hash_table, const index_type point,
+                         AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                         const options_type& opt, const data_attributes_type& attr, real_type* projections) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
+
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                real_type hash = acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dims, opt, attr)];
+                for (index_type dim = 0; dim < dims; ++dim) {
+                    hash += acc_data[get_linear_id_data(point, dim, attr)]
+                            * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
+                }
+                projections[hash_function] = hash / opt.w;
+            }
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the unquantized hash function values @p projections, where the
+         *        quantized value of the hash function @p perturbed_hash_function is shifted by @p delta (used for multi-probe querying).
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] projections the unquantized hash function values calculated by @ref projections()
+         * @param[in] perturbed_hash_function the hash function whose quantized value is shifted
+         * @param[in] delta the shift (`0` results in the same hash value as @ref operator()())
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine(const index_type hash_table [[maybe_unused]], const real_type* projections,
+                                const index_type perturbed_hash_function, const int delta, AccHashFunctions& acc_hash_functions [[maybe_unused]],
+                                const options_type& opt, const data_attributes_type& attr [[maybe_unused]]) const
+        {
+            hash_value_type combined_hash = opt.num_hash_functions;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                hash_value_type value = static_cast<hash_value_type>(projections[hash_function]);
+                if (hash_function == perturbed_hash_function) {
+                    value += static_cast<hash_value_type>(delta);
+                }
+                combined_hash = detail::hash_combine(combined_hash, value);
+            }
+            return combined_hash % opt.hash_table_size;
+        }
+        /**
+         * @brief Returns the coefficient of dimension @p dim of the hash function @p hash_function of hash table @p hash_table, i.e. one
+         *        entry of the `dims x (num_hash_tables * num_hash_functions)` matrix multiplied with the data points during the batched hashing.
+         * @details The offset \f$b\f$ is returned for `dim == dims`.
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] hash_function the provided hash function
+         * @param[in] dim the dimension (`dims` for the offset)
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the coefficient (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        real_type coefficient(const index_type hash_table, const index_type hash_function, const index_type dim,
+                              AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            return acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the precalculated dot products @p acc_dot_products of a data
+         *        point with all hash functions (see @ref coefficient()).
+         * @details Results in the same hash value as @ref operator()() if the dot products are accumulated in the same order.
+         * @tparam AccDotProducts the type of the dot products `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] acc_dot_products the dot products `sycl::accessor`
+         * @param[in] first the position of the dot product of the first hash function of hash table @p hash_table in @p acc_dot_products
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccDotProducts, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine_dot_products(const index_type hash_table [[maybe_unused]], AccDotProducts& acc_dot_products, const index_type first,
+                                             AccHashFunctions& acc_hash_functions [[maybe_unused]], const options_type& opt, const data_attributes_type& attr [[maybe_unused]]) const
+        {
+            hash_value_type combined_hash = opt.num_hash_functions;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                combined_hash = detail::hash_combine(combined_hash, static_cast<hash_value_type>(acc_dot_products[first + hash_function] / opt.w));
+            }
             return combined_hash % opt.hash_table_size;
         }
 
@@ -205,6 +348,15 @@ namespace sycl_lsh {
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
          */
         random_projections(const options_type& opt, const data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Construct a new @ref sycl_lsh::random_projections object from previously created hash functions (e.g. loaded from a file).
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data
+         * @param[in] host_buffer the values of the hash functions
+         *
+         * @throws std::invalid_argument if the number of values in @p host_buffer doesn't match the used @ref sycl_lsh::options and @p data.
+         */
+        random_projections(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer);
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -241,6 +393,38 @@ namespace sycl_lsh {
 
         const data_attributes_type& attr = data.get_attributes();
 
+        if (opt.seed != 0) {
+            // generate the hash functions directly on the device (identical on all MPI ranks, i.e. no broadcast necessary)
+            sycl::queue queue(device_selector{comm}, sycl::async_handler(&sycl_exception_handler));
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_hash_functions = device_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+
+                const options_type options = opt;
+                const data_attributes_type attributes = attr;
+                const get_linear_id<random_projections<layout, options_type, data_type>> get_linear_id_functor{};
+                const detail::philox rng(opt.seed);
+
+                cgh.parallel_for<kernel_generate_random_projections>(sycl::range<>(opt.num_hash_tables * opt.num_hash_functions), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type hash_table = idx / options.num_hash_functions;
+                    const index_type hash_function = idx % options.num_hash_functions;
+
+                    // select the hash function from the hash pool, the values of a hash pool function only depend on its index
+                    const index_type pool_hash_function = rng.index<index_type>(idx, detail::philox_stream::selection, options.hash_pool_size);
+                    for (index_type dim = 0; dim < attributes.dims; ++dim) {
+                        acc_hash_functions[get_linear_id_functor(hash_table, hash_function, dim, options, attributes)]
+                                = sycl::fabs(rng.normal<real_type>(pool_hash_function * attributes.dims + dim, detail::philox_stream::hash_pool));
+                    }
+                    acc_hash_functions[get_linear_id_functor(hash_table, hash_function, attributes.dims, options, attributes)]
+                            = rng.uniform<real_type>(pool_hash_function, detail::philox_stream::hash_pool_offset) * options.w;
+                });
+            });
+            queue.wait_and_throw();
+
+            logger.log("Created 'random_projections' hash functions using the seed {} in {}.\n", opt.seed, t.elapsed());
+            return;
+        }
+
         std::vector<real_type> host_buffer(device_buffer_.get_count());
 
         // create hash pool only on MPI master rank
@@ -293,17 +477,27 @@ namespace sycl_lsh {
         }
 
         // broadcast hash functions to other MPI ranks
+        const auto broadcast_start = mpi::communication_profiler::clock::now();
         MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? host_buffer.size() * sizeof(real_type) : 0,
+                                                     comm.master_rank() ? 0 : host_buffer.size() * sizeof(real_type), broadcast_start);
 
         // copy data to device buffer
-        auto acc = device_buffer_.template get_access<sycl::access::mode::discard_write>();
-        for (index_type i = 0; i < acc.get_count(); ++i) {
-            acc[i] = host_buffer[i];
-        }
+        device_buffer_ = device_buffer_type(host_buffer.begin(), host_buffer.end());
 
         logger.log("Created 'random_projections' hash functions in {}.\n", t.elapsed());
     }
 
+    template <memory_layout layout, typename Options, typename Data>
+    random_projections<layout, Options, Data>::random_projections(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer)
+            : device_buffer_(host_buffer.begin(), host_buffer.end())
+    {
+        const std::size_t expected_size = opt.num_hash_tables * opt.num_hash_functions * (data.get_attributes().dims + 1);
+        if (host_buffer.size() != expected_size) {
+            throw std::invalid_argument(fmt::format("Illegal number of hash function values ({})! Expected {}.", host_buffer.size(), expected_size));
+        }
+    }
+
 }
 
 #endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_RANDOM_PROJECTIONS_HPP
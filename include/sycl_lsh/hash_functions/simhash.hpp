@@ -0,0 +1,476 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-21
+ *
+ * @brief Implements the sign random projections (SimHash) hash functions as the used LSH hash functions.
+ * @details Each hash function is a random hyperplane through the origin, i.e. the hash functions are sensitive to the angle between two
+ *          data points (cosine similarity). The signs of all hash functions of a hash table are packed into the bits of a signature.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SIMHASH_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SIMHASH_HPP
+
+#include <sycl_lsh/detail/assert.hpp>
+#include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/distance.hpp>
+#include <sycl_lsh/detail/get_linear_id.hpp>
+#include <sycl_lsh/detail/lsh_hash.hpp>
+#include <sycl_lsh/detail/philox.hpp>
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/data.hpp>
+#include <sycl_lsh/device_selector.hpp>
+#include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/timer.hpp>
+#include <sycl_lsh/options.hpp>
+
+#include <fmt/format.h>
+#include <mpi.h>
+
+#include <climits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace sycl_lsh {
+
+    // SYCL kernel name needed to silence ComputeCpp warning
+    class kernel_generate_simhash;
+
+    // forward declare simhash class
+    template <memory_layout layout, typename Options, typename Data>
+    class simhash;
+
+
+    /**
+     * @brief Specialization of the @ref sycl_lsh::get_linear_id class for the @ref sycl_lsh::simhash class to convert a
+     *        multi-dimensional index to an one-dimensional one.
+     * @tparam layout the @ref sycl_lsh::memory_layout type
+     * @tparam Options the @ref sycl_lsh::options type
+     * @tparam Data the @ref sycl_lsh::data type
+     */
+    template <memory_layout layout, typename Options, typename Data>
+    struct get_linear_id<simhash<layout, Options, Data>> {
+
+        /// The used @ref sycl_lsh::options type.
+        using options_type = Options;
+        /// The used integral type (used for indices).
+        using index_type = typename options_type::index_type;
+
+        /// The used @ref sycl_lsh::data type.
+        using data_type = Data;
+        /// The used @ref sycl_lsh::data_attributes type.
+        using data_attributes_type = typename data_type::data_attributes_type;
+
+        /**
+         * @brief Convert the multi-dimensional index to an one-dimensional index.
+         * @param[in] hash_table the requested hash table
+         * @param[in] hash_function the requested hash function
+         * @param[in] dim the requested dimension of @p hash_function
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the attributes of the used data set
+         * @return the one-dimensional index (`[[nodiscard]]`)
+         *
+         * @pre @p hash_table must be in the range `[0, number of hash tables)` (currently disabled).
+         * @pre @p hash_function must be in the range `[0, number of hash functions)` (currently disabled).
+         * @pre @p dim must be in the range `[0, number of dimensions per data point)` (currently disabled).
+         */
+        [[nodiscard]]
+        index_type operator()(const index_type hash_table, const index_type hash_function, const index_type dim,
+                              const options_type& opt, const data_attributes_type& attr) const noexcept
+        {
+//            SYCL_LSH_DEBUG_ASSERT(0 <= hash_table && hash_table < opt.num_hash_tables, "Out-of-bounce access for hash table!\n");
+//            SYCL_LSH_DEBUG_ASSERT(0 <= hash_function && hash_function < opt.hash_pool_size, "Out-of-bounce access for hash function!\n");
+//            SYCL_LSH_DEBUG_ASSERT(0 <= dim && dim < attr.dims, "Out-of-bounce access for dimension!\n");
+
+            if constexpr (layout == memory_layout::aos) {
+                // Array of Structs
+                return hash_table * opt.num_hash_functions * attr.dims + hash_function * attr.dims + dim;
+            } else {
+                // Struct of Arrays
+                return hash_table * opt.num_hash_functions * attr.dims + dim * opt.num_hash_functions + hash_function;
+            }
+        }
+
+    };
+
+    /**
+     * @brief Specialization of the @ref sycl_lsh::lsh_hash class for the @ref sycl_lsh::simhash class to calculate the hash value.
+     * @tparam layout the @ref sycl_lsh::memory_layout type
+     * @tparam Options the @ref sycl_lsh::options type
+     * @tparam Data the @ref sycl_lsh::data type
+     */
+    template <memory_layout layout, typename Options, typename Data>
+    struct lsh_hash<simhash<layout, Options, Data>> {
+
+        /// The used @ref sycl_lsh::options type.
+        using options_type = Options;
+        /// The used floating point type (used for the data points and hash functions).
+        using real_type = typename options_type::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename options_type::index_type;
+        /// The used unsigned type (used for the calculated hash value).
+        using hash_value_type = typename options_type::hash_value_type;
+
+        /// The used @ref sycl_lsh::data type.
+        using data_type = Data;
+        /// The used @ref sycl_lsh::data_attributes type.
+        using data_attributes_type = typename data_type::data_attributes_type;
+
+        /// The used hash functions type (simhash for this specialization).
+        using hash_function_type = simhash<layout, Options, Data>;
+
+        /**
+         * @brief Calculates the hash value of the data point @p point in hash table @p hash_tables using sign random projections.
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value, i.e. the signature modulo the hash table size (`[[nodiscard]]`)
+         *
+         * @pre @p hash_table must be in the range `[0, number of hash tables)` (currently disabled).
+         * @pre @p hash_function must be in the range `[0, number of hash functions)` (currently disabled).
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type operator()(const index_type hash_table, const index_type point,
+                                   AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                   const options_type& opt, const data_attributes_type& attr) const
+        {
+            return this->signature(hash_table, point, acc_data, acc_hash_functions, opt, attr) % opt.hash_table_size;
+        }
+        /**
+         * @brief Calculates the combined hash value of the data point @p point in hash table @p hash_tables, i.e. the signature before it is
+         *        reduced modulo the hash table size (used for the hash fingerprints).
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the combined hash value (`[[nodiscard]]`)
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combined_hash_value(const index_type hash_table, const index_type point,
+                                            AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                            const options_type& opt, const data_attributes_type& attr) const
+        {
+            return this->signature(hash_table, point, acc_data, acc_hash_functions, opt, attr);
+        }
+
+        /**
+         * @brief Calculates the signature of the data point @p point in hash table @p hash_table, i.e. bit `i` is set if the data point
+         *        lies on the positive side of the hyperplane of hash function `i`.
+         * @tparam AccData the type of the data set `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] point the provided data point
+         * @param[in] acc_data the data set `sycl::accessor`
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the signature (`[[nodiscard]]`)
+         */
+        template <typename AccData, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type signature(const index_type hash_table, const index_type point,
+                                  AccData& acc_data, AccHashFunctions& acc_hash_functions,
+                                  const options_type& opt, const data_attributes_type& attr) const
+        {
+            // get indexing functions
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            const get_linear_id<data_type> get_linear_id_data{};
+            // the number of dimensions (compile time constant if known -> fully unrolled loops)
+            const index_type dims = detail::get_dims<options_type>(attr);
+
+            hash_value_type signature = 0;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                real_type hash = 0.0;
+                for (index_type dim = 0; dim < dims; ++dim) {
+                    hash += acc_data[get_linear_id_data(point, dim, attr)]
+                            * acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
+                }
+                // set the bit of the current hash function
+                signature |= static_cast<hash_value_type>(hash >= 0 ? 1 : 0) << hash_function;
+            }
+            return signature;
+        }
+        /**
+         * @brief Returns the coefficient of dimension @p dim of the hash function @p hash_function of hash table @p hash_table, i.e. one
+         *        entry of the `dims x (num_hash_tables * num_hash_functions)` matrix multiplied with the data points during the batched hashing.
+         * @details The hyperplanes pass through the origin, i.e. `0` is returned for `dim == dims`.
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] hash_function the provided hash function
+         * @param[in] dim the dimension (`dims` for the offset)
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the coefficient (`[[nodiscard]]`)
+         */
+        template <typename AccHashFunctions>
+        [[nodiscard]]
+        real_type coefficient(const index_type hash_table, const index_type hash_function, const index_type dim,
+                              AccHashFunctions& acc_hash_functions, const options_type& opt, const data_attributes_type& attr) const
+        {
+            if (dim == attr.dims) {
+                return 0.0;
+            }
+            const get_linear_id<hash_function_type> get_linear_id_hash_function{};
+            return acc_hash_functions[get_linear_id_hash_function(hash_table, hash_function, dim, opt, attr)];
+        }
+        /**
+         * @brief Calculates the hash value of hash table @p hash_table from the precalculated dot products @p acc_dot_products of a data
+         *        point with all hash functions (see @ref coefficient()).
+         * @details Results in the same hash value as @ref operator()() if the dot products are accumulated in the same order.
+         * @tparam AccDotProducts the type of the dot products `sycl::accessor`
+         * @tparam AccHashFunctions the type of the hash functions `sycl::accessor`
+         * @param[in] hash_table the provided hash table
+         * @param[in] acc_dot_products the dot products `sycl::accessor`
+         * @param[in] first the position of the dot product of the first hash function of hash table @p hash_table in @p acc_dot_products
+         * @param[in] acc_hash_functions the hash functions `sycl::accessor`
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] attr the used @ref sycl_lsh::data_attributes
+         * @return the calculated hash value (`[[nodiscard]]`)
+         */
+        template <typename AccDotProducts, typename AccHashFunctions>
+        [[nodiscard]]
+        hash_value_type combine_dot_products(const index_type hash_table [[maybe_unused]], AccDotProducts& acc_dot_products, const index_type first,
+                                             AccHashFunctions& acc_hash_functions [[maybe_unused]], const options_type& opt, const data_attributes_type& attr [[maybe_unused]]) const
+        {
+            hash_value_type signature = 0;
+            for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                signature |= static_cast<hash_value_type>(acc_dot_products[first + hash_function] >= 0 ? 1 : 0) << hash_function;
+            }
+            return signature % opt.hash_table_size;
+        }
+
+    };
+
+
+    /**
+     * @brief Class which represents the sign random projections (SimHash) hash functions used in the LSH algorithm.
+     * @tparam layout the @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam Data the used @ref sycl_lsh::data type
+     */
+    template <memory_layout layout, typename Options, typename Data>
+    class simhash final : private detail::hash_functions_base {
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                      template parameter sanity checks                                      //
+        // ---------------------------------------------------------------------------------------------------------- //
+        static_assert(std::is_base_of_v<detail::options_base, Options>, "The second template parameter must be a sycl_lsh::options type!");
+        static_assert(std::is_base_of_v<detail::data_base, Data>, "The third template parameter must be a sycl_lsh::data type!");
+    public:
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                type aliases                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /// The type of the @ref sycl_lsh::options object.
+        using options_type = Options;
+        /// The used floating point type for the hash functions.
+        using real_type = typename options_type::real_type;
+        /// The used integral type for indices.
+        using index_type = typename options_type::index_type;
+        /// The used unsigned type for the hash values.
+        using hash_value_type = typename options_type::hash_value_type;
+
+        /// The type of the @ref sycl_lsh::data object.
+        using data_type = Data;
+        /// The type of the @ref sycl_lsh::data_attributes object.
+        using data_attributes_type = typename data_type::data_attributes_type;
+
+        /// The type of the device buffer used by SYCL.
+        using device_buffer_type = sycl::buffer<real_type, 1>;
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                constructor                                                 //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Construct a new @ref sycl_lsh::simhash object representing the hash functions used in the LSH algorithm.
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if the signature of a hash table doesn't fit into the `hash_value_type`.
+         */
+        simhash(const options_type& opt, const data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Construct a new @ref sycl_lsh::simhash object from previously created hash functions (e.g. loaded from a file).
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data
+         * @param[in] host_buffer the values of the hash functions
+         *
+         * @throws std::invalid_argument if the signature of a hash table doesn't fit into the `hash_value_type`.
+         * @throws std::invalid_argument if the number of values in @p host_buffer doesn't match the used @ref sycl_lsh::options and @p data.
+         */
+        simhash(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer);
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                   getter                                                   //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Returns the specified @ref sycl_lsh::memory_layout type.
+         * @return the @ref sycl_lsh::memory_layout type (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        constexpr memory_layout get_memory_layout() const noexcept { return layout; }
+
+        /**
+         * @brief Returns the device buffer used in the SYCL kernels.
+         * @return the device buffer (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        device_buffer_type& get_device_buffer() noexcept { return device_buffer_; }
+
+    private:
+        /**
+         * @brief Checks whether the signature of a hash table fits into the `hash_value_type`.
+         * @param[in] opt the used @ref sycl_lsh::options
+         *
+         * @throws std::invalid_argument if `num_hash_functions` is greater than the number of bits of the `hash_value_type`.
+         */
+        static void check_signature_size(const options_type& opt);
+
+        device_buffer_type device_buffer_;
+    };
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                constructor                                                 //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options, typename Data>
+    simhash<layout, Options, Data>::simhash(const options_type& opt, const data_type& data, const mpi::communicator& comm, const mpi::logger& logger)
+            : device_buffer_(opt.num_hash_tables * opt.num_hash_functions * data.get_attributes().dims)
+    {
+        check_signature_size(opt);
+
+        mpi::timer t(comm);
+
+        const data_attributes_type& attr = data.get_attributes();
+
+        if (opt.seed != 0) {
+            // generate the hash functions directly on the device (identical on all MPI ranks, i.e. no broadcast necessary)
+            sycl::queue queue(device_selector{comm}, sycl::async_handler(&sycl_exception_handler));
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_hash_functions = device_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
+
+                const options_type options = opt;
+                const data_attributes_type attributes = attr;
+                const get_linear_id<simhash<layout, options_type, data_type>> get_linear_id_functor{};
+                const detail::philox rng(opt.seed);
+
+                cgh.parallel_for<kernel_generate_simhash>(sycl::range<>(opt.num_hash_tables * opt.num_hash_functions), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type hash_table = idx / options.num_hash_functions;
+                    const index_type hash_function = idx % options.num_hash_functions;
+
+                    // select the hash function from the hash pool, the values of a hash pool function only depend on its index
+                    const index_type pool_hash_function = rng.index<index_type>(idx, detail::philox_stream::selection, options.hash_pool_size);
+                    for (index_type dim = 0; dim < attributes.dims; ++dim) {
+                        acc_hash_functions[get_linear_id_functor(hash_table, hash_function, dim, options, attributes)]
+                                = rng.normal<real_type>(pool_hash_function * attributes.dims + dim, detail::philox_stream::hash_pool);
+                    }
+                });
+            });
+            queue.wait_and_throw();
+
+            logger.log("Created 'simhash' hash functions using the seed {} in {}.\n", opt.seed, t.elapsed());
+            return;
+        }
+
+        std::vector<real_type> host_buffer(device_buffer_.get_count());
+
+        // create hash pool only on MPI master rank
+        if (comm.master_rank()) {
+            // create random generators
+            #if SYCL_LSH_DEBUG
+                // don't seed random engine in debug mode
+                std::mt19937 rnd_normal_pool_gen;
+            #else
+                // seed random engine outside debug mode
+                std::random_device rnd_pool_device;
+                std::mt19937 rnd_normal_pool_gen(rnd_pool_device());
+            #endif
+            std::normal_distribution<real_type> rnd_normal_pool_dist;
+
+            // fill hash pool (the normal vectors of the hyperplanes)
+            std::vector<real_type> hash_pool(opt.hash_pool_size * attr.dims);
+            for (index_type hash_function = 0; hash_function < opt.hash_pool_size; ++hash_function) {
+                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                    hash_pool[hash_function * attr.dims + dim] = rnd_normal_pool_dist(rnd_normal_pool_gen);
+                }
+            }
+
+            // select actual hash functions
+            #if SYCL_LSH_DEBUG
+                // don't seed random engine in debug mode
+                std::mt19937 rnd_uniform_gen;
+            #else
+                // seed random engine outside debug mode
+                std::random_device rnd_device;
+                std::mt19937 rnd_uniform_gen(rnd_device());
+            #endif
+            std::uniform_int_distribution<index_type> rnd_uniform_dist(0, opt.hash_pool_size - 1);
+
+            const get_linear_id<simhash<layout, options_type, data_type>> get_linear_id_functor;
+
+            for (index_type hash_table = 0; hash_table < opt.num_hash_tables; ++hash_table) {
+                for (index_type hash_function = 0; hash_function < opt.num_hash_functions; ++hash_function) {
+                    const index_type pool_hash_function = rnd_uniform_dist(rnd_uniform_gen);
+                    for (index_type dim = 0; dim < attr.dims; ++dim) {
+                        host_buffer[get_linear_id_functor(hash_table, hash_function, dim, opt, attr)]
+                                = hash_pool[pool_hash_function * attr.dims + dim];
+                    }
+                }
+            }
+        }
+
+        // broadcast hash functions to other MPI ranks
+        const auto broadcast_start = mpi::communication_profiler::clock::now();
+        MPI_Bcast(host_buffer.data(), host_buffer.size(), mpi::type_cast<real_type>(), 0, comm.get());
+        mpi::communication_profiler::record_blocking(mpi::communication_kind::broadcast, comm.master_rank() ? host_buffer.size() * sizeof(real_type) : 0,
+                                                     comm.master_rank() ? 0 : host_buffer.size() * sizeof(real_type), broadcast_start);
+
+        // copy data to device buffer
+        device_buffer_ = device_buffer_type(host_buffer.begin(), host_buffer.end());
+
+        logger.log("Created 'simhash' hash functions in {}.\n", t.elapsed());
+    }
+
+    template <memory_layout layout, typename Options, typename Data>
+    simhash<layout, Options, Data>::simhash(const options_type& opt, const data_type& data, const std::vector<real_type>& host_buffer)
+            : device_buffer_(host_buffer.begin(), host_buffer.end())
+    {
+        check_signature_size(opt);
+
+        const std::size_t expected_size = opt.num_hash_tables * opt.num_hash_functions * data.get_attributes().dims;
+        if (host_buffer.size() != expected_size) {
+            throw std::invalid_argument(fmt::format("Illegal number of hash function values ({})! Expected {}.", host_buffer.size(), expected_size));
+        }
+    }
+
+    template <memory_layout layout, typename Options, typename Data>
+    void simhash<layout, Options, Data>::check_signature_size(const options_type& opt) {
+        constexpr std::size_t num_bits = sizeof(hash_value_type) * CHAR_BIT;
+        if (static_cast<std::size_t>(opt.num_hash_functions) > num_bits) {
+            throw std::invalid_argument(fmt::format("The 'simhash' hash functions support at most {} hash functions per hash table (the number of bits of the hash_value_type), but {} are used!",
+                                                    num_bits, opt.num_hash_functions));
+        }
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SIMHASH_HPP
@@ -12,33 +12,86 @@
 #include <sycl_lsh/argv_parser.hpp>
 #include <sycl_lsh/data.hpp>
 #include <sycl_lsh/data_attributes.hpp>
+#include <sycl_lsh/detail/compact_offsets.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/device_memory.hpp>
+#include <sycl_lsh/detail/device_profiler.hpp>
+#include <sycl_lsh/detail/device_ring_buffer.hpp>
+#include <sycl_lsh/detail/distance.hpp>
+#include <sycl_lsh/detail/fingerprint_filter.hpp>
+#include <sycl_lsh/detail/gemm.hpp>
+#include <sycl_lsh/detail/hamming_filter.hpp>
+#include <sycl_lsh/detail/knn_kernel_tuning.hpp>
+#include <sycl_lsh/detail/multi_probe.hpp>
+#include <sycl_lsh/detail/scan.hpp>
+#include <sycl_lsh/detail/seen_filter.hpp>
+#include <sycl_lsh/detail/shared_ring_buffer.hpp>
+#include <sycl_lsh/detail/storage.hpp>
 #include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/detail/top_k.hpp>
 #include <sycl_lsh/detail/utility.hpp>
 #include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/hash_functions/hash_functions.hpp>
 #include <sycl_lsh/knn.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/file.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
 #include <sycl_lsh/memory_layout.hpp>
 #include <sycl_lsh/options.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
+#include <sycl_lsh/mpi/top_k.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
 
 #include <fmt/format.h>
+#include <mpi.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
-#include <thread>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace sycl_lsh {
 
     // SYCL kernel name needed to silence ComputeCpp warnings
+    class kernel_calculate_hash_values;
+    class kernel_calculate_dot_products;
+    class kernel_combine_dot_products;
     class kernel_count_hash_values;
+    class kernel_cap_bucket_sizes;
     class kernel_calculate_offsets;
+    class kernel_reduce_bucket_statistics;
+    class kernel_bucket_size_histogram;
     class kernel_fill_hash_tables;
+    class kernel_flag_non_empty_buckets;
+    class kernel_count_non_empty_buckets;
+    class kernel_compact_offsets;
+    class kernel_calculate_signatures;
+    class kernel_calculate_fingerprints;
+    template <std::size_t blocking_size, std::size_t static_k>
     class kernel_calculate_knn;
+    class kernel_count_queries;
+    class kernel_sort_queries;
+    class kernel_calculate_knn_bucket_cooperative;
+    class kernel_calculate_knn_delta;
     class kernel_zero_out_buffer;
+    class kernel_gather_host_queries;
+    class kernel_scatter_host_queries;
 
     // forward declare hash_tables class
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
@@ -62,6 +115,38 @@ namespace sycl_lsh {
         using type_of_hash_functions = detail::get_hash_functions_type_t<layout, Options, Data, Options::used_hash_functions_type>;
         return hash_tables<layout, Options, Data, type_of_hash_functions>(opt, data, comm, logger);
     }
+    /**
+     * @brief Factory function for the @ref sycl_lsh::hash_tables class.
+     * @brief Used to be able to automatically deduce the @ref sycl_lsh::options and @ref sycl_lsh::data types.
+     * @details If the command line argument `hash_tables_load_file` is present in @p parser, the hash functions and hash tables are
+     *          loaded from the given file instead of being created. \n
+     *          If the command line argument `device_memory_budget` is present in @p parser, the planned device memory footprint is checked
+     *          against the budget and, if necessary, the out-of-core mode is enabled or the number of hash tables is reduced.
+     * @tparam layout the used @ref sycl_lsh::memory_layout type
+     * @tparam Options the used @ref sycl_lsh::options type
+     * @tparam Data the used @ref sycl_lsh::data type
+     * @param[in] parser the used @ref sycl_lsh::argv_parser
+     * @param[in] opt the used @ref sycl_lsh::options
+     * @param[in] data the used @ref sycl_lsh::data representing the used data set
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @param[in] logger the used @ref sycl_lsh::mpi::logger
+     * @return the @ref sycl_lsh::hash_tables object representing the hash tables used in the LSH algorithm (`[[nodiscard]]`)
+     */
+    template <memory_layout layout, typename Options, typename Data>
+    [[nodiscard]]
+    auto make_hash_tables(const argv_parser& parser, const Options& opt, Data& data, const mpi::communicator& comm, const mpi::logger& logger) {
+        using type_of_hash_functions = detail::get_hash_functions_type_t<layout, Options, Data, Options::used_hash_functions_type>;
+        using hash_tables_type = hash_tables<layout, Options, Data, type_of_hash_functions>;
+        if (parser.has_argv("hash_tables_load_file")) {
+            return hash_tables_type(opt, data, parser.argv_as<std::string>("hash_tables_load_file"), comm, logger);
+        }
+        if (parser.has_argv("device_memory_budget")) {
+            // fit the planned device memory footprint into the budget using the out-of-core mode or less hash tables
+            const auto [fitted_opt, query_chunk_size] = hash_tables_type::fit_device_memory_budget(parser, opt, data, comm, logger);
+            return hash_tables_type(fitted_opt, data, comm, logger, query_chunk_size);
+        }
+        return hash_tables_type(opt, data, comm, logger);
+    }
 
 
     /**
@@ -91,6 +176,8 @@ namespace sycl_lsh {
         using index_type = typename options_type::index_type;
         /// The used unsigned type (used for the hash values).
         using hash_value_type = typename options_type::hash_value_type;
+        /// The used integral type for the global IDs of the data points (the hash tables store the indices relative to their device).
+        using id_type = typename options_type::id_type;
 
         /// The type of the @ref sycl_lsh::data object.
         using data_type = Data;
@@ -103,7 +190,7 @@ namespace sycl_lsh {
 
         /// The type of the @ref sycl_lsh::knn object as the result of the k-nearest-neighbor search.
         using knn_type = knn<layout, options_type, data_type>;
-        using knn_device_buffer_type = sycl::buffer<index_type, 1>;
+        using knn_device_buffer_type = sycl::buffer<id_type, 1>;
         using knn_dist_device_buffer_type = sycl::buffer<real_type, 1>;
 
         /// The type of the used LSH hash functions.
@@ -111,6 +198,12 @@ namespace sycl_lsh {
 
         /// The type of the device buffer used by SYCL.
         using device_buffer_type = sycl::buffer<index_type, 1>;
+        /// The type of the device buffer used to store global IDs.
+        using id_device_buffer_type = sycl::buffer<id_type, 1>;
+        /// The type of the device buffer used to store the calculated hash values.
+        using hash_value_device_buffer_type = sycl::buffer<hash_value_type, 1>;
+        /// The type of the device buffer used to store the fingerprints of the combined hash values.
+        using fingerprint_device_buffer_type = sycl::buffer<detail::fingerprint_type, 1>;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -118,10 +211,15 @@ namespace sycl_lsh {
         // ---------------------------------------------------------------------------------------------------------- //
         /**
          * @brief Calculate the k-nearest-neighbors using **Locality Sensitive Hashing**, **SYCL** and **MPI**.
+         * @details If the command line argument `query_file` is present, the k-nearest-neighbors of the separate query set are calculated
+         *          instead of the all-k-nearest-neighbors of the data set. \n
+         *          If the command line argument `evaluate_recall_at` is present, the additional k' are answered by the same search (see
+         *          @ref get_k_nearest_neighbors(data_type&, const std::vector<index_type>&)).
          * @param[in] parser the used @ref sycl_lsh::argv_parser to get the number of nearest-neighbors to search for from
          * @return the found k-nearest-neighbors (`[[nodiscard]]`)
          *
          * @throws std::invalid_argument if the number of nearest-neighbors @p k is less or equal than `0` or greater and equal than `rank_size`.
+         * @throws std::invalid_argument if any value of the command line argument `evaluate_recall_at` isn't in the range `[1, k]`.
          */
         [[nodiscard]] 
         knn_type get_k_nearest_neighbors(const argv_parser& parser);
@@ -134,13 +232,204 @@ namespace sycl_lsh {
          */
         [[nodiscard]]
         knn_type get_k_nearest_neighbors(const index_type k);
+        /**
+         * @brief Calculate the k-nearest-neighbors of the separate query set @p queries in the already created hash tables using
+         *        **Locality Sensitive Hashing**, **SYCL** and **MPI**.
+         * @details Only the queries and their (partially) calculated nearest-neighbors are sent around the ring of all MPI ranks, i.e. the
+         *          hash tables can be reused for any number of query sets. If less than @p k nearest-neighbors could be found for a query,
+         *          the remaining IDs are `std::numeric_limits<id_type>::max()`.
+         * @param[in] queries the queries created using @ref sycl_lsh::make_query_data() (if @p queries is the indexed data set, the
+         *                    all-k-nearest-neighbors are calculated)
+         * @param[in] k the number of nearest-neighbors to search for
+         * @return the found k-nearest-neighbors of @p queries (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if the number of nearest-neighbors @p k is less or equal than `0` or greater and equal than `rank_size`.
+         * @throws std::invalid_argument if a separate query set is used together with the `ROUTING` distribution scheme.
+         * @throws std::invalid_argument if multi-probe querying (`num_probes > 0`) is used together with the entropy-based or simhash hash
+         *         functions, the `BUCKET` kNN kernel or more than @ref sycl_lsh::detail::max_probe_hash_functions hash functions per hash table.
+         * @throws std::invalid_argument if the Hamming distance prefilter (`max_hamming_distance > 0`) is used together with other than the
+         *         simhash hash functions, the `BUCKET` kNN kernel or more than @ref sycl_lsh::detail::max_hamming_filter_hash_tables hash tables.
+         * @throws std::invalid_argument if the adaptive early termination (`early_termination_tables > 0` or `early_termination_distance > 0`)
+         *         is used together with the `BUCKET` kNN kernel.
+         */
+        [[nodiscard]]
+        knn_type get_k_nearest_neighbors(data_type& queries, const index_type k);
+        /**
+         * @brief Calculate the k-nearest-neighbors for several k values @p ks with a single k-nearest-neighbor search.
+         * @details Performs only one search (i.e. one traversal of the ring of all MPI ranks including the hashing) for the largest k value.
+         *          The results of the smaller k values are the prefixes of the k-nearest-neighbors sorted by distance (see
+         *          @ref sycl_lsh::knn::get_knn_ids(const index_type, const index_type) const). The recall of all k values is calculated
+         *          in the same pass by @ref sycl_lsh::knn::recall().
+         * @param[in] queries the queries created using @ref sycl_lsh::make_query_data() (if @p queries is the indexed data set, the
+         *                    all-k-nearest-neighbors are calculated)
+         * @param[in] ks the numbers of nearest-neighbors to search for
+         * @return the found k-nearest-neighbors of @p queries for the largest k value (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if @p ks is empty.
+         * @throws std::invalid_argument if any value of @p ks is less or equal than `0` or greater and equal than `rank_size`.
+         * @throws std::invalid_argument under the same conditions as @ref get_k_nearest_neighbors(data_type&, const index_type).
+         */
+        [[nodiscard]]
+        knn_type get_k_nearest_neighbors(data_type& queries, const std::vector<index_type>& ks);
+        /**
+         * @brief Calculate the all-k-nearest-neighbors for several k values @p ks with a single k-nearest-neighbor search.
+         * @details Same as @ref get_k_nearest_neighbors(data_type&, const std::vector<index_type>&) for the indexed data set.
+         * @param[in] ks the numbers of nearest-neighbors to search for
+         * @return the found k-nearest-neighbors for the largest k value (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if @p ks is empty.
+         * @throws std::invalid_argument if any value of @p ks is less or equal than `0` or greater and equal than `rank_size`.
+         */
+        [[nodiscard]]
+        knn_type get_k_nearest_neighbors(const std::vector<index_type>& ks);
+        /**
+         * @brief Tunes the work-group size and the blocking size of the per query k-nearest-neighbor kernel on all devices.
+         * @details Times short kernel runs on (at most @ref sycl_lsh::detail::knn_tuning_num_queries) own data points for all candidate
+         *          work-group sizes and pre-instantiated blocking sizes. The best configuration per device name, @p k and number of dimensions
+         *          is cached in the file @p tuning_file, i.e. each configuration is only tuned once. The tuned configurations are used by
+         *          all subsequent k-nearest-neighbor searches with the same @p k.
+         * @param[in] k the number of nearest-neighbors to search for
+         * @param[in] tuning_file the file caching the tuned configurations (created if it doesn't exist)
+         *
+         * @throws std::invalid_argument if the number of nearest-neighbors @p k is less or equal than `0` or greater and equal than `rank_size`.
+         * @throws std::invalid_argument if the `BUCKET` kNN kernel is used.
+         * @throws std::invalid_argument if @p tuning_file contains an illegal line or configuration.
+         */
+        void tune_knn_kernel(const index_type k, const std::string& tuning_file);
         /**
          * @brief Performs the k-nearest-neighbor search given the data set @p data_buffer and already calculate nearest-neighbors @p knns.
          * @param[in] k the number of nearest neighbors to search for
          * @param[in] data_buffer the data to perfrom the nearest-neighbors search on
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
          * @param[in,out] knns the (already partially) calculated nearest-neighbors
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank, i.e. the hash values of
+         *            the data points are already known; `false` otherwise
+         */
+        void calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const index_type num_queries, knn_type& knns, const bool is_own_data);
+        /**
+         * @brief Performs the k-nearest-neighbor search given the data set @p data_buffer and already calculate nearest-neighbors stored in the
+         *        device buffers @p knn_buffer and @p knn_dist_buffer.
+         * @details If more than one device is used, the hash tables of all devices are searched concurrently and the partial
+         *          nearest-neighbors of all devices are merged on the host.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perfrom the nearest-neighbors search on
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank, i.e. the hash values of
+         *            the data points are already known; `false` otherwise
+         */
+        void calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const index_type num_queries,
+                                 knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data);
+        /**
+         * @brief Performs the k-nearest-neighbor search given a chunk of queries @p data_buffer and their already calculated nearest-neighbors
+         *        stored in the device buffers @p knn_buffer and @p knn_dist_buffer.
+         * @details The chunk contains the queries `[first_query, first_query + num_queries)` of the current round. The queries and their
+         *          nearest-neighbors are stored using the layout described by @p query_attr.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the chunk of queries to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer (`rank_size` is the capacity of the chunk)
+         * @param[in] first_query the position of the first query of the chunk in the data points of the current round
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs of the chunk
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances of the chunk
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank, i.e. the hash values of
+         *            the data points are already known; `false` otherwise
+         * @param[in] wait `true` if the function waits until the search has been finished; `false` if it only submits the search (only
+         *            possible if a single device is used, the nearest-neighbors of multiple devices are always merged before returning)
+         */
+        void calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr, const index_type first_query,
+                                 const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data,
+                                 const bool wait = true);
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                            save and load index                                             //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Saves the hash functions and hash tables to the file given by the command line argument `hash_tables_save_file` of
+         *        the @ref sycl_lsh::argv_parser @p parser.
+         * @param[in] parser the used @ref sycl_lsh::argv_parser
+         *
+         * @throws std::invalid_argument if the command line argument `hash_tables_save_file` isn't present in @p parser.
+         */
+        void save(const argv_parser& parser);
+        /**
+         * @brief Saves the hash functions and hash tables to the file @p file_name using MPI IO.
+         * @details The file starts with a header describing the used @ref sycl_lsh::options and @ref sycl_lsh::data_attributes followed
+         *          by the hash functions and the byte offsets of the hash tables of each MPI rank. Each MPI rank writes the offsets and
+         *          hash tables of all of its devices **concurrently** to its own part of the file. Data points inserted using
+         *          @ref insert() aren't saved.
+         * @param[in] file_name the file to save the hash functions and hash tables to
+         *
+         * @throws std::runtime_error if inserted data points have already been folded into the hash tables by @ref compact().
+         */
+        void save(std::string_view file_name);
+        /**
+         * @brief Replaces the current hash functions and hash tables with the ones saved in @p file_name.
+         * @param[in] file_name the file previously written by @ref save()
+         *
+         * @throws std::runtime_error if the saved hash tables aren't compatible with the current @ref sycl_lsh::options,
+         *         @ref sycl_lsh::data_attributes, number of MPI ranks or number of devices per MPI rank.
+         * @throws std::runtime_error if inserted data points have already been folded into the hash tables by @ref compact().
+         */
+        void load(std::string_view file_name);
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                update index                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Inserts the data points @p points of the current MPI rank without rebuilding the hash tables (collective operation).
+         * @details The inserted data points are appended to the delta segment of the current MPI rank, i.e. separate per hash table sorted
+         *          hash values searched after the own hash tables in each round. The inserted data points get the IDs
+         *          `total_size, total_size + 1, ...` consecutive in the order of the MPI ranks.
+         * @param[in] points the data points to insert (`dims` consecutive values per data point)
+         * @return the IDs of the inserted data points (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if the size of @p points isn't a multiple of `dims`.
+         * @throws std::invalid_argument if the `ROUTING` distribution scheme, a reduced precision storage type or a reduced number of
+         *         dimensions is used.
+         * @throws std::invalid_argument if the current MPI rank uses more than one device.
          */
-        void calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, knn_type& knns);
+        [[nodiscard]]
+        std::vector<id_type> insert(const std::vector<real_type>& points);
+        /**
+         * @brief Deletes the data points with the IDs @p ids (collective operation, the IDs may be owned by any MPI rank).
+         * @details Deleted data points of the data set or inserted data points already folded into the hash tables are marked as
+         *          tombstones and skipped by the k-nearest-neighbor search until they are removed from the hash tables by @ref compact().
+         *          Deleted inserted data points are removed from the delta segment immediately. Unknown or already deleted IDs are ignored.
+         * @param[in] ids the IDs of the data points to delete
+         *
+         * @throws std::invalid_argument if the `BUCKET` kNN kernel is used.
+         */
+        void erase(const std::vector<id_type>& ids);
+        /**
+         * @brief Rebuilds the hash tables of all devices with the inserted data points but without the deleted data points.
+         * @details The inserted data points of the delta segment are appended to the data points of the device (see
+         *          @ref fold_delta_segment()). Afterwards the k-nearest-neighbor search doesn't need to check the tombstones or search
+         *          the delta segment anymore.
+         */
+        void compact();
+
+
+        /**
+         * @brief The hash bucket statistics of the hash tables of all MPI ranks (calculated on the devices while creating the hash tables).
+         */
+        struct bucket_statistics {
+            /// The total number of hash buckets (of all hash tables, devices and MPI ranks).
+            std::uint64_t num_buckets = 0;
+            /// The number of non-empty hash buckets.
+            std::uint64_t num_occupied_buckets = 0;
+            /// The number of data points in the largest hash bucket.
+            index_type max_bucket_size = 0;
+            /// The average number of data points in the non-empty hash buckets.
+            double mean_bucket_size = 0.0;
+            /// The 50th, 90th and 99th percentile of the number of data points in the non-empty hash buckets.
+            std::array<index_type, 3> percentile_bucket_sizes = { 0, 0, 0 };
+            /// The expected number of candidates per query (summed over all hash tables and MPI ranks, assuming the queries are distributed like the data points).
+            double expected_candidates = 0.0;
+        };
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -164,10 +453,127 @@ namespace sycl_lsh {
          */
         [[nodiscard]]
         const data_type& get_data() const noexcept { return data_; }
+        /**
+         * @brief Returns the hash bucket statistics of the last creation of the hash tables (all zero if the hash tables have been loaded).
+         * @return the @ref bucket_statistics (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        const bucket_statistics& get_bucket_statistics() const noexcept { return bucket_statistics_; }
 
     private:
-        // befriend factory function
+        // befriend factory functions
         friend auto make_hash_tables<layout, Options, Data>(const options_type&, data_type&, const mpi::communicator&, const mpi::logger&);
+        friend auto make_hash_tables<layout, Options, Data>(const argv_parser&, const options_type&, data_type&, const mpi::communicator&, const mpi::logger&);
+
+        /// The default number of queries per chunk of the out-of-core mode (`0` keeps the whole received partition on the device).
+#if defined(SYCL_LSH_QUERY_CHUNK_SIZE)
+        static constexpr index_type default_query_chunk_size = SYCL_LSH_QUERY_CHUNK_SIZE;
+#else
+        static constexpr index_type default_query_chunk_size = 0;
+#endif
+
+        /**
+         * @brief The state of one of the devices used by the current MPI rank.
+         * @details The data points of the current MPI rank are split into disjoint, contiguous parts, one per device. Each device creates
+         *          the hash tables of its own part only and searches the nearest-neighbors of **all** queries in them.
+         */
+        struct device_context {
+            /// The SYCL queue used to submit the kernels to the device.
+            sycl::queue queue;
+            /// The attributes of the data points assigned to the device (`rank_size` is the number of assigned data points).
+            data_attributes_type attr;
+            /// The position of the first data point assigned to the device (relative to the current MPI rank).
+            index_type first_point;
+            /// The data points assigned to the device.
+            /// If `SYCL_LSH_REORDER_POINTS` is defined, sorted by their hash buckets in the first hash table.
+            data_device_buffer_type data_buffer;
+            /// The hash tables containing the data points assigned to the device.
+            device_buffer_type hash_tables_buffer;
+            /// The offsets of the hash buckets in the hash tables of the device.
+            /// If `SYCL_LSH_COMPACT_OFFSETS` is defined, only the offsets of the non-empty hash buckets (and one sentinel per hash table).
+            device_buffer_type offsets_buffer;
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+            /// The hash values of the non-empty hash buckets (sorted per hash table, each hash table is terminated by `hash_table_size`).
+            hash_value_device_buffer_type bucket_hash_values_buffer;
+            /// The position of the first entry of each hash table in the compact offsets (`num_hash_tables + 1` values).
+            device_buffer_type directory_buffer;
+#endif
+            /// The signatures of the data points assigned to the device in all hash tables (only used by the simhash hash functions).
+            hash_value_device_buffer_type signatures_buffer;
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+            /// The fingerprints of the combined hash values of the data points assigned to the device in all hash tables.
+            fingerprint_device_buffer_type fingerprints_buffer;
+            /// The number of candidates in the own hash buckets and the number of them skipped due to differing fingerprints per query
+            /// (`rank_size` values each).
+            device_buffer_type fingerprint_count_buffer;
+#endif
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+            /// The number of evaluated candidates, skipped candidates and candidates rejected by the Hamming distance prefilter per query
+            /// (`rank_size` values each).
+            device_buffer_type candidate_count_buffer;
+#endif
+            /// The number of searched hash tables per query (less than `num_hash_tables` if the search was terminated early).
+            device_buffer_type searched_tables_buffer;
+            /// The deletion flags of the data points assigned to the device (`1` if the data point has been deleted using @ref erase()).
+            device_buffer_type tombstones_buffer;
+            /// The number of data points of the data set assigned to the device (followed by the inserted data points folded in by @ref compact()).
+            index_type num_dataset_points;
+            /// The IDs of the inserted data points folded into the hash tables of the device.
+            std::vector<id_type> inserted_ids;
+            /// The IDs of @ref inserted_ids on the device.
+            id_device_buffer_type inserted_ids_buffer;
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+            /// The hash values of the inserted data points folded into the hash tables of the device (`num_hash_tables x inserted_ids.size()`).
+            hash_value_device_buffer_type inserted_hash_values_buffer;
+#endif
+#if defined(SYCL_LSH_REORDER_POINTS)
+            /// The position of each data point in @ref data_buffer relative to @ref first_point in the original order.
+            device_buffer_type point_ids_buffer;
+            /// The position of each data point in @ref data_buffer indexed by its original position relative to @ref first_point.
+            std::vector<index_type> point_positions;
+#endif
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY
+            /// The work-group size of the per query k-nearest-neighbor kernel (`0` if the size should be derived from the local memory size).
+            index_type knn_local_size = 0;
+            /// The blocking size of the per query k-nearest-neighbor kernel (one of @ref sycl_lsh::detail::usable_knn_blocking_sizes()).
+            index_type knn_blocking_size = options_type::blocking_size;
+            /// The number of searched nearest-neighbors @ref knn_local_size was tuned for (the local memory usage depends on it).
+            index_type knn_tuned_k = 0;
+#endif
+        };
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        /// The share of the queries searched by the host device in the first co-executed round.
+        static constexpr double initial_host_share = 0.1;
+        /// The minimum share of the queries searched by the host device (keeps measuring its throughput).
+        static constexpr double min_host_share = 0.01;
+        /// The maximum share of the queries searched by the host device.
+        static constexpr double max_host_share = 0.9;
+#endif
+#if !defined(SYCL_LSH_GPU_AWARE_MPI)
+        /// The number of staging buffers used in the out-of-core mode (uploading, searching and downloading three consecutive chunks).
+        static constexpr std::size_t num_query_chunks = 3;
+        /**
+         * @brief The staging buffers of one chunk of queries streamed through the device in the out-of-core mode.
+         * @details @ref num_query_chunks of them are used in turn such that the upload of the next chunk, the search of the current chunk
+         *          and the download of the previous chunk overlap.
+         */
+        struct query_chunk {
+            /// The queries of the chunk gathered on the host.
+            data_host_buffer_type data_host_buffer;
+            /// The (partially) calculated nearest-neighbor IDs of the chunk gathered on the host.
+            typename knn_type::knn_host_buffer_type knn_host_buffer;
+            /// The (partially) calculated nearest-neighbor distances of the chunk gathered on the host.
+            typename knn_type::dist_host_buffer_type knn_dist_host_buffer;
+            /// The queries of the chunk on the device.
+            data_device_buffer_type data_buffer;
+            /// The nearest-neighbor IDs of the chunk on the device.
+            knn_device_buffer_type knn_buffer;
+            /// The nearest-neighbor distances of the chunk on the device.
+            knn_dist_device_buffer_type knn_dist_buffer;
+            /// The events of the downloads of the nearest-neighbors of the chunk (waited for before they are scattered on the host).
+            std::vector<sycl::event> download_events;
+        };
+#endif
 
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                constructor                                                 //
@@ -178,36 +584,447 @@ namespace sycl_lsh {
          * @param[in] data the used @ref sycl_lsh::data representing the used data set
          * @param[in] comm the used @ref sycl_lsh::mpi::communicator
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         * @param[in] query_chunk_size the number of queries per chunk of the out-of-core mode (`0` keeps the whole received partition on the device)
+         *
+         * @throws std::invalid_argument if `SYCL_LSH_REPLICATION_FACTOR` is defined and doesn't divide the number of MPI ranks.
+         */
+        hash_tables(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger,
+                    index_type query_chunk_size = default_query_chunk_size);
+        /**
+         * @brief Constructs a new @ref sycl_lsh::hash_tables object loading the LSH hash functions and hash tables from @p file_name.
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data representing the used data set
+         * @param[in] file_name the file previously written by @ref save()
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if `SYCL_LSH_REPLICATION_FACTOR` is defined and doesn't divide the number of MPI ranks.
+         * @throws std::runtime_error if the saved hash tables aren't compatible with the current @ref sycl_lsh::options,
+         *         @ref sycl_lsh::data_attributes, number of MPI ranks or number of devices per MPI rank.
+         */
+        hash_tables(const options_type& opt, data_type& data, std::string_view file_name, const mpi::communicator& comm, const mpi::logger& logger);
+
+        /**
+         * @brief Checks the planned device memory footprint of the current MPI rank against the budget given by the command line argument
+         *        `device_memory_budget` (in MiB, `0` only uses the global memory size of the first device).
+         * @details If the footprint exceeds the budget, the received data points are streamed chunk-wise through the device (out-of-core mode,
+         *          only supported for the `RING` distribution scheme without `SYCL_LSH_GPU_AWARE_MPI`) and, if that isn't sufficient, the
+         *          number of hash tables is reduced (identically on all MPI ranks).
+         * @param[in] parser the used @ref sycl_lsh::argv_parser
+         * @param[in] opt the used @ref sycl_lsh::options
+         * @param[in] data the used @ref sycl_lsh::data representing the used data set
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         * @return the (possibly) adjusted options and the number of queries per chunk of the out-of-core mode (`[[nodiscard]]`)
+         *
+         * @throws std::runtime_error if the footprint exceeds the budget even with a single hash table.
+         */
+        [[nodiscard]]
+        static std::pair<options_type, index_type> fit_device_memory_budget(const argv_parser& parser, const options_type& opt, const data_type& data,
+                                                                           const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Selects the used devices and splits the data points of the current MPI rank across them.
+         */
+        void initialize_devices();
+#if defined(SYCL_LSH_REORDER_POINTS)
+        /**
+         * @brief Sorts the data points of each device by their hash buckets in the first hash table.
+         * @details Afterwards, the candidates of a hash bucket are contiguous in the data points of the device, i.e. reading them is
+         *          mostly coalesced. The hash tables, signatures and tombstones refer to the sorted positions, the original positions are
+         *          stored in `point_ids_buffer` and only used to report the IDs of the nearest-neighbors.
+         */
+        void reorder_points();
+#endif
+        /**
+         * @brief (Re-)accounts the device memory of the hash functions and the persistent buffers of all devices.
+         */
+        void account_device_buffers();
+        /**
+         * @brief Waits until all kernels submitted to the queues of all used devices have been finished.
+         */
+        void wait_and_throw();
+        /**
+         * @brief Returns the header of a saved hash tables file describing the current setup.
+         * @details Only files with exactly the same header can be loaded.
+         * @return the header values (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        std::vector<std::uint64_t> index_file_header() const;
+        /**
+         * @brief Checks whether the hash tables saved in @p file are compatible with the current setup and reads the saved hash functions.
+         * @param[in] file the opened hash tables file
+         * @param[in] file_name the name of the opened hash tables file
+         * @return the values of the saved hash functions (`[[nodiscard]]`)
+         *
+         * @throws std::runtime_error if the header of @p file doesn't match the current setup.
+         */
+        [[nodiscard]]
+        std::vector<real_type> read_hash_functions(const mpi::file& file, std::string_view file_name) const;
+        /**
+         * @brief Reads the saved offsets and hash tables of all devices of the current MPI rank from @p file.
+         * @param[in] file the opened hash tables file
+         * @param[in] file_name the name of the opened hash tables file
+         *
+         * @throws std::runtime_error if any MPI rank uses another number of devices than during saving.
+         */
+        void read_hash_tables(const mpi::file& file, std::string_view file_name);
+        /**
+         * @brief Calculate the hash values of all data points in @p data_buffer for all hash tables.
+         * @details If `SYCL_LSH_GEMM_HASHING` is defined, the dot products of the data points with all hash functions are calculated
+         *          chunk-wise as a tiled matrix product in local memory, followed by a kernel quantizing and combining them to the hash values.
+         * @param[in] queue the SYCL queue used to submit the kernel
+         * @param[in] data_buffer the data points to hash
+         * @param[in] attr the attributes of the data points in @p data_buffer
+         * @param[in] num_points the number of real data points in @p data_buffer (the remaining dummy points aren't hashed)
+         * @param[out] hash_values the calculated hash values (`num_hash_tables x rank_size`)
+         */
+        void calculate_hash_values(sycl::queue& queue, data_device_buffer_type& data_buffer, const data_attributes_type& attr, const index_type num_points,
+                                   hash_value_device_buffer_type& hash_values);
+        /**
+         * @brief Calculate the number of data points assigned to each hash bucket in each hash table (separately for each used device).
+         * @param[in,out] hash_values_count the number of data points per hash bucket (one buffer per device)
+         */
+        void count_hash_values(std::vector<device_buffer_type>& hash_values_count);
+        /**
+         * @brief Caps the sizes of the hash buckets to `max_bucket_size` data points (separately for each used device).
+         * @details Oversized hash buckets are subsampled while filling the hash tables, i.e. the data points exceeding the cap aren't inserted
+         *          in the respective hash table. This bounds the number of candidates per query and hash table and therefore the runtime
+         *          of the work-items hashing into these buckets.
+         * @param[in,out] hash_values_count the number of data points per hash bucket (one buffer per device)
+         */
+        void cap_bucket_sizes(std::vector<device_buffer_type>& hash_values_count);
+        /**
+         * @brief Calculates the offset of each hash bucket in each hash table (separately for each used device).
+         * @param[in] hash_values_count the number of data points per hash bucket (one buffer per device)
+         */
+        void calculate_offsets(std::vector<device_buffer_type>& hash_values_count);
+        /**
+         * @brief Calculates the hash bucket statistics on the devices, reduces them over all MPI ranks and logs them.
+         * @details The number of occupied hash buckets, the largest bucket and the expected number of candidates per query are reduced
+         *          chunk-wise on the devices. The percentiles are calculated from a histogram of the (non-empty) bucket sizes with at most
+         *          4096 bins, i.e. they are exact if the largest hash bucket contains at most 4096 data points.
+         * @param[in] hash_values_count the (capped) number of data points per hash bucket (one buffer per device)
          */
-        hash_tables(const options_type& opt, data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
+        void calculate_bucket_statistics(std::vector<device_buffer_type>& hash_values_count);
+        /**
+         * @brief Fill each hash table based on the previously calculated offsets (separately for each used device).
+         * @param[in,out] hash_values_count the (capped) number of data points per hash bucket (one buffer per device, used to reject the
+         *                data points of full hash buckets if `max_bucket_size` is set)
+         */
+        void fill_hash_tables(std::vector<device_buffer_type>& hash_values_count);
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+        /**
+         * @brief Replaces the dense offsets of each hash table (`hash_table_size + 1` values) by the offsets of the non-empty hash buckets
+         *        only (separately for each used device).
+         * @details The non-empty hash buckets are stored as (hash value, offset) pairs sorted by the hash values which are searched using
+         *          a binary search (see @ref sycl_lsh::detail::find_hash_bucket()). Afterwards the memory needed for the offsets only
+         *          depends on the number of non-empty hash buckets instead of `hash_table_size`.
+         */
+        void compact_offsets();
+#endif
+        /**
+         * @brief Creates the hash tables of all devices, i.e. counts the hash values, caps the hash buckets, calculates the offsets and
+         *        fills the hash tables (deleted data points are skipped).
+         */
+        void create_hash_tables();
+        /**
+         * @brief Recreates the delta segment of the current MPI rank from the currently inserted data points on the first device.
+         * @details The hash values of the inserted data points are sorted per hash table such that the k-nearest-neighbor search can
+         *          find the inserted data points of a hash bucket using a binary search.
+         */
+        void create_delta_segment();
+        /**
+         * @brief Appends the inserted data points of the delta segment to the data points of the (single) device and empties the delta
+         *        segment.
+         * @details The per data point buffers of the device are enlarged accordingly such that the next call to @ref create_hash_tables()
+         *          inserts the appended data points into the hash tables. The appended data points keep the IDs assigned by @ref insert().
+         */
+        void fold_delta_segment();
+        /**
+         * @brief Returns the number of inserted data points of all MPI ranks already folded into the hash tables (collective operation).
+         * @return the number of folded inserted data points (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        index_type num_folded_points() const;
+        /**
+         * @brief Performs the k-nearest-neighbor search of the queries in @p data_buffer in the delta segment of the current MPI rank.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         */
+        void calculate_knn_round_delta(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                       const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer);
+        /**
+         * @brief Calculates the signatures of the data points of each device in all hash tables used by the Hamming distance prefilter
+         *        (only used by the simhash hash functions).
+         */
+        void calculate_signatures();
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        /**
+         * @brief Calculates the fingerprints of the combined hash values of the data points of each device in all hash tables used to skip
+         *        the candidates which only share the hash bucket with a query due to the modulo with the hash table size.
+         */
+        void calculate_fingerprints();
+#endif
 
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_RING || SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING
+        /**
+         * @brief Calculates the k-nearest-neighbors by sending the queries and their (partially) calculated nearest-neighbors around a
+         *        ring of all MPI ranks.
+         * @details Each of the `comm.size()` rounds searches the nearest-neighbors of the currently received queries in the own hash tables.
+         * @param[in,out] queries the queries, either the data points in the hash tables or a separate query set
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in,out] knns the calculated nearest-neighbors
+         */
+        void calculate_knn_ring(data_type& queries, const index_type k, knn_type& knns);
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_STATIONARY_RING
+        /**
+         * @brief Calculates the k-nearest-neighbors by only sending the queries around a ring of all MPI ranks while their partial
+         *        nearest-neighbors stay on the MPI rank that calculated them.
+         * @details Each of the `comm.size()` rounds searches the nearest-neighbors of the currently received queries in the own hash tables
+         *          and keeps them as sorted partial lists. Afterwards, the partial lists are merged at the MPI ranks owning the queries using
+         *          @ref sycl_lsh::mpi::reduce_scatter_top_k(), i.e. the nearest-neighbors are sent only once instead of in each round. \n
+         *          If `SYCL_LSH_REPLICATION_FACTOR` is defined, the data points of each group of `SYCL_LSH_REPLICATION_FACTOR` consecutive
+         *          MPI ranks are gathered on all MPI ranks of the group once and sent around the ring of the groups, i.e. only
+         *          `comm.size() / SYCL_LSH_REPLICATION_FACTOR` rounds (each searching the data points of a whole group) are needed.
+         *          This only reduces the number of messages and synchronizations of the ring (i.e. the latency) and isn't a compute
+         *          speedup, since the data points (not the hash tables) are replicated: the data points searched and the bytes
+         *          received per MPI rank (i.e. the work on the critical path) are unchanged, while the host buffer of the received data
+         *          points grows by the replication factor and the data points are additionally gathered once inside each group.
+         * @param[in,out] queries the queries, either the data points in the hash tables or a separate query set
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in,out] knns the calculated nearest-neighbors
+         */
+        void calculate_knn_stationary_ring(data_type& queries, const index_type k, knn_type& knns);
+#endif
+#if !defined(SYCL_LSH_GPU_AWARE_MPI)
+        /**
+         * @brief Creates the @ref num_query_chunks staging buffers of the out-of-core mode used in turn, each holding @ref query_chunk_size_
+         *        queries and their nearest-neighbors.
+         * @param[in] query_attr the attributes of the searched queries
+         * @param[in] k the number of nearest neighbors to search for
+         * @return the staging buffers (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        std::vector<query_chunk> make_query_chunks(const data_attributes_type& query_attr, const index_type k) const;
+        /**
+         * @brief Performs the k-nearest-neighbor search of the current round by streaming the data points in the host buffer of @p queries
+         *        and their nearest-neighbors @p knns chunk-wise through the device.
+         * @details Only the own data points and hash tables reside permanently on the device. The transfers are submitted to
+         *          @p transfer_queue and the searches to the queue of the first device, i.e. the upload of the next chunk, the search of the
+         *          current chunk and the download of the previous chunk overlap (as well as gathering and scattering the chunks on the host).
+         * @param[in] queries the queries (their host buffer contains the data points of the current round)
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in,out] chunks the staging buffers created by @ref make_query_chunks()
+         * @param[in] transfer_queue the SYCL queue (on the first device) used for the uploads and downloads of the chunks
+         * @param[in] num_queries the number of real data points of the current round (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knns the (already partially) calculated nearest-neighbors
+         * @param[in] is_own_data `true` if the current data points are owned by the current MPI rank; `false` otherwise
+         */
+        void calculate_knn_round_chunked(data_type& queries, const index_type k, std::vector<query_chunk>& chunks, sycl::queue& transfer_queue,
+                                         const index_type num_queries, knn_type& knns, const bool is_own_data);
+#endif
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING
+        /**
+         * @brief Calculates the k-nearest-neighbors by exchanging the data points and their (partially) calculated nearest-neighbors inside
+         *        each node using shared memory and sending only the node aggregates around a ring of all nodes.
+         * @details The data points and nearest-neighbors of all MPI ranks on a node are stored in shared memory windows. In each of the
+         *          `node_size` rounds per node, every MPI rank processes another slot of its node directly from the shared memory.
+         *          Afterwards, each MPI rank sends its slot to the MPI rank with the same node-local rank on the next node.
+         *          Falls back to @ref calculate_knn_ring() if the nodes have different numbers of MPI ranks.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in,out] knns the calculated nearest-neighbors
+         */
+        void calculate_knn_hierarchical_ring(const index_type k, knn_type& knns);
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING
+        /**
+         * @brief Calculates the k-nearest-neighbors by only sending the queries to the MPI ranks that can contribute candidates.
+         * @details Each MPI rank publishes a bitmap of its non-empty hash buckets. A query is routed (using `MPI_Alltoallv`) to the
+         *          MPI ranks having a non-empty hash bucket in at least one of the hash tables. The partial nearest-neighbors calculated on
+         *          these MPI ranks are sent back and merged on the MPI rank owning the query. All received queries are packed densely
+         *          and searched in a single k-nearest-neighbor round, i.e. the work scales with the number of routed queries.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in,out] knns the calculated nearest-neighbors
+         */
+        void calculate_knn_query_routing(const index_type k, knn_type& knns);
+#endif
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY
+        /**
+         * @brief Performs the k-nearest-neighbor search using one work-item per query, i.e. per data point in @p data_buffer.
+         * @details Each work-item loads the candidates of its hash buckets directly from global memory.
+         * @param[in] device the device whose hash tables are searched
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] first_query the position of the first query of @p data_buffer in the data points of the current round
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank; `false` otherwise
+         * @return the SYCL event of the submitted kernel (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        sycl::event calculate_knn_round_per_query(device_context& device, const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                                  const index_type first_query, const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data);
+        /**
+         * @brief Returns the maximum work-group size of the per query k-nearest-neighbor kernel fitting into the local memory of @p device.
+         * @param[in] device the device executing the kernel
+         * @param[in] k the number of nearest neighbors to search for
+         * @return the maximum work-group size (`std::numeric_limits<index_type>::max()` if no local memory is needed) (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        index_type knn_max_local_size(const device_context& device, const index_type k) const;
         /**
-         * @brief Calculate the number of data points assigned to each hash bucket in each hash table.
-         * @param[in,out] hash_values_count the number of data points per hash bucket
+         * @brief Performs the k-nearest-neighbor search using one work-item per query with the pre-instantiated blocking size @p blocking_size.
+         * @details If @p static_k is not `0`, the nearest-neighbors of each work-item are kept in private memory (registers) using fully
+         *          unrollable updates instead of local memory, i.e. the work-group size isn't limited by the number of nearest-neighbors.
+         * @tparam blocking_size the number of candidates loaded at once by each work-item
+         * @tparam static_k the number of nearest neighbors @p k if it's one of the @ref sycl_lsh::detail::knn_static_ks, otherwise `0`
+         * @param[in] device the device whose hash tables are searched
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] first_query the position of the first query of @p data_buffer in the data points of the current round
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank; `false` otherwise
+         * @return the SYCL event of the submitted kernel (`[[nodiscard]]`)
+         */
+        template <std::size_t blocking_size, std::size_t static_k>
+        [[nodiscard]]
+        sycl::event calculate_knn_round_per_query_kernel(device_context& device, const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                                         const index_type first_query, const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data);
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        /**
+         * @brief Performs the k-nearest-neighbor search of the current round co-executed on the first device and the host CPU device.
+         * @details The last @p num_host_queries queries are gathered into separate buffers on the device and searched by the host device in the
+         *          same (read-only) hash tables, while the device searches the remaining queries. Only the host share is transferred to the host
+         *          and its results are scattered back on the device. Afterwards, the host share of the next round is updated such that both
+         *          devices would have finished at the same time given their measured throughputs.
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] first_query the position of the first query of @p data_buffer in the data points of the current round
+         * @param[in] num_device_queries the number of queries searched by the device
+         * @param[in] num_host_queries the number of queries searched by the host device (following the device queries)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank; `false` otherwise
+         */
+        void calculate_knn_round_co_executed(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr, const index_type first_query,
+                                             const index_type num_device_queries, const index_type num_host_queries, knn_device_buffer_type& knn_buffer,
+                                             knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data);
+#endif
+#elif SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+        /**
+         * @brief Sorts the IDs of the queries in each hash table by their hash value using a counting sort.
+         * @param[in] device the device used to sort the queries
+         * @param[in] query_hash_values the hash values of all queries (`num_hash_tables x query_attr.rank_size`)
+         * @param[in] query_attr the attributes of the queries
+         * @param[in] num_queries the number of real queries (the remaining ones are dummy points which aren't sorted)
+         * @param[out] sorted_queries the query IDs sorted by hash value per hash table (`num_hash_tables x query_attr.rank_size`, only the first
+         *             @p num_queries IDs of each hash table are valid)
          */
-        void count_hash_values(device_buffer_type& hash_values_count);
+        void sort_queries_by_hash_value(device_context& device, hash_value_device_buffer_type& query_hash_values, const data_attributes_type& query_attr,
+                                        const index_type num_queries, device_buffer_type& sorted_queries);
         /**
-         * @brief Calculates the offset of each hash bucket in each hash table.
-         * @param[in] hash_values_count the number of data points per hash bucket
+         * @brief Performs the k-nearest-neighbor search cooperatively per work-group on queries grouped by hash bucket.
+         * @details The queries of each hash table are sorted by their hash value. Each work-group processes `local_size` consecutive
+         *          sorted queries whose candidates are therefore located in one contiguous range of the hash table. The candidates of
+         *          this range are staged tile-wise in local memory **once** and compared against all queries of the work-group.
+         * @param[in] device the device whose hash tables are searched
+         * @param[in] k the number of nearest neighbors to search for
+         * @param[in] data_buffer the data to perform the nearest-neighbors search on
+         * @param[in] query_attr the attributes of the queries in @p data_buffer
+         * @param[in] first_query the position of the first query of @p data_buffer in the data points of the current round
+         * @param[in] num_queries the number of real data points in @p data_buffer (the remaining ones are dummy points which are skipped)
+         * @param[in,out] knn_buffer the (already partially) calculated nearest-neighbor IDs
+         * @param[in,out] knn_dist_buffer the (already partially) calculated nearest-neighbor distances
+         * @param[in] is_own_data `true` if @p data_buffer contains the data owned by the current MPI rank; `false` otherwise
+         *
+         * @throws std::runtime_error if the device's local memory can't hold the nearest-neighbors and one candidate per work-item.
          */
-        void calculate_offsets(device_buffer_type& hash_values_count);
+        void calculate_knn_round_per_bucket(device_context& device, const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                            const index_type first_query, const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data);
+#endif
+#if defined(SYCL_LSH_EXACT_RERANKING)
         /**
-         * @brief Fill each hash table based on the previously calculated offsets.
+         * @brief Re-ranks the @p k_candidates nearest-neighbor candidates found using the reduced precision or reduced dimensions data
+         *        points using their original data points and saves the @p k best ones in @p knns.
+         * @details The original data points of all candidates are requested from the MPI ranks owning them using a single
+         *          `MPI_Alltoallv` (each candidate is requested only once per MPI rank).
+         * @param[in] queries the queries whose nearest-neighbors are re-ranked
+         * @param[in] k_candidates the number of nearest-neighbor candidates per query
+         * @param[in] candidates the nearest-neighbor candidates (calculated using the approximated data points)
+         * @param[in] k the number of nearest-neighbors to search for
+         * @param[out] knns the re-ranked k-nearest-neighbors
          */
-        void fill_hash_tables();
+        void rerank_knns(data_type& queries, const index_type k_candidates, knn_type& candidates, const index_type k, knn_type& knns);
+#endif
 
 
-        const options_type& options_;
+        // a copy, since the number of hash tables may have been reduced to fit into the device memory budget
+        const options_type options_;
         data_type& data_;
         const data_attributes_type attr_;
         const mpi::communicator& comm_;
         const mpi::logger& logger_;
 
         hash_function_type hash_functions_;
+        // measures the device times of the kernels and transfers (only if SYCL_LSH_PROFILING is defined)
+        detail::device_profiler profiler_;
+        // accounts the device memory of the buffers
+        detail::device_memory_tracker memory_;
+        /// The number of queries per chunk of the out-of-core mode (`0` keeps the whole received partition on the device).
+        index_type query_chunk_size_ = default_query_chunk_size;
 
-        sycl::queue queue_;
-        device_buffer_type hash_tables_buffer_;
-        device_buffer_type offsets_buffer_;
+        std::vector<device_context> devices_;
+        bucket_statistics bucket_statistics_;
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        hash_value_device_buffer_type hash_values_buffer_;
+#endif
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        std::uint64_t num_candidates_ = 0;
+        std::uint64_t num_skipped_candidates_ = 0;
+        std::uint64_t num_filtered_candidates_ = 0;
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        std::uint64_t num_fingerprint_candidates_ = 0;
+        std::uint64_t num_fingerprint_filtered_candidates_ = 0;
+#endif
+        std::uint64_t num_searched_tables_ = 0;
+        std::uint64_t num_searched_queries_ = 0;
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        /// The SYCL queue of the host CPU device co-executing the k-nearest-neighbor search.
+        std::optional<sycl::queue> host_queue_;
+        /// The share of the queries of a round searched by the host device (updated after each co-executed round).
+        double host_share_ = initial_host_share;
+        std::uint64_t num_host_queries_ = 0;
+        std::uint64_t num_co_executed_queries_ = 0;
+#endif
+
+        /// The number of deleted data points of the current MPI rank.
+        index_type num_tombstones_ = 0;
+        /// The number of deleted data points of the current MPI rank still contained in the hash tables.
+        index_type num_pending_tombstones_ = 0;
+        /// The ID of the next inserted data point (the IDs of the data set are less than `total_size`).
+        id_type next_insert_id_ = attr_.total_size;
+        /// The inserted data points of the current MPI rank (`dims` consecutive values per data point).
+        std::vector<real_type> delta_points_;
+        /// The IDs of the inserted data points of the current MPI rank.
+        std::vector<id_type> delta_ids_;
+        /// The inserted data points on the first device (using the same memory layout as the data set).
+        data_device_buffer_type delta_data_buffer_{ sycl::range<>(1) };
+        /// The IDs of the inserted data points on the first device.
+        id_device_buffer_type delta_ids_buffer_{ sycl::range<>(1) };
+        /// The hash values of the inserted data points sorted per hash table (`num_hash_tables x delta_ids_.size()`).
+        hash_value_device_buffer_type delta_hash_values_buffer_{ sycl::range<>(1) };
+        /// The positions of the inserted data points in the order of @ref delta_hash_values_buffer_.
+        device_buffer_type delta_points_buffer_{ sycl::range<>(1) };
     };
 
 
@@ -218,182 +1035,2765 @@ namespace sycl_lsh {
     [[nodiscard]]
     typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_type
     sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::get_k_nearest_neighbors(const sycl_lsh::argv_parser& parser) {
-        return get_k_nearest_neighbors(parser.argv_as<index_type>("k"));
+        if (parser.has_argv("knn_tuning_file")) {
+            // tune the kNN kernel before the actual search
+            this->tune_knn_kernel(parser.argv_as<index_type>("k"), parser.argv_as<std::string>("knn_tuning_file"));
+        }
+        const index_type k = parser.argv_as<index_type>("k");
+        // the additional k' to evaluate are answered by the single search for k (batched k-nearest-neighbor search)
+        std::vector<index_type> ks;
+        if (parser.has_argv("evaluate_recall_at")) {
+            const std::string values = parser.argv_as<std::string>("evaluate_recall_at");
+            std::size_t pos = 0;
+            while (pos < values.size()) {
+                const std::size_t end = std::min(values.find(',', pos), values.size());
+                const index_type val = detail::convert_to<index_type>(values.substr(pos, end - pos));
+                if (val == 0 || val > k) {
+                    throw std::invalid_argument(fmt::format("Illegal recall@{} requested! Must be in the range [1, {}].", val, k));
+                }
+                ks.push_back(val);
+                pos = end + 1;
+            }
+            ks.push_back(k);
+        }
+
+        if (parser.has_argv("query_file")) {
+            // search the nearest-neighbors of a separate query set
+            data_type queries = make_query_data<layout>(parser, options_, data_, comm_, logger_);
+            logger_.log("\nUsed query set:\n{}\n", queries);
+            return ks.empty() ? get_k_nearest_neighbors(queries, k) : get_k_nearest_neighbors(queries, ks);
+        }
+        return ks.empty() ? get_k_nearest_neighbors(k) : get_k_nearest_neighbors(ks);
     }
 
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
     [[nodiscard]]
     typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_type
     sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::get_k_nearest_neighbors(const index_type k) {
+        return get_k_nearest_neighbors(data_, k);
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_type
+    sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::get_k_nearest_neighbors(data_type& queries, const index_type k) {
         mpi::timer t(comm_);
 
         if (k < 1 || k > attr_.rank_size) {
             throw std::invalid_argument(fmt::format("k ({}) must be in the range [1, number of data point per MPI rank ({}))!", k, attr_.rank_size));
         }
+        // the queries are the data points in the hash tables -> all-k-nearest-neighbors
+        const bool is_self_join = &queries == &data_;
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING
+        if (!is_self_join) {
+            throw std::invalid_argument("A separate query set isn't supported by the \"ROUTING\" distribution scheme!");
+        }
+#endif
+        if (options_.num_probes > 0) {
+            if constexpr (!supports_multi_probe(options_type::used_hash_functions_type)) {
+                throw std::invalid_argument(fmt::format("Multi-probe querying isn't supported by the '{}' hash functions!", options_type::used_hash_functions_type));
+            }
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+            throw std::invalid_argument("Multi-probe querying isn't supported by the \"BUCKET\" kNN kernel!");
+#endif
+            if (static_cast<std::size_t>(options_.num_hash_functions) > detail::max_probe_hash_functions) {
+                throw std::invalid_argument(fmt::format("Multi-probe querying supports at most {} hash functions per hash table, but {} are used!",
+                                                        detail::max_probe_hash_functions, options_.num_hash_functions));
+            }
+        }
+        if (options_.max_hamming_distance > 0) {
+            if constexpr (options_type::used_hash_functions_type != hash_functions_type::simhash) {
+                throw std::invalid_argument(fmt::format("The Hamming distance prefilter isn't supported by the '{}' hash functions!", options_type::used_hash_functions_type));
+            }
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+            throw std::invalid_argument("The Hamming distance prefilter isn't supported by the \"BUCKET\" kNN kernel!");
+#endif
+            if (static_cast<std::size_t>(options_.num_hash_tables) > detail::max_hamming_filter_hash_tables) {
+                throw std::invalid_argument(fmt::format("The Hamming distance prefilter supports at most {} hash tables, but {} are used!",
+                                                        detail::max_hamming_filter_hash_tables, options_.num_hash_tables));
+            }
+        }
+        if (options_.early_termination_tables > 0 || options_.early_termination_distance > 0) {
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+            throw std::invalid_argument("The adaptive early termination isn't supported by the \"BUCKET\" kNN kernel!");
+#endif
+        }
 
-        knn_type knns = make_knn<layout>(k, options_, data_, comm_, logger_);
-
-        for (int round = 0; round < comm_.size(); ++round) {
-            mpi::timer rt(comm_);
-
-            logger_.log("Round {} of {} ... ", round + 1, comm_.size());
-
-            const auto copy_received_data = [&]() {
-              data_host_buffer_type data_host_buffer = data_.get_host_buffer();
-              data_device_buffer_type buf(data_host_buffer.size());
-
-              // copy data to device buffer
-              auto acc = buf.template get_access<sycl::access::mode::discard_write>();
-              for (index_type i = 0; i < data_host_buffer.size(); ++i) {
-                acc[i] = data_host_buffer[i];
-              }
-              return buf;
-            };
-            data_device_buffer_type data_device_buffer = round == 0 ? data_.get_device_buffer() : copy_received_data();
-            
-            // create thread to asynchronously perform MPI communication
-            std::thread mpi_thread(&data_type::send_receive_host_buffer, &data_);
-
-            // calculate k-nearest-neighbors on current MPI rank
-            calculate_knn_round(k, data_device_buffer, knns);
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        // search for additional candidates which are discarded during the exact re-ranking
+        const index_type k_search = std::min<index_type>(k * detail::rerank_factor, attr_.rank_size);
+#else
+        const index_type k_search = k;
+#endif
 
-            // send calculated k-nearest-neighbors and distances to next rank
-            knns.send_receive_host_buffer();
-            // wait until all MPI communication has been finished
-            mpi_thread.join();
-            comm_.wait();
+        knn_type knns = make_knn<layout>(k_search, options_, queries, comm_, logger_);
+        // keep the device-resident k-nearest-neighbors in the context of the device performing the search
+        knns.set_queue(devices_.front().queue);
+        if (!is_self_join) {
+            // the IDs of the queries aren't valid placeholders (they may be the ID of any data point) -> use an invalid ID instead
+            std::fill(knns.get_knn_host_buffer().begin(), knns.get_knn_host_buffer().end(), std::numeric_limits<id_type>::max());
+        }
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        num_candidates_ = 0;
+        num_skipped_candidates_ = 0;
+        num_filtered_candidates_ = 0;
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        num_fingerprint_candidates_ = 0;
+        num_fingerprint_filtered_candidates_ = 0;
+#endif
+        num_searched_tables_ = 0;
+        num_searched_queries_ = 0;
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        num_host_queries_ = 0;
+        num_co_executed_queries_ = 0;
+#endif
+        profiler_.set_round(0);
+        mpi::communication_profiler::set_round(0);
 
-            logger_.log("finished in {}.\n", rt.elapsed());
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_RING
+        this->calculate_knn_ring(queries, k_search, knns);
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING
+        if (is_self_join) {
+            this->calculate_knn_hierarchical_ring(k_search, knns);
+        } else {
+            // only the queries and their nearest-neighbors are sent around -> no need for the node aggregates
+            this->calculate_knn_ring(queries, k_search, knns);
         }
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING
+        this->calculate_knn_query_routing(k_search, knns);
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_STATIONARY_RING
+        this->calculate_knn_stationary_ring(queries, k_search, knns);
+#endif
 
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        const std::uint64_t num_candidates = mpi::sum(num_candidates_, comm_);
+        const std::uint64_t num_skipped_candidates = mpi::sum(num_skipped_candidates_, comm_);
+        logger_.log("Skipped {} of {} distance calculations ({:.2f}%) due to already seen candidates.\n", num_skipped_candidates, num_candidates,
+                    num_candidates == 0 ? 0.0 : 100.0 * num_skipped_candidates / num_candidates);
+        if (options_.max_hamming_distance > 0) {
+            const std::uint64_t num_filtered_candidates = mpi::sum(num_filtered_candidates_, comm_);
+            logger_.log("Skipped {} of {} distance calculations ({:.2f}%) due to the Hamming distance prefilter.\n", num_filtered_candidates, num_candidates,
+                        num_candidates == 0 ? 0.0 : 100.0 * num_filtered_candidates / num_candidates);
+        }
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        const std::uint64_t num_fingerprint_candidates = mpi::sum(num_fingerprint_candidates_, comm_);
+        const std::uint64_t num_fingerprint_filtered_candidates = mpi::sum(num_fingerprint_filtered_candidates_, comm_);
+        logger_.log("Skipped {} of {} distance calculations in the own hash buckets ({:.2f}%) due to differing hash fingerprints.\n",
+                    num_fingerprint_filtered_candidates, num_fingerprint_candidates,
+                    num_fingerprint_candidates == 0 ? 0.0 : 100.0 * num_fingerprint_filtered_candidates / num_fingerprint_candidates);
+#endif
+        if (options_.early_termination_tables > 0 || options_.early_termination_distance > 0) {
+            const std::uint64_t num_searched_tables = mpi::sum(num_searched_tables_, comm_);
+            const std::uint64_t num_searched_queries = mpi::sum(num_searched_queries_, comm_);
+            logger_.log("Searched {:.2f} of {} hash tables per query on average due to the adaptive early termination.\n",
+                        num_searched_queries == 0 ? 0.0 : static_cast<double>(num_searched_tables) / num_searched_queries, options_.num_hash_tables);
+        }
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        const std::uint64_t num_host_queries = mpi::sum(num_host_queries_, comm_);
+        const std::uint64_t num_co_executed_queries = mpi::sum(num_co_executed_queries_, comm_);
+        logger_.log("Searched {} of {} queries ({:.2f}%) on the host device.\n", num_host_queries, num_co_executed_queries,
+                    num_co_executed_queries == 0 ? 0.0 : 100.0 * num_host_queries / num_co_executed_queries);
+        logger_.log_on_all("[{}] host share of the next round: {:.2f}%\n", comm_.rank(), 100.0 * host_share_);
+#endif
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        knn_type reranked_knns = make_knn<layout>(k, options_, queries, comm_, logger_);
+        reranked_knns.set_queue(devices_.front().queue);
+        this->rerank_knns(queries, k_search, knns, k, reranked_knns);
         logger_.log("Calculated {}-nearest-neighbors in {}.\n\n", k, t.elapsed());
-
+        profiler_.report("calculating the k-nearest-neighbors");
+        mpi::communication_profiler::report("calculating the k-nearest-neighbors", comm_, logger_);
+        memory_.report("calculating the k-nearest-neighbors");
+        return reranked_knns;
+#else
+        logger_.log("Calculated {}-nearest-neighbors in {}.\n\n", k, t.elapsed());
+        profiler_.report("calculating the k-nearest-neighbors");
+        mpi::communication_profiler::report("calculating the k-nearest-neighbors", comm_, logger_);
+        memory_.report("calculating the k-nearest-neighbors");
         return knns;
+#endif
     }
 
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
-    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, knn_type& knns) {
-        // TODO 2020-10-07 15:52 marcel: check if correct and useful
-        const index_type local_mem_size = queue_.get_device().template get_info<sycl::info::device::local_mem_size>();
-        const index_type max_local_size = local_mem_size / (k * (sizeof(index_type) + sizeof(real_type)));
-        const index_type max_work_group_size = queue_.get_device().template get_info<sycl::info::device::max_work_group_size>();
-        index_type local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
-        if (max_local_size == local_size) {
-            local_size /= 2;
+    [[nodiscard]]
+    typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_type
+    sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::get_k_nearest_neighbors(data_type& queries, const std::vector<index_type>& ks) {
+        if (ks.empty()) {
+            throw std::invalid_argument("No k values given for the batched k-nearest-neighbor search!");
+        }
+        for (const index_type k : ks) {
+            if (k < 1 || k > attr_.rank_size) {
+                throw std::invalid_argument(fmt::format("k ({}) must be in the range [1, number of data point per MPI rank ({}))!", k, attr_.rank_size));
+            }
         }
-        
-        const index_type global_size = ((attr_.rank_size + local_size - 1) / local_size) * local_size;
 
-        // create SYCL buffers for knn class
-        knn_device_buffer_type knn_buffer(knns.get_knn_host_buffer().data(), knns.get_knn_host_buffer().size());
-        knn_dist_device_buffer_type knn_dist_buffer(knns.get_distance_host_buffer().data(), knns.get_distance_host_buffer().size());
+        // a single search for the largest k -> the smaller k are answered using the prefixes of the sorted k-nearest-neighbors
+        const index_type max_k = *std::max_element(ks.begin(), ks.end());
+        logger_.log("Batched k-nearest-neighbor search for {} k values using a single search for k = {}.\n", ks.size(), max_k);
+        knn_type knns = get_k_nearest_neighbors(queries, max_k);
+        knns.set_batch_ks(ks);
+        return knns;
+    }
 
-        queue_.submit([&](sycl::handler& cgh) {
-            // get accessors
-            auto acc_data_owned = data_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-            auto acc_data_received = data_buffer.template get_access<sycl::access::mode::read>(cgh);
-            auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-            auto acc_offsets = offsets_buffer_.template get_access<sycl::access::mode::read>(cgh);
-            auto acc_hash_tables = hash_tables_buffer_.template get_access<sycl::access::mode::read>(cgh);
-            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>(cgh);
-            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>(cgh);
-            // get additional information
-            auto options = options_;
-            auto attr = attr_;
-            const index_type base_id = comm_.rank() * attr_.rank_size;
-            // get get_linear_id functor instantiation
-            const get_linear_id<data_type> get_linear_id_data{};
-            const get_linear_id<knn_type> get_linear_id_knn{};
-            // get hasher functor instantiation
-            const lsh_hash<hash_function_type> hasher{};
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_type
+    sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::get_k_nearest_neighbors(const std::vector<index_type>& ks) {
+        return get_k_nearest_neighbors(data_, ks);
+    }
 
-            // create local memory accessors
-            sycl::accessor<index_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
-                    knn_local_mem(sycl::range<>(local_size * k), cgh);
-            sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
-                    knn_dist_local_mem(sycl::range<>(local_size * k), cgh);
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::tune_knn_kernel(const index_type k, const std::string& tuning_file) {
+        mpi::timer t(comm_);
 
-            const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+        if (k < 1 || k > attr_.rank_size) {
+            throw std::invalid_argument(fmt::format("k ({}) must be in the range [1, number of data point per MPI rank ({}))!", k, attr_.rank_size));
+        }
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+        throw std::invalid_argument(fmt::format("Tuning '{}' isn't supported by the \"BUCKET\" kNN kernel!", tuning_file));
+#else
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        // the kernel searches for additional candidates which are discarded during the exact re-ranking
+        const index_type k_search = std::min<index_type>(k * detail::rerank_factor, attr_.rank_size);
+#else
+        const index_type k_search = k;
+#endif
+        using config_type = detail::knn_kernel_config<index_type>;
 
-            cgh.parallel_for<kernel_calculate_knn>(execution_range, [=](sycl::nd_item<> item) {
-                const index_type global_idx = item.get_global_linear_id();
-                const index_type local_idx  = item.get_local_linear_id();
+        // read the already tuned configurations (each MPI rank reads the file itself)
+        std::map<std::string, config_type> configs;
+        if (std::ifstream in(tuning_file); in) {
+            detail::read_knn_kernel_configs(in, tuning_file, configs);
+        }
 
-                // immediately return if global_idx is out-of-range
-                if (global_idx >= attr.rank_size) return;
+        const std::vector<std::size_t> blocking_sizes = detail::usable_knn_blocking_sizes<options_type::blocking_size>();
+        // time the kernel on (a part of) the own data points
+        const index_type num_queries = std::min<index_type>(attr_.correct_rank_size(comm_.rank()), detail::knn_tuning_num_queries);
+        knn_device_buffer_type knn_buffer(attr_.rank_size * k_search);
+        knn_dist_device_buffer_type knn_dist_buffer(attr_.rank_size * k_search);
 
-                index_type knn_blocked[options_type::blocking_size];
-                real_type knn_dist_blocked[options_type::blocking_size];
+        std::string new_configs;
+        std::string tuning_log;
+        for (device_context& device : devices_) {
+            const std::string device_name = device.queue.get_device().template get_info<sycl::info::device::name>();
+            const std::string key = detail::knn_kernel_config_key(device_name, k_search, attr_.dims);
 
-                // initialize local memory arrays
-                for (index_type nn = 0; nn < k; ++nn) {
-                    knn_local_mem[local_idx * k + nn] = acc_knn[get_linear_id_knn(global_idx, nn, attr, k)];
-                    knn_dist_local_mem[local_idx * k + nn] = acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)];
+            const index_type max_local_size = this->knn_max_local_size(device, k_search);
+            const index_type max_work_group_size = device.queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+
+            if (const auto it = configs.find(key); it != configs.end()) {
+                // use the cached configuration
+                const config_type& config = it->second;
+                if (config.local_size == 0 || config.local_size > max_local_size || config.local_size > max_work_group_size
+                    || std::find(blocking_sizes.begin(), blocking_sizes.end(), config.blocking_size) == blocking_sizes.end()) {
+                    throw std::invalid_argument(fmt::format("Illegal configuration (local_size: {}, blocking_size: {}) for '{}' in '{}'!",
+                                                            config.local_size, config.blocking_size, key, tuning_file));
                 }
+                device.knn_local_size = config.local_size;
+                device.knn_blocking_size = config.blocking_size;
+                device.knn_tuned_k = k_search;
+                tuning_log += fmt::format("[{}, {}] cached local_size: {}, blocking_size: {}\n",
+                                          comm_.rank(), device_name, device.knn_local_size, device.knn_blocking_size);
+                continue;
+            }
+
+            // time all candidate configurations
+            std::chrono::steady_clock::duration best_duration = std::chrono::steady_clock::duration::max();
+            config_type best_config{ 0, options_type::blocking_size };
+            for (index_type local_size = detail::min_knn_tuning_local_size; local_size < max_local_size && local_size <= max_work_group_size; local_size *= 2) {
+                for (const std::size_t blocking_size : blocking_sizes) {
+                    device.knn_local_size = local_size;
+                    device.knn_blocking_size = blocking_size;
+                    device.knn_tuned_k = k_search;
+
+                    // the first run is a warm-up run (e.g. JIT compilation of the kernel)
+                    std::chrono::steady_clock::duration duration{};
+                    for (int run = 0; run < 2; ++run) {
+                        device.queue.submit([&](sycl::handler& cgh) {
+                            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                            cgh.fill(acc_knn, std::numeric_limits<id_type>::max());
+                        });
+                        device.queue.submit([&](sycl::handler& cgh) {
+                            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                            cgh.fill(acc_knn_dist, std::numeric_limits<real_type>::max());
+                        });
+                        device.queue.wait_and_throw();
+
+                        const auto start = std::chrono::steady_clock::now();
+                        this->calculate_knn_round_per_query(device, k_search, data_.get_device_buffer(), attr_, 0, num_queries, knn_buffer, knn_dist_buffer, true)
+                                .wait_and_throw();
+                        duration = std::chrono::steady_clock::now() - start;
+                    }
+
+                    if (duration < best_duration) {
+                        best_duration = duration;
+                        best_config = config_type{ local_size, static_cast<index_type>(blocking_size) };
+                    }
+                }
+            }
+
+            // no candidate fits into the local memory -> keep the default configuration
+            device.knn_local_size = best_config.local_size;
+            device.knn_blocking_size = best_config.blocking_size;
+            device.knn_tuned_k = best_config.local_size == 0 ? 0 : k_search;
+            if (best_config.local_size != 0) {
+                configs.insert_or_assign(key, best_config);
+                new_configs += detail::format_knn_kernel_config(key, best_config);
+            }
+            tuning_log += fmt::format("[{}, {}] tuned local_size: {}, blocking_size: {}\n",
+                                      comm_.rank(), device_name, device.knn_local_size, device.knn_blocking_size);
+        }
+        logger_.log_on_all("{}", tuning_log);
+
+        // gather the newly tuned configurations on the master rank
+        const int new_configs_size = static_cast<int>(new_configs.size());
+        std::vector<int> sizes(comm_.size());
+        MPI_Gather(&new_configs_size, 1, mpi::type_cast<int>(), sizes.data(), 1, mpi::type_cast<int>(), 0, comm_.get());
+        std::vector<int> displacements(comm_.size(), 0);
+        std::partial_sum(sizes.begin(), sizes.end() - 1, displacements.begin() + 1);
+        std::string all_new_configs(comm_.master_rank() ? displacements.back() + sizes.back() : 0, '\0');
+        MPI_Gatherv(new_configs.data(), new_configs_size, mpi::type_cast<char>(), all_new_configs.data(), sizes.data(), displacements.data(),
+                    mpi::type_cast<char>(), 0, comm_.get());
+
+        // update the cache file
+        if (comm_.master_rank() && !all_new_configs.empty()) {
+            std::istringstream in(all_new_configs);
+            detail::read_knn_kernel_configs(in, tuning_file, configs);
+            detail::write_knn_kernel_configs(tuning_file, configs);
+        }
+
+        logger_.log("Tuned the kNN kernel in {}.\n", t.elapsed());
+        profiler_.report("tuning the kNN kernel");
+#endif
+    }
+
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_RING || SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_ring(data_type& queries, const index_type k, knn_type& knns) {
+        const data_attributes_type query_attr = queries.get_attributes();
+        // only the own data points have cached hash values and can be their own nearest-neighbors
+        const bool is_self_join = &queries == &data_;
+        // the data points are received and sent using the first device
+        sycl::queue& queue = devices_.front().queue;
+        data_device_buffer_type data_device_buffer = queries.get_device_buffer();
+#if defined(SYCL_LSH_GPU_AWARE_MPI)
+        // the device buffer containing the data received from the previous rank (reused in all rounds)
+        data_device_buffer_type received_data_device_buffer(queries.get_host_buffer().size());
+        memory_.allocate("received data points", received_data_device_buffer.get_size());
+
+        // the k-nearest-neighbors stay on the device during all rounds (and afterwards until they are requested on the host)
+        knn_device_buffer_type& knn_buffer = knns.get_knn_device_buffer();
+        knn_dist_device_buffer_type& knn_dist_buffer = knns.get_distance_device_buffer();
+        memory_.allocate("k-nearest-neighbors", knn_buffer.get_size() + knn_dist_buffer.get_size());
+
+        // the USM device buffers directly passed to the CUDA/ROCm-aware MPI implementation
+        detail::device_ring_buffer<typename data_type::storage_type> data_ring_buffer(queries.get_host_buffer().size(), queue, comm_, 0, mpi::communication_kind::ring_data);
+        detail::device_ring_buffer<id_type> knn_ring_buffer(knn_buffer.get_count(), queue, comm_, 1, mpi::communication_kind::ring_knn);
+        detail::device_ring_buffer<real_type> knn_dist_ring_buffer(knn_dist_buffer.get_count(), queue, comm_, 2, mpi::communication_kind::ring_knn);
+        memory_.allocate("device ring buffers", 2 * (received_data_device_buffer.get_size() + knn_buffer.get_size() + knn_dist_buffer.get_size()));
+#else
+        // in the out-of-core mode the received data points and their k-nearest-neighbors are streamed chunk-wise through the device
+        // using a pipeline of staging buffers (reused in all rounds) and a separate queue for the transfers
+        const bool is_chunked = query_chunk_size_ > 0;
+        std::vector<query_chunk> chunks;
+        if (is_chunked) {
+            chunks = this->make_query_chunks(query_attr, k);
+            memory_.allocate("query chunk staging buffers", num_query_chunks * (chunks.front().data_buffer.get_size() + chunks.front().knn_buffer.get_size()
+                                                                                + chunks.front().knn_dist_buffer.get_size()));
+        }
+        sycl::queue transfer_queue(queue.get_context(), queue.get_device(), sycl::async_handler(&sycl_exception_handler),
+                                   detail::device_profiler::queue_properties());
+        // the device buffer containing the data received from the previous rank (reused in all rounds, not needed in the out-of-core mode)
+        data_device_buffer_type received_data_device_buffer(is_chunked ? 1 : queries.get_host_buffer().size());
+        if (!is_chunked) {
+            memory_.allocate("received data points", received_data_device_buffer.get_size());
+            memory_.allocate("k-nearest-neighbors (per round)", knns.get_knn_host_buffer().size() * sizeof(id_type)
+                                                                + knns.get_distance_host_buffer().size() * sizeof(real_type));
+        }
+#endif
+
+        for (int round = 0; round < comm_.size(); ++round) {
+            mpi::timer rt(comm_);
+            // the MPI rank owning the data points of the current round
+            const int data_rank = (comm_.rank() + comm_.size() - round) % comm_.size();
+
+            logger_.log("Round {} of {} ... ", round + 1, comm_.size());
+            profiler_.set_round(round);
+            mpi::communication_profiler::set_round(round);
+
+#if defined(SYCL_LSH_GPU_AWARE_MPI)
+            // start sending the data of the current round to the next rank while calculating the k-nearest-neighbors
+            data_ring_buffer.start_send_receive(data_device_buffer);
+
+            // calculate k-nearest-neighbors on current MPI rank
+            calculate_knn_round(k, data_device_buffer, query_attr, 0, query_attr.correct_rank_size(data_rank), knn_buffer, knn_dist_buffer, is_self_join && round == 0);
+
+            // start sending the calculated k-nearest-neighbors and distances to next rank
+            knn_ring_buffer.start_send_receive(knn_buffer);
+            knn_dist_ring_buffer.start_send_receive(knn_dist_buffer);
+
+            // wait for the data of the next round
+            auto wait_start = std::chrono::steady_clock::now();
+            data_ring_buffer.finish_send_receive(received_data_device_buffer);
+            data_device_buffer = received_data_device_buffer;
+
+            // wait until the k-nearest-neighbors of the next round have been received
+            knn_ring_buffer.finish_send_receive(knn_buffer);
+            knn_dist_ring_buffer.finish_send_receive(knn_dist_buffer);
+            const auto wait_time = std::chrono::steady_clock::now() - wait_start;
+#else
+            // start sending the data of the current round to the next rank while calculating the k-nearest-neighbors
+            queries.start_send_receive_host_buffer();
+
+            // calculate k-nearest-neighbors on current MPI rank
+            if (is_chunked) {
+                this->calculate_knn_round_chunked(queries, k, chunks, transfer_queue, query_attr.correct_rank_size(data_rank), knns, is_self_join && round == 0);
+            } else {
+                calculate_knn_round(k, data_device_buffer, query_attr.correct_rank_size(data_rank), knns, is_self_join && round == 0);
+            }
+
+            // start sending the calculated k-nearest-neighbors and distances to next rank
+            knns.start_send_receive_host_buffer();
+
+            // wait for the data of the next round and copy it to the device while the k-nearest-neighbors are still being sent
+            auto wait_start = std::chrono::steady_clock::now();
+            queries.finish_send_receive_host_buffer();
+            auto wait_time = std::chrono::steady_clock::now() - wait_start;
+            if (!is_chunked && round + 1 < comm_.size()) {
+                profiler_.record(detail::profiled_command::copy_to_device, queue.submit([&](sycl::handler& cgh) {
+                    auto acc = received_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.copy(queries.get_host_buffer().data(), acc);
+                }));
+                data_device_buffer = received_data_device_buffer;
+            }
+
+            // wait until the k-nearest-neighbors of the next round have been received
+            wait_start = std::chrono::steady_clock::now();
+            knns.finish_send_receive_host_buffer();
+            wait_time += std::chrono::steady_clock::now() - wait_start;
+#endif
+
+            logger_.log("finished in {} (waited {} for MPI communication).\n",
+                        rt.elapsed(), std::chrono::duration_cast<std::chrono::milliseconds>(wait_time));
+        }
+
+#if defined(SYCL_LSH_GPU_AWARE_MPI)
+        // the final k-nearest-neighbors stay device-resident in knns (copied to the host only if requested)
+        queue.wait_and_throw();
+        memory_.release("device ring buffers");
+#else
+        memory_.release("query chunk staging buffers");
+        memory_.release("k-nearest-neighbors (per round)");
+#endif
+        memory_.release("received data points");
+    }
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_STATIONARY_RING
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_stationary_ring(data_type& queries, const index_type k, knn_type& knns) {
+        using candidate_type = mpi::top_k_candidate<real_type, id_type>;
+
+        const data_attributes_type query_attr = queries.get_attributes();
+        // only the own data points have cached hash values and can be their own nearest-neighbors
+        const bool is_self_join = &queries == &data_;
+        // the data points are received using the first device
+        sycl::queue& queue = devices_.front().queue;
+        data_device_buffer_type data_device_buffer = queries.get_device_buffer();
+        // get get_linear_id functor instantiation
+        const get_linear_id<knn_type> get_linear_id_knn{};
+
+        // the device buffer containing the data received from the previous rank (reused in all rounds)
+        data_device_buffer_type received_data_device_buffer(queries.get_host_buffer().size());
+        memory_.allocate("received data points", received_data_device_buffer.get_size());
+        // the k-nearest-neighbors of the current round (reused in all rounds)
+        const std::size_t list_size = static_cast<std::size_t>(query_attr.rank_size) * k;
+        knn_device_buffer_type knn_buffer(list_size);
+        knn_dist_device_buffer_type knn_dist_buffer(list_size);
+        memory_.allocate("k-nearest-neighbors (per round)", knn_buffer.get_size() + knn_dist_buffer.get_size());
+
+        // the sorted partial k-nearest-neighbors of the queries of all MPI ranks (grouped by the MPI rank owning the queries)
+        std::vector<candidate_type> partial_knns(comm_.size() * list_size);
+
+        // the own queries start with the placeholders of knns, the foreign queries with invalid IDs
+        const auto initialize_round_knns = [&](const bool is_own_queries) {
+            if (is_own_queries) {
+                profiler_.record(detail::profiled_command::copy_to_device, queue.submit([&](sycl::handler& cgh) {
+                    auto acc_knn = knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.copy(knns.get_knn_host_buffer().data(), acc_knn);
+                }));
+            } else {
+                queue.submit([&](sycl::handler& cgh) {
+                    auto acc_knn = knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.fill(acc_knn, std::numeric_limits<id_type>::max());
+                });
+            }
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.fill(acc_knn_dist, std::numeric_limits<real_type>::max());
+            });
+        };
+        // keep the sorted partial k-nearest-neighbors of the queries owned by data_rank (overlaps the MPI communication)
+        const auto keep_partial_knns = [&](const int data_rank) {
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read>();
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read>();
+            candidate_type* round_knns = partial_knns.data() + data_rank * list_size;
+            #if defined(_OPENMP)
+            #pragma omp parallel for schedule(static)
+            #endif
+            for (index_type point = 0; point < query_attr.rank_size; ++point) {
+                candidate_type* point_knns = round_knns + static_cast<std::size_t>(point) * k;
+                for (index_type nn = 0; nn < k; ++nn) {
+                    point_knns[nn] = candidate_type{ acc_knn_dist[get_linear_id_knn(point, nn, query_attr, k)], acc_knn[get_linear_id_knn(point, nn, query_attr, k)] };
+                }
+                std::sort(point_knns, point_knns + k);
+            }
+        };
+
+        // the number of consecutive MPI ranks replicating their data points (divides the number of MPI ranks, checked in the constructors)
+#if defined(SYCL_LSH_REPLICATION_FACTOR)
+        const int replication_factor = SYCL_LSH_REPLICATION_FACTOR;
+#else
+        const int replication_factor = 1;
+#endif
+
+        if (replication_factor > 1) {
+            using storage_type = typename data_type::storage_type;
+            const int num_rounds = comm_.size() / replication_factor;
+            // the group of consecutive MPI ranks the current MPI rank belongs to
+            const int group = comm_.rank() / replication_factor;
+            // the data points are sent to the MPI rank with the same position in the next group
+            const int destination = (comm_.rank() + replication_factor) % comm_.size();
+            const int source = (comm_.rank() + comm_.size() - replication_factor) % comm_.size();
+
+            // gather the data points of all MPI ranks of the own group once
+            mpi::timer gt(comm_);
+            const std::size_t partition_size = queries.get_host_buffer().size();
+            data_host_buffer_type group_host_buffer(replication_factor * partition_size);
+            data_host_buffer_type received_group_host_buffer(group_host_buffer.size());
+            {
+                MPI_Comm group_communicator;
+                MPI_Comm_split(comm_.get(), group, comm_.rank(), &group_communicator);
+                const mpi::communicator group_comm(group_communicator, true);
+                const auto gather_start = mpi::communication_profiler::clock::now();
+                MPI_Allgather(queries.get_host_buffer().data(), partition_size, mpi::type_cast<storage_type>(),
+                              group_host_buffer.data(), partition_size, mpi::type_cast<storage_type>(), group_comm.get());
+                const std::size_t bytes = (replication_factor - 1) * partition_size * sizeof(storage_type);
+                mpi::communication_profiler::record_blocking(mpi::communication_kind::ring_data, bytes, bytes, gather_start);
+            }
+            logger_.log("Replicated the data points of {} consecutive MPI ranks in {}.\n", replication_factor, gt.elapsed());
+
+            for (int round = 0; round < num_rounds; ++round) {
+                mpi::timer rt(comm_);
+                // the group owning the data points of the current round
+                const int data_group = (group + num_rounds - round) % num_rounds;
+
+                logger_.log("Round {} of {} ... ", round + 1, num_rounds);
+                profiler_.set_round(round);
+                mpi::communication_profiler::set_round(round);
+
+                // start sending the data of the current round to the next group while calculating the k-nearest-neighbors
+                std::array<MPI_Request, 2> requests = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+                const auto send_receive_start = mpi::communication_profiler::clock::now();
+                if (round + 1 < num_rounds) {
+                    MPI_Irecv(received_group_host_buffer.data(), received_group_host_buffer.size(), mpi::type_cast<storage_type>(), source, 0, comm_.get(), &requests[0]);
+                    MPI_Isend(group_host_buffer.data(), group_host_buffer.size(), mpi::type_cast<storage_type>(), destination, 0, comm_.get(), &requests[1]);
+                }
+                const double mpi_time = mpi::communication_profiler::elapsed(send_receive_start);
+
+                // calculate k-nearest-neighbors of the data points of all MPI ranks in the group on current MPI rank
+                for (int replica = 0; replica < replication_factor; ++replica) {
+                    const int data_rank = data_group * replication_factor + replica;
+                    const bool is_own_data = data_rank == comm_.rank();
+
+                    // the own data points already reside on the device
+                    data_device_buffer_type replica_device_buffer = data_device_buffer;
+                    if (!is_own_data) {
+                        profiler_.record(detail::profiled_command::copy_to_device, queue.submit([&](sycl::handler& cgh) {
+                            auto acc = received_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                            cgh.copy(group_host_buffer.data() + replica * partition_size, acc);
+                        }));
+                        replica_device_buffer = received_data_device_buffer;
+                    }
+
+                    initialize_round_knns(is_own_data);
+                    calculate_knn_round(k, replica_device_buffer, query_attr, 0, query_attr.correct_rank_size(data_rank), knn_buffer, knn_dist_buffer, is_self_join && is_own_data);
+                    keep_partial_knns(data_rank);
+                }
+
+                // wait for the data of the next round
+                const auto wait_start = std::chrono::steady_clock::now();
+                MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+                const auto wait_time = std::chrono::steady_clock::now() - wait_start;
+                if (round + 1 < num_rounds) {
+                    const std::size_t bytes = group_host_buffer.size() * sizeof(storage_type);
+                    const double wait_ms = std::chrono::duration<double, std::milli>(wait_time).count();
+                    mpi::communication_profiler::record(mpi::communication_kind::ring_data, bytes, bytes, mpi_time + wait_ms, wait_ms,
+                                                        mpi::communication_profiler::elapsed(send_receive_start));
+                    std::swap(group_host_buffer, received_group_host_buffer);
+                }
+
+                logger_.log("finished in {} (waited {} for MPI communication).\n",
+                            rt.elapsed(), std::chrono::duration_cast<std::chrono::milliseconds>(wait_time));
+            }
+        } else {
+            for (int round = 0; round < comm_.size(); ++round) {
+                mpi::timer rt(comm_);
+                // the MPI rank owning the data points of the current round
+                const int data_rank = (comm_.rank() + comm_.size() - round) % comm_.size();
+
+                logger_.log("Round {} of {} ... ", round + 1, comm_.size());
+                profiler_.set_round(round);
+                mpi::communication_profiler::set_round(round);
+
+                // start sending the data of the current round to the next rank while calculating the k-nearest-neighbors
+                queries.start_send_receive_host_buffer();
+
+                // calculate k-nearest-neighbors on current MPI rank
+                initialize_round_knns(round == 0);
+                calculate_knn_round(k, data_device_buffer, query_attr, 0, query_attr.correct_rank_size(data_rank), knn_buffer, knn_dist_buffer, is_self_join && round == 0);
+                keep_partial_knns(data_rank);
+
+                // wait for the data of the next round and copy it to the device
+                const auto wait_start = std::chrono::steady_clock::now();
+                queries.finish_send_receive_host_buffer();
+                const auto wait_time = std::chrono::steady_clock::now() - wait_start;
+                if (round + 1 < comm_.size()) {
+                    profiler_.record(detail::profiled_command::copy_to_device, queue.submit([&](sycl::handler& cgh) {
+                        auto acc = received_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                        cgh.copy(queries.get_host_buffer().data(), acc);
+                    }));
+                    data_device_buffer = received_data_device_buffer;
+                }
+
+                logger_.log("finished in {} (waited {} for MPI communication).\n",
+                            rt.elapsed(), std::chrono::duration_cast<std::chrono::milliseconds>(wait_time));
+            }
+        }
+        memory_.release("received data points");
+        memory_.release("k-nearest-neighbors (per round)");
+
+        // merge the partial k-nearest-neighbors at the MPI ranks owning the queries
+        mpi::timer mt(comm_);
+        const std::vector<candidate_type> merged_knns = mpi::reduce_scatter_top_k(partial_knns, k, comm_);
+
+        // save the k-nearest-neighbors in descending order of their distances
+        typename knn_type::knn_host_buffer_type& knn_ids = knns.get_knn_host_buffer();
+        typename knn_type::dist_host_buffer_type& knn_dists = knns.get_distance_host_buffer();
+        for (index_type point = 0; point < query_attr.rank_size; ++point) {
+            const candidate_type* point_knns = merged_knns.data() + static_cast<std::size_t>(point) * k;
+            for (index_type nn = 0; nn < k; ++nn) {
+                knn_ids[get_linear_id_knn(point, nn, query_attr, k)] = point_knns[k - 1 - nn].id;
+                knn_dists[get_linear_id_knn(point, nn, query_attr, k)] = point_knns[k - 1 - nn].dist;
+            }
+        }
+        logger_.log("Merged the partial k-nearest-neighbor lists in {}.\n", mt.elapsed());
+    }
+#endif
+#if !defined(SYCL_LSH_GPU_AWARE_MPI)
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    std::vector<typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::query_chunk>
+    sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::make_query_chunks(const data_attributes_type& query_attr, const index_type k) const {
+        const index_type chunk_size = std::min<index_type>(query_chunk_size_, query_attr.rank_size);
+
+        std::vector<query_chunk> chunks;
+        chunks.reserve(num_query_chunks);
+        for (std::size_t i = 0; i < num_query_chunks; ++i) {
+            chunks.push_back(query_chunk{ data_host_buffer_type(chunk_size * query_attr.dims),
+                                          typename knn_type::knn_host_buffer_type(chunk_size * k),
+                                          typename knn_type::dist_host_buffer_type(chunk_size * k),
+                                          data_device_buffer_type(chunk_size * query_attr.dims),
+                                          knn_device_buffer_type(chunk_size * k),
+                                          knn_dist_device_buffer_type(chunk_size * k),
+                                          std::vector<sycl::event>{} });
+        }
+        return chunks;
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_chunked(data_type& queries, const index_type k, std::vector<query_chunk>& chunks,
+                                                                                                   sycl::queue& transfer_queue, const index_type num_queries,
+                                                                                                   knn_type& knns, const bool is_own_data) {
+        // the chunks are searched using the first device
+        sycl::queue& queue = devices_.front().queue;
+        const data_attributes_type query_attr = queries.get_attributes();
+        const index_type chunk_size = std::min<index_type>(query_chunk_size_, query_attr.rank_size);
+        const data_attributes_type chunk_attr(query_attr.total_size, chunk_size, query_attr.dims);
+        const index_type num_chunks = (num_queries + chunk_size - 1) / chunk_size;
+        // get get_linear_id functor instantiation
+        const get_linear_id<data_type> get_linear_id_data{};
+        const get_linear_id<knn_type> get_linear_id_knn{};
+
+        const data_host_buffer_type& host_buffer = queries.get_host_buffer();
+        typename knn_type::knn_host_buffer_type& knn_host_buffer = knns.get_knn_host_buffer();
+        typename knn_type::dist_host_buffer_type& knn_dist_host_buffer = knns.get_distance_host_buffer();
+        const auto queries_of_chunk = [&](const index_type chunk) { return std::min<index_type>(chunk_size, num_queries - chunk * chunk_size); };
+
+        // gathers the queries of the given chunk and their k-nearest-neighbors and starts copying them to the device
+        const auto upload_chunk = [&](const index_type chunk, query_chunk& staging) {
+            const index_type first_query = chunk * chunk_size;
+            const index_type chunk_queries = queries_of_chunk(chunk);
+            for (index_type point = 0; point < chunk_queries; ++point) {
+                for (index_type dim = 0; dim < query_attr.dims; ++dim) {
+                    staging.data_host_buffer[get_linear_id_data(point, dim, chunk_attr)] = host_buffer[get_linear_id_data(first_query + point, dim, query_attr)];
+                }
+                for (index_type nn = 0; nn < k; ++nn) {
+                    staging.knn_host_buffer[get_linear_id_knn(point, nn, chunk_attr, k)] = knn_host_buffer[get_linear_id_knn(first_query + point, nn, query_attr, k)];
+                    staging.knn_dist_host_buffer[get_linear_id_knn(point, nn, chunk_attr, k)] = knn_dist_host_buffer[get_linear_id_knn(first_query + point, nn, query_attr, k)];
+                }
+            }
+            profiler_.record(detail::profiled_command::copy_to_device, transfer_queue.submit([&](sycl::handler& cgh) {
+                auto acc = staging.data_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(staging.data_host_buffer.data(), acc);
+            }));
+            profiler_.record(detail::profiled_command::copy_to_device, transfer_queue.submit([&](sycl::handler& cgh) {
+                auto acc = staging.knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(staging.knn_host_buffer.data(), acc);
+            }));
+            profiler_.record(detail::profiled_command::copy_to_device, transfer_queue.submit([&](sycl::handler& cgh) {
+                auto acc = staging.knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(staging.knn_dist_host_buffer.data(), acc);
+            }));
+        };
+        // starts copying the updated k-nearest-neighbors of the given chunk back to its host staging buffers
+        const auto download_chunk = [&](query_chunk& staging) {
+            staging.download_events.clear();
+            staging.download_events.push_back(transfer_queue.submit([&](sycl::handler& cgh) {
+                auto acc = staging.knn_buffer.template get_access<sycl::access::mode::read>(cgh);
+                cgh.copy(acc, staging.knn_host_buffer.data());
+            }));
+            staging.download_events.push_back(transfer_queue.submit([&](sycl::handler& cgh) {
+                auto acc = staging.knn_dist_buffer.template get_access<sycl::access::mode::read>(cgh);
+                cgh.copy(acc, staging.knn_dist_host_buffer.data());
+            }));
+            for (const sycl::event& event : staging.download_events) {
+                profiler_.record(detail::profiled_command::copy_to_host, event);
+            }
+        };
+        // waits for the download of the given chunk and scatters its k-nearest-neighbors to the host buffers of the current round
+        const auto scatter_chunk = [&](const index_type chunk, query_chunk& staging) {
+            sycl::event::wait_and_throw(staging.download_events);
+            const index_type first_query = chunk * chunk_size;
+            const index_type chunk_queries = queries_of_chunk(chunk);
+            for (index_type point = 0; point < chunk_queries; ++point) {
+                for (index_type nn = 0; nn < k; ++nn) {
+                    knn_host_buffer[get_linear_id_knn(first_query + point, nn, query_attr, k)] = staging.knn_host_buffer[get_linear_id_knn(point, nn, chunk_attr, k)];
+                    knn_dist_host_buffer[get_linear_id_knn(first_query + point, nn, query_attr, k)] = staging.knn_dist_host_buffer[get_linear_id_knn(point, nn, chunk_attr, k)];
+                }
+            }
+        };
+
+        if (num_chunks > 0) {
+            upload_chunk(0, chunks[0]);
+        }
+        for (index_type chunk = 0; chunk < num_chunks; ++chunk) {
+            query_chunk& current = chunks[chunk % num_query_chunks];
+
+            // submit the search of the current chunk (waits for its upload)
+            this->calculate_knn_round(k, current.data_buffer, chunk_attr, chunk * chunk_size, queries_of_chunk(chunk), current.knn_buffer, current.knn_dist_buffer,
+                                      is_own_data, false);
+
+            // meanwhile upload the next chunk (the previous user of its staging buffers has already been scattered)
+            if (chunk + 1 < num_chunks) {
+                upload_chunk(chunk + 1, chunks[(chunk + 1) % num_query_chunks]);
+            }
+            // and scatter the previous chunk
+            if (chunk > 0) {
+                scatter_chunk(chunk - 1, chunks[(chunk - 1) % num_query_chunks]);
+            }
+
+            // submit the download of the current chunk without blocking: the buffer dependencies let it start once its search has been
+            // finished, while the search of the next chunk is already submitted in the next iteration
+            download_chunk(current);
+        }
+        if (num_chunks > 0) {
+            scatter_chunk(num_chunks - 1, chunks[(num_chunks - 1) % num_query_chunks]);
+        }
+        queue.wait_and_throw();
+    }
+#endif
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_hierarchical_ring(const index_type k, knn_type& knns) {
+        // create a communicator for each node
+        MPI_Comm node_communicator;
+        MPI_Comm_split_type(comm_.get(), MPI_COMM_TYPE_SHARED, comm_.rank(), MPI_INFO_NULL, &node_communicator);
+        const mpi::communicator node_comm(node_communicator, true);
+        // create a communicator for each node-local rank (the nodes are ordered by the world rank of their first MPI rank)
+        int node_id = comm_.rank();
+        MPI_Bcast(&node_id, 1, MPI_INT, 0, node_comm.get());
+        MPI_Comm inter_node_communicator;
+        MPI_Comm_split(comm_.get(), node_comm.rank(), node_id, &inter_node_communicator);
+        const mpi::communicator inter_comm(inter_node_communicator, true);
+
+        // the slots of all nodes are sent around the inter-node ring in parallel -> all nodes must have the same number of MPI ranks
+        if (mpi::min(node_comm.size(), comm_) != mpi::max(node_comm.size(), comm_)) {
+            logger_.log("The nodes have different numbers of MPI ranks! Falling back to the flat ring.\n");
+            this->calculate_knn_ring(data_, k, knns);
+            return;
+        }
+        const int node_size = node_comm.size();
+        const int num_nodes = inter_comm.size();
+        logger_.log("Using a hierarchical ring of {} node(s) with {} MPI rank(s) each.\n", num_nodes, node_size);
+
+        // the world rank of each (node, node-local rank) pair (needed to determine the MPI rank owning the data points of a slot)
+        const int own_slot_id = inter_comm.rank() * node_size + node_comm.rank();
+        std::vector<int> slot_ids(comm_.size());
+        MPI_Allgather(&own_slot_id, 1, MPI_INT, slot_ids.data(), 1, MPI_INT, comm_.get());
+        std::vector<int> slot_world_ranks(comm_.size());
+        for (int world_rank = 0; world_rank < comm_.size(); ++world_rank) {
+            slot_world_ranks[slot_ids[world_rank]] = world_rank;
+        }
+
+        typename data_type::host_buffer_type& data_host_buffer = data_.get_host_buffer();
+        typename knn_type::knn_host_buffer_type& knn_host_buffer = knns.get_knn_host_buffer();
+        typename knn_type::dist_host_buffer_type& knn_dist_host_buffer = knns.get_distance_host_buffer();
+
+        // the shared memory windows containing the data points and the k-nearest-neighbors of all MPI ranks on the current node
+        detail::shared_ring_buffer<typename data_type::storage_type> data_ring_buffer(data_host_buffer.size(), node_comm, inter_comm, 0, mpi::communication_kind::ring_data);
+        detail::shared_ring_buffer<id_type> knn_ring_buffer(knn_host_buffer.size(), node_comm, inter_comm, 1, mpi::communication_kind::ring_knn);
+        detail::shared_ring_buffer<real_type> knn_dist_ring_buffer(knn_dist_host_buffer.size(), node_comm, inter_comm, 2, mpi::communication_kind::ring_knn);
+        std::copy(data_host_buffer.begin(), data_host_buffer.end(), data_ring_buffer.own_slot());
+        std::copy(knn_host_buffer.begin(), knn_host_buffer.end(), knn_ring_buffer.own_slot());
+        std::copy(knn_dist_host_buffer.begin(), knn_dist_host_buffer.end(), knn_dist_ring_buffer.own_slot());
+        data_ring_buffer.synchronize();
+        knn_ring_buffer.synchronize();
+        knn_dist_ring_buffer.synchronize();
+
+        // the data points are copied to the device using the first device
+        sycl::queue& queue = devices_.front().queue;
+        // the device buffer containing the data of the currently processed slot (reused in all rounds)
+        data_device_buffer_type slot_data_device_buffer(data_host_buffer.size());
+
+        for (int node_round = 0; node_round < num_nodes; ++node_round) {
+            // start sending the data of the own slot to the next node while processing all slots of the current node
+            data_ring_buffer.start_send_receive();
+
+            for (int local_round = 0; local_round < node_size; ++local_round) {
+                mpi::timer rt(comm_);
+                const int round = node_round * node_size + local_round;
+
+                logger_.log("Round {} of {} ... ", round + 1, comm_.size());
+                profiler_.set_round(round);
+                mpi::communication_profiler::set_round(round);
+
+                // calculate the k-nearest-neighbors of the current slot directly in the shared memory window
+                const int slot = (node_comm.rank() + local_round) % node_size;
+                const int data_rank = slot_world_ranks[((inter_comm.rank() + num_nodes - node_round) % num_nodes) * node_size + slot];
+                const bool is_own_data = round == 0;
+                data_device_buffer_type data_device_buffer = data_.get_device_buffer();
+                if (!is_own_data) {
+                    profiler_.record(detail::profiled_command::copy_to_device, queue.submit([&](sycl::handler& cgh) {
+                        auto acc = slot_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                        cgh.copy(data_ring_buffer.slot(slot), acc);
+                    }));
+                    data_device_buffer = slot_data_device_buffer;
+                }
+                {
+                    knn_device_buffer_type knn_buffer(knn_ring_buffer.slot(slot), knn_host_buffer.size());
+                    knn_dist_device_buffer_type knn_dist_buffer(knn_dist_ring_buffer.slot(slot), knn_dist_host_buffer.size());
+                    this->calculate_knn_round(k, data_device_buffer, attr_.correct_rank_size(data_rank), knn_buffer, knn_dist_buffer, is_own_data);
+                }
+
+                // wait until all MPI ranks on the current node finished their slots
+                auto wait_start = std::chrono::steady_clock::now();
+                knn_ring_buffer.synchronize();
+                knn_dist_ring_buffer.synchronize();
+                if (local_round + 1 == node_size) {
+                    // send the k-nearest-neighbors of the own slot to the next node and receive the new slot
+                    knn_ring_buffer.start_send_receive();
+                    knn_dist_ring_buffer.start_send_receive();
+                    data_ring_buffer.finish_send_receive();
+                    knn_ring_buffer.finish_send_receive();
+                    knn_dist_ring_buffer.finish_send_receive();
+                    data_ring_buffer.synchronize();
+                    knn_ring_buffer.synchronize();
+                    knn_dist_ring_buffer.synchronize();
+                }
+                const auto wait_time = std::chrono::steady_clock::now() - wait_start;
+
+                logger_.log("finished in {} (waited {} for MPI communication).\n",
+                            rt.elapsed(), std::chrono::duration_cast<std::chrono::milliseconds>(wait_time));
+            }
+        }
+
+        // after a full round trip the own slot contains the final k-nearest-neighbors
+        std::copy(knn_ring_buffer.own_slot(), knn_ring_buffer.own_slot() + knn_host_buffer.size(), knn_host_buffer.begin());
+        std::copy(knn_dist_ring_buffer.own_slot(), knn_dist_ring_buffer.own_slot() + knn_dist_host_buffer.size(), knn_dist_host_buffer.begin());
+    }
+#elif SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_query_routing(const index_type k, knn_type& knns) {
+        mpi::timer t(comm_);
+
+        using storage_type = typename data_type::storage_type;
+        using bitmap_word_type = std::uint64_t;
+        constexpr index_type bits_per_word = std::numeric_limits<bitmap_word_type>::digits;
+
+        const std::size_t comm_size = comm_.size();
+        const std::size_t rank = comm_.rank();
+        // get get_linear_id functor instantiation
+        const get_linear_id<data_type> get_linear_id_data{};
+        const get_linear_id<knn_type> get_linear_id_knn{};
+
+        // publish the non-empty hash buckets of all hash tables as one bitmap per MPI rank
+        const index_type num_buckets = options_.num_hash_tables * options_.hash_table_size;
+        const index_type num_words = (num_buckets + bits_per_word - 1) / bits_per_word;
+        std::vector<bitmap_word_type> occupancy(comm_size * num_words, 0);
+        for (device_context& device : devices_) {
+            bitmap_word_type* own_occupancy = occupancy.data() + rank * num_words;
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+            // all entries except the sentinels are non-empty hash buckets
+            auto acc_directory = device.directory_buffer.template get_access<sycl::access::mode::read>();
+            auto acc_bucket_hash_values = device.bucket_hash_values_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+                for (index_type entry = acc_directory[hash_table]; entry < acc_directory[hash_table + 1] - 1; ++entry) {
+                    const index_type bucket = hash_table * options_.hash_table_size + acc_bucket_hash_values[entry];
+                    own_occupancy[bucket / bits_per_word] |= bitmap_word_type{ 1 } << (bucket % bits_per_word);
+                }
+            }
+#else
+            auto acc_offsets = device.offsets_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+                for (index_type hash_bucket = 0; hash_bucket < options_.hash_table_size; ++hash_bucket) {
+                    const index_type offset = hash_table * (options_.hash_table_size + 1) + hash_bucket;
+                    if (acc_offsets[offset] != acc_offsets[offset + 1]) {
+                        const index_type bucket = hash_table * options_.hash_table_size + hash_bucket;
+                        own_occupancy[bucket / bits_per_word] |= bitmap_word_type{ 1 } << (bucket % bits_per_word);
+                    }
+                }
+            }
+#endif
+        }
+        MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, occupancy.data(), num_words, mpi::type_cast<bitmap_word_type>(), comm_.get());
+
+        // get the hash values of the own data points
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        hash_value_device_buffer_type& hash_values = hash_values_buffer_;
+#else
+        hash_value_device_buffer_type hash_values(options_.num_hash_tables * attr_.rank_size);
+        this->calculate_hash_values(devices_.front().queue, data_.get_device_buffer(), attr_, attr_.correct_rank_size(rank), hash_values);
+#endif
+
+        // route each query only to the MPI ranks having at least one non-empty hash bucket the query is hashed to
+        std::vector<std::vector<index_type>> routed_queries(comm_size);
+        {
+            auto acc_hash_values = hash_values.template get_access<sycl::access::mode::read>();
+            for (std::size_t destination = 0; destination < comm_size; ++destination) {
+                if (destination == rank) continue;
+                const bitmap_word_type* destination_occupancy = occupancy.data() + destination * num_words;
+                for (index_type point = 0; point < attr_.correct_rank_size(rank); ++point) {
+                    if (options_.num_probes > 0) {
+                        // the probed neighboring hash buckets aren't checked -> route the query to all MPI ranks
+                        routed_queries[destination].push_back(point);
+                        continue;
+                    }
+                    for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+                        const index_type bucket = hash_table * options_.hash_table_size + acc_hash_values[hash_table * attr_.rank_size + point];
+                        if ((destination_occupancy[bucket / bits_per_word] >> (bucket % bits_per_word)) & 1) {
+                            routed_queries[destination].push_back(point);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        std::vector<int> send_counts(comm_size);
+        for (std::size_t destination = 0; destination < comm_size; ++destination) {
+            send_counts[destination] = routed_queries[destination].size();
+        }
+        std::vector<int> recv_counts(comm_size);
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm_.get());
+
+        std::vector<int> send_displs(comm_size);
+        std::vector<int> recv_displs(comm_size);
+        std::exclusive_scan(send_counts.begin(), send_counts.end(), send_displs.begin(), 0);
+        std::exclusive_scan(recv_counts.begin(), recv_counts.end(), recv_displs.begin(), 0);
+        const std::size_t num_send_queries = send_displs.back() + send_counts.back();
+        const std::size_t num_recv_queries = recv_displs.back() + recv_counts.back();
+
+        // all counts and displacements are per query (scaling them by the number of dimensions or k could overflow the int)
+        MPI_Datatype point_type;
+        MPI_Type_contiguous(attr_.dims, mpi::type_cast<storage_type>(), &point_type);
+        MPI_Type_commit(&point_type);
+        MPI_Datatype knn_ids_type;
+        MPI_Type_contiguous(k, mpi::type_cast<id_type>(), &knn_ids_type);
+        MPI_Type_commit(&knn_ids_type);
+        MPI_Datatype knn_dists_type;
+        MPI_Type_contiguous(k, mpi::type_cast<real_type>(), &knn_dists_type);
+        MPI_Type_commit(&knn_dists_type);
+
+        // send the IDs (relative to their MPI rank) and data points of the routed queries
+        std::vector<index_type> send_ids;
+        send_ids.reserve(num_send_queries);
+        for (const std::vector<index_type>& ids : routed_queries) {
+            send_ids.insert(send_ids.end(), ids.begin(), ids.end());
+        }
+        std::vector<index_type> recv_ids(num_recv_queries);
+        MPI_Alltoallv(send_ids.data(), send_counts.data(), send_displs.data(), mpi::type_cast<index_type>(),
+                      recv_ids.data(), recv_counts.data(), recv_displs.data(), mpi::type_cast<index_type>(), comm_.get());
+
+        const data_host_buffer_type& own_data = data_.get_host_buffer();
+        std::vector<storage_type> send_points(num_send_queries * attr_.dims);
+        for (std::size_t i = 0; i < num_send_queries; ++i) {
+            for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                send_points[i * attr_.dims + dim] = own_data[get_linear_id_data(send_ids[i], dim, attr_)];
+            }
+        }
+        std::vector<storage_type> recv_points(num_recv_queries * attr_.dims);
+        MPI_Alltoallv(send_points.data(), send_counts.data(), send_displs.data(), point_type,
+                      recv_points.data(), recv_counts.data(), recv_displs.data(), point_type, comm_.get());
+
+        const std::uint64_t num_routed_queries = mpi::sum(static_cast<std::uint64_t>(num_send_queries), comm_);
+        const std::uint64_t num_ring_queries = mpi::sum(static_cast<std::uint64_t>(attr_.rank_size) * (comm_size - 1), comm_);
+        logger_.log("Routed {} of {} queries ({:.2f}%) to remote MPI ranks in {}.\n", num_routed_queries, num_ring_queries,
+                    num_ring_queries == 0 ? 0.0 : 100.0 * num_routed_queries / num_ring_queries, t.elapsed());
+
+        // calculate the k-nearest-neighbors of the own queries
+        mpi::timer ct(comm_);
+        this->calculate_knn_round(k, data_.get_device_buffer(), attr_.correct_rank_size(rank), knns, true);
+
+        // calculate the partial k-nearest-neighbors of all received queries at once, i.e. only the routed queries are uploaded and searched
+        std::vector<id_type> send_knn_ids(num_recv_queries * k);
+        std::vector<real_type> send_knn_dists(num_recv_queries * k);
+        if (num_recv_queries > 0) {
+            // the received queries are packed densely (grouped by the MPI rank they originate from)
+            const data_attributes_type recv_attr(attr_.total_size, num_recv_queries, attr_.dims);
+            data_host_buffer_type received_data(num_recv_queries * attr_.dims);
+            // use the queries themselves as placeholder nearest-neighbors (as in the ring)
+            std::vector<id_type> knn_ids(num_recv_queries * k);
+            for (std::size_t source = 0; source < comm_size; ++source) {
+                const id_type source_base_id = attr_.first_id(source);
+                for (index_type i = recv_displs[source]; i < static_cast<index_type>(recv_displs[source] + recv_counts[source]); ++i) {
+                    for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                        received_data[get_linear_id_data(i, dim, recv_attr)] = recv_points[static_cast<std::size_t>(i) * attr_.dims + dim];
+                    }
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        knn_ids[get_linear_id_knn(i, nn, recv_attr, k)] = source_base_id + recv_ids[i];
+                    }
+                }
+            }
+            data_device_buffer_type received_data_device_buffer(received_data.size());
+            profiler_.record(detail::profiled_command::copy_to_device, devices_.front().queue.submit([&](sycl::handler& cgh) {
+                auto acc = received_data_device_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(received_data.data(), acc);
+            }));
+            knn_device_buffer_type knn_buffer(knn_ids.begin(), knn_ids.end());
+            knn_dist_device_buffer_type knn_dist_buffer(knn_ids.size());
+            devices_.front().queue.submit([&](sycl::handler& cgh) {
+                auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.fill(acc_knn_dist, std::numeric_limits<real_type>::max());
+            });
+
+            this->calculate_knn_round(k, received_data_device_buffer, recv_attr, 0, num_recv_queries, knn_buffer, knn_dist_buffer, false);
+
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read>();
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_recv_queries; ++i) {
+                for (index_type nn = 0; nn < k; ++nn) {
+                    send_knn_ids[i * k + nn] = acc_knn[get_linear_id_knn(i, nn, recv_attr, k)];
+                    send_knn_dists[i * k + nn] = acc_knn_dist[get_linear_id_knn(i, nn, recv_attr, k)];
+                }
+            }
+        }
+        logger_.log("Calculated the k-nearest-neighbors of the own and the routed queries in {}.\n", ct.elapsed());
+
+        // send the partial k-nearest-neighbors back to the MPI ranks owning their queries
+        mpi::timer mt(comm_);
+        std::vector<id_type> recv_knn_ids(num_send_queries * k);
+        std::vector<real_type> recv_knn_dists(num_send_queries * k);
+        MPI_Alltoallv(send_knn_ids.data(), recv_counts.data(), recv_displs.data(), knn_ids_type,
+                      recv_knn_ids.data(), send_counts.data(), send_displs.data(), knn_ids_type, comm_.get());
+        MPI_Alltoallv(send_knn_dists.data(), recv_counts.data(), recv_displs.data(), knn_dists_type,
+                      recv_knn_dists.data(), send_counts.data(), send_displs.data(), knn_dists_type, comm_.get());
+        MPI_Type_free(&point_type);
+        MPI_Type_free(&knn_ids_type);
+        MPI_Type_free(&knn_dists_type);
+
+        // merge the partial k-nearest-neighbors (each candidate is owned by exactly one MPI rank -> no duplicates)
+        typename knn_type::knn_host_buffer_type& knn_ids = knns.get_knn_host_buffer();
+        typename knn_type::dist_host_buffer_type& knn_dists = knns.get_distance_host_buffer();
+        std::vector<std::size_t> next_routed_query(comm_size, 0);
+        std::vector<std::pair<real_type, id_type>> merged_knns;
+        for (index_type point = 0; point < attr_.rank_size; ++point) {
+            merged_knns.clear();
+            for (index_type nn = 0; nn < k; ++nn) {
+                merged_knns.emplace_back(knn_dists[get_linear_id_knn(point, nn, attr_, k)], knn_ids[get_linear_id_knn(point, nn, attr_, k)]);
+            }
+            for (std::size_t destination = 0; destination < comm_size; ++destination) {
+                std::size_t& pos = next_routed_query[destination];
+                if (pos < routed_queries[destination].size() && routed_queries[destination][pos] == point) {
+                    const std::size_t offset = (send_displs[destination] + pos) * k;
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        merged_knns.emplace_back(recv_knn_dists[offset + nn], recv_knn_ids[offset + nn]);
+                    }
+                    ++pos;
+                }
+            }
+            std::partial_sort(merged_knns.begin(), merged_knns.begin() + k, merged_knns.end());
+
+            // save the k-nearest-neighbors in descending order of their distances
+            for (index_type nn = 0; nn < k; ++nn) {
+                knn_ids[get_linear_id_knn(point, nn, attr_, k)] = merged_knns[k - 1 - nn].second;
+                knn_dists[get_linear_id_knn(point, nn, attr_, k)] = merged_knns[k - 1 - nn].first;
+            }
+        }
+        logger_.log("Merged the partial k-nearest-neighbor lists in {}.\n", mt.elapsed());
+    }
+#endif
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const index_type num_queries,
+                                                                                           knn_type& knns, const bool is_own_data) {
+        // the k-nearest-neighbors stay device-resident until they are requested on the host
+        knn_device_buffer_type& knn_buffer = knns.get_knn_device_buffer();
+        knn_dist_device_buffer_type& knn_dist_buffer = knns.get_distance_device_buffer();
+
+        this->calculate_knn_round(k, data_buffer, knns.get_attributes(), 0, num_queries, knn_buffer, knn_dist_buffer, is_own_data);
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const index_type num_queries,
+                                                                                           knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer,
+                                                                                           const bool is_own_data) {
+        this->calculate_knn_round(k, data_buffer, attr_, 0, num_queries, knn_buffer, knn_dist_buffer, is_own_data);
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round(const index_type k, data_device_buffer_type& data_buffer, const data_attributes_type& query_attr,
+                                                                                           const index_type first_query, const index_type num_queries,
+                                                                                           knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer,
+                                                                                           const bool is_own_data, const bool wait) {
+        if (num_queries == 0) {
+            // only dummy points -> nothing to do
+            return;
+        }
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        // the candidates are counted per query (a separate query set may contain more data points per MPI rank than the data set)
+        for (device_context& device : devices_) {
+            if (device.candidate_count_buffer.get_count() < 3 * query_attr.rank_size) {
+                device.candidate_count_buffer = device_buffer_type(3 * query_attr.rank_size);
+            }
+        }
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        for (device_context& device : devices_) {
+            if (device.fingerprint_count_buffer.get_count() < 2 * query_attr.rank_size) {
+                device.fingerprint_count_buffer = device_buffer_type(2 * query_attr.rank_size);
+            }
+        }
+#endif
+        for (device_context& device : devices_) {
+            if (device.searched_tables_buffer.get_count() < query_attr.rank_size) {
+                device.searched_tables_buffer = device_buffer_type(query_attr.rank_size);
+            }
+        }
+
+        // performs the k-nearest-neighbor search in the hash tables of the given device
+        const auto calculate_knn_round_on_device = [&](device_context& device, knn_device_buffer_type& device_knn_buffer, knn_dist_device_buffer_type& device_knn_dist_buffer) {
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY
+            [[maybe_unused]] const sycl::event event = this->calculate_knn_round_per_query(device, k, data_buffer, query_attr, first_query, num_queries,
+                                                                                           device_knn_buffer, device_knn_dist_buffer, is_own_data);
+#elif SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+            this->calculate_knn_round_per_bucket(device, k, data_buffer, query_attr, first_query, num_queries, device_knn_buffer, device_knn_dist_buffer, is_own_data);
+#endif
+        };
+
+        // the number of queries searched by the devices (the remaining ones are searched by the host device)
+        index_type num_device_queries = num_queries;
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        if (devices_.size() == 1) {
+            num_device_queries = num_queries - std::min<index_type>(static_cast<index_type>(host_share_ * num_queries), num_queries - 1);
+        }
+#endif
+
+        if (devices_.size() == 1 && num_device_queries < num_queries) {
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+            this->calculate_knn_round_co_executed(k, data_buffer, query_attr, first_query, num_device_queries, num_queries - num_device_queries,
+                                                  knn_buffer, knn_dist_buffer, is_own_data);
+#endif
+        } else if (devices_.size() == 1) {
+            calculate_knn_round_on_device(devices_.front(), knn_buffer, knn_dist_buffer);
+        } else {
+            // each device only finds the nearest-neighbors among its own data points
+            // -> start with empty nearest-neighbor lists on all devices and merge them with the already calculated ones afterwards
+            std::vector<knn_device_buffer_type> device_knn_buffers;
+            std::vector<knn_dist_device_buffer_type> device_knn_dist_buffers;
+            for (device_context& device : devices_) {
+                knn_device_buffer_type& device_knn_buffer = device_knn_buffers.emplace_back(knn_buffer.get_count());
+                knn_dist_device_buffer_type& device_knn_dist_buffer = device_knn_dist_buffers.emplace_back(knn_dist_buffer.get_count());
+                // keep the IDs (as placeholders) to prevent the candidates of previous rounds from being added again
+                device.queue.submit([&](sycl::handler& cgh) {
+                    auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_device_knn = device_knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.copy(acc_knn, acc_device_knn);
+                });
+                device.queue.submit([&](sycl::handler& cgh) {
+                    auto acc_device_knn_dist = device_knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.fill(acc_device_knn_dist, std::numeric_limits<real_type>::max());
+                });
+
+                calculate_knn_round_on_device(device, device_knn_buffer, device_knn_dist_buffer);
+            }
+
+            // wait until all k-nearest-neighbors were calculated on all devices of the current MPI rank
+            this->wait_and_throw();
+
+            // merge the k-nearest-neighbors of all devices (each candidate is owned by exactly one device -> no duplicates)
+            const get_linear_id<knn_type> get_linear_id_knn{};
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>();
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>();
+            std::vector<std::pair<real_type, id_type>> merged_knns;
+            for (std::size_t device = 0; device < devices_.size(); ++device) {
+                auto acc_device_knn = device_knn_buffers[device].template get_access<sycl::access::mode::read>();
+                auto acc_device_knn_dist = device_knn_dist_buffers[device].template get_access<sycl::access::mode::read>();
+                for (index_type point = 0; point < num_queries; ++point) {
+                    merged_knns.clear();
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        const index_type idx = get_linear_id_knn(point, nn, query_attr, k);
+                        merged_knns.emplace_back(acc_knn_dist[idx], acc_knn[idx]);
+                        // the placeholders of the device are already contained in the current nearest-neighbors
+                        if (acc_device_knn_dist[idx] != std::numeric_limits<real_type>::max()) {
+                            merged_knns.emplace_back(acc_device_knn_dist[idx], acc_device_knn[idx]);
+                        }
+                    }
+                    std::partial_sort(merged_knns.begin(), merged_knns.begin() + k, merged_knns.end());
+
+                    // save the k-nearest-neighbors in descending order of their distances
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        const index_type idx = get_linear_id_knn(point, nn, query_attr, k);
+                        acc_knn[idx] = merged_knns[k - 1 - nn].second;
+                        acc_knn_dist[idx] = merged_knns[k - 1 - nn].first;
+                    }
+                }
+            }
+        }
+
+        if (!delta_ids_.empty()) {
+            // additionally search the data points inserted after the creation of the hash tables (only supported using a single device,
+            // ordered after the search in the hash tables by the dependencies of the nearest-neighbor buffers)
+            this->calculate_knn_round_delta(k, data_buffer, query_attr, num_queries, knn_buffer, knn_dist_buffer);
+        }
+        if (wait && devices_.size() == 1) {
+            // wait until all k-nearest-neighbors were calculated on the current MPI rank
+            devices_.front().queue.wait_and_throw();
+        }
+
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        // accumulate the number of evaluated and skipped candidates of the current round
+        for (device_context& device : devices_) {
+            auto acc_candidate_count = device.candidate_count_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_device_queries; ++i) {
+                num_candidates_ += acc_candidate_count[i];
+                num_skipped_candidates_ += acc_candidate_count[query_attr.rank_size + i];
+                num_filtered_candidates_ += acc_candidate_count[2 * query_attr.rank_size + i];
+            }
+        }
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        // accumulate the number of candidates skipped due to differing fingerprints of the current round
+        for (device_context& device : devices_) {
+            auto acc_fingerprint_count = device.fingerprint_count_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_device_queries; ++i) {
+                num_fingerprint_candidates_ += acc_fingerprint_count[i];
+                num_fingerprint_filtered_candidates_ += acc_fingerprint_count[query_attr.rank_size + i];
+            }
+        }
+#endif
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY
+        // accumulate the number of searched hash tables of the current round
+        if (options_.early_termination_tables > 0 || options_.early_termination_distance > 0) {
+            for (device_context& device : devices_) {
+                auto acc_searched_tables = device.searched_tables_buffer.template get_access<sycl::access::mode::read>();
+                for (index_type i = 0; i < num_device_queries; ++i) {
+                    num_searched_tables_ += acc_searched_tables[i];
+                }
+                num_searched_queries_ += num_device_queries;
+            }
+        }
+#endif
+    }
+
+#if defined(SYCL_LSH_EXACT_RERANKING)
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::rerank_knns(data_type& queries, const index_type k_candidates, knn_type& candidates,
+                                                                                   const index_type k, knn_type& knns) {
+        mpi::timer t(comm_);
+
+        const data_attributes_type query_attr = queries.get_attributes();
+        // the original data points may have more dimensions than the ones used to search the candidates
+        const index_type dims = data_.get_original_dims();
+        const id_type base_id = attr_.first_id(comm_.rank());
+        const std::size_t comm_size = comm_.size();
+        // get get_linear_id functor instantiation
+        const get_linear_id<knn_type> get_linear_id_knn{};
+
+        // collect the IDs of all candidates of the real queries grouped by the MPI rank owning them
+        const index_type rank_size = query_attr.correct_rank_size(comm_.rank());
+        std::vector<std::vector<id_type>> requested_ids(comm_size);
+        for (index_type point = 0; point < rank_size; ++point) {
+            for (index_type nn = 0; nn < k_candidates; ++nn) {
+                // skip placeholder entries (no candidate found)
+                if (candidates.get_distance_host_buffer()[get_linear_id_knn(point, nn, query_attr, k_candidates)] == std::numeric_limits<real_type>::max()) {
+                    continue;
+                }
+                const id_type id = candidates.get_knn_host_buffer()[get_linear_id_knn(point, nn, query_attr, k_candidates)];
+                requested_ids[id / attr_.rank_size].push_back(id);
+            }
+        }
+        std::vector<int> send_counts(comm_size);
+        for (std::size_t rank = 0; rank < comm_size; ++rank) {
+            std::sort(requested_ids[rank].begin(), requested_ids[rank].end());
+            requested_ids[rank].erase(std::unique(requested_ids[rank].begin(), requested_ids[rank].end()), requested_ids[rank].end());
+            send_counts[rank] = requested_ids[rank].size();
+        }
+        std::vector<int> recv_counts(comm_size);
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm_.get());
+
+        std::vector<int> send_displs(comm_size);
+        std::vector<int> recv_displs(comm_size);
+        std::exclusive_scan(send_counts.begin(), send_counts.end(), send_displs.begin(), 0);
+        std::exclusive_scan(recv_counts.begin(), recv_counts.end(), recv_displs.begin(), 0);
+
+        // send the requested IDs to their owning MPI ranks
+        std::vector<id_type> send_ids;
+        send_ids.reserve(send_displs.back() + send_counts.back());
+        for (const std::vector<id_type>& ids : requested_ids) {
+            send_ids.insert(send_ids.end(), ids.begin(), ids.end());
+        }
+        std::vector<id_type> recv_ids(recv_displs.back() + recv_counts.back());
+        MPI_Alltoallv(send_ids.data(), send_counts.data(), send_displs.data(), mpi::type_cast<id_type>(),
+                      recv_ids.data(), recv_counts.data(), recv_displs.data(), mpi::type_cast<id_type>(), comm_.get());
+
+        // answer with the original data points of the requested IDs
+        std::vector<real_type> send_points(recv_ids.size() * dims);
+        for (std::size_t i = 0; i < recv_ids.size(); ++i) {
+            for (index_type dim = 0; dim < dims; ++dim) {
+                send_points[i * dims + dim] = data_.get_original_value(recv_ids[i] - base_id, dim);
+            }
+        }
+        // the counts and displacements stay per data point (scaling them by the number of dimensions could overflow the int)
+        MPI_Datatype point_type;
+        MPI_Type_contiguous(dims, mpi::type_cast<real_type>(), &point_type);
+        MPI_Type_commit(&point_type);
+        std::vector<real_type> recv_points(send_ids.size() * dims);
+        MPI_Alltoallv(send_points.data(), recv_counts.data(), recv_displs.data(), point_type,
+                      recv_points.data(), send_counts.data(), send_displs.data(), point_type, comm_.get());
+        MPI_Type_free(&point_type);
+
+        // calculate the exact distances and keep the k best candidates
+        std::vector<std::pair<real_type, id_type>> exact_knns(k_candidates);
+        for (index_type point = 0; point < rank_size; ++point) {
+            for (index_type nn = 0; nn < k_candidates; ++nn) {
+                const id_type id = candidates.get_knn_host_buffer()[get_linear_id_knn(point, nn, query_attr, k_candidates)];
+                real_type dist = candidates.get_distance_host_buffer()[get_linear_id_knn(point, nn, query_attr, k_candidates)];
+                // placeholder entries (no candidate found) must keep their distance
+                if (dist != std::numeric_limits<real_type>::max()) {
+                    const std::size_t owner = id / attr_.rank_size;
+                    const std::size_t pos = std::lower_bound(requested_ids[owner].begin(), requested_ids[owner].end(), id) - requested_ids[owner].begin();
+                    const std::size_t offset = (static_cast<std::size_t>(send_displs[owner]) + pos) * dims;
+                    dist = 0.0;
+                    for (index_type dim = 0; dim < dims; ++dim) {
+                        const real_type diff = queries.get_original_value(point, dim) - recv_points[offset + dim];
+                        dist += diff * diff;
+                    }
+                }
+                exact_knns[nn] = std::make_pair(dist, id);
+            }
+            std::partial_sort(exact_knns.begin(), exact_knns.begin() + k, exact_knns.end());
+
+            // save the k-nearest-neighbors in descending order of their distances
+            for (index_type nn = 0; nn < k; ++nn) {
+                knns.get_knn_host_buffer()[get_linear_id_knn(point, nn, query_attr, k)] = exact_knns[k - 1 - nn].second;
+                knns.get_distance_host_buffer()[get_linear_id_knn(point, nn, query_attr, k)] = exact_knns[k - 1 - nn].first;
+            }
+        }
+
+        logger_.log("Re-ranked the {}-nearest-neighbor candidates in {}.\n", k_candidates, t.elapsed());
+    }
+#endif
+
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    sycl_lsh::sycl::event sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_per_query(device_context& device, const index_type k, data_device_buffer_type& data_buffer,
+            const data_attributes_type& query_attr, const index_type first_query, const index_type num_queries,
+            knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data) {
+        // select the kernel instantiation with the (possibly tuned) blocking size of the device and the number of nearest-neighbors
+        sycl::event event;
+        detail::dispatch_knn_blocking_size<options_type::blocking_size>(device.knn_blocking_size, [&](auto blocking_size) {
+            detail::dispatch_knn_k(k, [&](auto static_k) {
+                event = this->template calculate_knn_round_per_query_kernel<decltype(blocking_size)::value, decltype(static_k)::value>(device, k, data_buffer,
+                        query_attr, first_query, num_queries, knn_buffer, knn_dist_buffer, is_own_data);
+            });
+        });
+        return event;
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    typename sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::index_type
+    sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::knn_max_local_size(const device_context& device, const index_type k) const {
+        const std::size_t local_mem_size = device.queue.get_device().template get_info<sycl::info::device::local_mem_size>();
+        // the pre-instantiated numbers of nearest-neighbors are kept in private memory
+        std::size_t local_mem_per_work_item = detail::is_static_knn_k(k) ? 0 : k * (sizeof(id_type) + sizeof(real_type));
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        // each work-item additionally needs local memory for its seen filter
+        local_mem_per_work_item += detail::seen_filter_size * sizeof(index_type);
+#endif
+        return local_mem_per_work_item == 0 ? std::numeric_limits<index_type>::max() : local_mem_size / local_mem_per_work_item;
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    template <std::size_t blocking_size, std::size_t static_k>
+    [[nodiscard]]
+    sycl_lsh::sycl::event sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_per_query_kernel(device_context& device, const index_type k, data_device_buffer_type& data_buffer,
+            const data_attributes_type& query_attr, const index_type first_query, const index_type num_queries,
+            knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data) {
+        // the tuned work-group size may exceed the local memory for another number of nearest-neighbors
+        index_type local_size = device.knn_tuned_k == k ? device.knn_local_size : 0;
+        if (local_size == 0) {
+            // TODO 2020-10-07 15:52 marcel: check if correct and useful
+            const index_type max_local_size = this->knn_max_local_size(device, k);
+            const index_type max_work_group_size = device.queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+            local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
+            if (max_local_size == local_size) {
+                local_size /= 2;
+            }
+        }
+
+        const index_type global_size = ((num_queries + local_size - 1) / local_size) * local_size;
+
+        const sycl::event event = device.queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_data_owned = data_.get_device_accessor(device.data_buffer, device.attr, cgh);
+            auto acc_data_received = data_.get_device_accessor(data_buffer, query_attr, cgh);
+            auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+            auto acc_offsets = device.offsets_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+            auto acc_directory = device.directory_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_bucket_hash_values = device.bucket_hash_values_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+            auto acc_hash_tables = device.hash_tables_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+            auto acc_hash_values = hash_values_buffer_.template get_access<sycl::access::mode::read>(cgh);
+#endif
+            auto acc_signatures = device.signatures_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+            auto acc_candidate_count = device.candidate_count_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+            auto acc_fingerprints = device.fingerprints_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_fingerprint_count = device.fingerprint_count_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+#endif
+            auto acc_searched_tables = device.searched_tables_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            auto acc_tombstones = device.tombstones_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_inserted_ids = device.inserted_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_REORDER_POINTS)
+            auto acc_point_ids = device.point_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+            // get additional information
+            auto options = options_;
+            auto attr = query_attr;
+            [[maybe_unused]] const index_type rank_size = attr_.rank_size;
+            auto owned_attr = device.attr;
+            // the hash tables contain the indices local to the device, the nearest-neighbors the global IDs
+            const index_type owned_first_point = device.first_point;
+            const id_type owned_base_id = attr_.first_id(comm_.rank()) + device.first_point;
+            const index_type num_dataset_points = device.num_dataset_points;
+            // the number of additionally probed hash buckets (always 0 for the entropy-based hash functions)
+            const index_type num_probes = supports_multi_probe(options_type::used_hash_functions_type) ? options_.num_probes : 0;
+            // the maximum Hamming distance of the signatures of a query and its candidates (always 0, i.e. disabled, for all but the simhash hash functions)
+            const index_type max_hamming_distance = options_type::used_hash_functions_type == hash_functions_type::simhash ? options_.max_hamming_distance : 0;
+            // the squared distance of the k-th nearest-neighbor below which the search of a query is terminated (the kernel uses squared distances)
+            const real_type early_termination_distance = options_.early_termination_distance * options_.early_termination_distance;
+            // the deleted data points only need to be skipped if they are still contained in the hash tables
+            const bool has_tombstones = num_pending_tombstones_ > 0;
+            // get get_linear_id functor instantiation
+            const get_linear_id<data_type> get_linear_id_data{};
+            const get_linear_id<knn_type> get_linear_id_knn{};
+            // get hasher functor instantiation
+            const lsh_hash<hash_function_type> hasher{};
+
+            // create local memory accessors (the nearest-neighbors of a pre-instantiated k are kept in private memory)
+            const index_type knn_local_mem_size = static_k == 0 ? local_size * k : 1;
+            sycl::accessor<id_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_local_mem(sycl::range<>(knn_local_mem_size), cgh);
+            sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_dist_local_mem(sycl::range<>(knn_local_mem_size), cgh);
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+            sycl::accessor<index_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    seen_local_mem(sycl::range<>(local_size * detail::seen_filter_size), cgh);
+#endif
+
+            const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+
+            cgh.parallel_for<kernel_calculate_knn<blocking_size, static_k>>(execution_range, [=](sycl::nd_item<> item) {
+                const index_type global_idx = item.get_global_linear_id();
+                const index_type local_idx  = item.get_local_linear_id();
+
+                // immediately return if global_idx is out-of-range or a dummy point
+                if (global_idx >= num_queries) return;
+                // the position of the query in the data points of the current round
+                const index_type query = first_query + global_idx;
+
+                index_type knn_blocked[blocking_size];
+                real_type knn_dist_blocked[blocking_size];
+                // the nearest-neighbors of a pre-instantiated k (the loops over them have a compile time trip count and can be fully unrolled)
+                [[maybe_unused]] id_type knn_private[static_k == 0 ? 1 : static_k];
+                [[maybe_unused]] real_type knn_dist_private[static_k == 0 ? 1 : static_k];
+
+                // initialize private or local memory arrays
+                auto knn_list = [&]() {
+                    if constexpr (static_k != 0) {
+                        for (index_type nn = 0; nn < static_k; ++nn) {
+                            knn_private[nn] = acc_knn[get_linear_id_knn(global_idx, nn, attr, k)];
+                            knn_dist_private[nn] = acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)];
+                        }
+                        return detail::make_top_k<options_type>(knn_private, knn_dist_private, 0, static_k);
+                    } else {
+                        for (index_type nn = 0; nn < k; ++nn) {
+                            knn_local_mem[local_idx * k + nn] = acc_knn[get_linear_id_knn(global_idx, nn, attr, k)];
+                            knn_dist_local_mem[local_idx * k + nn] = acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)];
+                        }
+                        return detail::make_top_k<options_type>(knn_local_mem, knn_dist_local_mem, local_idx * k, k);
+                    }
+                }();
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                auto seen = detail::make_seen_filter<options_type>(seen_local_mem, local_idx * detail::seen_filter_size);
+                seen.clear();
+                index_type num_candidates = 0;
+                index_type num_skipped_candidates = 0;
+                index_type num_filtered_candidates = 0;
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+                index_type num_fingerprint_candidates = 0;
+                index_type num_fingerprint_filtered_candidates = 0;
+#endif
+
+                // signatures of the query in all hash tables needed for the Hamming distance prefilter
+                [[maybe_unused]] hash_value_type query_signatures[detail::max_hamming_filter_hash_tables];
+                if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+                    if (max_hamming_distance > 0) {
+                        for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                            query_signatures[hash_table] = hasher.signature(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr);
+                        }
+                    }
+                }
+
+                // number of consecutive hash tables without any change to the nearest-neighbors (adaptive early termination)
+                index_type num_unchanged_tables = 0;
+                index_type num_searched_tables = 0;
+
+                // perform nearest-neighbor search for all hash tables
+                for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                    ++num_searched_tables;
+                    bool knn_list_changed = false;
+                    // calculate hash value (= hash bucket) for current point
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+                    // the fingerprint needs the combined hash value of the query (the cached hash values are already reduced)
+                    const hash_value_type query_hash = hasher.combined_hash_value(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr);
+                    const hash_value_type home_bucket = query_hash % options.hash_table_size;
+                    const detail::fingerprint_type query_fingerprint = detail::hash_fingerprint(query_hash, options.hash_table_size);
+#elif defined(SYCL_LSH_CACHE_HASH_VALUES)
+                    const hash_value_type home_bucket = is_own_data ? acc_hash_values[hash_table * rank_size + query]
+                                                                    : hasher(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr);
+#else
+                    const hash_value_type home_bucket = hasher(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr);
+#endif
+                    // unquantized hash function values needed to calculate the neighboring hash buckets (multi-probe LSH)
+                    [[maybe_unused]] real_type projections[detail::max_probe_hash_functions];
+                    [[maybe_unused]] detail::perturbation<index_type, real_type> perturbation{ 0, 0, 0.0 };
+                    if constexpr (supports_multi_probe(options_type::used_hash_functions_type)) {
+                        if (num_probes > 0) {
+                            hasher.projections(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr, projections);
+                        }
+                    }
+
+                    // perform nearest-neighbor search for the own and all probed neighboring hash buckets
+                    for (index_type probe = 0; probe <= num_probes; ++probe) {
+                        hash_value_type hash_bucket = home_bucket;
+                        if constexpr (supports_multi_probe(options_type::used_hash_functions_type)) {
+                            if (probe > 0) {
+                                perturbation = detail::next_perturbation(projections, options.num_hash_functions, perturbation);
+                                hash_bucket = hasher.combine(hash_table, projections, perturbation.hash_function, perturbation.delta,
+                                                             acc_hash_functions, options, attr);
+                                // the perturbed hash value may collide with the own hash bucket
+                                if (hash_bucket == home_bucket) {
+                                    continue;
+                                }
+                            }
+                        }
+
+                        // calculate hash bucket offsets
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+                        const detail::bucket_range<index_type> bucket = detail::find_hash_bucket(acc_directory, acc_bucket_hash_values, acc_offsets, hash_table, hash_bucket);
+                        const index_type bucket_begin = bucket.begin;
+                        const index_type bucket_end   = bucket.end;
+#else
+                        const index_type bucket_begin = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_bucket];
+                        const index_type bucket_end   = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_bucket + 1];
+#endif
+
+                        // perform nearest-neighbor search for all data points in the calculate hash bucket
+                        for (index_type bucket_elem = bucket_begin; bucket_elem < bucket_end; bucket_elem += blocking_size) {
+                            // initialize thread local blocking array
+                            for (index_type block = 0; block < blocking_size; ++block) {
+                                knn_blocked[block] = acc_hash_tables[hash_table * owned_attr.rank_size + bucket_elem + block];
+                                knn_dist_blocked[block] = 0.0;
+                            }
+
+                            // calculate distances
+                            for (index_type block = 0; block < blocking_size; ++block) {
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+                                // skip candidates of the own hash bucket whose combined hash values differ from the one of the query, i.e. which
+                                // only share the hash bucket due to the modulo (before the seen filter, since they may match in another hash table)
+                                if (probe == 0) {
+                                    ++num_fingerprint_candidates;
+                                    if (acc_fingerprints[hash_table * owned_attr.rank_size + knn_blocked[block]] != query_fingerprint) {
+                                        ++num_fingerprint_filtered_candidates;
+                                        knn_dist_blocked[block] = std::numeric_limits<real_type>::max();
+                                        continue;
+                                    }
+                                }
+#endif
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                                // skip candidates already evaluated in a previous hash table
+                                ++num_candidates;
+                                if (seen.test_and_set(knn_blocked[block])) {
+                                    ++num_skipped_candidates;
+                                    knn_dist_blocked[block] = std::numeric_limits<real_type>::max();
+                                    continue;
+                                }
+#endif
+                                // skip deleted candidates (until the hash tables are compacted)
+                                if (has_tombstones && acc_tombstones[knn_blocked[block]] != 0) {
+                                    knn_dist_blocked[block] = std::numeric_limits<real_type>::max();
+                                    continue;
+                                }
+                                if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+                                    // skip candidates whose signatures differ in too many bits, i.e. with a too large estimated angle to the query
+                                    if (max_hamming_distance > 0) {
+                                        index_type hamming_distance = 0;
+                                        for (index_type signature_table = 0; signature_table < options.num_hash_tables; ++signature_table) {
+                                            hamming_distance += detail::hamming_distance(query_signatures[signature_table],
+                                                    acc_signatures[signature_table * owned_attr.rank_size + knn_blocked[block]]);
+                                        }
+                                        if (hamming_distance > max_hamming_distance) {
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                                            ++num_filtered_candidates;
+#endif
+                                            knn_dist_blocked[block] = std::numeric_limits<real_type>::max();
+                                            continue;
+                                        }
+                                    }
+                                }
+                                if constexpr (layout == memory_layout::aos && options_type::dims != 0 && std::is_same_v<typename data_type::storage_type, real_type>) {
+                                    // fully unrolled and vectorized distance calculation
+                                    knn_dist_blocked[block] = detail::squared_euclidean_distance<options_type>(
+                                            acc_data_received, global_idx * options_type::dims, acc_data_owned, knn_blocked[block] * options_type::dims,
+                                            knn_list.max_distance());
+                                } else {
+#if defined(SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE)
+                                    // abandon the candidate as soon as its partial distance can't improve the nearest-neighbors anymore
+                                    const real_type max_distance = knn_list.max_distance();
+                                    for (index_type chunk = 0; chunk < attr.dims && knn_dist_blocked[block] < max_distance; chunk += SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE) {
+                                        const index_type chunk_end = chunk + SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE < attr.dims ? chunk + SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE : attr.dims;
+                                        for (index_type dim = chunk; dim < chunk_end; ++dim) {
+#else
+                                    {
+                                        for (index_type dim = 0; dim < attr.dims; ++dim) {
+#endif
+                                            const real_type x = acc_data_received[get_linear_id_data(global_idx, dim, attr)];
+                                            const real_type y = acc_data_owned[get_linear_id_data(knn_blocked[block], dim, owned_attr)];
+                                            knn_dist_blocked[block] += (x - y) * (x - y);
+                                        }
+                                    }
+                                }
+                            }
+
+                            // update nearest-neighbors
+                            for (index_type block = 0; block < blocking_size; ++block) {
+#if defined(SYCL_LSH_REORDER_POINTS)
+                                // the data points are sorted by hash bucket -> translate the candidate to its original position
+                                const index_type point = acc_point_ids[knn_blocked[block]];
+#else
+                                const index_type point = knn_blocked[block];
+#endif
+                                // a query can only be its own candidate if it's part of the own data
+                                if (knn_dist_blocked[block] < knn_list.max_distance()
+                                        && !(is_own_data && point < num_dataset_points && owned_first_point + point == query)) {
+                                    // the inserted data points folded in by compact() follow the data points of the data set
+                                    knn_list.add(point < num_dataset_points ? owned_base_id + point : acc_inserted_ids[point - num_dataset_points],
+                                                 knn_dist_blocked[block]);
+                                    knn_list_changed = true;
+                                }
+                            }
+                        }
+                    }
+
+                    // skip the remaining hash tables if the nearest-neighbors are considered converged
+                    num_unchanged_tables = knn_list_changed ? 0 : num_unchanged_tables + 1;
+                    if (options.early_termination_tables > 0 && num_unchanged_tables >= options.early_termination_tables) {
+                        break;
+                    }
+                    if (knn_list.max_distance() < early_termination_distance) {
+                        break;
+                    }
+                }
+                knn_list.finalize();
+
+                // write back to global buffer
+                if constexpr (static_k != 0) {
+                    for (index_type nn = 0; nn < static_k; ++nn) {
+                        acc_knn[get_linear_id_knn(global_idx, nn, attr, k)] = knn_private[nn];
+                        acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)] = knn_dist_private[nn];
+                    }
+                } else {
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        acc_knn[get_linear_id_knn(global_idx, nn, attr, k)] = knn_local_mem[local_idx * k + nn];
+                        acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)] = knn_dist_local_mem[local_idx * k + nn];
+                    }
+                }
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                acc_candidate_count[global_idx] = num_candidates;
+                acc_candidate_count[attr.rank_size + global_idx] = num_skipped_candidates;
+                acc_candidate_count[2 * attr.rank_size + global_idx] = num_filtered_candidates;
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+                acc_fingerprint_count[global_idx] = num_fingerprint_candidates;
+                acc_fingerprint_count[attr.rank_size + global_idx] = num_fingerprint_filtered_candidates;
+#endif
+                acc_searched_tables[global_idx] = num_searched_tables;
+            });
+        });
+        profiler_.record(detail::profiled_command::calculate_knn, event);
+        return event;
+    }
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_co_executed(const index_type k, data_device_buffer_type& data_buffer,
+            const data_attributes_type& query_attr, const index_type first_query, const index_type num_device_queries, const index_type num_host_queries,
+            knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data) {
+        device_context& device = devices_.front();
+        const data_attributes_type host_attr(query_attr.total_size, num_host_queries, query_attr.dims);
+
+        // gather the host share on the device (only these queries and their nearest-neighbors are transferred to the host)
+        data_device_buffer_type host_data_buffer(num_host_queries * query_attr.dims);
+        knn_device_buffer_type host_knn_buffer(num_host_queries * k);
+        knn_dist_device_buffer_type host_knn_dist_buffer(num_host_queries * k);
+        device.queue.submit([&](sycl::handler& cgh) {
+            auto acc_data = data_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_host_data = host_data_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            auto acc_host_knn = host_knn_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            auto acc_host_knn_dist = host_knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            const data_attributes_type attr = query_attr;
+            const data_attributes_type share_attr = host_attr;
+            const index_type offset = num_device_queries;
+            // get get_linear_id functor instantiation
+            const get_linear_id<data_type> get_linear_id_data{};
+            const get_linear_id<knn_type> get_linear_id_knn{};
+
+            cgh.parallel_for<kernel_gather_host_queries>(sycl::range<>(num_host_queries), [=](sycl::item<> item) {
+                const index_type point = item.get_linear_id();
+                for (index_type dim = 0; dim < attr.dims; ++dim) {
+                    acc_host_data[get_linear_id_data(point, dim, share_attr)] = acc_data[get_linear_id_data(offset + point, dim, attr)];
+                }
+                for (index_type nn = 0; nn < k; ++nn) {
+                    acc_host_knn[get_linear_id_knn(point, nn, share_attr, k)] = acc_knn[get_linear_id_knn(offset + point, nn, attr, k)];
+                    acc_host_knn_dist[get_linear_id_knn(point, nn, share_attr, k)] = acc_knn_dist[get_linear_id_knn(offset + point, nn, attr, k)];
+                }
+            });
+        });
+
+        // the host device searches the same (read-only) hash tables, but needs its own per query counters
+        device_context host_device = device;
+        host_device.queue = *host_queue_;
+        host_device.knn_local_size = 0;
+        host_device.knn_tuned_k = 0;
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        host_device.candidate_count_buffer = device_buffer_type(3 * num_host_queries);
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        host_device.fingerprint_count_buffer = device_buffer_type(2 * num_host_queries);
+#endif
+        host_device.searched_tables_buffer = device_buffer_type(num_host_queries);
+
+        // search both shares concurrently and measure when each of them has been finished
+        const auto start = std::chrono::steady_clock::now();
+        const sycl::event device_event = this->calculate_knn_round_per_query(device, k, data_buffer, query_attr, first_query, num_device_queries,
+                                                                             knn_buffer, knn_dist_buffer, is_own_data);
+        const sycl::event host_event = this->calculate_knn_round_per_query(host_device, k, host_data_buffer, host_attr, first_query + num_device_queries,
+                                                                           num_host_queries, host_knn_buffer, host_knn_dist_buffer, is_own_data);
+        std::future<std::chrono::steady_clock::time_point> host_end = std::async(std::launch::async, [&]() {
+            sycl::event(host_event).wait_and_throw();
+            return std::chrono::steady_clock::now();
+        });
+        sycl::event(device_event).wait_and_throw();
+        const std::chrono::duration<double> device_time = std::chrono::steady_clock::now() - start;
+        const std::chrono::duration<double> host_time = host_end.get() - start;
+
+        // choose the host share of the next round such that both devices would finish at the same time
+        const double device_throughput = num_device_queries / std::max(device_time.count(), 1e-9);
+        const double host_throughput = num_host_queries / std::max(host_time.count(), 1e-9);
+        host_share_ = std::clamp(host_throughput / (device_throughput + host_throughput), min_host_share, max_host_share);
+
+        // scatter the results of the host share back on the device
+        device.queue.submit([&](sycl::handler& cgh) {
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::write>(cgh);
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::write>(cgh);
+            auto acc_host_knn = host_knn_buffer.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_host_knn_dist = host_knn_dist_buffer.template get_access<sycl::access::mode::read>(cgh);
+            const data_attributes_type attr = query_attr;
+            const data_attributes_type share_attr = host_attr;
+            const index_type offset = num_device_queries;
+            // get get_linear_id functor instantiation
+            const get_linear_id<knn_type> get_linear_id_knn{};
+
+            cgh.parallel_for<kernel_scatter_host_queries>(sycl::range<>(num_host_queries), [=](sycl::item<> item) {
+                const index_type point = item.get_linear_id();
+                for (index_type nn = 0; nn < k; ++nn) {
+                    acc_knn[get_linear_id_knn(offset + point, nn, attr, k)] = acc_host_knn[get_linear_id_knn(point, nn, share_attr, k)];
+                    acc_knn_dist[get_linear_id_knn(offset + point, nn, attr, k)] = acc_host_knn_dist[get_linear_id_knn(point, nn, share_attr, k)];
+                }
+            });
+        });
+        device.queue.wait_and_throw();
+
+        // accumulate the statistics of the host share (the ones of the device share are accumulated by the caller)
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        {
+            auto acc_candidate_count = host_device.candidate_count_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_host_queries; ++i) {
+                num_candidates_ += acc_candidate_count[i];
+                num_skipped_candidates_ += acc_candidate_count[num_host_queries + i];
+                num_filtered_candidates_ += acc_candidate_count[2 * num_host_queries + i];
+            }
+        }
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        {
+            auto acc_fingerprint_count = host_device.fingerprint_count_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_host_queries; ++i) {
+                num_fingerprint_candidates_ += acc_fingerprint_count[i];
+                num_fingerprint_filtered_candidates_ += acc_fingerprint_count[num_host_queries + i];
+            }
+        }
+#endif
+        if (options_.early_termination_tables > 0 || options_.early_termination_distance > 0) {
+            auto acc_searched_tables = host_device.searched_tables_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type i = 0; i < num_host_queries; ++i) {
+                num_searched_tables_ += acc_searched_tables[i];
+            }
+            num_searched_queries_ += num_host_queries;
+        }
+        num_host_queries_ += num_host_queries;
+        num_co_executed_queries_ += num_device_queries + num_host_queries;
+    }
+#endif
+#elif SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::sort_queries_by_hash_value(device_context& device, hash_value_device_buffer_type& query_hash_values,
+                                                                                                  const data_attributes_type& query_attr, const index_type num_queries,
+                                                                                                  device_buffer_type& sorted_queries) {
+        // count the number of queries per hash bucket
+        device_buffer_type query_count(options_.num_hash_tables * options_.hash_table_size);
+        device.queue.submit([&](sycl::handler& cgh) {
+            auto acc_query_count = query_count.template get_access<sycl::access::mode::discard_write>(cgh);
+            cgh.fill(acc_query_count, index_type{ 0 });
+        });
+        device.queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_query_count = query_count.template get_access<sycl::access::mode::atomic>(cgh);
+            auto acc_query_hash_values = query_hash_values.template get_access<sycl::access::mode::read>(cgh);
+            // get additional information
+            auto options = options_;
+            auto attr = query_attr;
+
+            cgh.parallel_for<kernel_count_queries>(sycl::range<>(num_queries), [=](sycl::item<> item) {
+                const index_type idx = item.get_linear_id();
+
+                for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                    const hash_value_type hash_value = acc_query_hash_values[hash_table * attr.rank_size + idx];
+                    acc_query_count[hash_table * options.hash_table_size + hash_value].fetch_add(1);
+                }
+            });
+        });
+
+        // calculate the position of the first query of each hash bucket
+        device_buffer_type query_offsets(options_.num_hash_tables * options_.hash_table_size);
+        detail::exclusive_scan(device.queue, query_count, query_offsets,
+                               options_.num_hash_tables, options_.hash_table_size, options_.hash_table_size, 0);
+
+        // scatter the query IDs to their hash buckets
+        device.queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            auto acc_query_offsets = query_offsets.template get_access<sycl::access::mode::atomic>(cgh);
+            auto acc_query_hash_values = query_hash_values.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_sorted_queries = sorted_queries.template get_access<sycl::access::mode::discard_write>(cgh);
+            // get additional information
+            auto options = options_;
+            auto attr = query_attr;
+
+            cgh.parallel_for<kernel_sort_queries>(sycl::range<>(num_queries), [=](sycl::item<> item) {
+                const index_type idx = item.get_linear_id();
+
+                for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                    const hash_value_type hash_value = acc_query_hash_values[hash_table * attr.rank_size + idx];
+                    const index_type pos = acc_query_offsets[hash_table * options.hash_table_size + hash_value].fetch_add(1);
+                    acc_sorted_queries[hash_table * attr.rank_size + pos] = idx;
+                }
+            });
+        });
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_per_bucket(device_context& device, const index_type k, data_device_buffer_type& data_buffer,
+            const data_attributes_type& query_attr, const index_type first_query, const index_type num_queries,
+            knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer, const bool is_own_data) {
+        // get the hash values of all queries (already known for the own data if cached and not split into chunks)
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        const bool use_cached_hash_values = is_own_data && query_attr.rank_size == attr_.rank_size;
+        hash_value_device_buffer_type query_hash_values = use_cached_hash_values ? hash_values_buffer_ : hash_value_device_buffer_type(options_.num_hash_tables * query_attr.rank_size);
+        if (!use_cached_hash_values) {
+            this->calculate_hash_values(device.queue, data_buffer, query_attr, num_queries, query_hash_values);
+        }
+#else
+        hash_value_device_buffer_type query_hash_values(options_.num_hash_tables * query_attr.rank_size);
+        this->calculate_hash_values(device.queue, data_buffer, query_attr, num_queries, query_hash_values);
+#endif
+
+        // group the queries by their hash buckets
+        device_buffer_type sorted_queries(options_.num_hash_tables * query_attr.rank_size);
+        this->sort_queries_by_hash_value(device, query_hash_values, query_attr, num_queries, sorted_queries);
+
+        // each work-item needs local memory for its nearest-neighbors and one staged candidate
+        const index_type local_mem_size = device.queue.get_device().template get_info<sycl::info::device::local_mem_size>();
+        const index_type local_mem_per_work_item = k * (sizeof(id_type) + sizeof(real_type)) + query_attr.dims * sizeof(real_type) + sizeof(index_type);
+        const index_type max_local_size = local_mem_size / local_mem_per_work_item;
+        if (max_local_size == 0) {
+            throw std::runtime_error(fmt::format("Not enough local memory ({} bytes) for the bucket cooperative k-nearest-neighbor kernel (at least {} bytes needed)!",
+                                                 local_mem_size, local_mem_per_work_item));
+        }
+        const index_type max_work_group_size = device.queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+        const index_type local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
+
+        const index_type global_size = ((num_queries + local_size - 1) / local_size) * local_size;
+
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+        // the seen filters must persist across all hash tables -> stored in global memory
+        device_buffer_type seen_buffer(query_attr.rank_size * detail::seen_filter_size);
+        device.queue.submit([&](sycl::handler& cgh) {
+            auto acc_seen = seen_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            cgh.fill(acc_seen, std::numeric_limits<index_type>::max());
+        });
+        device.queue.submit([&](sycl::handler& cgh) {
+            auto acc_candidate_count = device.candidate_count_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+            cgh.fill(acc_candidate_count, index_type{ 0 });
+        });
+#endif
+
+        for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+            profiler_.record(detail::profiled_command::calculate_knn, device.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_data_owned = data_.get_device_accessor(device.data_buffer, device.attr, cgh);
+                auto acc_data_received = data_.get_device_accessor(data_buffer, query_attr, cgh);
+                auto acc_hash_values = query_hash_values.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_sorted_queries = sorted_queries.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_offsets = device.offsets_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+                auto acc_directory = device.directory_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_bucket_hash_values = device.bucket_hash_values_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+                auto acc_hash_tables = device.hash_tables_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+                auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                auto acc_seen = seen_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+                auto acc_candidate_count = device.candidate_count_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+#endif
+                auto acc_inserted_ids = device.inserted_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_REORDER_POINTS)
+                auto acc_point_ids = device.point_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+                // get additional information
+                auto options = options_;
+                auto attr = query_attr;
+                auto owned_attr = device.attr;
+                // the hash tables contain the indices local to the device, the nearest-neighbors the global IDs
+                const index_type owned_first_point = device.first_point;
+                const id_type owned_base_id = attr_.first_id(comm_.rank()) + device.first_point;
+                const index_type num_dataset_points = device.num_dataset_points;
+                // get get_linear_id functor instantiation
+                const get_linear_id<data_type> get_linear_id_data{};
+                const get_linear_id<knn_type> get_linear_id_knn{};
+
+                // create local memory accessors
+                sycl::accessor<id_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        knn_local_mem(sycl::range<>(local_size * k), cgh);
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        knn_dist_local_mem(sycl::range<>(local_size * k), cgh);
+                sycl::accessor<index_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        candidate_local_mem(sycl::range<>(local_size), cgh);
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        candidate_data_local_mem(sycl::range<>(local_size * attr.dims), cgh);
+
+                const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+
+                cgh.parallel_for<kernel_calculate_knn_bucket_cooperative>(execution_range, [=](sycl::nd_item<> item) {
+                    const index_type global_idx = item.get_global_linear_id();
+                    const index_type local_idx  = item.get_local_linear_id();
+#if !defined(SYCL_LSH_COMPACT_OFFSETS)
+                    const index_type hash_table_offset = hash_table * (options.hash_table_size + 1);
+#endif
+
+                    // out-of-range work-items only help staging the candidates (no early return because of the barriers)
+                    const bool is_active = global_idx < num_queries;
+
+                    // the current query and its candidate range
+                    // (extended to the next multiple of blocking_size in order to check the same candidates as the per query kernel)
+                    const index_type query = is_active ? acc_sorted_queries[hash_table * attr.rank_size + global_idx] : 0;
+                    const hash_value_type hash_bucket = acc_hash_values[hash_table * attr.rank_size + query];
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+                    const detail::bucket_range<index_type> bucket = detail::find_hash_bucket(acc_directory, acc_bucket_hash_values, acc_offsets, hash_table, hash_bucket);
+                    const index_type bucket_begin = bucket.begin;
+                    const index_type bucket_end   = bucket.end;
+#else
+                    const index_type bucket_begin = acc_offsets[hash_table_offset + hash_bucket];
+                    const index_type bucket_end   = acc_offsets[hash_table_offset + hash_bucket + 1];
+#endif
+                    const index_type candidates_end = bucket_begin
+                            + ((bucket_end - bucket_begin + options_type::blocking_size - 1) / options_type::blocking_size) * options_type::blocking_size;
+
+                    // the queries are sorted by hash value -> the candidates of all queries of the work-group are contiguous
+                    const index_type group_first = item.get_group_linear_id() * local_size;
+                    const index_type group_last = (group_first + local_size < num_queries ? group_first + local_size : num_queries) - 1;
+                    const hash_value_type first_hash_bucket = acc_hash_values[hash_table * attr.rank_size + acc_sorted_queries[hash_table * attr.rank_size + group_first]];
+                    const hash_value_type last_hash_bucket = acc_hash_values[hash_table * attr.rank_size + acc_sorted_queries[hash_table * attr.rank_size + group_last]];
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+                    const index_type range_begin = detail::find_hash_bucket(acc_directory, acc_bucket_hash_values, acc_offsets, hash_table, first_hash_bucket).begin;
+                    const index_type range_end = detail::find_hash_bucket(acc_directory, acc_bucket_hash_values, acc_offsets, hash_table, last_hash_bucket).end
+                                                 + options_type::blocking_size - 1;
+#else
+                    const index_type range_begin = acc_offsets[hash_table_offset + first_hash_bucket];
+                    const index_type range_end = acc_offsets[hash_table_offset + last_hash_bucket + 1] + options_type::blocking_size - 1;
+#endif
+
+                    // initialize local memory arrays
+                    if (is_active) {
+                        for (index_type nn = 0; nn < k; ++nn) {
+                            knn_local_mem[local_idx * k + nn] = acc_knn[get_linear_id_knn(query, nn, attr, k)];
+                            knn_dist_local_mem[local_idx * k + nn] = acc_knn_dist[get_linear_id_knn(query, nn, attr, k)];
+                        }
+                    }
+
+                    auto knn_list = detail::make_top_k<options_type>(knn_local_mem, knn_dist_local_mem, local_idx * k, k);
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                    auto seen = detail::make_seen_filter<options_type>(acc_seen, query * detail::seen_filter_size);
+                    index_type num_candidates = 0;
+                    index_type num_skipped_candidates = 0;
+#endif
+
+                    for (index_type tile_begin = range_begin; tile_begin < range_end; tile_begin += local_size) {
+                        // cooperatively stage the current candidate tile in local memory
+                        if (tile_begin + local_idx < range_end) {
+                            const index_type candidate = acc_hash_tables[hash_table * owned_attr.rank_size + tile_begin + local_idx];
+                            candidate_local_mem[local_idx] = candidate;
+                            const index_type dims = detail::get_dims<options_type>(attr);
+                            for (index_type dim = 0; dim < dims; ++dim) {
+                                candidate_data_local_mem[local_idx * dims + dim] = acc_data_owned[get_linear_id_data(candidate, dim, owned_attr)];
+                            }
+                        }
+                        item.barrier(sycl::access::fence_space::local_space);
+
+                        if (is_active) {
+                            // only the part of the tile belonging to the hash bucket of the current query is relevant
+                            const index_type first = bucket_begin > tile_begin ? bucket_begin : tile_begin;
+                            const index_type last = candidates_end < tile_begin + local_size ? candidates_end : tile_begin + local_size;
+                            for (index_type elem = first; elem < last; ++elem) {
+                                const index_type tile_idx = elem - tile_begin;
+                                const index_type candidate = candidate_local_mem[tile_idx];
+
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                                // skip candidates already evaluated in a previous hash table
+                                ++num_candidates;
+                                if (seen.test_and_set(candidate)) {
+                                    ++num_skipped_candidates;
+                                    continue;
+                                }
+#endif
+
+                                // calculate distance
+                                real_type dist = 0.0;
+                                if constexpr (layout == memory_layout::aos && options_type::dims != 0 && std::is_same_v<typename data_type::storage_type, real_type>) {
+                                    // fully unrolled and vectorized distance calculation
+                                    dist = detail::squared_euclidean_distance<options_type>(
+                                            acc_data_received, query * options_type::dims, candidate_data_local_mem, tile_idx * options_type::dims,
+                                            knn_list.max_distance());
+                                } else {
+#if defined(SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE)
+                                    // abandon the candidate as soon as its partial distance can't improve the nearest-neighbors anymore
+                                    const real_type max_distance = knn_list.max_distance();
+                                    for (index_type chunk = 0; chunk < attr.dims && dist < max_distance; chunk += SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE) {
+                                        const index_type chunk_end = chunk + SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE < attr.dims ? chunk + SYCL_LSH_EARLY_ABANDON_CHUNK_SIZE : attr.dims;
+                                        for (index_type dim = chunk; dim < chunk_end; ++dim) {
+#else
+                                    {
+                                        for (index_type dim = 0; dim < attr.dims; ++dim) {
+#endif
+                                            const real_type x = acc_data_received[get_linear_id_data(query, dim, attr)];
+                                            const real_type y = candidate_data_local_mem[tile_idx * attr.dims + dim];
+                                            dist += (x - y) * (x - y);
+                                        }
+                                    }
+                                }
+
+                                // update nearest-neighbors
+#if defined(SYCL_LSH_REORDER_POINTS)
+                                // the data points are sorted by hash bucket -> translate the candidate to its original position
+                                const index_type point = acc_point_ids[candidate];
+#else
+                                const index_type point = candidate;
+#endif
+                                // a query can only be its own candidate if it's part of the own data
+                                if (dist < knn_list.max_distance() && !(is_own_data && point < num_dataset_points && owned_first_point + point == first_query + query)) {
+                                    // the inserted data points folded in by compact() follow the data points of the data set
+                                    knn_list.add(point < num_dataset_points ? owned_base_id + point : acc_inserted_ids[point - num_dataset_points], dist);
+                                }
+                            }
+                        }
+                        item.barrier(sycl::access::fence_space::local_space);
+                    }
+
+                    knn_list.finalize();
+
+                    // write back to global buffer
+                    if (is_active) {
+                        for (index_type nn = 0; nn < k; ++nn) {
+                            acc_knn[get_linear_id_knn(query, nn, attr, k)] = knn_local_mem[local_idx * k + nn];
+                            acc_knn_dist[get_linear_id_knn(query, nn, attr, k)] = knn_dist_local_mem[local_idx * k + nn];
+                        }
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                        acc_candidate_count[query] += num_candidates;
+                        acc_candidate_count[attr.rank_size + query] += num_skipped_candidates;
+#endif
+                    }
+                });
+            }));
+        }
+    }
+#endif
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void sycl_lsh::hash_tables<layout, Options, Data, HashFunctionType>::calculate_knn_round_delta(const index_type k, data_device_buffer_type& data_buffer,
+            const data_attributes_type& query_attr, const index_type num_queries, knn_device_buffer_type& knn_buffer, knn_dist_device_buffer_type& knn_dist_buffer) {
+        device_context& device = devices_.front();
+
+        const index_type local_mem_size = device.queue.get_device().template get_info<sycl::info::device::local_mem_size>();
+        const index_type max_local_size = local_mem_size / (k * (sizeof(id_type) + sizeof(real_type)));
+        const index_type max_work_group_size = device.queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+        index_type local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
+        if (max_local_size == local_size) {
+            local_size /= 2;
+        }
+
+        const index_type global_size = ((num_queries + local_size - 1) / local_size) * local_size;
+
+        device.queue.submit([&](sycl::handler& cgh) {
+            // get accessors
+            const data_attributes_type delta_attr(delta_ids_.size(), delta_ids_.size(), attr_.dims);
+            auto acc_data_delta = data_.get_device_accessor(delta_data_buffer_, delta_attr, cgh);
+            auto acc_data_received = data_.get_device_accessor(data_buffer, query_attr, cgh);
+            auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+            auto acc_delta_ids = delta_ids_buffer_.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_delta_hash_values = delta_hash_values_buffer_.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_delta_points = delta_points_buffer_.template get_access<sycl::access::mode::read>(cgh);
+            auto acc_knn = knn_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::read_write>(cgh);
+            // get additional information
+            auto options = options_;
+            auto attr = query_attr;
+            const index_type num_delta_points = delta_ids_.size();
+            // get get_linear_id functor instantiation
+            const get_linear_id<data_type> get_linear_id_data{};
+            const get_linear_id<knn_type> get_linear_id_knn{};
+            // get hasher functor instantiation
+            const lsh_hash<hash_function_type> hasher{};
+
+            // create local memory accessors
+            sycl::accessor<id_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_local_mem(sycl::range<>(local_size * k), cgh);
+            sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_dist_local_mem(sycl::range<>(local_size * k), cgh);
+
+            const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+
+            cgh.parallel_for<kernel_calculate_knn_delta>(execution_range, [=](sycl::nd_item<> item) {
+                const index_type global_idx = item.get_global_linear_id();
+                const index_type local_idx  = item.get_local_linear_id();
+
+                // immediately return if global_idx is out-of-range or a dummy point
+                if (global_idx >= num_queries) return;
+
+                // initialize local memory arrays
+                for (index_type nn = 0; nn < k; ++nn) {
+                    knn_local_mem[local_idx * k + nn] = acc_knn[get_linear_id_knn(global_idx, nn, attr, k)];
+                    knn_dist_local_mem[local_idx * k + nn] = acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)];
+                }
+                auto knn_list = detail::make_top_k<options_type>(knn_local_mem, knn_dist_local_mem, local_idx * k, k);
 
                 // perform nearest-neighbor search for all hash tables
                 for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
-                    // calculate hash value (= hash bucket) for current point
                     const hash_value_type hash_bucket = hasher(hash_table, global_idx, acc_data_received, acc_hash_functions, options, attr);
 
-                    // calculate hash bucket offsets
-                    const index_type bucket_begin = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_bucket];
-                    const index_type bucket_end   = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_bucket + 1];
+                    // binary search the first inserted data point in the hash bucket
+                    index_type bucket_elem = hash_table * num_delta_points;
+                    index_type count = num_delta_points;
+                    while (count > 0) {
+                        const index_type step = count / 2;
+                        if (acc_delta_hash_values[bucket_elem + step] < hash_bucket) {
+                            bucket_elem += step + 1;
+                            count -= step + 1;
+                        } else {
+                            count = step;
+                        }
+                    }
+
+                    // perform nearest-neighbor search for all inserted data points in the hash bucket
+                    const index_type hash_table_end = (hash_table + 1) * num_delta_points;
+                    for (; bucket_elem < hash_table_end && acc_delta_hash_values[bucket_elem] == hash_bucket; ++bucket_elem) {
+                        const index_type point = acc_delta_points[bucket_elem];
+                        real_type dist = 0.0;
+                        for (index_type dim = 0; dim < attr.dims; ++dim) {
+                            const real_type x = acc_data_received[get_linear_id_data(global_idx, dim, attr)];
+                            const real_type y = acc_data_delta[get_linear_id_data(point, dim, delta_attr)];
+                            dist += (x - y) * (x - y);
+                        }
+                        if (dist < knn_list.max_distance()) {
+                            knn_list.add(acc_delta_ids[point], dist);
+                        }
+                    }
+                }
+                knn_list.finalize();
+
+                // write back to global buffer
+                for (index_type nn = 0; nn < k; ++nn) {
+                    acc_knn[get_linear_id_knn(global_idx, nn, attr, k)] = knn_local_mem[local_idx * k + nn];
+                    acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)] = knn_dist_local_mem[local_idx * k + nn];
+                }
+            });
+        });
+    }
+
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                            save and load index                                             //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::save(const argv_parser& parser) {
+        // check if the required command line argument is present
+        if (!parser.has_argv("hash_tables_save_file")) {
+            throw std::invalid_argument("Required command line argument 'hash_tables_save_file' not provided!");
+        }
+        this->save(parser.argv_as<std::string>("hash_tables_save_file"));
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::save(const std::string_view file_name) {
+        mpi::timer t(comm_);
+
+        // the file format only describes the hash tables of the data set
+        if (this->num_folded_points() > 0) {
+            throw std::runtime_error("Can't save hash tables containing inserted data points!");
+        }
+
+        mpi::file file(file_name, comm_, mpi::file::mode::write);
+
+        // copy the hash functions to the host
+        std::vector<real_type> hash_functions(hash_functions_.get_device_buffer().get_count());
+        {
+            auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>();
+            for (index_type idx = 0; idx < hash_functions.size(); ++idx) {
+                hash_functions[idx] = acc_hash_functions[idx];
+            }
+        }
+        std::vector<std::uint64_t> header = this->index_file_header();
+        header.push_back(hash_functions.size());
+
+        // copy the offsets and hash tables of all devices to the host
+        std::vector<index_type> rank_hash_tables;
+        for (device_context& device : devices_) {
+            auto acc_offsets = device.offsets_buffer.template get_access<sycl::access::mode::read>();
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+            // always save the dense offsets, i.e. the file doesn't depend on the offsets representation
+            auto acc_directory = device.directory_buffer.template get_access<sycl::access::mode::read>();
+            auto acc_bucket_hash_values = device.bucket_hash_values_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+                // the offset of an empty hash bucket is the offset of the next non-empty one (or the sentinel)
+                index_type entry = acc_directory[hash_table];
+                for (index_type hash_bucket = 0; hash_bucket <= options_.hash_table_size; ++hash_bucket) {
+                    while (acc_bucket_hash_values[entry] < hash_bucket) {
+                        ++entry;
+                    }
+                    rank_hash_tables.push_back(acc_offsets[entry]);
+                }
+            }
+#else
+            for (index_type idx = 0; idx < device.offsets_buffer.get_count(); ++idx) {
+                rank_hash_tables.push_back(acc_offsets[idx]);
+            }
+#endif
+            auto acc_hash_tables = device.hash_tables_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type idx = 0; idx < device.hash_tables_buffer.get_count(); ++idx) {
+                rank_hash_tables.push_back(acc_hash_tables[idx]);
+            }
+        }
+
+        // calculate the byte offsets of the hash tables of each MPI rank
+        const std::uint64_t rank_table_offset = header.size() * sizeof(std::uint64_t) + (hash_functions.size() + 1) * sizeof(real_type);
+        const std::uint64_t rank_size = rank_hash_tables.size() * sizeof(index_type);
+        std::uint64_t rank_offset = 0;
+        MPI_Exscan(&rank_size, &rank_offset, 1, mpi::type_cast<std::uint64_t>(), MPI_SUM, comm_.get());
+        if (comm_.master_rank()) {
+            // the result of MPI_Exscan is undefined on the first MPI rank
+            rank_offset = 0;
+        }
+        rank_offset += rank_table_offset + 2 * comm_.size() * sizeof(std::uint64_t);
+        const std::uint64_t rank_entry[2] = { rank_offset, devices_.size() };
+        std::vector<std::uint64_t> rank_table(2 * comm_.size());
+        MPI_Gather(rank_entry, 2, mpi::type_cast<std::uint64_t>(), rank_table.data(), 2, mpi::type_cast<std::uint64_t>(), 0, comm_.get());
+
+        // write header, hash functions and byte offsets
+        if (comm_.master_rank()) {
+            MPI_Offset offset = 0;
+            MPI_File_write_at(file.get(), offset, header.data(), header.size(), mpi::type_cast<std::uint64_t>(), MPI_STATUS_IGNORE);
+            offset += header.size() * sizeof(std::uint64_t);
+            MPI_File_write_at(file.get(), offset, &options_.w, 1, mpi::type_cast<real_type>(), MPI_STATUS_IGNORE);
+            offset += sizeof(real_type);
+            MPI_File_write_at(file.get(), offset, hash_functions.data(), hash_functions.size(), mpi::type_cast<real_type>(), MPI_STATUS_IGNORE);
+            MPI_File_write_at(file.get(), rank_table_offset, rank_table.data(), rank_table.size(), mpi::type_cast<std::uint64_t>(), MPI_STATUS_IGNORE);
+        }
+
+        // write the hash tables of all MPI ranks concurrently
+        MPI_File_write_at_all(file.get(), rank_offset, rank_hash_tables.data(), rank_hash_tables.size(), mpi::type_cast<index_type>(), MPI_STATUS_IGNORE);
+
+        logger_.log("Saved hash tables to '{}' in {}.\n", file_name, t.elapsed());
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::load(const std::string_view file_name) {
+        mpi::timer t(comm_);
+
+        // the loaded hash tables wouldn't contain the inserted data points already removed from the delta segment
+        if (this->num_folded_points() > 0) {
+            throw std::runtime_error("Can't load hash tables after inserted data points have been folded into the hash tables!");
+        }
+
+        const mpi::file file(file_name, comm_, mpi::file::mode::read);
+        hash_functions_ = hash_function_type(options_, data_, this->read_hash_functions(file, file_name));
+        this->read_hash_tables(file, file_name);
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        // recalculate the cached hash values using the loaded hash functions
+        this->calculate_hash_values(devices_.front().queue, data_.get_device_buffer(), attr_, attr_.correct_rank_size(comm_.rank()), hash_values_buffer_);
+#endif
+        // the loaded hash tables may contain the deleted data points and the inserted data points must be rehashed
+        num_pending_tombstones_ = num_tombstones_;
+        this->create_delta_segment();
+        this->wait_and_throw();
+
+        logger_.log("Loaded hash tables from '{}' in {}.\n", file_name, t.elapsed());
+        profiler_.report("loading the hash tables");
+        mpi::communication_profiler::report("loading the hash tables", comm_, logger_);
+    }
+
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                update index                                                //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    std::vector<typename hash_tables<layout, Options, Data, HashFunctionType>::id_type>
+    hash_tables<layout, Options, Data, HashFunctionType>::insert(const std::vector<real_type>& points) {
+        mpi::timer t(comm_);
+
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING
+        throw std::invalid_argument("Inserting data points isn't supported by the \"ROUTING\" distribution scheme!");
+#elif defined(SYCL_LSH_EXACT_RERANKING)
+        // the exact re-ranking requests the original data points of the candidates from the MPI ranks owning them in the data set
+        throw std::invalid_argument("Inserting data points isn't supported together with a reduced precision storage type or a reduced number of dimensions!");
+#else
+        if (devices_.size() > 1) {
+            // the delta segment is only searched and folded in on a single device
+            throw std::invalid_argument(fmt::format("Inserting data points isn't supported using more than one device per MPI rank ({})!", devices_.size()));
+        }
+        if (points.size() % attr_.dims != 0) {
+            throw std::invalid_argument(fmt::format("The number of values ({}) must be a multiple of the number of dimensions ({})!", points.size(), attr_.dims));
+        }
+        const index_type num_points = points.size() / attr_.dims;
+
+        // assign consecutive IDs in the order of the MPI ranks
+        const id_type num_ids = num_points;
+        id_type first_id = 0;
+        MPI_Exscan(&num_ids, &first_id, 1, mpi::type_cast<id_type>(), MPI_SUM, comm_.get());
+        if (comm_.master_rank()) {
+            // the result of MPI_Exscan is undefined on the first MPI rank
+            first_id = 0;
+        }
+        first_id += next_insert_id_;
+        const id_type total_num_points = mpi::sum(num_ids, comm_);
+        next_insert_id_ += total_num_points;
+
+        std::vector<id_type> ids(num_points);
+        std::iota(ids.begin(), ids.end(), first_id);
+        delta_points_.insert(delta_points_.end(), points.begin(), points.end());
+        delta_ids_.insert(delta_ids_.end(), ids.begin(), ids.end());
+        this->create_delta_segment();
+        devices_.front().queue.wait_and_throw();
+
+        logger_.log("Inserted {} data points in {}.\n", total_num_points, t.elapsed());
+        return ids;
+#endif
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::erase(const std::vector<id_type>& ids) {
+        mpi::timer t(comm_);
+
+#if SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_BUCKET
+        throw std::invalid_argument("Deleting data points isn't supported by the \"BUCKET\" kNN kernel!");
+#else
+        // the IDs may be owned by any MPI rank -> gather the IDs of all MPI ranks
+        const int num_ids = ids.size();
+        std::vector<int> counts(comm_.size());
+        MPI_Allgather(&num_ids, 1, mpi::type_cast<int>(), counts.data(), 1, mpi::type_cast<int>(), comm_.get());
+        std::vector<int> displs(comm_.size());
+        std::exclusive_scan(counts.begin(), counts.end(), displs.begin(), 0);
+        std::vector<id_type> all_ids(displs.back() + counts.back());
+        MPI_Allgatherv(ids.data(), num_ids, mpi::type_cast<id_type>(), all_ids.data(), counts.data(), displs.data(), mpi::type_cast<id_type>(), comm_.get());
+        std::sort(all_ids.begin(), all_ids.end());
+
+        // mark the own data points of the data set as deleted
+        const id_type base_id = attr_.first_id(comm_.rank());
+        index_type num_deleted = 0;
+        for (device_context& device : devices_) {
+            const id_type first_id = base_id + device.first_point;
+            auto acc_tombstones = device.tombstones_buffer.template get_access<sycl::access::mode::read_write>();
+            for (auto it = std::lower_bound(all_ids.begin(), all_ids.end(), first_id); it != all_ids.end() && *it < first_id + device.num_dataset_points; ++it) {
+#if defined(SYCL_LSH_REORDER_POINTS)
+                // the tombstones are stored in the sorted order of the data points
+                const index_type point = device.point_positions[*it - first_id];
+#else
+                const index_type point = *it - first_id;
+#endif
+                if (acc_tombstones[point] == 0) {
+                    acc_tombstones[point] = 1;
+                    ++num_deleted;
+                }
+            }
+            // the inserted data points folded in by compact() are appended in their original order
+            for (std::size_t point = 0; point < device.inserted_ids.size(); ++point) {
+                if (std::binary_search(all_ids.begin(), all_ids.end(), device.inserted_ids[point]) && acc_tombstones[device.num_dataset_points + point] == 0) {
+                    acc_tombstones[device.num_dataset_points + point] = 1;
+                    ++num_deleted;
+                }
+            }
+        }
+        num_tombstones_ += num_deleted;
+        num_pending_tombstones_ += num_deleted;
+
+        // remove the own inserted data points immediately
+        std::size_t num_kept = 0;
+        for (std::size_t point = 0; point < delta_ids_.size(); ++point) {
+            if (!std::binary_search(all_ids.begin(), all_ids.end(), delta_ids_[point])) {
+                delta_ids_[num_kept] = delta_ids_[point];
+                std::copy_n(delta_points_.begin() + point * attr_.dims, attr_.dims, delta_points_.begin() + num_kept * attr_.dims);
+                ++num_kept;
+            }
+        }
+        const index_type num_deleted_inserted = delta_ids_.size() - num_kept;
+        if (num_deleted_inserted > 0) {
+            delta_ids_.resize(num_kept);
+            delta_points_.resize(num_kept * attr_.dims);
+            this->create_delta_segment();
+            devices_.front().queue.wait_and_throw();
+        }
+
+        logger_.log("Deleted {} data points in {}.\n", mpi::sum(num_deleted + num_deleted_inserted, comm_), t.elapsed());
+#endif
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::compact() {
+        mpi::timer t(comm_);
+
+        const index_type num_inserted = delta_ids_.size();
+        if (num_inserted > 0) {
+            this->fold_delta_segment();
+        }
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+        // the offsets are calculated densely before being compacted again
+        for (device_context& device : devices_) {
+            device.offsets_buffer = device_buffer_type(options_.num_hash_tables * (options_.hash_table_size + 1));
+        }
+#endif
+        this->create_hash_tables();
+        this->wait_and_throw();
+
+        logger_.log("Compacted hash tables with {} inserted and without {} deleted data points in {}.\n",
+                    mpi::sum(num_inserted, comm_), mpi::sum(num_tombstones_, comm_), t.elapsed());
+        profiler_.report("compacting the hash tables");
+        mpi::communication_profiler::report("compacting the hash tables", comm_, logger_);
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::create_delta_segment() {
+        const index_type num_points = delta_ids_.size();
+        if (num_points == 0) {
+            // empty delta segment -> never searched
+            return;
+        }
+
+        // copy the inserted data points using the memory layout of the data set
+        const data_attributes_type delta_attr(num_points, num_points, attr_.dims);
+        const get_linear_id<data_type> get_linear_id_data{};
+        data_host_buffer_type host_buffer(num_points * attr_.dims);
+        for (index_type point = 0; point < num_points; ++point) {
+            for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                host_buffer[get_linear_id_data(point, dim, delta_attr)] = delta_points_[point * attr_.dims + dim];
+            }
+        }
+        delta_data_buffer_ = data_device_buffer_type(host_buffer.begin(), host_buffer.end());
+        delta_ids_buffer_ = id_device_buffer_type(delta_ids_.begin(), delta_ids_.end());
+
+        // calculate the hash values of the inserted data points
+        hash_value_device_buffer_type hash_values(options_.num_hash_tables * num_points);
+        this->calculate_hash_values(devices_.front().queue, delta_data_buffer_, delta_attr, num_points, hash_values);
+
+        // sort the inserted data points by their hash values per hash table
+        std::vector<hash_value_type> sorted_hash_values(options_.num_hash_tables * num_points);
+        std::vector<index_type> sorted_points(options_.num_hash_tables * num_points);
+        {
+            auto acc_hash_values = hash_values.template get_access<sycl::access::mode::read>();
+            std::vector<std::pair<hash_value_type, index_type>> hash_table_points(num_points);
+            for (index_type hash_table = 0; hash_table < options_.num_hash_tables; ++hash_table) {
+                for (index_type point = 0; point < num_points; ++point) {
+                    hash_table_points[point] = std::make_pair(acc_hash_values[hash_table * num_points + point], point);
+                }
+                std::sort(hash_table_points.begin(), hash_table_points.end());
+                for (index_type point = 0; point < num_points; ++point) {
+                    sorted_hash_values[hash_table * num_points + point] = hash_table_points[point].first;
+                    sorted_points[hash_table * num_points + point] = hash_table_points[point].second;
+                }
+            }
+        }
+        delta_hash_values_buffer_ = hash_value_device_buffer_type(sorted_hash_values.begin(), sorted_hash_values.end());
+        delta_points_buffer_ = device_buffer_type(sorted_points.begin(), sorted_points.end());
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::fold_delta_segment() {
+        // insert() guarantees a single device
+        device_context& device = devices_.front();
+        const index_type num_points = device.attr.rank_size;
+        const index_type num_inserted = delta_ids_.size();
+        const data_attributes_type folded_attr(device.attr.total_size, num_points + num_inserted, attr_.dims);
+
+        // append the inserted data points to the data points of the device (never modifies the data points of the data set)
+        const get_linear_id<data_type> get_linear_id_data{};
+        data_host_buffer_type host_buffer(folded_attr.rank_size * attr_.dims);
+        {
+            auto acc_data = device.data_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type point = 0; point < num_points; ++point) {
+                for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                    host_buffer[get_linear_id_data(point, dim, folded_attr)] = acc_data[get_linear_id_data(point, dim, device.attr)];
+                }
+            }
+        }
+        for (index_type point = 0; point < num_inserted; ++point) {
+            for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                host_buffer[get_linear_id_data(num_points + point, dim, folded_attr)] = delta_points_[point * attr_.dims + dim];
+            }
+        }
+        device.data_buffer = data_device_buffer_type(host_buffer.begin(), host_buffer.end());
+        device.inserted_ids.insert(device.inserted_ids.end(), delta_ids_.begin(), delta_ids_.end());
+        device.inserted_ids_buffer = id_device_buffer_type(device.inserted_ids.begin(), device.inserted_ids.end());
+
+        // the appended data points aren't deleted
+        std::vector<index_type> tombstones(folded_attr.rank_size, 0);
+        {
+            auto acc_tombstones = device.tombstones_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type point = 0; point < num_points; ++point) {
+                tombstones[point] = acc_tombstones[point];
+            }
+        }
+        device.tombstones_buffer = device_buffer_type(tombstones.begin(), tombstones.end());
+#if defined(SYCL_LSH_REORDER_POINTS)
+        // the appended data points aren't sorted by their hash buckets, i.e. they keep their position
+        std::vector<index_type> point_ids(folded_attr.rank_size);
+        {
+            auto acc_point_ids = device.point_ids_buffer.template get_access<sycl::access::mode::read>();
+            for (index_type point = 0; point < num_points; ++point) {
+                point_ids[point] = acc_point_ids[point];
+            }
+        }
+        std::iota(point_ids.begin() + num_points, point_ids.end(), num_points);
+        device.point_ids_buffer = device_buffer_type(point_ids.begin(), point_ids.end());
+        device.point_positions.resize(folded_attr.rank_size);
+        std::iota(device.point_positions.begin() + num_points, device.point_positions.end(), num_points);
+#endif
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        // the cached hash values of the data set don't contain the appended data points -> cache the ones of all folded data points separately
+        const index_type num_folded = device.inserted_ids.size();
+        const data_attributes_type inserted_attr(num_folded, num_folded, attr_.dims);
+        data_host_buffer_type inserted_host_buffer(num_folded * attr_.dims);
+        for (index_type point = 0; point < num_folded; ++point) {
+            for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                inserted_host_buffer[get_linear_id_data(point, dim, inserted_attr)] = host_buffer[get_linear_id_data(device.num_dataset_points + point, dim, folded_attr)];
+            }
+        }
+        data_device_buffer_type inserted_data_buffer(inserted_host_buffer.begin(), inserted_host_buffer.end());
+        device.inserted_hash_values_buffer = hash_value_device_buffer_type(options_.num_hash_tables * num_folded);
+        this->calculate_hash_values(device.queue, inserted_data_buffer, inserted_attr, num_folded, device.inserted_hash_values_buffer);
+#endif
+
+        // enlarge the remaining per data point buffers (recalculated by create_hash_tables())
+        device.attr = folded_attr;
+        device.hash_tables_buffer = device_buffer_type(options_.num_hash_tables * folded_attr.rank_size + options_type::blocking_size);
+        device.signatures_buffer = hash_value_device_buffer_type(options_type::used_hash_functions_type == hash_functions_type::simhash
+                                                                 ? options_.num_hash_tables * folded_attr.rank_size : 1);
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        device.fingerprints_buffer = fingerprint_device_buffer_type(options_.num_hash_tables * folded_attr.rank_size);
+#endif
+        this->account_device_buffers();
 
-                    // perform nearest-neighbor search for all data points in the calculate hash bucket
-                    for (index_type bucket_elem = bucket_begin; bucket_elem < bucket_end; bucket_elem += options_type::blocking_size) {
-                        // initialize thread local blocking array
-                        for (index_type block = 0; block < options_type::blocking_size; ++block) {
-                            knn_blocked[block] = acc_hash_tables[hash_table * attr.rank_size + bucket_elem + block];
-                            knn_dist_blocked[block] = 0.0;
-                        }
+        // the delta segment is empty afterwards -> never searched
+        delta_points_.clear();
+        delta_ids_.clear();
+    }
 
-                        // calculate distances
-                        for (index_type block = 0; block < options_type::blocking_size; ++block) {
-                            for (index_type dim = 0; dim < attr.dims; ++dim) {
-                                const real_type x = acc_data_received[get_linear_id_data(global_idx, dim, attr)];
-                                const real_type y = acc_data_owned[get_linear_id_data(knn_blocked[block] - base_id, dim, attr)];
-                                knn_dist_blocked[block] += (x - y) * (x - y);
-                            }
-                        }
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    typename hash_tables<layout, Options, Data, HashFunctionType>::index_type
+    hash_tables<layout, Options, Data, HashFunctionType>::num_folded_points() const {
+        index_type num_folded = 0;
+        for (const device_context& device : devices_) {
+            num_folded += device.inserted_ids.size();
+        }
+        return mpi::sum(num_folded, comm_);
+    }
 
-                        // check candidate function
-                        const auto is_candidate = [&](const index_type candidate_idx, const index_type global_idx, const index_type local_idx) {
-                            if (candidate_idx - base_id == global_idx) return false;
-                            for (index_type nn = 0; nn < k; ++nn) {
-                                if (knn_local_mem[local_idx * k + nn] == candidate_idx) return false;
-                            }
-                            return true;
-                        };
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    std::vector<std::uint64_t> hash_tables<layout, Options, Data, HashFunctionType>::index_file_header() const {
+        return {
+            0x4853'4C5F'4C43'5953,      // magic number: "SYCL_LSH"
+            2,                          // file format version (2: the hash tables contain the indices local to the device)
+            sizeof(real_type),
+            sizeof(index_type),
+            sizeof(hash_value_type),
+            static_cast<std::uint64_t>(layout),
+            static_cast<std::uint64_t>(options_type::used_hash_functions_type),
+            options_type::blocking_size,
+            sizeof(typename data_type::storage_type),
+            options_.hash_pool_size,
+            options_.num_hash_functions,
+            options_.num_hash_tables,
+            options_.hash_table_size,
+            options_.num_cut_off_points,
+            options_.max_bucket_size,
+            attr_.total_size,
+            attr_.rank_size,
+            attr_.dims,
+            static_cast<std::uint64_t>(comm_.size()),
+#if defined(SYCL_LSH_REORDER_POINTS)
+            1,                          // the hash tables contain the positions of the reordered data points
+#else
+            0,
+#endif
+            data_.get_original_dims()   // differs from dims if the number of dimensions has been reduced
+        };
+    }
 
-                        // update nearest-neighbors
-                        for (index_type block = 0; block < options_type::blocking_size; ++block) {
-                            if (knn_dist_blocked[block] < knn_dist_local_mem[local_idx * k] && is_candidate(knn_blocked[block], global_idx, local_idx)) {
-                                knn_local_mem[local_idx * k] = knn_blocked[block];
-                                knn_dist_local_mem[local_idx * k] = knn_dist_blocked[block];
-
-                                // ensure that the greatest distance is at pos 0
-                                for (index_type nn = 0; nn < k - 1; ++nn) {
-                                    if (knn_dist_local_mem[local_idx * k + nn] < knn_dist_local_mem[local_idx * k + nn + 1]) {
-                                        detail::swap(knn_local_mem[local_idx * k + nn], knn_local_mem[local_idx * k + nn + 1]);
-                                        detail::swap(knn_dist_local_mem[local_idx * k + nn], knn_dist_local_mem[local_idx * k + nn + 1]);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    std::vector<typename hash_tables<layout, Options, Data, HashFunctionType>::real_type>
+    hash_tables<layout, Options, Data, HashFunctionType>::read_hash_functions(const mpi::file& file, const std::string_view file_name) const {
+        constexpr std::array<std::string_view, 21> header_names = {
+            "magic number", "file format version", "sizeof(real_type)", "sizeof(index_type)", "sizeof(hash_value_type)", "memory_layout",
+            "hash_functions_type", "blocking_size", "sizeof(storage_type)", "hash_pool_size", "num_hash_functions", "num_hash_tables",
+            "hash_table_size", "num_cut_off_points", "max_bucket_size", "total_size", "rank_size", "dims", "number of MPI ranks",
+            "SYCL_LSH_REORDER_POINTS", "original dims"
+        };
+        const std::vector<std::uint64_t> expected_header = this->index_file_header();
 
-                // write back to global buffer
-                for (index_type nn = 0; nn < k; ++nn) {
-                    acc_knn[get_linear_id_knn(global_idx, nn, attr, k)] = knn_local_mem[local_idx * k + nn];
-                    acc_knn_dist[get_linear_id_knn(global_idx, nn, attr, k)] = knn_dist_local_mem[local_idx * k + nn];
-                }
-            });
-        });
+        // read header (the last value is the number of hash function values)
+        std::vector<std::uint64_t> header(expected_header.size() + 1, 0);
+        MPI_File_read_at(file.get(), 0, header.data(), header.size(), mpi::type_cast<std::uint64_t>(), MPI_STATUS_IGNORE);
+        for (std::size_t i = 0; i < expected_header.size(); ++i) {
+            if (header[i] != expected_header[i]) {
+                throw std::runtime_error(fmt::format("Can't load hash tables from '{}': {} is {} but the current setup requires {}!",
+                                                     file_name, header_names[i], header[i], expected_header[i]));
+            }
+        }
+        MPI_Offset offset = header.size() * sizeof(std::uint64_t);
+        real_type w;
+        MPI_File_read_at(file.get(), offset, &w, 1, mpi::type_cast<real_type>(), MPI_STATUS_IGNORE);
+        if (w != options_.w) {
+            throw std::runtime_error(fmt::format("Can't load hash tables from '{}': w is {} but the current setup requires {}!", file_name, w, options_.w));
+        }
+        offset += sizeof(real_type);
+
+        // read hash functions
+        std::vector<real_type> hash_functions(header.back());
+        MPI_File_read_at(file.get(), offset, hash_functions.data(), hash_functions.size(), mpi::type_cast<real_type>(), MPI_STATUS_IGNORE);
+        return hash_functions;
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::read_hash_tables(const mpi::file& file, const std::string_view file_name) {
+        // read the byte offset of the hash tables of the current MPI rank
+        const MPI_Offset rank_table_offset = (this->index_file_header().size() + 1) * sizeof(std::uint64_t)
+                                             + (hash_functions_.get_device_buffer().get_count() + 1) * sizeof(real_type);
+        std::uint64_t rank_entry[2];
+        MPI_File_read_at(file.get(), rank_table_offset + 2 * comm_.rank() * sizeof(std::uint64_t), rank_entry, 2, mpi::type_cast<std::uint64_t>(), MPI_STATUS_IGNORE);
+
+        // the hash tables of a device can only be loaded on a device searching the same data points
+        const int num_mismatching_ranks = mpi::sum<int>(rank_entry[1] != devices_.size() ? 1 : 0, comm_);
+        if (num_mismatching_ranks > 0) {
+            throw std::runtime_error(fmt::format("Can't load hash tables from '{}': {} MPI rank(s) use another number of devices than during saving!",
+                                                 file_name, num_mismatching_ranks));
+        }
+
+        // read the offsets and hash tables of all devices of the current MPI rank concurrently
+        index_type rank_size = 0;
+        for (const device_context& device : devices_) {
+            rank_size += device.offsets_buffer.get_count() + device.hash_tables_buffer.get_count();
+        }
+        std::vector<index_type> rank_hash_tables(rank_size);
+        MPI_File_read_at_all(file.get(), rank_entry[0], rank_hash_tables.data(), rank_hash_tables.size(), mpi::type_cast<index_type>(), MPI_STATUS_IGNORE);
 
-        // wait until all k-nearest-neighbors were calculated on the current MPI rank
-        queue_.wait_and_throw();
+        // copy the offsets and hash tables to the devices
+        const index_type* ptr = rank_hash_tables.data();
+        for (device_context& device : devices_) {
+            profiler_.record(detail::profiled_command::copy_to_device, device.queue.submit([&](sycl::handler& cgh) {
+                auto acc_offsets = device.offsets_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(ptr, acc_offsets);
+            }));
+            ptr += device.offsets_buffer.get_count();
+            profiler_.record(detail::profiled_command::copy_to_device, device.queue.submit([&](sycl::handler& cgh) {
+                auto acc_hash_tables = device.hash_tables_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(ptr, acc_hash_tables);
+            }));
+            ptr += device.hash_tables_buffer.get_count();
+        }
+        // wait until the copies have been finished before the host buffer gets destroyed
+        this->wait_and_throw();
     }
 
 
@@ -402,160 +3802,1049 @@ namespace sycl_lsh {
     //                                                constructor                                                 //
     // ---------------------------------------------------------------------------------------------------------- //
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
-    hash_tables<layout, Options, Data, HashFunctionType>::hash_tables(const Options& opt, Data& data, const mpi::communicator& comm, const mpi::logger& logger)
+    hash_tables<layout, Options, Data, HashFunctionType>::hash_tables(const Options& opt, Data& data, const mpi::communicator& comm, const mpi::logger& logger,
+                                                                      const index_type query_chunk_size)
             : options_(opt), data_(data), attr_(data.get_attributes()), comm_(comm), logger_(logger),
-              hash_functions_(opt, data, comm, logger),
-              queue_(device_selector{comm}, sycl::async_handler(&sycl_exception_handler)),
-              hash_tables_buffer_(opt.num_hash_tables * data.get_attributes().rank_size + options_type::blocking_size),
-              offsets_buffer_(opt.num_hash_tables * (opt.hash_table_size + 1))
+              hash_functions_(options_, data, comm, logger), profiler_(comm, logger), memory_(comm, logger), query_chunk_size_(query_chunk_size)
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+              , hash_values_buffer_(opt.num_hash_tables * data.get_attributes().rank_size)
+#endif
     {
-        // log used devices
-        logger_.log_on_all("[{}, {}]\n", comm_.rank(), queue_.get_device().template get_info<sycl::info::device::name>());
+#if defined(SYCL_LSH_REPLICATION_FACTOR)
+        if (comm_.size() % SYCL_LSH_REPLICATION_FACTOR != 0) {
+            throw std::invalid_argument(fmt::format("The number of MPI ranks ({}) must be divisible by the replication factor ({})!",
+                                                    comm_.size(), SYCL_LSH_REPLICATION_FACTOR));
+        }
+#endif
+        this->initialize_devices();
         mpi::timer t(comm_);
 
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
         {
-            // create temporary buffer to count the occurrence of each hash value
-            device_buffer_type hash_values_count(options_.num_hash_tables * options_.hash_table_size);
-            // initialize buffer to all zeros
-            queue_.submit([&](sycl::handler& cgh) {
-              auto acc_hash_values_count = hash_values_count.template get_access<sycl::access::mode::discard_write>(cgh);
+            // calculate the hash values of all data points once
+            mpi::timer ht(comm_);
+            this->calculate_hash_values(devices_.front().queue, data_.get_device_buffer(), attr_, attr_.correct_rank_size(comm_.rank()), hash_values_buffer_);
+            #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
+                devices_.front().queue.wait_and_throw();
+            #endif
+            logger_.log("Calculated hash values in {}.\n", ht.elapsed());
+        }
+#endif
 
-              cgh.parallel_for<kernel_zero_out_buffer>(sycl::range<>(hash_values_count.get_count()), [=](sycl::item<> item) {
-                const index_type idx = item.get_linear_id();
+        this->create_hash_tables();
+        if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+            this->calculate_signatures();
+        }
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        this->calculate_fingerprints();
+#endif
+
+        logger_.log("Created hash tables in {}.\n", t.elapsed());
+        profiler_.report("creating the hash tables");
+        mpi::communication_profiler::report("creating the hash tables", comm_, logger_);
+        memory_.report("creating the hash tables");
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    hash_tables<layout, Options, Data, HashFunctionType>::hash_tables(const Options& opt, Data& data, const std::string_view file_name,
+                                                                      const mpi::communicator& comm, const mpi::logger& logger)
+            : options_(opt), data_(data), attr_(data.get_attributes()), comm_(comm), logger_(logger),
+              hash_functions_(options_, data, this->read_hash_functions(mpi::file(file_name, comm, mpi::file::mode::read), file_name)),
+              profiler_(comm, logger), memory_(comm, logger)
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+              , hash_values_buffer_(opt.num_hash_tables * data.get_attributes().rank_size)
+#endif
+    {
+#if defined(SYCL_LSH_REPLICATION_FACTOR)
+        if (comm_.size() % SYCL_LSH_REPLICATION_FACTOR != 0) {
+            throw std::invalid_argument(fmt::format("The number of MPI ranks ({}) must be divisible by the replication factor ({})!",
+                                                    comm_.size(), SYCL_LSH_REPLICATION_FACTOR));
+        }
+#endif
+        this->initialize_devices();
+        mpi::timer t(comm_);
+
+        this->read_hash_tables(mpi::file(file_name, comm_, mpi::file::mode::read), file_name);
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+        // the saved offsets are always dense -> only keep the offsets of the non-empty hash buckets
+        this->compact_offsets();
+#endif
+        if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+            this->calculate_signatures();
+        }
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+        this->calculate_fingerprints();
+#endif
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        // calculate the hash values of all data points once
+        this->calculate_hash_values(devices_.front().queue, data_.get_device_buffer(), attr_, attr_.correct_rank_size(comm_.rank()), hash_values_buffer_);
+#endif
+        this->wait_and_throw();
+
+        logger_.log("Loaded hash tables from '{}' in {}.\n", file_name, t.elapsed());
+        profiler_.report("loading the hash tables");
+        mpi::communication_profiler::report("loading the hash tables", comm_, logger_);
+        memory_.report("loading the hash tables");
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    [[nodiscard]]
+    std::pair<typename hash_tables<layout, Options, Data, HashFunctionType>::options_type, typename hash_tables<layout, Options, Data, HashFunctionType>::index_type>
+    hash_tables<layout, Options, Data, HashFunctionType>::fit_device_memory_budget(const argv_parser& parser, const options_type& opt, const data_type& data,
+                                                                                   const mpi::communicator& comm, const mpi::logger& logger) {
+        using storage_type = typename data_type::storage_type;
+        const data_attributes_type attr = data.get_attributes();
+        // the first device holds the most data points as well as all buffers of the k-nearest-neighbor search
+        const std::size_t num_points = attr.rank_size;
+        const std::size_t dims = attr.dims;
+#if defined(SYCL_LSH_EXACT_RERANKING)
+        const std::size_t k = std::min<std::size_t>(parser.argv_as<index_type>("k") * detail::rerank_factor, num_points);
+#else
+        const std::size_t k = parser.argv_as<index_type>("k");
+#endif
+
+        // the budget can't exceed the global memory of the first device
+        const std::size_t global_mem_size = detail::select_devices(comm).front().get_info<sycl::info::device::global_mem_size>();
+        const std::size_t budget_mib = parser.argv_as<std::size_t>("device_memory_budget");
+        const std::size_t budget = budget_mib == 0 ? global_mem_size : std::min<std::size_t>(budget_mib * 1024 * 1024, global_mem_size);
 
-                acc_hash_values_count[idx] = 0;
-              });
+        // the planned (approximate) peak device memory footprint of the current MPI rank
+        const auto planned_footprint = [&](const std::size_t num_hash_tables, const std::size_t query_chunk_size) -> std::size_t {
+            const std::size_t knn_bytes = num_points * k * (sizeof(index_type) + sizeof(real_type));
+            const std::size_t data_bytes = num_points * dims * sizeof(storage_type);
+            // buffers used during the whole lifetime
+            std::size_t persistent = data_bytes
+                                   + num_points * sizeof(index_type) * 2                                                  // searched tables, tombstones
+                                   + num_hash_tables * (num_points + options_type::blocking_size) * sizeof(index_type)   // hash tables
+                                   + num_hash_tables * (opt.hash_table_size + 1) * sizeof(index_type)                   // offsets
+                                   + num_hash_tables * opt.num_hash_functions * (dims + 1) * sizeof(real_type);          // hash functions
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+            persistent += 3 * num_points * sizeof(index_type);
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+            persistent += num_hash_tables * num_points * sizeof(detail::fingerprint_type) + 2 * num_points * sizeof(index_type);
+#endif
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+            persistent += num_hash_tables * num_points * sizeof(hash_value_type);
+#endif
+            if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+                persistent += num_hash_tables * num_points * sizeof(hash_value_type);
+            }
+            // the temporary hash value counts during the creation of the hash tables
+            const std::size_t creation = num_hash_tables * opt.hash_table_size * sizeof(index_type);
+            // the received data points and k-nearest-neighbors during the search
+#if defined(SYCL_LSH_GPU_AWARE_MPI)
+            const std::size_t search = 3 * (data_bytes + knn_bytes);
+#else
+            const std::size_t search = query_chunk_size == 0 ? data_bytes + knn_bytes
+                                     : num_query_chunks * std::min(query_chunk_size, num_points) * (dims * sizeof(storage_type) + k * (sizeof(index_type) + sizeof(real_type)));
+#endif
+            return persistent + std::max(creation, search);
+        };
+
+        // the largest query chunk size (halving down to 1024 queries) fitting into the budget
+        const auto fitting_query_chunk_size = [&](const std::size_t num_hash_tables) -> index_type {
+#if SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_RING && !defined(SYCL_LSH_GPU_AWARE_MPI)
+            if (planned_footprint(num_hash_tables, default_query_chunk_size) > budget) {
+                constexpr index_type min_query_chunk_size = 1024;
+                index_type query_chunk_size = default_query_chunk_size == 0 ? attr.rank_size : std::min<index_type>(default_query_chunk_size, attr.rank_size);
+                while (query_chunk_size > min_query_chunk_size && planned_footprint(num_hash_tables, query_chunk_size) > budget) {
+                    query_chunk_size = std::max<index_type>(query_chunk_size / 2, min_query_chunk_size);
+                }
+                return query_chunk_size;
+            }
+#endif
+            return default_query_chunk_size;
+        };
+
+        options_type fitted_opt = opt;
+        logger.log("Planned device memory footprint: {:.2f} MiB (budget: {:.2f} MiB).\n",
+                   detail::to_mib(mpi::max(planned_footprint(opt.num_hash_tables, default_query_chunk_size), comm)), detail::to_mib(mpi::min(budget, comm)));
+
+        // reduce the number of hash tables if the out-of-core mode isn't sufficient (must be the same on all MPI ranks)
+        index_type query_chunk_size = fitting_query_chunk_size(opt.num_hash_tables);
+        index_type num_hash_tables = opt.num_hash_tables;
+        while (num_hash_tables > 1 && planned_footprint(num_hash_tables, query_chunk_size) > budget) {
+            --num_hash_tables;
+        }
+        fitted_opt.num_hash_tables = mpi::min(num_hash_tables, comm);
+        // less hash tables may allow larger query chunks again
+        query_chunk_size = fitting_query_chunk_size(fitted_opt.num_hash_tables);
+
+        if (mpi::max(static_cast<int>(planned_footprint(fitted_opt.num_hash_tables, query_chunk_size) > budget), comm) != 0) {
+            throw std::runtime_error(fmt::format("The planned device memory footprint exceeds the budget of {:.2f} MiB even with a single hash table!",
+                                                 detail::to_mib(budget)));
+        }
+        if (fitted_opt.num_hash_tables != opt.num_hash_tables) {
+            logger.log("Reduced the number of hash tables from {} to {} to fit into the device memory budget.\n", opt.num_hash_tables, fitted_opt.num_hash_tables);
+        }
+        if (query_chunk_size != default_query_chunk_size) {
+            logger.log_on_all("[{}] Streaming the received data points through the device in chunks of {} to fit into the device memory budget.\n",
+                              comm.rank(), query_chunk_size);
+        }
+        return std::make_pair(fitted_opt, query_chunk_size);
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::initialize_devices() {
+        // split the real data points (i.e. without the dummy points on the last MPI rank) of the current MPI rank evenly across all used devices
+        const std::vector<sycl::device> devices = detail::select_devices(comm_);
+        const index_type rank_size = attr_.correct_rank_size(comm_.rank());
+        const index_type num_devices = std::max<index_type>(std::min<index_type>(devices.size(), rank_size), 1);
+        const get_linear_id<data_type> get_linear_id_data{};
+        index_type first_point = 0;
+        for (index_type device = 0; device < num_devices; ++device) {
+            const index_type num_points = rank_size / num_devices + (device < rank_size % num_devices ? 1 : 0);
+            const data_attributes_type device_attr(attr_.total_size, num_points, attr_.dims);
+
+            data_device_buffer_type data_buffer = data_.get_device_buffer();
+            if (num_points != attr_.rank_size) {
+                // copy the data points assigned to the current device
+                const data_host_buffer_type& host_buffer = data_.get_host_buffer();
+                data_host_buffer_type device_host_buffer(num_points * attr_.dims);
+                for (index_type point = 0; point < num_points; ++point) {
+                    for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                        device_host_buffer[get_linear_id_data(point, dim, device_attr)] = host_buffer[get_linear_id_data(first_point + point, dim, attr_)];
+                    }
+                }
+                data_buffer = data_device_buffer_type(device_host_buffer.begin(), device_host_buffer.end());
+            }
+
+            devices_.push_back(device_context{ sycl::queue(devices[device], sycl::async_handler(&sycl_exception_handler), detail::device_profiler::queue_properties()),
+                                               device_attr, first_point, data_buffer,
+                                               device_buffer_type(options_.num_hash_tables * num_points + options_type::blocking_size),
+                                               device_buffer_type(options_.num_hash_tables * (options_.hash_table_size + 1))
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+                                               , hash_value_device_buffer_type(options_.num_hash_tables)
+                                               , device_buffer_type(options_.num_hash_tables + 1)
+#endif
+                                               , hash_value_device_buffer_type(options_type::used_hash_functions_type == hash_functions_type::simhash
+                                                                               ? options_.num_hash_tables * num_points : 1)
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+                                               , fingerprint_device_buffer_type(options_.num_hash_tables * num_points)
+                                               , device_buffer_type(2 * attr_.rank_size)
+#endif
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+                                               , device_buffer_type(3 * attr_.rank_size)
+#endif
+                                               , device_buffer_type(attr_.rank_size)
+                                               , device_buffer_type(num_points)
+                                               , num_points
+                                               , std::vector<id_type>{}
+                                               , id_device_buffer_type(sycl::range<>(1))
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+                                               , hash_value_device_buffer_type(sycl::range<>(1))
+#endif
+#if defined(SYCL_LSH_REORDER_POINTS)
+                                               , device_buffer_type(num_points)
+                                               , std::vector<index_type>(num_points)
+#endif
+                                             });
+            first_point += num_points;
+        }
+#if defined(SYCL_LSH_REORDER_POINTS)
+        this->reorder_points();
+#endif
+        this->account_device_buffers();
+
+        // initially no data point is deleted
+        for (device_context& device : devices_) {
+            device.queue.submit([&](sycl::handler& cgh) {
+                auto acc_tombstones = device.tombstones_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.fill(acc_tombstones, index_type{ 0 });
             });
+        }
 
-            // count the occurrence of each hash value per hash table
-            this->count_hash_values(hash_values_count);
-            // calculate the offset values
-            this->calculate_offsets(hash_values_count);
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        // the host CPU device co-executes the k-nearest-neighbor search (only used together with a single device)
+        if (devices_.size() == 1) {
+            host_queue_.emplace(sycl::cpu_selector{}, sycl::async_handler(&sycl_exception_handler), detail::device_profiler::queue_properties());
         }
-        // fill the hash tables based on the previously calculated offsets
-        this->fill_hash_tables();
+#endif
 
-        logger_.log("Created hash tables in {}.\n", t.elapsed());
+        // log used devices
+        for (const device_context& device : devices_) {
+            logger_.log_on_all("[{}, {}]\n", comm_.rank(), device.queue.get_device().template get_info<sycl::info::device::name>());
+        }
+#if defined(SYCL_LSH_HOST_CO_EXECUTION)
+        if (host_queue_.has_value()) {
+            logger_.log_on_all("[{}, {}] (co-executing)\n", comm_.rank(), host_queue_->get_device().template get_info<sycl::info::device::name>());
+        }
+#endif
     }
 
+#if defined(SYCL_LSH_REORDER_POINTS)
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
-    void hash_tables<layout, Options, Data, HashFunctionType>::count_hash_values(device_buffer_type& hash_values_count) {
+    void hash_tables<layout, Options, Data, HashFunctionType>::reorder_points() {
         mpi::timer t(comm_);
 
-        queue_.submit([&](sycl::handler& cgh) {
+        const data_host_buffer_type& host_buffer = data_.get_host_buffer();
+        const get_linear_id<data_type> get_linear_id_data{};
+        for (device_context& device : devices_) {
+            const index_type num_points = device.attr.rank_size;
+
+            // calculate the hash values of the data points assigned to the device
+            hash_value_device_buffer_type hash_values(options_.num_hash_tables * num_points);
+            this->calculate_hash_values(device.queue, device.data_buffer, device.attr, num_points, hash_values);
+
+            // sort the data points by their hash buckets in the first hash table (data points in the same hash bucket keep their order)
+            std::vector<index_type> point_ids(num_points);
+            std::iota(point_ids.begin(), point_ids.end(), 0);
+            {
+                auto acc_hash_values = hash_values.template get_access<sycl::access::mode::read>();
+                std::stable_sort(point_ids.begin(), point_ids.end(), [&](const index_type lhs, const index_type rhs) {
+                    return acc_hash_values[lhs] < acc_hash_values[rhs];
+                });
+            }
+
+            // copy the data points in the sorted order (never modifies the data points of the data set shared with a single device)
+            data_host_buffer_type device_host_buffer(num_points * attr_.dims);
+            for (index_type point = 0; point < num_points; ++point) {
+                device.point_positions[point_ids[point]] = point;
+                for (index_type dim = 0; dim < attr_.dims; ++dim) {
+                    device_host_buffer[get_linear_id_data(point, dim, device.attr)] = host_buffer[get_linear_id_data(device.first_point + point_ids[point], dim, attr_)];
+                }
+            }
+            device.data_buffer = data_device_buffer_type(device_host_buffer.begin(), device_host_buffer.end());
+            device.point_ids_buffer = device_buffer_type(point_ids.begin(), point_ids.end());
+        }
+
+        logger_.log("Reordered the data points by hash bucket in {}.\n", t.elapsed());
+    }
+#endif
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::account_device_buffers() {
+        memory_.allocate("hash functions", hash_functions_.get_device_buffer().get_size());
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+        memory_.allocate("cached hash values", hash_values_buffer_.get_size());
+#endif
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            device_context& context = devices_[device];
+            memory_.allocate(fmt::format("device {}: data points", device), context.data_buffer.get_size());
+            memory_.allocate(fmt::format("device {}: hash tables", device), context.hash_tables_buffer.get_size());
+            std::size_t offsets_size = context.offsets_buffer.get_size();
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+            offsets_size += context.bucket_hash_values_buffer.get_size() + context.directory_buffer.get_size();
+#endif
+            memory_.allocate(fmt::format("device {}: offsets", device), offsets_size);
+            if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+                memory_.allocate(fmt::format("device {}: signatures", device), context.signatures_buffer.get_size());
+            }
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+            memory_.allocate(fmt::format("device {}: fingerprints", device), context.fingerprints_buffer.get_size());
+#endif
+            std::size_t counters_size = context.searched_tables_buffer.get_size() + context.tombstones_buffer.get_size();
+#if defined(SYCL_LSH_SEEN_FILTER_SIZE)
+            counters_size += context.candidate_count_buffer.get_size();
+#endif
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+            counters_size += context.fingerprint_count_buffer.get_size();
+#endif
+            memory_.allocate(fmt::format("device {}: per query counters", device), counters_size);
+#if defined(SYCL_LSH_REORDER_POINTS)
+            memory_.allocate(fmt::format("device {}: original positions", device), context.point_ids_buffer.get_size());
+#endif
+            if (!context.inserted_ids.empty()) {
+                std::size_t inserted_size = context.inserted_ids_buffer.get_size();
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+                inserted_size += context.inserted_hash_values_buffer.get_size();
+#endif
+                memory_.allocate(fmt::format("device {}: inserted IDs", device), inserted_size);
+            }
+        }
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::wait_and_throw() {
+        for (device_context& device : devices_) {
+            device.queue.wait_and_throw();
+        }
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_hash_values(sycl::queue& queue, data_device_buffer_type& data_buffer, const data_attributes_type& attr,
+                                                                                   const index_type num_points, hash_value_device_buffer_type& hash_values) {
+#if defined(SYCL_LSH_GEMM_HASHING)
+        if (num_points == 0) return;
+
+        // the dot products of all data points with all hash functions form a dense (num_points x dims) * (dims x num_columns) matrix product
+        constexpr index_type tile_size = detail::gemm_tile_size;
+        const index_type num_columns = options_.num_hash_tables * options_.num_hash_functions;
+        const index_type num_column_tiles = (num_columns + tile_size - 1) / tile_size;
+        const index_type chunk_size = std::min<index_type>(detail::gemm_chunk_size, num_points);
+        sycl::buffer<real_type, 1> dot_products(sycl::range<>(chunk_size * num_columns));
+
+        for (index_type chunk_first = 0; chunk_first < num_points; chunk_first += chunk_size) {
+            const index_type chunk_points = std::min<index_type>(chunk_size, num_points - chunk_first);
+            const index_type num_row_tiles = (chunk_points + tile_size - 1) / tile_size;
+
+            // calculate the dot products of the data points of the current chunk
+            profiler_.record(detail::profiled_command::calculate_hash_values, queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_dot_products = dot_products.template get_access<sycl::access::mode::discard_write>(cgh);
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                auto acc_data = data_.get_device_accessor(data_buffer, attr, cgh);
+                // get additional information
+                auto options = options_;
+                // get get_linear_id functor instantiation
+                const get_linear_id<data_type> get_linear_id_data{};
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+
+                // create local memory accessors
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        tile_a(sycl::range<>(tile_size * tile_size), cgh);
+                sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                        tile_b(sycl::range<>(tile_size * tile_size), cgh);
+
+                const auto execution_range = sycl::nd_range<>(sycl::range<>(num_row_tiles * num_column_tiles * tile_size * tile_size),
+                                                               sycl::range<>(tile_size * tile_size));
+
+                cgh.parallel_for<kernel_calculate_dot_products>(execution_range, [=](sycl::nd_item<> item) {
+                    const index_type group = item.get_group_linear_id();
+                    const index_type local_row = item.get_local_linear_id() / tile_size;
+                    const index_type local_col = item.get_local_linear_id() % tile_size;
+                    const index_type row = (group / num_column_tiles) * tile_size + local_row;
+                    const index_type col = (group % num_column_tiles) * tile_size + local_col;
+
+                    // work-items outside of the matrix stage the values of the last data point or hash function (no early return because of the barriers)
+                    const index_type point = chunk_first + (row < chunk_points ? row : chunk_points - 1);
+                    const index_type column = col < num_columns ? col : num_columns - 1;
+                    const index_type hash_table = column / options.num_hash_functions;
+                    const index_type hash_function = column % options.num_hash_functions;
+                    // the number of dimensions (compile time constant if known)
+                    const index_type dims = detail::get_dims<options_type>(attr);
+
+                    // start with the offset of the hash function -> same accumulation order as lsh_hash::operator()
+                    const real_type dot_product = detail::tiled_gemm_entry(item, row, col, local_row, local_col, tile_a, tile_b, dims,
+                            hasher.coefficient(hash_table, hash_function, dims, acc_hash_functions, options, attr),
+                            [&](const index_type, const index_type dim) -> real_type {
+                                return acc_data[get_linear_id_data(point, dim, attr)];
+                            },
+                            [&](const index_type dim, const index_type) -> real_type {
+                                return hasher.coefficient(hash_table, hash_function, dim, acc_hash_functions, options, attr);
+                            });
+
+                    if (row < chunk_points && col < num_columns) {
+                        acc_dot_products[row * num_columns + col] = dot_product;
+                    }
+                });
+            }));
+
+            // quantize and combine the dot products of each hash table
+            profiler_.record(detail::profiled_command::calculate_hash_values, queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_hash_values = hash_values.template get_access<sycl::access::mode::write>(cgh);
+                auto acc_dot_products = dot_products.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                // get additional information
+                auto options = options_;
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+
+                cgh.parallel_for<kernel_combine_dot_products>(sycl::range<>(chunk_points), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                        acc_hash_values[hash_table * attr.rank_size + chunk_first + idx] = hasher.combine_dot_products(hash_table, acc_dot_products,
+                                idx * num_columns + hash_table * options.num_hash_functions, acc_hash_functions, options, attr);
+                    }
+                });
+            }));
+        }
+#else
+        profiler_.record(detail::profiled_command::calculate_hash_values, queue.submit([&](sycl::handler& cgh) {
             // get accessors
-            auto acc_hash_values_count = hash_values_count.template get_access<sycl::access::mode::atomic>(cgh);
+            auto acc_hash_values = hash_values.template get_access<sycl::access::mode::discard_write>(cgh);
             auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-            auto acc_data = data_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+            auto acc_data = data_.get_device_accessor(data_buffer, attr, cgh);
             // get additional information
             auto options = options_;
-            auto attr = attr_;
             // get hasher functor instantiation
             const lsh_hash<hash_function_type> hasher{};
 
-            cgh.parallel_for<kernel_count_hash_values>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+            cgh.parallel_for<kernel_calculate_hash_values>(sycl::range<>(num_points), [=](sycl::item<> item) {
                 const index_type idx = item.get_linear_id();
 
                 for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
-                    const hash_value_type hash_value = hasher(hash_table, idx, acc_data, acc_hash_functions, options, attr);
-                    acc_hash_values_count[hash_table * options.hash_table_size + hash_value].fetch_add(1);
+                    acc_hash_values[hash_table * attr.rank_size + idx] = hasher(hash_table, idx, acc_data, acc_hash_functions, options, attr);
                 }
             });
-        });
+        }));
+#endif
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::create_hash_tables() {
+        {
+            // create temporary buffers to count the occurrence of each hash value on each device
+            std::vector<device_buffer_type> hash_values_count;
+            for (device_context& device : devices_) {
+                device_buffer_type& device_hash_values_count = hash_values_count.emplace_back(options_.num_hash_tables * options_.hash_table_size);
+                memory_.allocate(fmt::format("device {}: hash value counts (temporary)", hash_values_count.size() - 1), device_hash_values_count.get_size());
+                // initialize buffer to all zeros
+                device.queue.submit([&](sycl::handler& cgh) {
+                  auto acc_hash_values_count = device_hash_values_count.template get_access<sycl::access::mode::discard_write>(cgh);
+
+                  cgh.parallel_for<kernel_zero_out_buffer>(sycl::range<>(device_hash_values_count.get_count()), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    acc_hash_values_count[idx] = 0;
+                  });
+                });
+            }
+
+            // count the occurrence of each hash value per hash table
+            this->count_hash_values(hash_values_count);
+            // limit the number of data points per hash bucket
+            this->cap_bucket_sizes(hash_values_count);
+            // calculate the offset values
+            this->calculate_offsets(hash_values_count);
+            // calculate the hash bucket statistics (e.g. to judge the quality of the used options without a k-nearest-neighbor search)
+            this->calculate_bucket_statistics(hash_values_count);
+            // fill the hash tables based on the previously calculated offsets
+            this->fill_hash_tables(hash_values_count);
+            for (std::size_t device = 0; device < hash_values_count.size(); ++device) {
+                memory_.release(fmt::format("device {}: hash value counts (temporary)", device));
+            }
+        }
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+        // only keep the offsets of the non-empty hash buckets
+        this->compact_offsets();
+#endif
+        num_pending_tombstones_ = 0;
+    }
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::count_hash_values(std::vector<device_buffer_type>& hash_values_count) {
+        mpi::timer t(comm_);
+
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            device_context& context = devices_[device];
+            profiler_.record(detail::profiled_command::count_hash_values, context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_hash_values_count = hash_values_count[device].template get_access<sycl::access::mode::atomic>(cgh);
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+                auto acc_hash_values = hash_values_buffer_.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_inserted_hash_values = context.inserted_hash_values_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_REORDER_POINTS)
+                auto acc_point_ids = context.point_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+#else
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                auto acc_data = data_.get_device_accessor(context.data_buffer, context.attr, cgh);
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+#endif
+                auto acc_tombstones = context.tombstones_buffer.template get_access<sycl::access::mode::read>(cgh);
+                // get additional information
+                auto options = options_;
+                [[maybe_unused]] auto attr = attr_;
+                auto device_attr = context.attr;
+                [[maybe_unused]] const index_type first_point = context.first_point;
+                [[maybe_unused]] const index_type num_dataset_points = context.num_dataset_points;
+                [[maybe_unused]] const index_type num_inserted_points = context.inserted_ids.size();
+
+                cgh.parallel_for<kernel_count_hash_values>(sycl::range<>(device_attr.rank_size), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    // deleted data points aren't inserted in the hash tables
+                    if (acc_tombstones[idx] != 0) return;
+
+                    for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+#if defined(SYCL_LSH_REORDER_POINTS)
+                        // the cached hash values are stored in the original order
+                        const index_type point = acc_point_ids[idx];
+#else
+                        const index_type point = idx;
+#endif
+                        // the cached hash values of the data set don't contain the inserted data points folded in by compact()
+                        const hash_value_type hash_value = point < num_dataset_points
+                                                           ? acc_hash_values[hash_table * attr.rank_size + first_point + point]
+                                                           : acc_inserted_hash_values[hash_table * num_inserted_points + point - num_dataset_points];
+#else
+                        const hash_value_type hash_value = hasher(hash_table, idx, acc_data, acc_hash_functions, options, device_attr);
+#endif
+                        acc_hash_values_count[hash_table * options.hash_table_size + hash_value].fetch_add(1);
+                    }
+                });
+            }));
+        }
         #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
-            queue_.wait_and_throw();
+            this->wait_and_throw();
         #endif
 
         logger_.log("Counted hash values in {}.\n", t.elapsed());
     }
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
-    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_offsets(device_buffer_type& hash_values_count) {
+    void hash_tables<layout, Options, Data, HashFunctionType>::cap_bucket_sizes(std::vector<device_buffer_type>& hash_values_count) {
+        if (options_.max_bucket_size == 0) {
+            return;
+        }
+
+        // count the oversized hash buckets
+        index_type num_buckets = 0;
+        index_type num_capped_buckets = 0;
+        for (device_buffer_type& device_hash_values_count : hash_values_count) {
+            auto acc_hash_values_count = device_hash_values_count.template get_access<sycl::access::mode::read>();
+            for (index_type bucket = 0; bucket < device_hash_values_count.get_count(); ++bucket) {
+                const index_type bucket_size = acc_hash_values_count[bucket];
+                num_buckets += bucket_size > 0 ? 1 : 0;
+                num_capped_buckets += bucket_size > options_.max_bucket_size ? 1 : 0;
+            }
+        }
+        num_buckets = mpi::sum(num_buckets, comm_);
+        num_capped_buckets = mpi::sum(num_capped_buckets, comm_);
+
         mpi::timer t(comm_);
 
-        queue_.submit([&](sycl::handler& cgh) {
-            // get accessors
-            auto acc_hash_values_count = hash_values_count.template get_access<sycl::access::mode::read>(cgh);
-            auto acc_offset = offsets_buffer_.template get_access<sycl::access::mode::discard_write>(cgh);
-            // get additional information
-            auto options = options_;
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            devices_[device].queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_hash_values_count = hash_values_count[device].template get_access<sycl::access::mode::read_write>(cgh);
+                // get additional information
+                const index_type max_size = options_.max_bucket_size;
 
-            cgh.parallel_for<kernel_calculate_offsets>(sycl::range<>(options.num_hash_tables), [=](sycl::item<> item){
-                const index_type idx = item.get_linear_id();
+                cgh.parallel_for<kernel_cap_bucket_sizes>(sycl::range<>(hash_values_count[device].get_count()), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
 
-                // calculate constant offsets
-                const index_type hash_table_offset = idx * (options.hash_table_size + 1);
-                const index_type hash_value_count_offset = idx * options.hash_table_size;
-                // zero out the first two offsets in each hash table
-                acc_offset[hash_table_offset] = 0;
-                acc_offset[hash_table_offset + 1] = 0;
-                // fill remaining offset values
-                for (index_type hash_value = 2; hash_value <= options.hash_table_size; ++hash_value) {
-                    // calculated modified prefix sum
-                    acc_offset[hash_table_offset + hash_value] =
-                            acc_offset[hash_table_offset + hash_value - 1] +
-                            acc_hash_values_count[hash_value_count_offset + hash_value - 2];
-                }
+                    if (acc_hash_values_count[idx] > max_size) {
+                        acc_hash_values_count[idx] = max_size;
+                    }
+                });
             });
-        });
+        }
+        #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
+            this->wait_and_throw();
+        #endif
+
+        logger_.log("Capped {} of {} non-empty hash buckets to {} data points in {}.\n", num_capped_buckets, num_buckets, options_.max_bucket_size, t.elapsed());
+    }
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_offsets(std::vector<device_buffer_type>& hash_values_count) {
+        mpi::timer t(comm_);
+
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            device_context& context = devices_[device];
+            // zero out the first offset in each hash table
+            profiler_.record(detail::profiled_command::calculate_offsets, context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_offset = context.offsets_buffer.template get_access<sycl::access::mode::write>(cgh);
+                // get additional information
+                auto options = options_;
+
+                cgh.parallel_for<kernel_calculate_offsets>(sycl::range<>(options.num_hash_tables), [=](sycl::item<> item){
+                    const index_type idx = item.get_linear_id();
+
+                    acc_offset[idx * (options.hash_table_size + 1)] = 0;
+                });
+            }));
+            // calculate modified prefix sum: offset[hash_value + 1] = sum of all counts of hash values less than hash_value
+            // (incremented to the correct hash bucket end during filling of the hash tables)
+            detail::exclusive_scan(context.queue, hash_values_count[device], context.offsets_buffer,
+                                   options_.num_hash_tables, options_.hash_table_size, options_.hash_table_size + 1, 1);
+        }
         #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
-            queue_.wait_and_throw();
+            this->wait_and_throw();
         #endif
 
         logger_.log("Calculated offsets in {}.\n", t.elapsed());
     }
     template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
-    void hash_tables<layout, Options, Data, HashFunctionType>::fill_hash_tables() {
+    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_bucket_statistics(std::vector<device_buffer_type>& hash_values_count) {
         mpi::timer t(comm_);
 
-        queue_.submit([&](sycl::handler& cgh) {
-            // get accessors
-            auto acc_data = data_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-            auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
-            auto acc_offsets = offsets_buffer_.template get_access<sycl::access::mode::atomic>(cgh);
-            auto acc_hash_tables = hash_tables_buffer_.template get_access<sycl::access::mode::write>(cgh);
-            // get additional information
-            auto options = options_;
-            auto attr = attr_;
-            const index_type base_id = comm_.rank() * attr_.rank_size;
-            const index_type comm_rank = comm_.rank();
-            const index_type comm_size = comm_.size();
-            // get hasher functor instantiation
-            const lsh_hash<hash_function_type> hasher{};
+        // the number of consecutive hash buckets reduced by a single work-item
+        constexpr index_type buckets_per_item = 256;
+        // the maximum number of bins of the bucket size histogram
+        constexpr index_type max_num_bins = 4096;
 
-            cgh.parallel_for<kernel_fill_hash_tables>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
-                const index_type idx = item.get_linear_id();
+        // reduce chunks of hash buckets on the devices: number of occupied buckets, largest bucket, number of entries and squared bucket sizes
+        std::vector<sycl::buffer<std::uint64_t, 1>> partials;
+        partials.reserve(devices_.size());
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            const index_type num_buckets = hash_values_count[device].get_count();
+            const index_type num_items = (num_buckets + buckets_per_item - 1) / buckets_per_item;
+            sycl::buffer<std::uint64_t, 1>& device_partials = partials.emplace_back(sycl::range<1>(4 * num_items));
+            devices_[device].queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_hash_values_count = hash_values_count[device].template get_access<sycl::access::mode::read>(cgh);
+                auto acc_partials = device_partials.template get_access<sycl::access::mode::discard_write>(cgh);
+
+                cgh.parallel_for<kernel_reduce_bucket_statistics>(sycl::range<>(num_items), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type last = (idx + 1) * buckets_per_item < num_buckets ? (idx + 1) * buckets_per_item : num_buckets;
 
-                index_type val = base_id + idx;
-                if (comm_rank == comm_size - 1) {
-                    // set correct values IDs for dummy points
-                    const index_type correct_rank_size = attr.total_size - ((comm_size - 1) * attr.rank_size);
-                    if (idx >= correct_rank_size) {
-                        val = base_id + correct_rank_size - 1;
+                    std::uint64_t occupied = 0, largest = 0, entries = 0, squares = 0;
+                    for (index_type bucket = idx * buckets_per_item; bucket < last; ++bucket) {
+                        const std::uint64_t bucket_size = acc_hash_values_count[bucket];
+                        occupied += bucket_size > 0 ? 1 : 0;
+                        largest = bucket_size > largest ? bucket_size : largest;
+                        entries += bucket_size;
+                        squares += bucket_size * bucket_size;
                     }
+                    acc_partials[4 * idx] = occupied;
+                    acc_partials[4 * idx + 1] = largest;
+                    acc_partials[4 * idx + 2] = entries;
+                    acc_partials[4 * idx + 3] = squares;
+                });
+            });
+        }
+
+        // combine the (few) partial results on the host
+        bucket_statistics stats;
+        std::uint64_t largest = 0;
+        std::uint64_t num_entries = 0;
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            auto acc_partials = partials[device].template get_access<sycl::access::mode::read>();
+            std::uint64_t squares = 0;
+            for (std::size_t i = 0; i < acc_partials.get_count(); i += 4) {
+                stats.num_occupied_buckets += acc_partials[i];
+                largest = std::max<std::uint64_t>(largest, acc_partials[i + 1]);
+                num_entries += acc_partials[i + 2];
+                squares += acc_partials[i + 3];
+            }
+            stats.num_buckets += hash_values_count[device].get_count();
+            // a query hashes into a bucket with a probability proportional to its size and compares against all of its data points
+            stats.expected_candidates += static_cast<double>(squares) / std::max<index_type>(devices_[device].attr.rank_size, 1);
+        }
+        stats.num_buckets = mpi::sum(stats.num_buckets, comm_);
+        stats.num_occupied_buckets = mpi::sum(stats.num_occupied_buckets, comm_);
+        stats.max_bucket_size = static_cast<index_type>(mpi::max(largest, comm_));
+        num_entries = mpi::sum(num_entries, comm_);
+        stats.mean_bucket_size = stats.num_occupied_buckets > 0 ? static_cast<double>(num_entries) / stats.num_occupied_buckets : 0.0;
+        stats.expected_candidates = mpi::sum(stats.expected_candidates, comm_);
+
+        if (stats.max_bucket_size > 0) {
+            // histogram of the non-empty bucket sizes: bin i contains the sizes [i * bin_width + 1, (i + 1) * bin_width]
+            const index_type num_bins = std::min(stats.max_bucket_size, max_num_bins);
+            const index_type bin_width = (stats.max_bucket_size + num_bins - 1) / num_bins;
+            std::vector<device_buffer_type> histograms;
+            histograms.reserve(devices_.size());
+            for (std::size_t device = 0; device < devices_.size(); ++device) {
+                device_buffer_type& device_histogram = histograms.emplace_back(sycl::range<1>(num_bins));
+                devices_[device].queue.submit([&](sycl::handler& cgh) {
+                    auto acc_histogram = device_histogram.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.fill(acc_histogram, index_type{ 0 });
+                });
+                devices_[device].queue.submit([&](sycl::handler& cgh) {
+                    // get accessors
+                    auto acc_hash_values_count = hash_values_count[device].template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_histogram = device_histogram.template get_access<sycl::access::mode::atomic>(cgh);
+
+                    cgh.parallel_for<kernel_bucket_size_histogram>(sycl::range<>(hash_values_count[device].get_count()), [=](sycl::item<> item) {
+                        const index_type bucket_size = acc_hash_values_count[item.get_linear_id()];
+
+                        if (bucket_size > 0) {
+                            acc_histogram[(bucket_size - 1) / bin_width].fetch_add(1);
+                        }
+                    });
+                });
+            }
+            std::vector<std::uint64_t> histogram(num_bins, 0);
+            for (device_buffer_type& device_histogram : histograms) {
+                auto acc_histogram = device_histogram.template get_access<sycl::access::mode::read>();
+                for (index_type bin = 0; bin < num_bins; ++bin) {
+                    histogram[bin] += acc_histogram[bin];
                 }
+            }
+            histogram = mpi::sum(std::move(histogram), comm_);
 
-                for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
-                    // get hash value
-                    const hash_value_type hash_value = hasher(hash_table, idx, acc_data, acc_hash_functions, options, attr);
-                    // update offsets
-                    const index_type hash_table_idx = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_value + 1].fetch_add(1);
-                    acc_hash_tables[hash_table * attr.rank_size + hash_table_idx] = val;
+            // the upper bound of the bin containing the respective percentile
+            constexpr std::array<double, 3> percentiles = { 0.5, 0.9, 0.99 };
+            std::uint64_t cumulative = 0;
+            std::size_t percentile = 0;
+            for (index_type bin = 0; bin < num_bins && percentile < percentiles.size(); ++bin) {
+                cumulative += histogram[bin];
+                while (percentile < percentiles.size() && cumulative >= percentiles[percentile] * stats.num_occupied_buckets) {
+                    stats.percentile_bucket_sizes[percentile++] = std::min((bin + 1) * bin_width, stats.max_bucket_size);
                 }
-               
-                // fill additional values needed for blocking
-                if (idx == attr.rank_size - 1) {
-                    for (index_type block = 0; block < options_type::blocking_size; ++block) {
-                        acc_hash_tables[options.num_hash_tables * attr.rank_size + block] = val;
-                    }
+            }
+        }
+        bucket_statistics_ = stats;
+
+        logger_.log("Calculated hash bucket statistics in {}:\n", t.elapsed());
+        logger_.log("  occupied hash buckets: {} of {} ({:.2f}%)\n", stats.num_occupied_buckets, stats.num_buckets,
+                    stats.num_buckets > 0 ? 100.0 * stats.num_occupied_buckets / stats.num_buckets : 0.0);
+        logger_.log("  hash bucket size: max {}, mean {:.2f}, p50 {}, p90 {}, p99 {}\n", stats.max_bucket_size, stats.mean_bucket_size,
+                    stats.percentile_bucket_sizes[0], stats.percentile_bucket_sizes[1], stats.percentile_bucket_sizes[2]);
+        logger_.log("  expected candidates per query: {:.2f}\n", stats.expected_candidates);
+    }
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::fill_hash_tables(std::vector<device_buffer_type>& hash_values_count) {
+        mpi::timer t(comm_);
+
+        for (std::size_t device = 0; device < devices_.size(); ++device) {
+            device_context& context = devices_[device];
+            // the blocking reads past the hash bucket ends -> use the index of a not deleted data point as padding
+            index_type padding_point = 0;
+            if (num_tombstones_ > 0) {
+                auto acc_tombstones = context.tombstones_buffer.template get_access<sycl::access::mode::read>();
+                while (padding_point + 1 < context.attr.rank_size && acc_tombstones[padding_point] != 0) {
+                    ++padding_point;
                 }
-            });
-        });
+            }
+            if (options_.max_bucket_size != 0 || num_tombstones_ > 0) {
+                // the capped hash tables or the hash tables without the deleted data points don't fill their whole part of the buffer
+                // -> initialize it with a valid index since the blocking reads past the hash bucket ends
+                context.queue.submit([&](sycl::handler& cgh) {
+                    auto acc_hash_tables = context.hash_tables_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    cgh.fill(acc_hash_tables, padding_point);
+                });
+            }
+            profiler_.record(detail::profiled_command::fill_hash_tables, context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+                auto acc_hash_values = hash_values_buffer_.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_inserted_hash_values = context.inserted_hash_values_buffer.template get_access<sycl::access::mode::read>(cgh);
+#if defined(SYCL_LSH_REORDER_POINTS)
+                auto acc_point_ids = context.point_ids_buffer.template get_access<sycl::access::mode::read>(cgh);
+#endif
+#else
+                auto acc_data = data_.get_device_accessor(context.data_buffer, context.attr, cgh);
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+#endif
+                auto acc_offsets = context.offsets_buffer.template get_access<sycl::access::mode::atomic>(cgh);
+                auto acc_hash_values_count = hash_values_count[device].template get_access<sycl::access::mode::atomic>(cgh);
+                auto acc_hash_tables = context.hash_tables_buffer.template get_access<sycl::access::mode::write>(cgh);
+                auto acc_tombstones = context.tombstones_buffer.template get_access<sycl::access::mode::read>(cgh);
+                // get additional information
+                auto options = options_;
+                [[maybe_unused]] auto attr = attr_;
+                auto device_attr = context.attr;
+                [[maybe_unused]] const index_type first_point = context.first_point;
+                [[maybe_unused]] const index_type num_dataset_points = context.num_dataset_points;
+                [[maybe_unused]] const index_type num_inserted_points = context.inserted_ids.size();
+                const index_type max_bucket_size = options_.max_bucket_size;
+
+                cgh.parallel_for<kernel_fill_hash_tables>(sycl::range<>(device_attr.rank_size), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    // the hash tables contain the indices local to the device (the global IDs may exceed the index_type)
+                    const index_type val = idx;
+
+                    // fill additional values needed for blocking
+                    if (idx == device_attr.rank_size - 1) {
+                        for (index_type block = 0; block < options_type::blocking_size; ++block) {
+                            acc_hash_tables[options.num_hash_tables * device_attr.rank_size + block] = padding_point;
+                        }
+                    }
+
+                    // deleted data points aren't inserted in the hash tables
+                    if (acc_tombstones[idx] != 0) return;
+
+                    for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                        // get hash value
+#if defined(SYCL_LSH_CACHE_HASH_VALUES)
+#if defined(SYCL_LSH_REORDER_POINTS)
+                        // the cached hash values are stored in the original order
+                        const index_type point = acc_point_ids[idx];
+#else
+                        const index_type point = idx;
+#endif
+                        // the cached hash values of the data set don't contain the inserted data points folded in by compact()
+                        const hash_value_type hash_value = point < num_dataset_points
+                                                           ? acc_hash_values[hash_table * attr.rank_size + first_point + point]
+                                                           : acc_inserted_hash_values[hash_table * num_inserted_points + point - num_dataset_points];
+#else
+                        const hash_value_type hash_value = hasher(hash_table, idx, acc_data, acc_hash_functions, options, device_attr);
+#endif
+                        if (max_bucket_size != 0) {
+                            // the (capped) count is decremented for each inserted data point -> skip the data point if the hash bucket is already full
+                            const index_type remaining = acc_hash_values_count[hash_table * options.hash_table_size + hash_value].fetch_sub(1);
+                            if (remaining <= 0 || remaining > max_bucket_size) {
+                                continue;
+                            }
+                        }
+                        // update offsets
+                        const index_type hash_table_idx = acc_offsets[hash_table * (options.hash_table_size + 1) + hash_value + 1].fetch_add(1);
+                        acc_hash_tables[hash_table * device_attr.rank_size + hash_table_idx] = val;
+                    }
+                });
+            }));
+        }
         #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
-            queue_.wait_and_throw();
+            this->wait_and_throw();
         #endif
       
         logger_.log("Filled hash tables in {}.\n", t.elapsed());
     }
+#if defined(SYCL_LSH_COMPACT_OFFSETS)
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::compact_offsets() {
+        mpi::timer t(comm_);
+
+        const index_type num_buckets = options_.num_hash_tables * options_.hash_table_size;
+        index_type num_entries = 0;
+        for (device_context& context : devices_) {
+            // flag the non-empty hash buckets
+            device_buffer_type non_empty(num_buckets);
+            context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_offsets = context.offsets_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_non_empty = non_empty.template get_access<sycl::access::mode::discard_write>(cgh);
+                // get additional information
+                const index_type hash_table_size = options_.hash_table_size;
+
+                cgh.parallel_for<kernel_flag_non_empty_buckets>(sycl::range<>(num_buckets), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type offset = (idx / hash_table_size) * (hash_table_size + 1) + idx % hash_table_size;
+
+                    acc_non_empty[idx] = acc_offsets[offset] != acc_offsets[offset + 1] ? 1 : 0;
+                });
+            });
+            // calculate the position of each non-empty hash bucket in its hash table
+            device_buffer_type positions(num_buckets);
+            detail::exclusive_scan(context.queue, non_empty, positions, options_.num_hash_tables, options_.hash_table_size, options_.hash_table_size, 0);
+
+            // count the entries of each hash table (the non-empty hash buckets and the sentinel)
+            context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_non_empty = non_empty.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_positions = positions.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_directory = context.directory_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                // get additional information
+                const index_type hash_table_size = options_.hash_table_size;
+
+                cgh.parallel_for<kernel_count_non_empty_buckets>(sycl::range<>(options_.num_hash_tables), [=](sycl::item<> item) {
+                    const index_type hash_table = item.get_linear_id();
+                    const index_type last = (hash_table + 1) * hash_table_size - 1;
+
+                    acc_directory[hash_table + 1] = acc_positions[last] + acc_non_empty[last] + 1;
+                });
+            });
+            // the directory is tiny -> calculate the position of the first entry of each hash table on the host
+            index_type device_num_entries = 0;
+            {
+                auto acc_directory = context.directory_buffer.template get_access<sycl::access::mode::read_write>();
+                acc_directory[0] = 0;
+                for (index_type hash_table = 1; hash_table <= options_.num_hash_tables; ++hash_table) {
+                    acc_directory[hash_table] += acc_directory[hash_table - 1];
+                }
+                device_num_entries = acc_directory[options_.num_hash_tables];
+            }
+
+            // scatter the hash values and offsets of the non-empty hash buckets
+            hash_value_device_buffer_type bucket_hash_values(device_num_entries);
+            device_buffer_type offsets(device_num_entries);
+            context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_dense_offsets = context.offsets_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_non_empty = non_empty.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_positions = positions.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_directory = context.directory_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_bucket_hash_values = bucket_hash_values.template get_access<sycl::access::mode::discard_write>(cgh);
+                auto acc_offsets = offsets.template get_access<sycl::access::mode::discard_write>(cgh);
+                // get additional information
+                const index_type hash_table_size = options_.hash_table_size;
+
+                cgh.parallel_for<kernel_compact_offsets>(sycl::range<>(num_buckets), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+                    const index_type hash_table = idx / hash_table_size;
+                    const index_type hash_bucket = idx % hash_table_size;
+                    const index_type dense_offset = hash_table * (hash_table_size + 1) + hash_bucket;
+
+                    if (acc_non_empty[idx] != 0) {
+                        const index_type entry = acc_directory[hash_table] + acc_positions[idx];
+                        acc_bucket_hash_values[entry] = hash_bucket;
+                        acc_offsets[entry] = acc_dense_offsets[dense_offset];
+                    }
+                    // the sentinel contains the end of the last hash bucket
+                    if (hash_bucket == hash_table_size - 1) {
+                        const index_type entry = acc_directory[hash_table + 1] - 1;
+                        acc_bucket_hash_values[entry] = hash_table_size;
+                        acc_offsets[entry] = acc_dense_offsets[dense_offset + 1];
+                    }
+                });
+            });
+
+            // release the dense offsets
+            context.offsets_buffer = offsets;
+            context.bucket_hash_values_buffer = bucket_hash_values;
+            num_entries += device_num_entries;
+        }
+        #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
+            this->wait_and_throw();
+        #endif
+
+        this->account_device_buffers();
+
+        num_entries = mpi::sum(num_entries, comm_);
+        logger_.log("Compacted offsets to {} entries (instead of {}) in {}.\n",
+                    num_entries, mpi::sum<index_type>(devices_.size() * options_.num_hash_tables * (options_.hash_table_size + 1), comm_), t.elapsed());
+    }
+#endif
+
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_signatures() {
+        mpi::timer t(comm_);
+
+        for (device_context& context : devices_) {
+            context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_data = data_.get_device_accessor(context.data_buffer, context.attr, cgh);
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                auto acc_signatures = context.signatures_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                // get additional information
+                auto options = options_;
+                auto device_attr = context.attr;
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+
+                cgh.parallel_for<kernel_calculate_signatures>(sycl::range<>(device_attr.rank_size), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                        acc_signatures[hash_table * device_attr.rank_size + idx] = hasher.signature(hash_table, idx, acc_data, acc_hash_functions, options, device_attr);
+                    }
+                });
+            });
+        }
+        #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
+            this->wait_and_throw();
+        #endif
+
+        logger_.log("Calculated signatures in {}.\n", t.elapsed());
+    }
+
+#if defined(SYCL_LSH_FINGERPRINT_FILTER)
+    template <memory_layout layout, typename Options, typename Data, typename HashFunctionType>
+    void hash_tables<layout, Options, Data, HashFunctionType>::calculate_fingerprints() {
+        mpi::timer t(comm_);
+
+        for (device_context& context : devices_) {
+            context.queue.submit([&](sycl::handler& cgh) {
+                // get accessors
+                auto acc_data = data_.get_device_accessor(context.data_buffer, context.attr, cgh);
+                auto acc_hash_functions = hash_functions_.get_device_buffer().template get_access<sycl::access::mode::read>(cgh);
+                auto acc_fingerprints = context.fingerprints_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                // get additional information
+                auto options = options_;
+                auto device_attr = context.attr;
+                // get hasher functor instantiation
+                const lsh_hash<hash_function_type> hasher{};
+
+                cgh.parallel_for<kernel_calculate_fingerprints>(sycl::range<>(device_attr.rank_size), [=](sycl::item<> item) {
+                    const index_type idx = item.get_linear_id();
+
+                    for (index_type hash_table = 0; hash_table < options.num_hash_tables; ++hash_table) {
+                        const hash_value_type combined_hash = hasher.combined_hash_value(hash_table, idx, acc_data, acc_hash_functions, options, device_attr);
+                        acc_fingerprints[hash_table * device_attr.rank_size + idx] = detail::hash_fingerprint(combined_hash, options.hash_table_size);
+                    }
+                });
+            });
+        }
+        #if SYCL_LSH_TIMER == SYCL_LSH_BLOCKING_TIMER
+            this->wait_and_throw();
+        #endif
+
+        logger_.log("Calculated hash fingerprints in {}.\n", t.elapsed());
+    }
+#endif
 
 }
 
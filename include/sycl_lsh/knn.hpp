@@ -13,9 +13,15 @@
 #include <sycl_lsh/data.hpp>
 #include <sycl_lsh/data_attributes.hpp>
 #include <sycl_lsh/detail/defines.hpp>
+#include <sycl_lsh/detail/get_linear_id.hpp>
+#include <sycl_lsh/detail/sycl.hpp>
+#include <sycl_lsh/detail/utility.hpp>
+#include <sycl_lsh/device_selector.hpp>
 #include <sycl_lsh/memory_layout.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/file.hpp>
+#include <sycl_lsh/mpi/file_parser/file_parser.hpp>
 #include <sycl_lsh/mpi/math.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
@@ -25,12 +31,21 @@
 #include <mpi.h>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <utility>
 #include <type_traits>
 #include <vector>
 
 namespace sycl_lsh {
 
+    // SYCL kernel names needed to silence ComputeCpp warnings
+    class kernel_transpose_knn_ids;
+    class kernel_transform_knn_dists;
+
     // forward declare knn class
     template <memory_layout layout, typename Options, typename Data>
     class knn;
@@ -123,6 +138,47 @@ namespace sycl_lsh {
     };
 
 
+    /**
+     * @brief Non-owning view of the first nearest-neighbors of a single data point stored in a @ref sycl_lsh::knn object.
+     * @details The view is invalidated if the viewed @ref sycl_lsh::knn object is changed or destroyed.
+     * @tparam T the type of the viewed values (IDs or distances)
+     * @tparam index_type the used integral type
+     */
+    template <typename T, typename index_type>
+    class knn_prefix_view {
+    public:
+        /**
+         * @brief Construct a new @ref sycl_lsh::knn_prefix_view object.
+         * @param[in] first pointer to the first (nearest) viewed value
+         * @param[in] size the number of viewed values
+         */
+        knn_prefix_view(const T* first, const index_type size) noexcept : first_(first), size_(size) { }
+
+        /**
+         * @brief Returns the number of viewed nearest-neighbors.
+         * @return the number of nearest-neighbors (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        index_type size() const noexcept { return size_; }
+        /**
+         * @brief Returns the value of the @p nn-th nearest-neighbor.
+         * @param[in] nn the requested nearest-neighbor
+         * @return the value (`[[nodiscard]]`)
+         *
+         * @pre @p nn must be in the range `[0, size())`.
+         */
+        [[nodiscard]]
+        const T& operator[](const index_type nn) const noexcept {
+            SYCL_LSH_DEBUG_ASSERT(nn < size_, "Out-of-bounce access for nearest-neighbor!\n");
+            return first_[nn];
+        }
+
+    private:
+        const T* first_;
+        index_type size_;
+    };
+
+
     /**
      * @brief Class representing the result of the k-nearest-neighbor search.
      * @tparam layout the @ref sycl_lsh::memory_layout type
@@ -144,8 +200,10 @@ namespace sycl_lsh {
         using options_type = Options;
         /// The used floating point type for the k-nearest-neighbor distances.
         using real_type = typename Options::real_type;
-        /// The used integral type for the k-nearest-neighbor IDs.
+        /// The used integral type for indices.
         using index_type = typename Options::index_type;
+        /// The used integral type for the (global) k-nearest-neighbor IDs.
+        using id_type = typename Options::id_type;
 
         /// The type of the @ref sycl_lsh::data object.
         using data_type = Data;
@@ -153,18 +211,36 @@ namespace sycl_lsh {
         using data_attributes_type = typename data_type::data_attributes_type;
 
         /// The type of the host buffer representing the k-nearest-neighbor IDs used to hide the MPI communications.
-        using knn_host_buffer_type = std::vector<index_type>;
+        using knn_host_buffer_type = std::vector<id_type>;
         /// The type of the host buffer representing the k-nearest-neighbor distances used to hide the MPI communications.
         using dist_host_buffer_type = std::vector<real_type>;
+        /// The type of the device buffer representing the device-resident k-nearest-neighbor IDs.
+        using knn_device_buffer_type = sycl::buffer<id_type, 1>;
+        /// The type of the device buffer representing the device-resident k-nearest-neighbor distances.
+        using dist_device_buffer_type = sycl::buffer<real_type, 1>;
+        /// The type of the view of the nearest-neighbor IDs of a single data point.
+        using knn_view_type = knn_prefix_view<id_type, index_type>;
+        /// The type of the view of the nearest-neighbor distances of a single data point.
+        using dist_view_type = knn_prefix_view<real_type, index_type>;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
         //                                             update host buffer                                             //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
-         * @brief Send the elements of the host buffers to the neighboring buffers replacing its content using a ring like send pattern.
+         * @brief Starts to send the elements of the host buffers to the next MPI rank and to receive the elements of the previous MPI rank
+         *        using a ring like send pattern.
+         * @details Uses non-blocking MPI communication, i.e. the host buffers **must not** be changed until
+         *          @ref finish_send_receive_host_buffer() has been called. \n
+         *          For the @ref sycl_lsh::memory_layout::aos layout only the k-nearest-neighbors of the real data points are sent, i.e. the
+         *          ones of the dummy points padding the last MPI rank aren't.
+         */
+        void start_send_receive_host_buffer();
+        /**
+         * @brief Waits until the communication started by @ref start_send_receive_host_buffer() has been finished and replaces the content
+         *        of the host buffers with the received elements.
          */
-        void send_receive_host_buffer();
+        void finish_send_receive_host_buffer();
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -192,29 +268,75 @@ namespace sycl_lsh {
          */
         [[nodiscard]]
         dist_host_buffer_type get_knn_dists(const index_type point) const;
+        /**
+         * @brief Returns a view of the IDs of the @p num_nn nearest-neighbors found for @p point, i.e. the prefix of the k-nearest-neighbors
+         *        sorted by distance.
+         * @details Used to answer the smaller k of a batched k-nearest-neighbor search (see @ref get_batch_ks()) without another search. \n
+         *          The k-nearest-neighbors of all data points are sorted only once (see @ref sort_by_distance()).
+         * @param[in] point the data point to return the nearest-neighbors for
+         * @param[in] num_nn the number of nearest-neighbors to view
+         * @return the view of the IDs of the @p num_nn nearest-neighbors of @p point (`[[nodiscard]]`)
+         *
+         * @attention The view is invalidated if the host buffers are accessed non-const or the device buffers are used!
+         *
+         * @pre @p point must be in the range `[0, number of data points on the current MPI rank)`.
+         * @pre @p num_nn must be in the range `[1, k]`.
+         */
+        [[nodiscard]]
+        knn_view_type get_knn_ids(const index_type point, const index_type num_nn) const;
+        /**
+         * @brief Returns a view of the distances of the @p num_nn nearest-neighbors found for @p point, i.e. the prefix of the
+         *        k-nearest-neighbor distances sorted in ascending order.
+         * @details Same as @ref get_knn_ids(const index_type, const index_type) const.
+         * @param[in] point the data point to return the nearest-neighbors for
+         * @param[in] num_nn the number of nearest-neighbors to view
+         * @return the view of the distances of the @p num_nn nearest-neighbors of @p point (`[[nodiscard]]`)
+         *
+         * @attention The view is invalidated if the host buffers are accessed non-const or the device buffers are used!
+         *
+         * @pre @p point must be in the range `[0, number of data points on the current MPI rank)`.
+         * @pre @p num_nn must be in the range `[1, k]`.
+         */
+        [[nodiscard]]
+        dist_view_type get_knn_dists(const index_type point, const index_type num_nn) const;
+        /**
+         * @brief Creates a copy of the k-nearest-neighbors of each data point sorted by distance (in ascending order).
+         * @details Nop if the copy is already up-to-date, i.e. the sort is performed only once after each k-nearest-neighbor search. The
+         *          host buffers (and therefore the saved k-nearest-neighbors) keep their order.
+         */
+        void sort_by_distance() const;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                  save knn                                                  //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
-         * @brief Saves the calculated k-nearest-neighbor IDs to the file parsed from the command line arguments
+         * @brief Starts to save the calculated k-nearest-neighbor IDs to the file parsed from the command line arguments
          *        @ref sycl_lsh::argv_parser @p parser via the command line argument `knn_save_file`. \n
-         *        **Always** saves the k-nearest-neighbor IDs in *Array of Structs* layout.
+         *        **Always** saves the k-nearest-neighbor IDs in *Array of Structs* layout (transposed on the device if necessary).
+         * @details Each MPI rank writes its k-nearest-neighbor IDs at its explicitly calculated file offset using a non-blocking collective
+         *          write (if supported by the file parser), i.e. the write overlaps with the following work until @ref finish_saving()
+         *          has been called (or the @ref sycl_lsh::knn object has been destroyed).
          * @param[in] parser the used @ref sycl_lsh::argv_parser
          *
          * @throws std::invalid_argument if the command line argument `knn_save_file` isn't present in @p parser.
          */
         void save_knns(const argv_parser& parser);
         /**
-         * @brief Saves the calculated k-nearest-neighbor distances to the file parser from the command line arguments
+         * @brief Starts to save the calculated k-nearest-neighbor distances to the file parser from the command line arguments
          *        @ref sycl_lsh::argv_parser @p parser via the command line argument `knn_dist_save_file`. \n
-         *        **Always** saves the k-nearest-neighbor distances in *Array of Structs* layout.
+         *        **Always** saves the k-nearest-neighbor distances in *Array of Structs* layout (the `std::sqrt` and the transposition are
+         *        calculated on the device).
+         * @details Same as @ref save_knns(), i.e. the write overlaps with the following work until @ref finish_saving() has been called.
          * @param[in] parser the used @ref sycl_lsh::argv_parser
          *
          * @throws std::invalid_argument if the command line argument `knn_dist_save_file` isn't present in @p parser.
          */
         void save_distances(const argv_parser& parser);
+        /**
+         * @brief Waits until all writes started by @ref save_knns() and @ref save_distances() have been finished.
+         */
+        void finish_saving();
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -222,10 +344,16 @@ namespace sycl_lsh {
         // ---------------------------------------------------------------------------------------------------------- //
         /**
          * @brief Calculates the recall using: \f$ \frac{true\ positives}{relevant\ elements} \f$
+         * @details The correct IDs of each point are sorted such that each calculated ID can be found using a binary search, i.e. the
+         *          evaluation runs in \f$O(N \cdot k \cdot log\ k)\f$ (in parallel if OpenMP is available). \n
+         *          If the command line argument `evaluate_recall_at` is present, the recall@k' of the calculated k' nearest-neighbors
+         *          (ordered by distance) with respect to the first k' correct nearest-neighbors is additionally calculated and logged for
+         *          each given k' in the same pass (as are the k values of a batched k-nearest-neighbor search, see @ref set_batch_ks()).
          * @param[in] parser the used @ref sycl_lsh::argv_parser
          * @return the resulting recall (`[[nodiscard]]`)
          *
          * @throws std::invalid_argument if the required command line argument `evaluate_knn_file` isn't present in @p parser.
+         * @throws std::invalid_argument if any value of the command line argument `evaluate_recall_at` isn't in the range `[1, k]`.
          * @throws std::runtime_error if the parsed total number of points doesn't match with the current `total_size`.
          * @throws std::runtime_error if the parsed number of points per MPI rank doesn't match with the current `rank_size`.
          * @throws std::runtime_error if the parsed number of dimensions doesn't match with the current `dims`.
@@ -251,25 +379,101 @@ namespace sycl_lsh {
         //                                                   getter                                                   //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
- * @brief Returns the specified @ref sycl_lsh::memory_layout type.
- * @return the @ref sycl_lsh::memory_layout type (`[[nodiscard]]`)
- */
+         * @brief Returns the specified @ref sycl_lsh::memory_layout type.
+         * @return the @ref sycl_lsh::memory_layout type (`[[nodiscard]]`)
+         */
         [[nodiscard]]
         constexpr memory_layout get_memory_layout() const noexcept { return layout; }
+        /**
+         * @brief Returns the @ref sycl_lsh::data_attributes of the data points whose k-nearest-neighbors are stored.
+         * @return the @ref sycl_lsh::data_attributes (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        data_attributes_type get_attributes() const noexcept { return attr_; }
+        /**
+         * @brief Returns the number of nearest-neighbors stored per data point.
+         * @return the number of nearest-neighbors (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        index_type get_k() const noexcept { return k_; }
+        /**
+         * @brief Sets the k values of a batched k-nearest-neighbor search answered by this single search (using the prefixes of the sorted
+         *        k-nearest-neighbors).
+         * @details The recall@k' of each k' in @p ks is additionally calculated in the same pass by @ref recall(). \n
+         *          Sorts the k-nearest-neighbors once such that the prefixes can be viewed without copying.
+         * @param[in] ks the requested k values
+         *
+         * @throws std::invalid_argument if any value of @p ks isn't in the range `[1, k]`.
+         */
+        void set_batch_ks(std::vector<index_type> ks);
+        /**
+         * @brief Returns the k values of the batched k-nearest-neighbor search (sorted in ascending order).
+         * @return the k values (empty if no batched search has been performed) (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        const std::vector<index_type>& get_batch_ks() const noexcept { return batch_ks_; }
 
         /**
          * @brief Returns the host buffer containing the k-nearest-neighbor IDs used to hide the MPI communication.
          * @return the knn host buffer (`[[nodiscard]]`)
          */
         [[nodiscard]]
-        knn_host_buffer_type& get_knn_host_buffer() noexcept { return knn_host_buffer_; }
+        knn_host_buffer_type& get_knn_host_buffer() {
+            this->use_host_buffers();
+            return knn_host_buffer_;
+        }
         /**
          * @brief Returns the host buffer containing the k-nearest-neighbor distances used to hide the MPI communication.
          * @details The distances are calculated without the use of `std::sqrt`!
          * @return the knn distances host buffer (`[[nodiscard]]`)
          */
         [[nodiscard]]
-        dist_host_buffer_type& get_distance_host_buffer() noexcept { return dist_host_buffer_; }
+        dist_host_buffer_type& get_distance_host_buffer() {
+            this->use_host_buffers();
+            return dist_host_buffer_;
+        }
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                           device-resident state                                            //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Returns the device buffer containing the k-nearest-neighbor IDs.
+         * @details Makes the k-nearest-neighbors device-resident (initialized with the content of the host buffers), i.e. the host
+         *          buffers are **only** updated if they are requested again (@ref get_knn_host_buffer(), @ref update_host_buffers(),
+         *          saving or evaluating the k-nearest-neighbors). Afterwards, the device buffers may be changed until the host buffers are
+         *          requested.
+         * @return the knn device buffer (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        knn_device_buffer_type& get_knn_device_buffer() {
+            this->use_device_buffers();
+            return device_buffers_->knn;
+        }
+        /**
+         * @brief Returns the device buffer containing the k-nearest-neighbor distances (without the use of `std::sqrt`).
+         * @details Same as @ref get_knn_device_buffer().
+         * @return the knn distances device buffer (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        dist_device_buffer_type& get_distance_device_buffer() {
+            this->use_device_buffers();
+            return device_buffers_->dist;
+        }
+        /**
+         * @brief Uses @p queue for all device work of this object instead of a separately created queue.
+         * @details Should be the queue of the device performing the k-nearest-neighbor search, i.e. the device buffers are only used
+         *          within its context and never migrated between contexts.
+         * @param[in] queue the SYCL queue to use (shares the underlying queue)
+         */
+        void set_queue(const sycl::queue& queue) {
+            queue_ = std::make_unique<sycl::queue>(queue);
+        }
+        /**
+         * @brief Copies the device-resident k-nearest-neighbors back to the host buffers (nop if they are already up-to-date).
+         * @details The device buffers stay valid, i.e. reading the results on the host doesn't require another upload.
+         */
+        void update_host_buffers() const;
 
     private:
         // befriend the factory function
@@ -279,15 +483,6 @@ namespace sycl_lsh {
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                constructor                                                 //
         // ---------------------------------------------------------------------------------------------------------- //
-        /**
-         * @brief Construct a new @ref sycl_lsh::knn object given @p k, the number of nearest-neighbors to search for.
-         * @param[in] k the number of nearest-neighbors to search for
-         * @param[in] data the used @ref sycl_lsh::data representing the used data set
-         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
-         * @param[in] logger the used @ref sycl_lsh::mpi::logger
-         *
-         * @pre @p k **must** be greater than `0`.
-         */
         /**
          * @brief Construct a new @ref sycl_lsh::knn object given @p k, the number of nearest-neighbors to search for.
          * @param[in] k the number of nearest-neighbors to search for
@@ -299,15 +494,63 @@ namespace sycl_lsh {
          */
         knn(const index_type k, const data_type& data, const mpi::communicator& comm, const mpi::logger& logger);
 
+        /*
+         * Creates the device buffers if necessary and refreshes their content from the host buffers if they are outdated. The device
+         * buffers become the up-to-date copy.
+         */
+        void use_device_buffers();
+        /*
+         * Updates the host buffers if necessary. The host buffers become the up-to-date copy (the device buffers stay allocated).
+         */
+        void use_host_buffers();
+        /*
+         * Returns the queue used for all device work of this object (the one given to set_queue() or created on first use, i.e. the device
+         * is selected only once).
+         */
+        sycl::queue& get_queue() const;
+
 
         const data_attributes_type attr_;
         const mpi::communicator& comm_;
         const mpi::logger& logger_;
 
         const index_type k_;
-
-        knn_host_buffer_type knn_host_buffer_;
-        dist_host_buffer_type dist_host_buffer_;
+        // the k values of a batched k-nearest-neighbor search (sorted, the largest one is k_)
+        std::vector<index_type> batch_ks_;
+
+        // updated lazily from the device buffers (if they are the up-to-date copy)
+        mutable knn_host_buffer_type knn_host_buffer_;
+        mutable dist_host_buffer_type dist_host_buffer_;
+        // the device-resident k-nearest-neighbors (nullptr if they have never been used), allocated once and reused in all rounds
+        struct device_buffers {
+            knn_device_buffer_type knn;
+            dist_device_buffer_type dist;
+        };
+        std::unique_ptr<device_buffers> device_buffers_;
+        // true if the device buffers have been changed since the host buffers have been updated the last time
+        mutable bool host_buffers_outdated_ = false;
+        // true if the host buffers may have been changed since the device buffers have been refreshed the last time
+        bool device_buffers_outdated_ = true;
+        // the k-nearest-neighbors sorted by distance (AoS layout, created lazily to answer the prefixes of a batched search)
+        mutable knn_host_buffer_type sorted_knn_buffer_;
+        mutable dist_host_buffer_type sorted_dist_buffer_;
+        // true if the sorted copy is up-to-date with the host buffers
+        mutable bool sorted_ = false;
+        // the second host buffers used to receive the elements of the previous MPI rank while the host buffers are being sent
+        knn_host_buffer_type knn_receive_buffer_;
+        dist_host_buffer_type dist_receive_buffer_;
+        std::array<MPI_Request, 4> requests_ = { MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+        // the start of the currently running send/receive (used to measure the transfer time)
+        mpi::communication_profiler::clock::time_point send_receive_start_;
+        // the MPI rank owning the data points whose k-nearest-neighbors are currently stored in the host buffers
+        int host_buffer_rank_ = comm_.rank();
+
+        // the queue used for all device work of this object (nullptr until set or first used)
+        mutable std::unique_ptr<sycl::queue> queue_;
+
+        // the file parsers of the currently pending writes started by save_knns() and save_distances()
+        std::unique_ptr<mpi::file_parser<options_type, id_type>> knn_save_parser_;
+        std::unique_ptr<mpi::file_parser<options_type, real_type>> dist_save_parser_;
     };
 
 
@@ -319,14 +562,16 @@ namespace sycl_lsh {
         : attr_(data.get_attributes()), comm_(comm), logger_(logger),
           k_(k),
           knn_host_buffer_(attr_.rank_size * k),
-          dist_host_buffer_(attr_.rank_size * k, std::numeric_limits<real_type>::max())
+          dist_host_buffer_(attr_.rank_size * k, std::numeric_limits<real_type>::max()),
+          knn_receive_buffer_(attr_.rank_size * k),
+          dist_receive_buffer_(attr_.rank_size * k)
     {
         mpi::timer t(comm_);
 
         SYCL_LSH_DEBUG_ASSERT(0 < k, "Illegal number of k-nearest-neighbors!\n");
 
         // calculate start ID
-        const index_type base_id = comm_.rank() * attr_.rank_size;
+        const id_type base_id = attr_.first_id(comm_.rank());
 
         const get_linear_id<knn<layout, options_type, data_type>> get_linear_id_functor{};
 
@@ -339,7 +584,7 @@ namespace sycl_lsh {
 
         // correctly set default values for dummy points on last MPI rank
         if (comm_.rank() == comm_.size() - 1) {
-            const index_type correct_rank_size = attr_.total_size - ((comm_.size() - 1) * attr_.rank_size);
+            const index_type correct_rank_size = attr_.correct_rank_size(comm_.rank());
             for (index_type point = correct_rank_size; point < attr_.rank_size; ++point) {
                 for (index_type nn = 0; nn < k_; ++nn) {
                     knn_host_buffer_[get_linear_id_functor(point, nn, attr_, k_)] = base_id + correct_rank_size - 1;
@@ -359,6 +604,7 @@ namespace sycl_lsh {
     typename knn<layout, Options, Data>::knn_host_buffer_type knn<layout, Options, Data>::get_knn_ids(const index_type point) const {
         SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr_.rank_size, "Out-of-bounce access for data point!\n");
 
+        this->update_host_buffers();
         const get_linear_id<knn<layout, options_type, data_type>> get_linear_id_functor{};
 
         knn_host_buffer_type res(k_);
@@ -372,6 +618,7 @@ namespace sycl_lsh {
     typename knn<layout, Options, Data>::dist_host_buffer_type knn<layout, Options, Data>::get_knn_dists(const index_type point) const {
         SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr_.rank_size, "Out-of-bounce access for data point!\n")
 
+        this->update_host_buffers();
         const get_linear_id<knn<layout, options_type, data_type>> get_linear_id_functor{};
 
         dist_host_buffer_type res(k_);
@@ -380,6 +627,74 @@ namespace sycl_lsh {
         }
         return res;
     }
+    template <memory_layout layout, typename Options, typename Data>
+    [[nodiscard]]
+    typename knn<layout, Options, Data>::knn_view_type knn<layout, Options, Data>::get_knn_ids(const index_type point, const index_type num_nn) const {
+        SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr_.rank_size, "Out-of-bounce access for data point!\n");
+        SYCL_LSH_DEBUG_ASSERT(0 < num_nn && num_nn <= k_, "Illegal number of nearest-neighbors!\n");
+
+        this->sort_by_distance();
+        return knn_view_type(sorted_knn_buffer_.data() + static_cast<std::size_t>(point) * k_, num_nn);
+    }
+    template <memory_layout layout, typename Options, typename Data>
+    [[nodiscard]]
+    typename knn<layout, Options, Data>::dist_view_type knn<layout, Options, Data>::get_knn_dists(const index_type point, const index_type num_nn) const {
+        SYCL_LSH_DEBUG_ASSERT(0 <= point && point < attr_.rank_size, "Out-of-bounce access for data point!\n");
+        SYCL_LSH_DEBUG_ASSERT(0 < num_nn && num_nn <= k_, "Illegal number of nearest-neighbors!\n");
+
+        this->sort_by_distance();
+        return dist_view_type(sorted_dist_buffer_.data() + static_cast<std::size_t>(point) * k_, num_nn);
+    }
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::sort_by_distance() const {
+        if (sorted_) {
+            return;
+        }
+        this->update_host_buffers();
+        // sort a copy such that the order of the host buffers (and therefore of the saved files) doesn't change
+        sorted_knn_buffer_.resize(knn_host_buffer_.size());
+        sorted_dist_buffer_.resize(dist_host_buffer_.size());
+
+        const get_linear_id<knn<layout, options_type, data_type>> get_linear_id_functor{};
+        #if defined(_OPENMP)
+        #pragma omp parallel
+        #endif
+        {
+            std::vector<std::pair<real_type, id_type>> candidates(k_);
+
+            #if defined(_OPENMP)
+            #pragma omp for schedule(static)
+            #endif
+            for (index_type point = 0; point < attr_.rank_size; ++point) {
+                // the nearest-neighbors aren't necessarily sorted by distance
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    const index_type idx = get_linear_id_functor(point, nn, attr_, k_);
+                    candidates[nn] = std::make_pair(dist_host_buffer_[idx], knn_host_buffer_[idx]);
+                }
+                std::sort(candidates.begin(), candidates.end());
+                // the sorted copy is always stored in the AoS layout, i.e. each prefix is contiguous
+                const std::size_t offset = static_cast<std::size_t>(point) * k_;
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    sorted_dist_buffer_[offset + nn] = candidates[nn].first;
+                    sorted_knn_buffer_[offset + nn] = candidates[nn].second;
+                }
+            }
+        }
+        sorted_ = true;
+    }
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::set_batch_ks(std::vector<index_type> ks) {
+        for (const index_type val : ks) {
+            if (val == 0 || val > k_) {
+                throw std::invalid_argument(fmt::format("Illegal batched k ({}) requested! Must be in the range [1, {}].", val, k_));
+            }
+        }
+        std::sort(ks.begin(), ks.end());
+        ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+        batch_ks_ = std::move(ks);
+        // sort once such that all k' can be answered using the prefixes
+        this->sort_by_distance();
+    }
 
 
     // ---------------------------------------------------------------------------------------------------------- //
@@ -394,31 +709,49 @@ namespace sycl_lsh {
             throw std::invalid_argument("Required command line argument 'knn_save_file' not provided!");
         }
 
+        this->update_host_buffers();
         knn_host_buffer_type tmp_buffer(knn_host_buffer_.size());
 
         if constexpr (layout == memory_layout::soa) {
-            // expect the values to be saved in array of structs (aos) layout -> transform if wrong layout
-            const get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
-            const get_linear_id<knn<memory_layout::soa, options_type, data_type>> get_linear_id_soa{};
-
-            for (index_type point = 0; point < attr_.rank_size; ++point) {
-                for (index_type nn = 0; nn < k_; ++nn) {
-                    tmp_buffer[get_linear_id_aos(point, nn, attr_, k_)]
-                            = knn_host_buffer_[get_linear_id_soa(point, nn, attr_, k_)];
-                }
+            // expect the values to be saved in array of structs (aos) layout -> transform on the device if wrong layout
+            sycl::queue& queue = this->get_queue();
+            {
+                sycl::buffer<id_type, 1> soa_buffer(knn_host_buffer_.data(), sycl::range<>(knn_host_buffer_.size()),
+                                                    { sycl::property::buffer::use_host_ptr() });
+                soa_buffer.set_final_data(nullptr);
+                sycl::buffer<id_type, 1> aos_buffer(tmp_buffer.data(), sycl::range<>(tmp_buffer.size()),
+                                                    { sycl::property::buffer::use_host_ptr() });
+
+                queue.submit([&](sycl::handler& cgh) {
+                    auto acc_soa = soa_buffer.template get_access<sycl::access::mode::read>(cgh);
+                    auto acc_aos = aos_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                    const data_attributes_type attr = attr_;
+                    const index_type k = k_;
+                    const get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
+                    const get_linear_id<knn<memory_layout::soa, options_type, data_type>> get_linear_id_soa{};
+
+                    cgh.parallel_for<kernel_transpose_knn_ids>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                        const index_type point = item.get_linear_id();
+                        for (index_type nn = 0; nn < k; ++nn) {
+                            acc_aos[get_linear_id_aos(point, nn, attr, k)] = acc_soa[get_linear_id_soa(point, nn, attr, k)];
+                        }
+                    });
+                });
+                // the destruction of aos_buffer waits until the transposition has been finished and copies the result back
             }
+            queue.wait_and_throw();
         } else {
             // if the layout is correct, simply copy the values to the temporary buffer
             std::copy(knn_host_buffer_.begin(), knn_host_buffer_.end(), tmp_buffer.begin());
         }
 
 
-        // write content to the respective file
+        // start writing the content to the respective file
         const std::string& file_name = parser.argv_as<std::string>("knn_save_file");
-        auto file_parser = mpi::make_file_parser<index_type, options_type>(file_name, parser, mpi::file::mode::write, comm_, logger_);
-        file_parser->write_content(attr_.total_size, k_, tmp_buffer);
+        knn_save_parser_ = mpi::make_file_parser<id_type, options_type>(file_name, parser, mpi::file::mode::write, comm_, logger_);
+        knn_save_parser_->start_write_content(attr_.total_size, k_, std::move(tmp_buffer));
 
-        logger_.log("Saved k-nearest-neighbor IDs in {}.\n", t.elapsed());
+        logger_.log("Started saving k-nearest-neighbor IDs in {}.\n", t.elapsed());
     }
     template <memory_layout layout, typename Options, typename Data>
     void knn<layout, Options, Data>::save_distances(const argv_parser& parser) {
@@ -428,35 +761,65 @@ namespace sycl_lsh {
         if (!parser.has_argv("knn_dist_save_file")) {
             throw std::invalid_argument("Required command line argument 'knn_dist_save_file' not provided!");
         }
-        
-        dist_host_buffer_type tmp_buffer(dist_host_buffer_.size());
 
-        if constexpr (layout == memory_layout::soa) {
-            // expect the values to be saved in array of structs (aos) layout -> transform if wrong layout
-            const get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
-            const get_linear_id<knn<memory_layout::soa, options_type, data_type>> get_linear_id_soa{};
+        this->update_host_buffers();
+        dist_host_buffer_type tmp_buffer(dist_host_buffer_.size());
 
-            for (index_type point = 0; point < attr_.rank_size; ++point) {
-                for (index_type nn = 0; nn < k_; ++nn) {
-                    tmp_buffer[get_linear_id_aos(point, nn, attr_, k_)]
-                            = dist_host_buffer_[get_linear_id_soa(point, nn, attr_, k_)];
-                }
-            }
-        } else {
-            // if the layout is correct, simply copy the values to the temporary buffer (because of the call to `std::sqrt` later on)
-            std::copy(dist_host_buffer_.begin(), dist_host_buffer_.end(), tmp_buffer.begin());
+        // transform the values using `std::sqrt` and expect the values to be saved in array of structs (aos) layout
+        // -> transform on the device if wrong layout
+        sycl::queue& queue = this->get_queue();
+        {
+            sycl::buffer<real_type, 1> in_buffer(dist_host_buffer_.data(), sycl::range<>(dist_host_buffer_.size()),
+                                                 { sycl::property::buffer::use_host_ptr() });
+            in_buffer.set_final_data(nullptr);
+            sycl::buffer<real_type, 1> aos_buffer(tmp_buffer.data(), sycl::range<>(tmp_buffer.size()),
+                                                  { sycl::property::buffer::use_host_ptr() });
+
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_in = in_buffer.template get_access<sycl::access::mode::read>(cgh);
+                auto acc_aos = aos_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+                const data_attributes_type attr = attr_;
+                const index_type k = k_;
+                const get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
+                const get_linear_id<knn<layout, options_type, data_type>> get_linear_id_this{};
+
+                cgh.parallel_for<kernel_transform_knn_dists>(sycl::range<>(attr.rank_size), [=](sycl::item<> item) {
+                    const index_type point = item.get_linear_id();
+                    for (index_type nn = 0; nn < k; ++nn) {
+                        acc_aos[get_linear_id_aos(point, nn, attr, k)] = sycl::sqrt(acc_in[get_linear_id_this(point, nn, attr, k)]);
+                    }
+                });
+            });
+            // the destruction of aos_buffer waits until the transformation has been finished and copies the result back
         }
-
-        // transform the values using `std::sqrt`
-        std::transform(tmp_buffer.begin(), tmp_buffer.end(), tmp_buffer.begin(), [](const real_type val) { return std::sqrt(val); });
+        queue.wait_and_throw();
 
 
-        // write content to the respective file
+        // start writing the content to the respective file
         const std::string& file_name = parser.argv_as<std::string>("knn_dist_save_file");
-        auto file_parser = mpi::make_file_parser<real_type, options_type>(file_name, parser, mpi::file::mode::write, comm_, logger_);
-        file_parser->write_content(attr_.total_size, k_, tmp_buffer);
+        dist_save_parser_ = mpi::make_file_parser<real_type, options_type>(file_name, parser, mpi::file::mode::write, comm_, logger_);
+        dist_save_parser_->start_write_content(attr_.total_size, k_, std::move(tmp_buffer));
 
-        logger_.log("Saved k-nearest-neighbor distances in {}.\n", t.elapsed());
+        logger_.log("Started saving k-nearest-neighbor distances in {}.\n", t.elapsed());
+    }
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::finish_saving() {
+        if (knn_save_parser_ == nullptr && dist_save_parser_ == nullptr) {
+            // nothing to wait for
+            return;
+        }
+        mpi::timer t(comm_);
+
+        if (knn_save_parser_ != nullptr) {
+            knn_save_parser_->finish_write_content();
+            knn_save_parser_.reset();
+        }
+        if (dist_save_parser_ != nullptr) {
+            dist_save_parser_->finish_write_content();
+            dist_save_parser_.reset();
+        }
+
+        logger_.log("Finished saving the k-nearest-neighbors in {}.\n", t.elapsed());
     }
 
 
@@ -474,10 +837,32 @@ namespace sycl_lsh {
             throw std::invalid_argument("Required command line argument 'evaluate_knn_file' not provided!");
         }
 
+        // parse the additionally requested recall@k' values (k itself is always evaluated last)
+        std::vector<index_type> recall_at;
+        if (parser.has_argv("evaluate_recall_at")) {
+            const std::string values = parser.argv_as<std::string>("evaluate_recall_at");
+            std::size_t pos = 0;
+            while (pos < values.size()) {
+                const std::size_t end = std::min(values.find(',', pos), values.size());
+                const index_type val = detail::convert_to<index_type>(values.substr(pos, end - pos));
+                if (val == 0 || val > k_) {
+                    throw std::invalid_argument(fmt::format("Illegal recall@{} requested! Must be in the range [1, {}].", val, k_));
+                }
+                recall_at.push_back(val);
+                pos = end + 1;
+            }
+        }
+        // the k values of a batched k-nearest-neighbor search are always evaluated
+        recall_at.insert(recall_at.end(), batch_ks_.begin(), batch_ks_.end());
+        recall_at.push_back(k_);
+        std::sort(recall_at.begin(), recall_at.end());
+        recall_at.erase(std::unique(recall_at.begin(), recall_at.end()), recall_at.end());
+        const std::size_t num_recall_at = recall_at.size();
+
         // read correct k-nearest-neighbor IDs from the respective file
         const std::string& file_name = parser.argv_as<std::string>("evaluate_knn_file");
-        auto file_parser = mpi::make_file_parser<index_type, options_type>(file_name, parser, mpi::file::mode::read, comm_, logger_);
-        const index_type parsed_total_size = file_parser->parse_total_size();
+        auto file_parser = mpi::make_file_parser<id_type, options_type>(file_name, parser, mpi::file::mode::read, comm_, logger_);
+        const id_type parsed_total_size = file_parser->parse_total_size();
         const index_type parsed_rank_size = file_parser->parse_rank_size();
         const index_type parsed_dims = file_parser->parse_dims();
         knn_host_buffer_type correct_knn = file_parser->parse_content();
@@ -491,30 +876,71 @@ namespace sycl_lsh {
             throw std::runtime_error(fmt::format("The number of nearest-neighbors in '{}' is {}, but should be {}!", file_name, parsed_dims, k_));
         }
 
-        const index_type correct_rank_size = comm_.rank() == comm_.size() - 1 ? (attr_.total_size - (comm_.size() - 1) * attr_.rank_size) : attr_.rank_size;
+        this->update_host_buffers();
+        const index_type correct_rank_size = attr_.correct_rank_size(comm_.rank());
 
         const sycl_lsh::get_linear_id<knn<layout, options_type, data_type>> get_linear_id_this{};
         const sycl_lsh::get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
 
-        index_type count = 0;
-        for (index_type point = 0; point < correct_rank_size; ++point) {
-            for (index_type nn = 0; nn < k_; ++nn) {
-                // get calculated k-nearest-neighbor ID
-                const index_type calculated_id = knn_host_buffer_[get_linear_id_this(point, nn, attr_, k_)];
-                // check if calculated ID is contained in the correct IDs
-                for (index_type i = 0; i < k_; ++i) {
-                    if (calculated_id == correct_knn[get_linear_id_aos(point, i, attr_, k_)]) {
-                        // correct ID found
-                        ++count;
-                        break;
+        // count the correctly found IDs for all recall@k' values in a single pass: O(N * k * log k) instead of O(N * k^2)
+        // (the total counts may exceed the index_type for large data sets)
+        std::vector<std::uint64_t> counts(num_recall_at, 0);
+        #if defined(_OPENMP)
+        #pragma omp parallel
+        #endif
+        {
+            // the correct IDs together with their position, sorted by ID
+            std::vector<std::pair<id_type, index_type>> correct_ids(k_);
+            // the calculated IDs together with their distance, sorted by distance
+            std::vector<std::pair<real_type, id_type>> calculated_ids(k_);
+            std::vector<std::uint64_t> thread_counts(num_recall_at, 0);
+
+            #if defined(_OPENMP)
+            #pragma omp for schedule(static)
+            #endif
+            for (index_type point = 0; point < correct_rank_size; ++point) {
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    correct_ids[nn] = std::make_pair(correct_knn[get_linear_id_aos(point, nn, attr_, k_)], nn);
+                    calculated_ids[nn] = std::make_pair(dist_host_buffer_[get_linear_id_this(point, nn, attr_, k_)],
+                                                        knn_host_buffer_[get_linear_id_this(point, nn, attr_, k_)]);
+                }
+                std::sort(correct_ids.begin(), correct_ids.end());
+                // the order of the calculated IDs is only relevant for a recall@k' with k' < k
+                if (num_recall_at > 1) {
+                    std::sort(calculated_ids.begin(), calculated_ids.end());
+                }
+
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    // check if calculated ID is contained in the correct IDs
+                    const id_type calculated_id = calculated_ids[nn].second;
+                    const auto it = std::lower_bound(correct_ids.cbegin(), correct_ids.cend(), std::make_pair(calculated_id, index_type{ 0 }));
+                    if (it != correct_ids.cend() && it->first == calculated_id) {
+                        // correct ID found -> counts for each recall@k' with k' greater than the calculated and correct position
+                        const index_type min_k = std::max(nn, it->second) + 1;
+                        for (std::size_t i = num_recall_at; i > 0 && recall_at[i - 1] >= min_k; --i) {
+                            ++thread_counts[i - 1];
+                        }
                     }
                 }
             }
+
+            #if defined(_OPENMP)
+            #pragma omp critical
+            #endif
+            {
+                for (std::size_t i = 0; i < num_recall_at; ++i) {
+                    counts[i] += thread_counts[i];
+                }
+            }
         }
+        MPI_Allreduce(MPI_IN_PLACE, counts.data(), counts.size(), mpi::type_cast<std::uint64_t>(), MPI_SUM, comm_.get());
 
-        const real_type res = (static_cast<real_type>(mpi::sum(count, comm_)) / (attr_.total_size * k_)) * 100.0;
+        const real_type res = (static_cast<real_type>(counts.back()) / (static_cast<real_type>(attr_.total_size) * k_)) * 100.0;
 
         logger_.log("\nCalculated recall in {}.\n", t.elapsed());
+        for (std::size_t i = 0; i < num_recall_at - 1; ++i) {
+            logger_.log("recall@{}: {}%\n", recall_at[i], (static_cast<real_type>(counts[i]) / (static_cast<real_type>(attr_.total_size) * recall_at[i])) * 100.0);
+        }
         #if defined(SYCL_LSH_BENCHMARK)
             if (comm_.master_rank()) {
                 mpi::timer::benchmark_out() << res << ',';
@@ -538,7 +964,7 @@ namespace sycl_lsh {
         // read correct k-nearest-neighbor distances from the respective file
         const std::string& file_name = parser.argv_as<std::string>("evaluate_knn_dist_file");
         auto file_parser = mpi::make_file_parser<real_type, options_type>(file_name, parser, mpi::file::mode::read, comm_, logger_);
-        const index_type parsed_total_size = file_parser->parse_total_size();
+        const id_type parsed_total_size = file_parser->parse_total_size();
         const index_type parsed_rank_size = file_parser->parse_rank_size();
         const index_type parsed_dims = file_parser->parse_dims();
         dist_host_buffer_type correct_knn_dist = file_parser->parse_content();
@@ -552,7 +978,8 @@ namespace sycl_lsh {
             throw std::runtime_error(fmt::format("The number of nearest-neighbor distances in '{}' is {}, but should be {}!", file_name, parsed_dims, k_));
         }
 
-        const index_type correct_rank_size = comm_.rank() == comm_.size() - 1 ? (attr_.total_size - (comm_.size() - 1) * attr_.rank_size) : attr_.rank_size;
+        this->update_host_buffers();
+        const index_type correct_rank_size = attr_.correct_rank_size(comm_.rank());
 
         const sycl_lsh::get_linear_id<knn<layout, options_type, data_type>> get_linear_id_this{};
         const sycl_lsh::get_linear_id<knn<memory_layout::aos, options_type, data_type>> get_linear_id_aos{};
@@ -563,50 +990,60 @@ namespace sycl_lsh {
         index_type mean_error_count = 0;
         real_type mean_error_ratio = 0.0;
 
-        dist_host_buffer_type calculated_knn_dist_sorted(k_);
-        dist_host_buffer_type correct_knn_dist_sorted(k_);
+        #if defined(_OPENMP)
+        #pragma omp parallel
+        #endif
+        {
+            dist_host_buffer_type calculated_knn_dist_sorted(k_);
+            dist_host_buffer_type correct_knn_dist_sorted(k_);
+
+            #if defined(_OPENMP)
+            #pragma omp for schedule(static) reduction(+ : num_points_not_found, num_knn_not_found, mean_error_count, mean_error_ratio)
+            #endif
+            for (index_type point = 0; point < correct_rank_size; ++point) {
+                // fill k-nearest-neighbor distances for current point
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    calculated_knn_dist_sorted[nn] = dist_host_buffer_[get_linear_id_this(point, nn, attr_, k_)];
+                    correct_knn_dist_sorted[nn] = correct_knn_dist[get_linear_id_aos(point, nn, attr_, k_)];
+                }
+                // check whether k k-nearest-neighbor could be found
+                const auto count_not_found = std::count(calculated_knn_dist_sorted.cbegin(), calculated_knn_dist_sorted.cend(), std::numeric_limits<real_type>::max());
+                if (count_not_found != 0) {
+                    ++num_points_not_found;
+                    num_knn_not_found += count_not_found;
+                    continue;
+                }
+                // calculate `std::sqrt` distance
+                std::transform(calculated_knn_dist_sorted.begin(), calculated_knn_dist_sorted.end(), calculated_knn_dist_sorted.begin(),
+                               [](const real_type val) { return std::sqrt(val); });
+                // sort distances (the correct distances are normally already sorted)
+                std::sort(calculated_knn_dist_sorted.begin(), calculated_knn_dist_sorted.end());
+                if (!std::is_sorted(correct_knn_dist_sorted.cbegin(), correct_knn_dist_sorted.cend())) {
+                    std::sort(correct_knn_dist_sorted.begin(), correct_knn_dist_sorted.end());
+                }
 
-        for (index_type point = 0; point < correct_rank_size; ++point) {
-            // fill k-nearest-neighbor distances for current point
-            for (index_type nn = 0; nn < k_; ++nn) {
-                calculated_knn_dist_sorted[nn] = dist_host_buffer_[get_linear_id_this(point, nn, attr_, k_)];
-                correct_knn_dist_sorted[nn] = correct_knn_dist[get_linear_id_aos(point, nn, attr_, k_)];
-            }
-            // check whether k k-nearest-neighbor could be found
-            auto count_not_found = std::count(calculated_knn_dist_sorted.cbegin(), calculated_knn_dist_sorted.cend(), std::numeric_limits<real_type>::max());
-            if (count_not_found != 0) {
-                ++num_points_not_found;
-                num_knn_not_found += count_not_found;
-                continue;
-            }
-            // calculate `std::sqrt` distance
-            std::transform(calculated_knn_dist_sorted.begin(), calculated_knn_dist_sorted.end(), calculated_knn_dist_sorted.begin(),
-                           [](const real_type val) { return std::sqrt(val); });
-            // sort distances
-            std::sort(calculated_knn_dist_sorted.begin(), calculated_knn_dist_sorted.end());
-            std::sort(correct_knn_dist_sorted.begin(), correct_knn_dist_sorted.end());
-
-            // calculate error ratio
-            index_type error_count = 0;
-            real_type error_ratio = 0.0;
-            for (index_type nn = 0; nn < k_; ++nn) {
-                if (correct_knn_dist_sorted[nn] == 0.0) {
-                    // two different points at the same position
-                    if (calculated_knn_dist_sorted[nn] == 0.0) {
-                        // calculated nearest neighbor is correct
-                        error_ratio += 1.0;
+                // calculate error ratio
+                index_type error_count = 0;
+                real_type error_ratio = 0.0;
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    if (correct_knn_dist_sorted[nn] == 0.0) {
+                        // two different points at the same position
+                        if (calculated_knn_dist_sorted[nn] == 0.0) {
+                            // calculated nearest neighbor is correct
+                            error_ratio += 1.0;
+                            ++error_count;
+                        }
+                    } else {
+                        // calculate distance ratio
+                        error_ratio += calculated_knn_dist_sorted[nn] / correct_knn_dist_sorted[nn];
                         ++error_count;
                     }
-                } else {
-                    // calculate distance ratio
-                    error_ratio += calculated_knn_dist_sorted[nn] / correct_knn_dist_sorted[nn];
-                    ++error_count;
                 }
-            }
-            // calculate error ratio for current k-nearest neighbors
-            if (error_count != 0) {
-                mean_error_ratio += error_ratio / error_count;
-                ++mean_error_count;
+                // calculate error ratio for current k-nearest neighbors
+                if (error_count != 0) {
+                    mean_error_ratio += error_ratio / error_count;
+                    ++mean_error_count;
+                }
             }
         }
 
@@ -632,19 +1069,118 @@ namespace sycl_lsh {
     //                                             update host buffer                                             //
     // ---------------------------------------------------------------------------------------------------------- //
     template <memory_layout layout, typename Options, typename Data>
-    void knn<layout, Options, Data>::send_receive_host_buffer() {
+    void knn<layout, Options, Data>::start_send_receive_host_buffer() {
+        this->use_host_buffers();
         const int destination = (comm_.rank() + 1) % comm_.size();
         const int source = (comm_.size() + (comm_.rank() - 1) % comm_.size()) % comm_.size();
+        // the dummy points are only stored contiguously at the end of the host buffers for the AoS layout
+        const std::size_t send_count = layout == memory_layout::aos ? attr_.correct_rank_size(host_buffer_rank_) * k_ : knn_host_buffer_.size();
 
+        send_receive_start_ = mpi::communication_profiler::clock::now();
         // send/receive k-nearest-neighbor IDs
-        MPI_Sendrecv_replace(knn_host_buffer_.data(), knn_host_buffer_.size(), mpi::type_cast<typename knn_host_buffer_type::value_type>(),
-                             destination, 0, source, 0, comm_.get(), MPI_STATUS_IGNORE);
+        MPI_Irecv(knn_receive_buffer_.data(), knn_receive_buffer_.size(), mpi::type_cast<typename knn_host_buffer_type::value_type>(),
+                  source, 1, comm_.get(), &requests_[0]);
+        MPI_Isend(knn_host_buffer_.data(), send_count, mpi::type_cast<typename knn_host_buffer_type::value_type>(),
+                  destination, 1, comm_.get(), &requests_[1]);
 
         // send/receive k-nearest-neighbor distances
-        MPI_Sendrecv_replace(dist_host_buffer_.data(), dist_host_buffer_.size(), mpi::type_cast<typename dist_host_buffer_type::value_type>(),
-                             destination, 0, source, 0, comm_.get(), MPI_STATUS_IGNORE);
+        MPI_Irecv(dist_receive_buffer_.data(), dist_receive_buffer_.size(), mpi::type_cast<typename dist_host_buffer_type::value_type>(),
+                  source, 2, comm_.get(), &requests_[2]);
+        MPI_Isend(dist_host_buffer_.data(), send_count, mpi::type_cast<typename dist_host_buffer_type::value_type>(),
+                  destination, 2, comm_.get(), &requests_[3]);
+        const double mpi_time = mpi::communication_profiler::elapsed(send_receive_start_);
+        mpi::communication_profiler::record(mpi::communication_kind::ring_knn,
+                                            send_count * (sizeof(typename knn_host_buffer_type::value_type) + sizeof(typename dist_host_buffer_type::value_type)),
+                                            0, mpi_time, 0.0, 0.0);
+    }
+
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::finish_send_receive_host_buffer() {
+        const auto wait_start = mpi::communication_profiler::clock::now();
+        std::array<MPI_Status, 4> statuses;
+        MPI_Waitall(requests_.size(), requests_.data(), statuses.data());
+        const double wait_time = mpi::communication_profiler::elapsed(wait_start);
+        mpi::communication_profiler::record(mpi::communication_kind::ring_knn, 0,
+                                            mpi::communication_profiler::received_bytes<typename knn_host_buffer_type::value_type>(statuses[0])
+                                            + mpi::communication_profiler::received_bytes<typename dist_host_buffer_type::value_type>(statuses[2]),
+                                            wait_time, wait_time, mpi::communication_profiler::elapsed(send_receive_start_));
+        // the received elements are the new content of the host buffers
+        std::swap(knn_host_buffer_, knn_receive_buffer_);
+        std::swap(dist_host_buffer_, dist_receive_buffer_);
+        host_buffer_rank_ = (host_buffer_rank_ + comm_.size() - 1) % comm_.size();
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                           device-resident state                                            //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::update_host_buffers() const {
+        if (!host_buffers_outdated_) {
+            return;
+        }
+        mpi::timer t(comm_);
+
+        sycl::queue& queue = this->get_queue();
+        // only wait for the copies (the queue may be shared with other work)
+        sycl::event knn_event = queue.submit([&](sycl::handler& cgh) {
+            auto acc_knn = device_buffers_->knn.template get_access<sycl::access::mode::read>(cgh);
+            cgh.copy(acc_knn, knn_host_buffer_.data());
+        });
+        sycl::event dist_event = queue.submit([&](sycl::handler& cgh) {
+            auto acc_dist = device_buffers_->dist.template get_access<sycl::access::mode::read>(cgh);
+            cgh.copy(acc_dist, dist_host_buffer_.data());
+        });
+        knn_event.wait_and_throw();
+        dist_event.wait_and_throw();
+        host_buffers_outdated_ = false;
+
+        logger_.log("Copied the device-resident k-nearest-neighbors to the host in {}.\n", t.elapsed());
+    }
+
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::use_device_buffers() {
+        if (device_buffers_ == nullptr) {
+            // the device buffers aren't backed by the host buffers, i.e. they are never written back implicitly
+            device_buffers_ = std::make_unique<device_buffers>(device_buffers{ knn_device_buffer_type(knn_host_buffer_.size()),
+                                                                               dist_device_buffer_type(dist_host_buffer_.size()) });
+            device_buffers_outdated_ = true;
+        }
+        if (device_buffers_outdated_) {
+            // only refresh the content of the already allocated device buffers
+            sycl::queue& queue = this->get_queue();
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_knn = device_buffers_->knn.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(knn_host_buffer_.data(), acc_knn);
+            });
+            queue.submit([&](sycl::handler& cgh) {
+                auto acc_dist = device_buffers_->dist.template get_access<sycl::access::mode::discard_write>(cgh);
+                cgh.copy(dist_host_buffer_.data(), acc_dist);
+            });
+            // no wait: the host buffers are only accessed again through update_host_buffers(), whose copies depend on these uploads
+            // (and the device buffers wait for them on destruction)
+            device_buffers_outdated_ = false;
+        }
+        host_buffers_outdated_ = true;
+        sorted_ = false;
     }
 
+    template <memory_layout layout, typename Options, typename Data>
+    void knn<layout, Options, Data>::use_host_buffers() {
+        this->update_host_buffers();
+        // the device buffers stay allocated for the next round, but their content must be refreshed before they are used again
+        device_buffers_outdated_ = true;
+        // the host buffers may be changed by the caller
+        sorted_ = false;
+    }
+
+    template <memory_layout layout, typename Options, typename Data>
+    sycl::queue& knn<layout, Options, Data>::get_queue() const {
+        if (queue_ == nullptr) {
+            queue_ = std::make_unique<sycl::queue>(device_selector{ comm_ }, sycl::async_handler(&sycl_exception_handler));
+        }
+        return *queue_;
+    }
 }
 
 #endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_KNN_HPP
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2021-01-02
+ *
+ * @brief Implements the @ref sycl_lsh::mpi::communication_profiler class recording the MPI communication of the current MPI rank.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMMUNICATION_PROFILER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMMUNICATION_PROFILER_HPP
+
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sycl_lsh::mpi {
+
+    /**
+     * @brief The kinds of MPI communication recorded by the @ref sycl_lsh::mpi::communication_profiler.
+     */
+    enum class communication_kind {
+        /** the data points sent around the k-nearest-neighbor ring */
+        ring_data = 0,
+        /** the k-nearest-neighbors and their distances sent around the k-nearest-neighbor ring */
+        ring_knn = 1,
+        /** the distributed odd-even sort (@ref sycl_lsh::mpi::sort) */
+        sort = 2,
+        /** the broadcasts of the hash functions */
+        broadcast = 3,
+        /** the reductions while calculating the cut-off points of the entropy-based and mixed hash functions */
+        allreduce = 4,
+        /** the barriers (@ref sycl_lsh::mpi::communicator::wait()) */
+        barrier = 5,
+        /** the final merge of the partial k-nearest-neighbors of the `STATIONARY_RING` distribution scheme (@ref sycl_lsh::mpi::reduce_scatter_top_k) */
+        top_k_merge = 6
+    };
+
+    /// The names of the @ref sycl_lsh::mpi::communication_kind values (in the same order).
+    constexpr std::array<std::string_view, 7> communication_kind_names = { "ring data points", "ring k-nearest-neighbors", "sort",
+                                                                           "broadcast hash functions", "allreduce cut-off points", "barrier",
+                                                                           "reduce-scatter top-k" };
+
+    /**
+     * @brief The MPI communication of one @ref sycl_lsh::mpi::communication_kind in one round on the current MPI rank.
+     */
+    struct communication_statistics {
+        /// The number of recorded MPI calls.
+        std::uint64_t num_calls = 0;
+        /// The number of sent bytes.
+        std::uint64_t bytes_sent = 0;
+        /// The number of received bytes.
+        std::uint64_t bytes_received = 0;
+        /// The time spent inside MPI calls in ms.
+        double mpi_time = 0.0;
+        /// The time spent blocked waiting for the completion of the communication (or in a blocking MPI call) in ms.
+        double wait_time = 0.0;
+        /// The time from starting the communication until its completion in ms.
+        double transfer_time = 0.0;
+
+        /**
+         * @brief Returns the achieved bandwidth, i.e. the sent and received bytes per transfer time.
+         * @return the bandwidth in MiB/s (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        double bandwidth() const noexcept {
+            return transfer_time > 0.0 ? static_cast<double>(bytes_sent + bytes_received) / (1024.0 * 1024.0) / (transfer_time / 1000.0) : 0.0;
+        }
+    };
+
+    /**
+     * @brief Records the bytes and times of the MPI communication of the current MPI rank per @ref sycl_lsh::mpi::communication_kind and
+     *        round.
+     * @details The recorded statistics are shared by all objects of the current MPI rank (like MPI itself). Only the communication of the
+     *          k-nearest-neighbor ring is recorded per round, all other kinds are recorded in round `0`.
+     */
+    class communication_profiler {
+    public:
+        /// The [`std::chrono`](https://en.cppreference.com/w/cpp/chrono) clock used to measure the times.
+        using clock = std::chrono::steady_clock;
+        /// The recorded statistics indexed by the @ref sycl_lsh::mpi::communication_kind and round.
+        using statistics_type = std::array<std::vector<communication_statistics>, communication_kind_names.size()>;
+
+        /**
+         * @brief Sets the round of the k-nearest-neighbor ring all following recorded ring communication belongs to.
+         * @param[in] round the current round
+         */
+        static void set_round(std::size_t round) noexcept;
+        /**
+         * @brief Records an MPI communication of kind @p kind.
+         * @param[in] kind the kind of the communication
+         * @param[in] bytes_sent the number of sent bytes
+         * @param[in] bytes_received the number of received bytes
+         * @param[in] mpi_time the time spent inside MPI calls in ms
+         * @param[in] wait_time the time spent blocked waiting for the completion of the communication in ms
+         * @param[in] transfer_time the time from starting the communication until its completion in ms
+         */
+        static void record(communication_kind kind, std::size_t bytes_sent, std::size_t bytes_received, double mpi_time, double wait_time,
+                           double transfer_time);
+        /**
+         * @brief Records a blocking MPI communication of kind @p kind started at @p start and finished now.
+         * @param[in] kind the kind of the communication
+         * @param[in] bytes_sent the number of sent bytes
+         * @param[in] bytes_received the number of received bytes
+         * @param[in] start the time point the blocking MPI call has been started
+         */
+        static void record_blocking(const communication_kind kind, const std::size_t bytes_sent, const std::size_t bytes_received,
+                                    const clock::time_point start) {
+            const double time = elapsed(start);
+            record(kind, bytes_sent, bytes_received, time, time, time);
+        }
+
+        /**
+         * @brief Returns the elapsed time since @p start.
+         * @param[in] start the start time point
+         * @return the elapsed time in ms (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        static double elapsed(const clock::time_point start) noexcept {
+            return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        }
+        /**
+         * @brief Returns the number of bytes received by the MPI call described by @p status.
+         * @tparam T the type of the received elements
+         * @param[in] status the status of the finished receive
+         * @return the number of received bytes (`[[nodiscard]]`)
+         */
+        template <typename T>
+        [[nodiscard]]
+        static std::size_t received_bytes(const MPI_Status& status) {
+            int count = 0;
+            MPI_Get_count(&status, type_cast<T>(), &count);
+            return count == MPI_UNDEFINED ? 0 : static_cast<std::size_t>(count) * sizeof(T);
+        }
+
+        /**
+         * @brief Logs the communication recorded since the last report aggregated over all MPI ranks and clears it (collective operation).
+         * @details The sent and received bytes are summed over all MPI ranks, the MPI and wait times are aggregated (min/avg/max) and the
+         *          bandwidth is averaged. A large difference between the minimum and maximum wait time indicates load imbalance.
+         * @param[in] phase the description of the finished phase
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         */
+        static void report(std::string_view phase, const communicator& comm, const logger& logger);
+        /**
+         * @brief Returns the communication of the current MPI rank recorded until the last @ref report().
+         * @return the statistics indexed by the @ref sycl_lsh::mpi::communication_kind and round (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        static const statistics_type& last_report() noexcept { return last_report_; }
+
+    private:
+        static std::size_t round_;
+        static statistics_type statistics_;
+        static statistics_type last_report_;
+    };
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_COMMUNICATION_PROFILER_HPP
@@ -86,6 +86,19 @@ namespace sycl_lsh::mpi {
         void attach_errhandler(const errhandler& handler);
 
 
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                MPI IO hints                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Sets the MPI IO hints @p hints, e.g. `cb_nodes=4,cb_buffer_size=16777216`, using *MPI_File_set_info()* (collective operation).
+         * @details Unknown hints are silently ignored by the MPI implementation.
+         * @param[in] hints the comma separated `key=value` pairs
+         *
+         * @throws std::invalid_argument if **any** hint isn't a `key=value` pair.
+         */
+        void set_hints(std::string_view hints);
+
+
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                   getter                                                   //
         // ---------------------------------------------------------------------------------------------------------- //
@@ -9,21 +9,55 @@
 #ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_ARFF_PARSER_HPP
 #define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_ARFF_PARSER_HPP
 
-#include <sycl_lsh/exceptions/not_implemented_exception.hpp>
+#include <sycl_lsh/detail/arithmetic_type_name.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/file.hpp>
 #include <sycl_lsh/mpi/file_parser/base_parser.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+#include <sycl_lsh/mpi/timer.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
 
+#include <fmt/format.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
 #include <vector>
 
 namespace sycl_lsh::mpi {
 
     /**
      * @brief File parser class for the **arff** data format.
-     * @details Not yet implemented.
+     * @details Only `numeric`, `real` or `integer` attributes are supported. Comments (`%`) and empty lines are ignored. \n
+     *          Besides dense data sections, sparse data sections are supported (detected by the first data line starting with `{`). Each
+     *          sparse line lists its non-zero values as `{index value, ...}` with strictly increasing zero-based indices. This is only a
+     *          sparse input format: the data points are parsed and redistributed in CSR format, but are densified directly afterwards,
+     *          i.e. the resulting @ref sycl_lsh::data (and everything using it) still scales with the number of dimensions. \n
+     *          The MPI master rank parses the header. Afterwards, each MPI rank reads its own byte range of the `@data` section using MPI IO
+     *          and parses all lines **starting** in it (i.e. the last line is read past the end of the byte range) using `std::from_chars`.
+     *          Finally, the parsed data points are redistributed such that each MPI rank has the same number of data points.
+     *
+     * Example:
+     * @relation example
+     * @attribute x numeric
+     * @attribute y numeric
+     * @data
+     * 0.0,0.1
+     * 0.2,0.3
+     *
+     * or sparse:
+     * @data
+     * {1 0.1}
+     * {0 0.2,1 0.3}
      * @tparam Options  type of the used @ref sycl_lsh::options class
      * @tparam T the type of the data to parse
      */
@@ -33,6 +67,8 @@ namespace sycl_lsh::mpi {
     public:
         /// The index type as specified in the provided @ref sycl_lsh::options template type.
         using index_type = typename base_type::index_type;
+        /// The global ID type as specified in the provided @ref sycl_lsh::options template type.
+        using id_type = typename base_type::id_type;
         /// The type of the data which should get parsed.
         using parsing_type = typename base_type::parsing_type;
 
@@ -47,49 +83,142 @@ namespace sycl_lsh::mpi {
          * @param[in] mode the file open mode (@ref sycl_lsh::mpi::file::mode::read or @ref sycl_lsh::mpi::file::mode::write)
          * @param[in] comm the used @ref sycl_lsh::mpi::communicator
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
-         *
-         * @throws std::logic_error since `.arff` files aren't currently supported.
          */
         arff_parser(std::string_view file_name, file::mode mode, const communicator& comm, const logger& logger);
 
-        
+
         // ---------------------------------------------------------------------------------------------------------- //
         //                                                  parsing                                                   //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
          * @brief Parse the **total** number of data points in the file.
+         * @details Returns the number of data lines found by all MPI ranks. Parses the whole file on the first call (collective operation).
          * @return the total number of data points (`[[nodiscard]]`)
          *
-         * @throws sycl_lsh::not_implemented since `.arff` files aren't currently supported.
+         * @throws std::invalid_argument if the header doesn't contain a `@data` section or contains non-numeric attributes.
+         * @throws std::invalid_argument if **any** line of the `@data` section is illegal.
          */
         [[nodiscard]]
-        index_type parse_total_size() const override;
+        id_type parse_total_size() const override { this->parse_file(); return total_size_; }
         /**
          * @brief Parse the number of dimensions of each data point in the file.
+         * @details Returns the number of `@attribute` lines in the header. Parses the whole file on the first call (collective operation).
          * @return the number of dimensions (`[[nodiscard]]`)
          *
-         * @throws sycl_lsh::not_implemented since `.arff` files aren't currently supported.
+         * @throws std::invalid_argument if the header doesn't contain a `@data` section or contains non-numeric attributes.
+         * @throws std::invalid_argument if **any** line of the `@data` section is illegal.
          */
         [[nodiscard]]
-        index_type parse_dims() const override;
+        index_type parse_dims() const override { this->parse_file(); return dims_; }
         /**
          * @brief Parse the content of the file.
+         * @details Fills the last elements of the buffer on the last MPI rank such that all MPI ranks have te same number of data points.
+         *          Parses the whole file on the first call (collective operation).
          * @return the parsed data (`[[nodiscard]]`)
          *
-         * @throws sycl_lsh::not_implemented since `.arff` files aren't currently supported.
+         * @throws std::invalid_argument if the header doesn't contain a `@data` section or contains non-numeric attributes.
+         * @throws std::invalid_argument if **any** line of the `@data` section is illegal.
+         *
+         * @note Calls MPI_Abort() if the file has been opened in write mode.
          */
-        [[nodiscard]] 
+        [[nodiscard]]
         std::vector<parsing_type> parse_content() const override;
         /**
          * @brief Write the content in @p buffer to the file.
+         * @details Each dimension is written as `numeric` attribute `dim_i`.
          * @param[in] total_size the total number of values to write (sum of all values from **all** MPI ranks)
          * @param[in] dims the number of dimensions of each value
          * @param[in] buffer the data to write to the file
          *
-         * @throws sycl_lsh::not_implemented since `.arff` files aren't currently supported.
+         * @note Calls MPI_Abort() if the file has been opened in read mode.
          */
-        void write_content(index_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const override;
+        void write_content(id_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const override;
+
+    private:
+        /// The number of bytes read at once while searching for the end of the header or the end of the last line of an MPI rank.
+        static constexpr MPI_Offset read_block_size = 1 << 20;
+        /// The maximum number of bytes read using a single MPI IO call (the count is an `int`).
+        static constexpr MPI_Offset max_read_size = 1 << 30;
 
+        /**
+         * @brief Parses the whole file if it hasn't been parsed yet (i.e. after the MPI IO hints have been set).
+         */
+        void parse_file() const;
+        /**
+         * @brief Parses the header on the MPI master rank and broadcasts the number of dimensions, the offset of the `@data` section and
+         *        whether the data section is sparse.
+         * @details The data section is considered sparse if its first data line starts with `{`.
+         * @return the byte offset of the first line of the `@data` section (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if the header doesn't contain a `@data` section or contains non-numeric attributes.
+         */
+        [[nodiscard]]
+        MPI_Offset parse_header() const;
+        /**
+         * @brief Parses all lines of the `@data` section starting in the byte range of the current MPI rank and redistributes them.
+         * @param[in] data_begin the byte offset of the first line of the `@data` section
+         *
+         * @throws std::invalid_argument if **any** line of the `@data` section is illegal.
+         */
+        void parse_data(MPI_Offset data_begin) const;
+        /**
+         * @brief Redistributes the parsed sparse data points (in CSR format) according to the data point counts and displacements and
+         *        expands the data points received by the current MPI rank to dense data points.
+         * @details Only the non-zero values are sent, i.e. the number of values sent between two MPI ranks varies.
+         * @param[in] send_counts the number of data points sent to each MPI rank
+         * @param[in] send_displs the first parsed data point sent to each MPI rank
+         * @param[in] recv_counts the number of data points received from each MPI rank
+         * @param[in] recv_displs the position of the first data point received from each MPI rank
+         * @param[in] row_nnz the number of non-zero values of each parsed data point
+         * @param[in] col_indices the dimensions of all non-zero values
+         * @param[in] values all non-zero values
+         *
+         * @throws std::runtime_error if more than `INT_MAX` non-zero values must be sent from one MPI rank to another.
+         */
+        void redistribute_sparse(const std::vector<int>& send_counts, const std::vector<int>& send_displs, const std::vector<int>& recv_counts,
+                                 const std::vector<int>& recv_displs, const std::vector<index_type>& row_nnz,
+                                 const std::vector<index_type>& col_indices, const std::vector<parsing_type>& values) const;
+        /**
+         * @brief Parses the sparse data line @p line (without the enclosing braces) and appends its non-zero values to @p col_indices and
+         *        @p values.
+         * @param[in] line the sparse data line, i.e. `index value` pairs separated by `,`
+         * @param[in,out] col_indices the dimensions of all non-zero values
+         * @param[in,out] values all non-zero values
+         * @return the number of appended non-zero values (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if @p line isn't a valid sparse data line.
+         */
+        [[nodiscard]]
+        index_type parse_sparse_line(std::string_view line, std::vector<index_type>& col_indices, std::vector<parsing_type>& values) const;
+        /**
+         * @brief Appends @p count bytes starting at the byte offset @p offset to @p buffer.
+         * @param[in] offset the byte offset to start reading at
+         * @param[in] count the number of bytes to read
+         * @param[in,out] buffer the buffer to append to
+         */
+        void read_bytes(MPI_Offset offset, MPI_Offset count, std::string& buffer) const;
+        /**
+         * @brief Converts @p str to a value of type @ref parsing_type using `std::from_chars` (independent of the current locale).
+         * @param[in] str the string to convert
+         * @return the converted value (`[[nodiscard]]`)
+         *
+         * @throws std::invalid_argument if @p str isn't a valid value of type @ref parsing_type.
+         */
+        [[nodiscard]]
+        static parsing_type convert_value(std::string_view str);
+        /**
+         * @brief Removes all leading and trailing whitespaces from @p str.
+         * @param[in] str the string to trim
+         * @return the trimmed string (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        static std::string_view trim(std::string_view str);
+
+        mutable bool parsed_ = false;
+        mutable id_type total_size_ = 0;
+        mutable index_type dims_ = 0;
+        mutable bool sparse_ = false;
+        mutable std::vector<parsing_type> content_;
     };
 
 
@@ -100,33 +229,460 @@ namespace sycl_lsh::mpi {
     arff_parser<Options, T>::arff_parser(const std::string_view file_name, const file::mode mode, const communicator& comm, const logger& logger)
             : file_parser<Options, T>(file_name, mode, comm, logger)
     {
-        throw std::logic_error("Parsing an '.arff' file is currently no supported! Maybe run data_sets/convert_arff_to_binary.py first?");
+        logger.log("Parsing the data file '{}' using the arff_parser together with MPI IO.\n", file_name);
     }
 
 
     // ---------------------------------------------------------------------------------------------------------- //
     //                                                  parsing                                                   //
     // ---------------------------------------------------------------------------------------------------------- //
+    template <typename Options, typename T>
+    std::vector<typename arff_parser<Options, T>::parsing_type> arff_parser<Options, T>::parse_content() const {
+        // throw if file has been opened in the wrong mode
+        if (base_type::mode_ == mpi::file::mode::write) {
+            if (base_type::comm_.rank() == 0) {
+                fmt::print(stderr, "\nCan't read from a file opened in write mode!\n\n");
+            }
+            MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+        }
+
+        this->parse_file();
+        return content_;
+    }
+
+    template <typename Options, typename T>
+    void arff_parser<Options, T>::write_content(const id_type total_size, const index_type dims, const std::vector<parsing_type>& buffer) const {
+        mpi::timer t(base_type::comm_);
+
+        // throw if file has been opened in the wrong mode
+        if (base_type::mode_ == mpi::file::mode::read) {
+            if (base_type::comm_.rank() == 0) {
+                fmt::print(stderr, "\nCan't write to a file opened in read mode!\n\n");
+            }
+            MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+        }
+
+        // write header information
+        if (base_type::comm_.master_rank()) {
+            std::string header = "@relation sycl_lsh\n\n";
+            for (index_type dim = 0; dim < dims; ++dim) {
+                fmt::format_to(std::back_inserter(header), "@attribute dim_{} numeric\n", dim);
+            }
+            header += "\n@data\n";
+            MPI_File_write(base_type::file_.get(), header.data(), header.size(), MPI_CHAR, MPI_STATUS_IGNORE);
+        }
+        base_type::comm_.wait();
+        MPI_File_seek_shared(base_type::file_.get(), 0, MPI_SEEK_END);
+
+        // write actual content
+        index_type correct_rank_size = buffer.size() / dims;
+        if (base_type::comm_.rank() == base_type::comm_.size() - 1) {
+            correct_rank_size = total_size - static_cast<id_type>(base_type::comm_.size() - 1) * correct_rank_size;
+        }
+        std::string content;
+        for (index_type point = 0; point < correct_rank_size; ++point) {
+            for (index_type dim = 0; dim < dims; ++dim) {
+                fmt::format_to(std::back_inserter(content), dim == 0 ? "{}" : ",{}", buffer[static_cast<std::size_t>(point) * dims + dim]);
+            }
+            content += '\n';
+        }
+        MPI_File_write_ordered(base_type::file_.get(), content.data(), content.size(), MPI_CHAR, MPI_STATUS_IGNORE);
+
+        base_type::logger_.log("Wrote content to file in {}.\n", t.elapsed());
+    }
+
+
+    template <typename Options, typename T>
+    void arff_parser<Options, T>::parse_file() const {
+        if (parsed_) {
+            return;
+        }
+        // already set before parsing the data section since it needs the rank size (calculated using parse_total_size())
+        parsed_ = true;
+        timer t(base_type::comm_);
+        this->parse_data(this->parse_header());
+        base_type::logger_.log("Parsed the data file in {}.\n", t.elapsed());
+    }
+
     template <typename Options, typename T>
     [[nodiscard]]
-    typename arff_parser<Options, T>::index_type arff_parser<Options, T>::parse_total_size() const {
-        throw sycl_lsh::not_implemented();
+    MPI_Offset arff_parser<Options, T>::parse_header() const {
+        const communicator& comm = base_type::comm_;
+
+        // [data_begin, dims, sparse]; data_begin is -1 if the header is illegal
+        long long header_info[3] = { -1, 0, 0 };
+        std::string error;
+        if (comm.master_rank()) {
+            MPI_Offset file_size;
+            MPI_File_get_size(base_type::file_.get(), &file_size);
+
+            std::string buffer;
+            MPI_Offset buffer_begin = 0;    // byte offset of the first character in buffer
+            std::size_t line_begin = 0;     // first character of the next unprocessed line in buffer
+            // continue after the '@data' line until the first data line to detect a sparse data section
+            bool first_data_line_found = false;
+            while (!first_data_line_found && error.empty()) {
+                std::size_t line_end = buffer.find('\n', line_begin);
+                if (line_end == std::string::npos) {
+                    const MPI_Offset next = buffer_begin + static_cast<MPI_Offset>(buffer.size());
+                    if (next >= file_size) {
+                        // the last line doesn't need a trailing newline
+                        if (line_begin >= buffer.size()) {
+                            if (header_info[0] == -1) {
+                                error = "Missing '@data' section!";
+                            }
+                            break;
+                        }
+                        line_end = buffer.size();
+                    } else {
+                        // read the next block of the header
+                        buffer.erase(0, line_begin);
+                        buffer_begin += line_begin;
+                        line_begin = 0;
+                        this->read_bytes(next, std::min(read_block_size, file_size - next), buffer);
+                        continue;
+                    }
+                }
+
+                const std::string_view line = trim(std::string_view(buffer).substr(line_begin, line_end - line_begin));
+                const MPI_Offset next_line = buffer_begin + line_end + 1;
+                line_begin = line_end + 1;
+
+                // ignore empty lines and comments
+                if (line.empty() || line.front() == '%') {
+                    continue;
+                }
+                if (header_info[0] != -1) {
+                    header_info[2] = line.front() == '{';
+                    first_data_line_found = true;
+                    break;
+                }
+                std::string lower_line(line);
+                std::transform(lower_line.begin(), lower_line.end(), lower_line.begin(), [](const unsigned char c) { return std::tolower(c); });
+
+                if (lower_line.rfind("@data", 0) == 0) {
+                    header_info[0] = std::min(next_line, file_size);
+                } else if (lower_line.rfind("@attribute", 0) == 0) {
+                    // skip the (possibly quoted) attribute name
+                    std::string_view attribute = trim(std::string_view(lower_line).substr(std::string_view("@attribute").size()));
+                    std::size_t name_end;
+                    if (!attribute.empty() && (attribute.front() == '\'' || attribute.front() == '"')) {
+                        name_end = attribute.find(attribute.front(), 1);
+                        name_end = name_end == std::string_view::npos ? attribute.size() : name_end + 1;
+                    } else {
+                        name_end = std::min(attribute.find_first_of(" \t"), attribute.size());
+                    }
+                    const std::string_view type = trim(attribute.substr(name_end));
+                    if (type != "numeric" && type != "real" && type != "integer") {
+                        error = fmt::format("Only numeric attributes are supported, but got '{}'!", line);
+                    }
+                    ++header_info[1];
+                }
+            }
+        }
+
+        // broadcast the header information or the error
+        MPI_Bcast(header_info, 3, type_cast<long long>(), 0, comm.get());
+        int error_size = error.size();
+        MPI_Bcast(&error_size, 1, type_cast<int>(), 0, comm.get());
+        if (error_size > 0) {
+            error.resize(error_size);
+            MPI_Bcast(error.data(), error_size, MPI_CHAR, 0, comm.get());
+            throw std::invalid_argument(fmt::format("Illegal '.arff' header: {}", error));
+        }
+        if (header_info[1] == 0) {
+            throw std::invalid_argument("Illegal '.arff' header: no attributes!");
+        }
+
+        dims_ = static_cast<index_type>(header_info[1]);
+        sparse_ = header_info[2] != 0;
+        if (sparse_) {
+            base_type::logger_.log("Detected a sparse '.arff' data section.\n");
+        }
+        return static_cast<MPI_Offset>(header_info[0]);
+    }
+
+    template <typename Options, typename T>
+    void arff_parser<Options, T>::parse_data(const MPI_Offset data_begin) const {
+        const communicator& comm = base_type::comm_;
+        const int comm_size = comm.size();
+        const int comm_rank = comm.rank();
+
+        MPI_Offset file_size;
+        MPI_File_get_size(base_type::file_.get(), &file_size);
+
+        // each MPI rank parses all lines starting in its byte range [begin, end) of the data section
+        const MPI_Offset data_size = file_size - data_begin;
+        const MPI_Offset chunk_size = (data_size + comm_size - 1) / comm_size;
+        const MPI_Offset begin = data_begin + std::min<MPI_Offset>(comm_rank * chunk_size, data_size);
+        const MPI_Offset end = data_begin + std::min<MPI_Offset>((comm_rank + 1) * chunk_size, data_size);
+
+        std::vector<parsing_type> values;
+        // the number of non-zero values per data point and their dimensions (only used for sparse data sections)
+        std::vector<index_type> row_nnz;
+        std::vector<index_type> col_indices;
+        index_type num_points = 0;
+        std::string error;
+        try {
+            if (begin < end) {
+                // additionally read the last byte of the previous MPI rank to detect whether a line starts at begin
+                const MPI_Offset read_begin = begin == data_begin ? begin : begin - 1;
+                std::string buffer;
+                this->read_bytes(read_begin, end - read_begin, buffer);
+
+                // the first line of the current MPI rank starts after the first newline (unless it's the first line of the data section)
+                std::size_t first = begin == data_begin ? 0 : buffer.find('\n');
+                first = first == std::string::npos ? buffer.size() : first + (begin == data_begin ? 0 : 1);
+
+                // realign to the end of the last line starting in the byte range of the current MPI rank
+                const std::size_t last_owned = end - 1 - read_begin;
+                std::size_t last = buffer.find('\n', last_owned);
+                MPI_Offset next = end;
+                while (last == std::string::npos && next < file_size) {
+                    const std::size_t searched = buffer.size();
+                    const MPI_Offset count = std::min(read_block_size, file_size - next);
+                    this->read_bytes(next, count, buffer);
+                    next += count;
+                    last = buffer.find('\n', searched);
+                }
+                last = last == std::string::npos ? buffer.size() : last;
+
+                // parse all lines
+                for (std::size_t line_begin = first; line_begin < last && line_begin <= last_owned; ) {
+                    const std::size_t line_end = std::min(buffer.find('\n', line_begin), last);
+                    const std::string_view line = trim(std::string_view(buffer).substr(line_begin, line_end - line_begin));
+                    line_begin = line_end + 1;
+
+                    // ignore empty lines and comments
+                    if (line.empty() || line.front() == '%') {
+                        continue;
+                    }
+
+                    if (sparse_) {
+                        if (line.front() != '{' || line.back() != '}') {
+                            throw std::invalid_argument(fmt::format("Illegal line '{}' in a sparse data section! Must be enclosed in braces.", line));
+                        }
+                        row_nnz.push_back(this->parse_sparse_line(line.substr(1, line.size() - 2), col_indices, values));
+                        ++num_points;
+                        continue;
+                    }
+
+                    index_type dim = 0;
+                    for (std::size_t value_begin = 0; value_begin <= line.size(); ++dim) {
+                        const std::size_t value_end = std::min(line.find(',', value_begin), line.size());
+                        if (dim < dims_) {
+                            values.push_back(convert_value(trim(line.substr(value_begin, value_end - value_begin))));
+                        }
+                        value_begin = value_end + 1;
+                    }
+                    if (dim != dims_) {
+                        throw std::invalid_argument(fmt::format("Illegal number of values ({}) in line '{}'! Must be {}.", dim, line, dims_));
+                    }
+                    ++num_points;
+                }
+            }
+        } catch (const std::invalid_argument& e) {
+            error = e.what();
+        }
+
+        // an error on any MPI rank aborts the parsing on all MPI ranks
+        if (mpi::sum<int>(!error.empty(), comm) > 0) {
+            throw std::invalid_argument(error.empty() ? std::string("Illegal '.arff' data section on another MPI rank!") : error);
+        }
+
+        // agree on the global position of the parsed data points (may exceed the index_type)
+        const id_type num_parsed_points = num_points;
+        id_type first_point = 0;
+        MPI_Exscan(&num_parsed_points, &first_point, 1, type_cast<id_type>(), MPI_SUM, comm.get());
+        if (comm.master_rank()) {
+            // the result of MPI_Exscan is undefined on the first MPI rank
+            first_point = 0;
+        }
+        total_size_ = mpi::sum(num_parsed_points, comm);
+        if (total_size_ == 0) {
+            throw std::invalid_argument("Illegal '.arff' data section: no data points!");
+        }
+        const index_type rank_size = this->parse_rank_size();
+
+        // redistribute the parsed data points such that MPI rank i holds the data points [i * rank_size, (i + 1) * rank_size)
+        std::vector<int> send_counts(comm_size, 0);
+        std::vector<int> send_displs(comm_size, 0);
+        for (int rank = 0; rank < comm_size; ++rank) {
+            const id_type lo = std::max<id_type>(first_point, static_cast<id_type>(rank) * rank_size);
+            const id_type hi = std::min<id_type>(first_point + num_points, static_cast<id_type>(rank + 1) * rank_size);
+            if (lo < hi) {
+                send_counts[rank] = hi - lo;
+                send_displs[rank] = lo - first_point;
+            }
+        }
+        std::vector<int> recv_counts(comm_size);
+        MPI_Alltoall(send_counts.data(), 1, type_cast<int>(), recv_counts.data(), 1, type_cast<int>(), comm.get());
+        std::vector<int> recv_displs(comm_size, 0);
+        for (int rank = 1; rank < comm_size; ++rank) {
+            recv_displs[rank] = recv_displs[rank - 1] + recv_counts[rank - 1];
+        }
+
+        content_.resize(static_cast<std::size_t>(rank_size) * dims_);
+        if (sparse_) {
+            this->redistribute_sparse(send_counts, send_displs, recv_counts, recv_displs, row_nnz, col_indices, values);
+        } else {
+            MPI_Datatype point_type;
+            MPI_Type_contiguous(dims_, type_cast<parsing_type>(), &point_type);
+            MPI_Type_commit(&point_type);
+            MPI_Alltoallv(values.data(), send_counts.data(), send_displs.data(), point_type,
+                          content_.data(), recv_counts.data(), recv_displs.data(), point_type, comm.get());
+            MPI_Type_free(&point_type);
+        }
+
+        // fill missing data points ON THE LAST MPI RANK with dummy points
+        const index_type correct_rank_size = recv_displs.back() + recv_counts.back();
+        if (comm_rank == comm_size - 1 && correct_rank_size > 0) {
+            for (index_type point = correct_rank_size; point < rank_size; ++point) {
+                for (index_type dim = 0; dim < dims_; ++dim) {
+                    content_[static_cast<std::size_t>(point) * dims_ + dim] = content_[static_cast<std::size_t>(correct_rank_size - 1) * dims_ + dim];
+                }
+            }
+        }
+    }
+
+    template <typename Options, typename T>
+    void arff_parser<Options, T>::redistribute_sparse(const std::vector<int>& send_counts, const std::vector<int>& send_displs,
+                                                      const std::vector<int>& recv_counts, const std::vector<int>& recv_displs,
+                                                      const std::vector<index_type>& row_nnz, const std::vector<index_type>& col_indices,
+                                                      const std::vector<parsing_type>& values) const {
+        const communicator& comm = base_type::comm_;
+        const int comm_size = comm.size();
+
+        // exchange the number of non-zero values of each data point
+        const index_type num_received_points = recv_displs.back() + recv_counts.back();
+        std::vector<index_type> received_row_nnz(num_received_points);
+        MPI_Alltoallv(row_nnz.data(), send_counts.data(), send_displs.data(), type_cast<index_type>(),
+                      received_row_nnz.data(), recv_counts.data(), recv_displs.data(), type_cast<index_type>(), comm.get());
+
+        // calculate the (variable) number of non-zero values sent to and received from each MPI rank
+        std::vector<std::size_t> row_offsets(row_nnz.size() + 1, 0);
+        for (std::size_t point = 0; point < row_nnz.size(); ++point) {
+            row_offsets[point + 1] = row_offsets[point] + row_nnz[point];
+        }
+        std::vector<int> send_nnz_counts(comm_size, 0);
+        std::vector<int> send_nnz_displs(comm_size, 0);
+        std::vector<int> recv_nnz_counts(comm_size, 0);
+        std::vector<int> recv_nnz_displs(comm_size, 0);
+        std::size_t max_nnz_count = 0;
+        std::size_t received_nnz = 0;
+        for (int rank = 0; rank < comm_size; ++rank) {
+            const std::size_t send_nnz = row_offsets[send_displs[rank] + send_counts[rank]] - row_offsets[send_displs[rank]];
+            std::size_t recv_nnz = 0;
+            for (int point = recv_displs[rank]; point < recv_displs[rank] + recv_counts[rank]; ++point) {
+                recv_nnz += received_row_nnz[point];
+            }
+            max_nnz_count = std::max({ max_nnz_count, send_nnz, recv_nnz, row_offsets[send_displs[rank]], received_nnz });
+            send_nnz_counts[rank] = send_nnz;
+            send_nnz_displs[rank] = row_offsets[send_displs[rank]];
+            recv_nnz_counts[rank] = recv_nnz;
+            recv_nnz_displs[rank] = received_nnz;
+            received_nnz += recv_nnz;
+        }
+        if (mpi::max(max_nnz_count, comm) > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Too many non-zero values per MPI rank to redistribute the sparse data points!");
+        }
+
+        // exchange the non-zero values and their dimensions
+        std::vector<index_type> received_col_indices(received_nnz);
+        std::vector<parsing_type> received_values(received_nnz);
+        MPI_Alltoallv(col_indices.data(), send_nnz_counts.data(), send_nnz_displs.data(), type_cast<index_type>(),
+                      received_col_indices.data(), recv_nnz_counts.data(), recv_nnz_displs.data(), type_cast<index_type>(), comm.get());
+        MPI_Alltoallv(values.data(), send_nnz_counts.data(), send_nnz_displs.data(), type_cast<parsing_type>(),
+                      received_values.data(), recv_nnz_counts.data(), recv_nnz_displs.data(), type_cast<parsing_type>(), comm.get());
+
+        // expand the received data points to dense data points
+        std::fill(content_.begin(), content_.end(), parsing_type{ 0 });
+        std::size_t nnz = 0;
+        for (index_type point = 0; point < num_received_points; ++point) {
+            for (index_type i = 0; i < received_row_nnz[point]; ++i, ++nnz) {
+                content_[static_cast<std::size_t>(point) * dims_ + received_col_indices[nnz]] = received_values[nnz];
+            }
+        }
     }
 
     template <typename Options, typename T>
     [[nodiscard]]
-    typename arff_parser<Options, T>::index_type arff_parser<Options, T>::parse_dims() const {
-        throw sycl_lsh::not_implemented();
+    typename arff_parser<Options, T>::index_type arff_parser<Options, T>::parse_sparse_line(const std::string_view line, std::vector<index_type>& col_indices,
+                                                                                            std::vector<parsing_type>& values) const {
+        index_type nnz = 0;
+        if (trim(line).empty()) {
+            // all values are zero
+            return nnz;
+        }
+        for (std::size_t entry_begin = 0; entry_begin <= line.size(); ++nnz) {
+            const std::size_t entry_end = std::min(line.find(',', entry_begin), line.size());
+            const std::string_view entry = trim(line.substr(entry_begin, entry_end - entry_begin));
+            entry_begin = entry_end + 1;
+
+            // split the entry in its index and value
+            const std::size_t index_end = std::min(entry.find_first_of(" \t"), entry.size());
+            const std::string_view index_str = entry.substr(0, index_end);
+            index_type index = 0;
+            const auto [ptr, ec] = std::from_chars(index_str.data(), index_str.data() + index_str.size(), index);
+            if (ec != std::errc{} || ptr != index_str.data() + index_str.size() || index_end == entry.size()) {
+                throw std::invalid_argument(fmt::format("Illegal sparse entry '{}'! Must be 'index value'.", entry));
+            }
+            if (index >= dims_) {
+                throw std::invalid_argument(fmt::format("Illegal sparse index {} in entry '{}'! Must be less than {}.", index, entry, dims_));
+            }
+            if (nnz > 0 && index <= col_indices.back()) {
+                throw std::invalid_argument(fmt::format("Illegal sparse index {} in entry '{}'! The indices must be strictly increasing.", index, entry));
+            }
+            col_indices.push_back(index);
+            values.push_back(convert_value(trim(entry.substr(index_end))));
+        }
+        return nnz;
     }
 
     template <typename Options, typename T>
-    std::vector<typename arff_parser<Options, T>::parsing_type> arff_parser<Options, T>::parse_content() const {
-        throw sycl_lsh::not_implemented();
+    void arff_parser<Options, T>::read_bytes(MPI_Offset offset, MPI_Offset count, std::string& buffer) const {
+        std::size_t pos = buffer.size();
+        buffer.resize(buffer.size() + count);
+        while (count > 0) {
+            const int block = std::min(count, max_read_size);
+            MPI_Status status;
+            MPI_File_read_at(base_type::file_.get(), offset, buffer.data() + pos, block, MPI_CHAR, &status);
+            int read_count;
+            MPI_Get_count(&status, MPI_CHAR, &read_count);
+            if (read_count <= 0) {
+                // unexpected end of file
+                buffer.resize(pos);
+                return;
+            }
+            offset += read_count;
+            count -= read_count;
+            pos += read_count;
+        }
     }
 
     template <typename Options, typename T>
-    void arff_parser<Options, T>::write_content(const index_type, const index_type, const std::vector<parsing_type>&) const {
-        throw sycl_lsh::not_implemented();
+    [[nodiscard]]
+    typename arff_parser<Options, T>::parsing_type arff_parser<Options, T>::convert_value(std::string_view str) {
+        // std::from_chars doesn't accept a leading '+'
+        if (!str.empty() && str.front() == '+') {
+            str.remove_prefix(1);
+        }
+        parsing_type value{};
+        const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        if (ec != std::errc{} || ptr != str.data() + str.size()) {
+            throw std::invalid_argument(fmt::format("Can't convert '{}' to a value of type {}!", str, sycl_lsh::detail::arithmetic_type_name<parsing_type>()));
+        }
+        return value;
+    }
+
+    template <typename Options, typename T>
+    [[nodiscard]]
+    std::string_view arff_parser<Options, T>::trim(std::string_view str) {
+        const std::size_t first = str.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return std::string_view{};
+        }
+        return str.substr(first, str.find_last_not_of(" \t\r") - first + 1);
     }
 
 }
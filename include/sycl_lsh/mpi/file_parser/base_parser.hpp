@@ -15,7 +15,6 @@
 #include <sycl_lsh/mpi/file.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
 
-#include <cmath>
 #include <string_view>
 #include <type_traits>
 #include <vector>
@@ -34,6 +33,8 @@ namespace sycl_lsh::mpi {
     public:
         /// The index type as specified in the provided @ref sycl_lsh::options template type.
         using index_type = typename Options::index_type;
+        /// The global ID type as specified in the provided @ref sycl_lsh::options template type.
+        using id_type = typename Options::id_type;
         /// The type of the data which should get parsed.
         using parsing_type = T;
 
@@ -63,7 +64,7 @@ namespace sycl_lsh::mpi {
          * @return the total number of data points (`[[nodiscard]]`)
          */
         [[nodiscard]]
-        virtual index_type parse_total_size() const = 0;
+        virtual id_type parse_total_size() const = 0;
         /**
          * @brief Parse the number of data points **per MPI rank** of the file.
          * @details If the total number of data points isn't dividable by the MPI communicator size,
@@ -71,7 +72,9 @@ namespace sycl_lsh::mpi {
          *          Example: \n
          *          data = xxxxxxxxxx (size = 10), communicator size = 3 \n
          *          rank 1: xxxx, rank 2: xxxx, rank 3: xxdd \n
-         *          -> the rank size is 4 for each MPI rank!
+         *          -> the rank size is 4 for each MPI rank! \n
+         *          The dummy points are neither inserted into the hash tables nor are their k-nearest-neighbors calculated
+         *          (see @ref sycl_lsh::data_attributes::correct_rank_size()).
          * @return the number of data points per MPI rank (`[[nodiscard]]`)
          */
         [[nodiscard]]
@@ -95,7 +98,35 @@ namespace sycl_lsh::mpi {
          * @param[in] dims the number of dimensions of each value
          * @param[in] buffer the data to write to the file
          */
-        virtual void write_content(index_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const = 0;
+        virtual void write_content(id_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const = 0;
+        /**
+         * @brief Starts to write the content in @p buffer to the file.
+         * @details The default implementation simply writes the content using @ref write_content(). File parsers supporting it may
+         *          write the content using non-blocking MPI IO, i.e. the content is only guaranteed to be written after
+         *          @ref finish_write_content() has been called (or the file parser has been destroyed).
+         * @param[in] total_size the total number of values to write (sum of all values from **all** MPI ranks)
+         * @param[in] dims the number of dimensions of each value
+         * @param[in] buffer the data to write to the file (kept alive by the file parser until the write has been finished)
+         */
+        virtual void start_write_content(const id_type total_size, const index_type dims, std::vector<parsing_type> buffer) {
+            this->write_content(total_size, dims, buffer);
+        }
+        /**
+         * @brief Waits until the write started by @ref start_write_content() has been finished.
+         */
+        virtual void finish_write_content() { }
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                MPI IO hints                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Sets the MPI IO hints @p hints (e.g. `cb_nodes=4,cb_buffer_size=16777216`) of the parsed file (collective operation).
+         * @param[in] hints the comma separated `key=value` pairs
+         *
+         * @throws std::invalid_argument if **any** hint isn't a `key=value` pair.
+         */
+        void set_hints(const std::string_view hints) { file_.set_hints(hints); }
 
     protected:
         const communicator& comm_;
@@ -119,9 +150,9 @@ namespace sycl_lsh::mpi {
     template <typename Options, typename T>
     [[nodiscard]]
     typename file_parser<Options, T>::index_type file_parser<Options, T>::parse_rank_size() const {
-        // read the total size
-        const index_type total_size = this->parse_total_size();
-        return static_cast<index_type>(std::ceil(total_size / static_cast<float>(comm_.size())));
+        // read the total size (integer arithmetic since a float can't represent large total sizes exactly)
+        const id_type total_size = this->parse_total_size();
+        return static_cast<index_type>((total_size + comm_.size() - 1) / comm_.size());
     }
 
 }
@@ -10,18 +10,24 @@
 #define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_BINARY_PARSER_HPP
 
 #include <sycl_lsh/detail/assert.hpp>
+#include <sycl_lsh/detail/binary_format.hpp>
 #include <sycl_lsh/exceptions/not_implemented_exception.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/file_parser/base_parser.hpp>
 #include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
 #include <sycl_lsh/mpi/timer.hpp>
 #include <sycl_lsh/mpi/type_cast.hpp>
 
 #include <fmt/format.h>
 #include <mpi.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <optional>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace sycl_lsh::mpi {
@@ -38,6 +44,11 @@ namespace sycl_lsh::mpi {
      * 0.2 0.3
      * 0.4 0.5
      * 0.6 0.7
+     *
+     * Additionally, the versioned, chunked binary v2 file format (see @ref sycl_lsh::detail::binary_v2_header) is detected by its magic
+     * bytes. Its chunk index allows each MPI rank to read only the chunks containing its data points, which may be stored as raw values,
+     * as half precision values or byte shuffled and LZ4 compressed (needs `SYCL_LSH_ENABLE_LZ4`). Each MPI rank decodes its chunks on
+     * the host. Only the original format can be written.
      * @tparam Options  type of the used @ref sycl_lsh::options class
      * @tparam T the type of the data to parse
      */
@@ -47,12 +58,14 @@ namespace sycl_lsh::mpi {
     public:
         /// The index type as specified in the provided @ref sycl_lsh::options template type.
         using index_type = typename base_type::index_type;
+        /// The global ID type as specified in the provided @ref sycl_lsh::options template type.
+        using id_type = typename base_type::id_type;
         /// The type of the data which should get parsed.
         using parsing_type = typename base_type::parsing_type;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
-        //                                                constructor                                                 //
+        //                                         constructor and destructor                                         //
         // ---------------------------------------------------------------------------------------------------------- //
         /**
          * @brief Construct a new @ref sycl_lsh::mpi::binary_parser object responsible for parsing the custom binary file format.
@@ -62,6 +75,10 @@ namespace sycl_lsh::mpi {
          * @param[in] logger the used @ref sycl_lsh::mpi::logger
          */
         binary_parser(std::string_view file_name, file::mode mode, const communicator& comm, const logger& logger);
+        /**
+         * @brief Waits until a write started by @ref start_write_content() has been finished.
+         */
+        ~binary_parser() override;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -69,11 +86,11 @@ namespace sycl_lsh::mpi {
         // ---------------------------------------------------------------------------------------------------------- //
         /**
          * @brief Parse the **total** number of data points in the file.
-         * @details Reads the total size from the first line of the file. The type must be of @ref options::index_type.
+         * @details Reads the total size from the first line of the file. The type must be of @ref options::id_type.
          * @return the total number of data points (`[[nodiscard]]`)
          */
         [[nodiscard]]
-        index_type parse_total_size() const override;
+        id_type parse_total_size() const override;
         /**
          * @brief Parse the number of dimensions of each data point in the file.
          * @details Reads the number of dimensions from the second line of the file. The type must be of @ref options::index_type. \n
@@ -85,6 +102,8 @@ namespace sycl_lsh::mpi {
         /**
          * @brief Parse the content of the file.
          * @details Fills the last elements of the buffer on the last MPI rank such that all MPI ranks have te same number of data points. \n
+         *          All MPI ranks read their data points using a single collective read (tunable using MPI IO hints, see
+         *          @ref sycl_lsh::mpi::file::set_hints()). \n
          *          Calls *MPI_Abort()* if the file size doesn't match the header information or the values actual read diverge from the
          *          number of values which should theoretically be used
          * @return the parsed data (`[[nodiscard]]`)
@@ -97,24 +116,99 @@ namespace sycl_lsh::mpi {
         std::vector<parsing_type> parse_content() const override;
         /**
          * @brief Write the content in @p buffer to the file.
+         * @details Each MPI rank writes its data points at its explicitly calculated offset using a single collective write.
          * @param[in] total_size the total number of values to write (sum of all values from **all** MPI ranks)
          * @param[in] dims the number of dimensions of each value
          * @param[in] buffer the data to write to the file
          *
          * @note Calls MPI_Abort() if the file has been opened in read mode.
          */
-        void write_content(index_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const override;
+        void write_content(id_type total_size, index_type dims, const std::vector<parsing_type>& buffer) const override;
+        /**
+         * @brief Starts to write the content in @p buffer to the file using a single non-blocking collective write (`MPI_File_iwrite_at_all`).
+         * @details The content is only guaranteed to be written after @ref finish_write_content() has been called.
+         * @param[in] total_size the total number of values to write (sum of all values from **all** MPI ranks)
+         * @param[in] dims the number of dimensions of each value
+         * @param[in] buffer the data to write to the file (kept alive until the write has been finished)
+         *
+         * @note Calls MPI_Abort() if the file has been opened in read mode.
+         */
+        void start_write_content(id_type total_size, index_type dims, std::vector<parsing_type> buffer) override;
+        /**
+         * @brief Waits until the write started by @ref start_write_content() has been finished.
+         */
+        void finish_write_content() override;
+
+    private:
+        /// The size of the header information (the total size and the number of dimensions) in bytes.
+        static constexpr MPI_Offset header_offset = sizeof(id_type) + sizeof(index_type);
+        /// The maximum number of bytes read using a single MPI IO call (the count is an `int`).
+        static constexpr std::uint64_t max_read_size = 1 << 30;
+
+        /**
+         * @brief Parse the content of a binary v2 file.
+         * @return the parsed data (`[[nodiscard]]`)
+         *
+         * @note Calls MPI_Abort() if the value type or codec isn't supported.
+         * @note Calls MPI_Abort() if **any** chunk is broken.
+         */
+        [[nodiscard]]
+        std::vector<parsing_type> parse_content_v2() const;
+        /**
+         * @brief Writes the header information (on the master rank only) and calculates the byte offset and the number of data points
+         *        the current MPI rank has to write.
+         * @param[in] total_size the total number of values to write (sum of all values from **all** MPI ranks)
+         * @param[in] dims the number of dimensions of each value
+         * @param[in] buffer_size the number of values in the buffer of the current MPI rank
+         * @return the byte offset and the number of data points of the current MPI rank (`[[nodiscard]]`)
+         *
+         * @note Calls MPI_Abort() if the file has been opened in read mode.
+         */
+        [[nodiscard]]
+        std::pair<MPI_Offset, int> prepare_write_content(id_type total_size, index_type dims, std::size_t buffer_size) const;
+
+        /// The header of the file if it's a binary v2 file.
+        std::optional<sycl_lsh::detail::binary_v2_header> v2_header_;
+        /// The buffer written by the currently pending non-blocking write.
+        std::vector<parsing_type> write_buffer_;
+        /// The request of the currently pending non-blocking write.
+        MPI_Request write_request_ = MPI_REQUEST_NULL;
     };
 
 
     // ---------------------------------------------------------------------------------------------------------- //
-    //                                                constructor                                                 //
+    //                                         constructor and destructor                                         //
     // ---------------------------------------------------------------------------------------------------------- //
     template <typename Options, typename T>
     binary_parser<Options, T>::binary_parser(const std::string_view file_name, const file::mode mode, const communicator& comm, const logger& logger)
         : file_parser<Options, T>(file_name, mode, comm, logger)
     {
         logger.log("Parsing the data file '{}' using the binary_parser together with MPI IO.\n", file_name);
+
+        // check whether the file is a binary v2 file
+        if (mode == file::mode::read) {
+            MPI_Offset file_size;
+            MPI_File_get_size(base_type::file_.get(), &file_size);
+            if (file_size >= static_cast<MPI_Offset>(sizeof(sycl_lsh::detail::binary_v2_header))) {
+                sycl_lsh::detail::binary_v2_header header;
+                MPI_File_read_at_all(base_type::file_.get(), 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+                if (std::string_view(header.magic, sizeof(header.magic)) == sycl_lsh::detail::binary_v2_magic) {
+                    if (header.version != 2) {
+                        if (comm.rank() == 0) {
+                            fmt::print(stderr, "\nUnsupported binary file format version {}!\n\n", header.version);
+                        }
+                        MPI_Abort(comm.get(), EXIT_FAILURE);
+                    }
+                    v2_header_ = header;
+                    logger.log("Detected the binary v2 file format (codec: {}, chunk size: {}).\n", header.codec, header.chunk_size);
+                }
+            }
+        }
+    }
+
+    template <typename Options, typename T>
+    binary_parser<Options, T>::~binary_parser() {
+        this->finish_write_content();
     }
 
 
@@ -123,18 +217,24 @@ namespace sycl_lsh::mpi {
     // ---------------------------------------------------------------------------------------------------------- //
     template <typename Options, typename T>
     [[nodiscard]]
-    typename binary_parser<Options, T>::index_type binary_parser<Options, T>::parse_total_size() const {
+    typename binary_parser<Options, T>::id_type binary_parser<Options, T>::parse_total_size() const {
+        if (v2_header_.has_value()) {
+            return static_cast<id_type>(v2_header_->total_size);
+        }
         // read first line containing the total_size
-        index_type total_size;
-        MPI_File_read_at(base_type::file_.get(), 0, &total_size, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
+        id_type total_size;
+        MPI_File_read_at(base_type::file_.get(), 0, &total_size, 1, type_cast<id_type>(), MPI_STATUS_IGNORE);
         return total_size;
     }
 
     template <typename Options, typename T>
     [[nodiscard]]
     typename binary_parser<Options, T>::index_type binary_parser<Options, T>::parse_dims() const {
+        if (v2_header_.has_value()) {
+            return static_cast<index_type>(v2_header_->dims);
+        }
         index_type dims;
-        MPI_File_read_at(base_type::file_.get(), sizeof(index_type), &dims, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
+        MPI_File_read_at(base_type::file_.get(), sizeof(id_type), &dims, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
         return dims;
     }
 
@@ -150,13 +250,19 @@ namespace sycl_lsh::mpi {
             MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
         }
 
-        const index_type total_size = this->parse_total_size();
+        if (v2_header_.has_value()) {
+            std::vector<parsing_type> buffer = this->parse_content_v2();
+            base_type::logger_.log("Parsed the data file in {}.\n", t.elapsed());
+            return buffer;
+        }
+
+        const id_type total_size = this->parse_total_size();
         const index_type rank_size = this->parse_rank_size();
         const index_type dims = this->parse_dims();
         const int comm_size = base_type::comm_.size();
         const int comm_rank = base_type::comm_.rank();
 
-        std::vector<parsing_type> buffer(rank_size * dims);
+        std::vector<parsing_type> buffer(static_cast<std::size_t>(rank_size) * dims);
 
         // perform minimal sanity checks
         SYCL_LSH_DEBUG_ASSERT(0 < total_size, "Illegal total size!");
@@ -166,39 +272,43 @@ namespace sycl_lsh::mpi {
         // check for correct type
         MPI_Offset file_size;
         MPI_File_get_size(base_type::file_.get(), &file_size);  // get file size
-        file_size -= 2 * sizeof(index_type);                    // subtract header information (size and dims)
-        if (static_cast<index_type>(file_size) != total_size * dims * sizeof(parsing_type)) {
+        file_size -= header_offset;                             // subtract header information (size and dims)
+        const MPI_Offset expected_file_size = static_cast<MPI_Offset>(total_size) * dims * static_cast<MPI_Offset>(sizeof(parsing_type));
+        if (file_size != expected_file_size) {
             if (comm_rank == 0) {
                 fmt::print(stderr, "\nBroken file! File size ({}) doesn't match header information ({} * {} * sizeof(parsing_type) = {})\n\n",
-                        file_size, total_size, dims, total_size * dims * sizeof(parsing_type));
+                        file_size, total_size, dims, expected_file_size);
             }
             MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
         }
 
         // calculate byte offsets per MPI rank
-        constexpr index_type header_offset = 2 * sizeof(index_type);    // header information (size and dims)
-        const index_type rank_offset = header_offset + comm_rank * rank_size * dims * sizeof(parsing_type);
-        const index_type correct_rank_size = comm_rank  == comm_size - 1 ? (total_size - ((comm_size - 1) * rank_size)) : rank_size;
+        const MPI_Offset rank_offset = header_offset + static_cast<MPI_Offset>(comm_rank) * rank_size * dims * sizeof(parsing_type);
+        const index_type correct_rank_size = comm_rank  == comm_size - 1 ? (total_size - static_cast<id_type>(comm_size - 1) * rank_size) : rank_size;
 
         // check if the provided buffer is big enough
-        if (correct_rank_size * dims > buffer.size()) {
+        if (static_cast<std::size_t>(correct_rank_size) * dims > buffer.size()) {
             if (comm_rank == 0) {
                 fmt::print(stderr, "\nTrying to write {} values, but the size of the buffer is only {}!\n\n",
-                        correct_rank_size * dims, buffer.size());
+                        static_cast<std::size_t>(correct_rank_size) * dims, buffer.size());
             }
             MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
         }
 
-        // read data
+        // read data using a collective read (a data point is a single element such that the count doesn't overflow for large partitions)
+        MPI_Datatype point_type;
+        MPI_Type_contiguous(dims, type_cast<parsing_type>(), &point_type);
+        MPI_Type_commit(&point_type);
         MPI_Status status;
-        MPI_File_read_at(base_type::file_.get(), rank_offset, buffer.data(), correct_rank_size * dims, type_cast<parsing_type>(), &status);
+        MPI_File_read_at_all(base_type::file_.get(), rank_offset, buffer.data(), correct_rank_size, point_type, &status);
 
         // check whether the correct number of values were read
         int read_count;
-        MPI_Get_count(&status, type_cast<parsing_type>(), &read_count);
-        if (static_cast<index_type>(read_count) != correct_rank_size * dims) {
-            fmt::print(stderr, "\nRead the wrong number of values on rank {}!. Expected {} values but read {} values.\n\n",
-                    base_type::comm_.rank(), correct_rank_size * dims, read_count);
+        MPI_Get_count(&status, point_type, &read_count);
+        MPI_Type_free(&point_type);
+        if (static_cast<index_type>(read_count) != correct_rank_size) {
+            fmt::print(stderr, "\nRead the wrong number of data points on rank {}!. Expected {} data points but read {} data points.\n\n",
+                    base_type::comm_.rank(), correct_rank_size, read_count);
             MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
         }
 
@@ -206,7 +316,7 @@ namespace sycl_lsh::mpi {
         if (comm_rank == comm_size - 1) {
             for (index_type point = correct_rank_size; point < rank_size; ++point) {
                 for (index_type dim = 0; dim < dims; ++dim) {
-                    buffer[point * dims + dim] = buffer[(correct_rank_size - 1) * dims + dim];
+                    buffer[static_cast<std::size_t>(point) * dims + dim] = buffer[static_cast<std::size_t>(correct_rank_size - 1) * dims + dim];
                 }
             }
         }
@@ -217,9 +327,146 @@ namespace sycl_lsh::mpi {
     }
 
     template <typename Options, typename T>
-    void binary_parser<Options, T>::write_content(const index_type total_size, const index_type dims, const std::vector<parsing_type>& buffer) const {
+    std::vector<typename binary_parser<Options, T>::parsing_type> binary_parser<Options, T>::parse_content_v2() const {
+        namespace detail = sycl_lsh::detail;
+
+        const detail::binary_v2_header& header = *v2_header_;
+        const id_type total_size = this->parse_total_size();
+        const index_type rank_size = this->parse_rank_size();
+        const index_type dims = this->parse_dims();
+        const int comm_size = base_type::comm_.size();
+        const int comm_rank = base_type::comm_.rank();
+        const auto codec = static_cast<detail::binary_codec>(header.codec);
+
+        // check for a supported value type and codec
+        if (header.value_type != static_cast<std::uint32_t>(detail::binary_value_type_of<parsing_type>())) {
+            if (comm_rank == 0) {
+                fmt::print(stderr, "\nThe value type of the file ({}) doesn't match the parsed type ({})!\n\n",
+                        header.value_type, static_cast<std::uint32_t>(detail::binary_value_type_of<parsing_type>()));
+            }
+            MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+        }
+#if !defined(SYCL_LSH_ENABLE_LZ4)
+        if (codec == detail::binary_codec::shuffle_lz4) {
+            if (comm_rank == 0) {
+                fmt::print(stderr, "\nCan't read LZ4 compressed chunks! Maybe enable SYCL_LSH_ENABLE_LZ4?\n\n");
+            }
+            MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+        }
+#endif
+        if (header.chunk_size == 0) {
+            if (comm_rank == 0) {
+                fmt::print(stderr, "\nBroken file! Illegal chunk size 0!\n\n");
+            }
+            MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+        }
+
+        std::vector<parsing_type> buffer(static_cast<std::size_t>(rank_size) * dims);
+        const std::uint64_t first_point = static_cast<std::uint64_t>(comm_rank) * rank_size;
+        const index_type correct_rank_size = comm_rank  == comm_size - 1 ? (total_size - static_cast<id_type>(comm_size - 1) * rank_size) : rank_size;
+
+        // read the chunk index entries of the chunks containing the data points of the current MPI rank
+        const std::uint64_t first_chunk = first_point / header.chunk_size;
+        const std::uint64_t last_chunk = (first_point + correct_rank_size - 1) / header.chunk_size;
+        std::vector<std::uint64_t> offsets(last_chunk - first_chunk + 2);
+        MPI_File_read_at(base_type::file_.get(), sizeof(header) + first_chunk * sizeof(std::uint64_t),
+                         offsets.data(), offsets.size(), type_cast<std::uint64_t>(), MPI_STATUS_IGNORE);
+
+        // read all chunks at once using collective reads (each MPI rank must participate in the same number of calls)
+        std::vector<char> chunks(offsets.back() - offsets.front());
+        const int num_reads = mpi::max<int>((chunks.size() + max_read_size - 1) / max_read_size, base_type::comm_);
+        for (int read = 0; read < num_reads; ++read) {
+            const std::uint64_t pos = std::min<std::uint64_t>(read * max_read_size, chunks.size());
+            const int count = std::min<std::uint64_t>(max_read_size, chunks.size() - pos);
+            MPI_Status status;
+            MPI_File_read_at_all(base_type::file_.get(), offsets.front() + pos, chunks.data() + pos, count, MPI_BYTE, &status);
+
+            int read_count;
+            MPI_Get_count(&status, MPI_BYTE, &read_count);
+            if (read_count != count) {
+                fmt::print(stderr, "\nRead the wrong number of bytes on rank {}!. Expected {} bytes but read {} bytes.\n\n", comm_rank, count, read_count);
+                MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+            }
+        }
+
+        // decode the chunks and copy the data points of the current MPI rank
+        std::vector<parsing_type> chunk_values(header.chunk_size * dims);
+        std::vector<unsigned char> scratch;
+        for (std::uint64_t chunk = first_chunk; chunk <= last_chunk; ++chunk) {
+            const std::uint64_t chunk_first_point = chunk * header.chunk_size;
+            const std::uint64_t chunk_points = std::min<std::uint64_t>(header.chunk_size, total_size - chunk_first_point);
+            const std::uint64_t chunk_begin = offsets[chunk - first_chunk] - offsets.front();
+            const std::uint64_t chunk_end = offsets[chunk - first_chunk + 1] - offsets.front();
+            if (chunk_end < chunk_begin || chunk_end > chunks.size()
+                || !detail::decode_binary_chunk(codec, chunks.data() + chunk_begin, chunk_end - chunk_begin, chunk_points * dims, chunk_values.data(), scratch))
+            {
+                fmt::print(stderr, "\nBroken chunk {} on rank {}!\n\n", chunk, comm_rank);
+                MPI_Abort(base_type::comm_.get(), EXIT_FAILURE);
+            }
+
+            const std::uint64_t lo = std::max(chunk_first_point, first_point);
+            const std::uint64_t hi = std::min(chunk_first_point + chunk_points, first_point + correct_rank_size);
+            std::copy(chunk_values.begin() + (lo - chunk_first_point) * dims, chunk_values.begin() + (hi - chunk_first_point) * dims,
+                      buffer.begin() + (lo - first_point) * dims);
+        }
+
+        // fill missing data points ON THE LAST MPI RANK with dummy points
+        if (comm_rank == comm_size - 1) {
+            for (index_type point = correct_rank_size; point < rank_size; ++point) {
+                for (index_type dim = 0; dim < dims; ++dim) {
+                    buffer[static_cast<std::size_t>(point) * dims + dim] = buffer[static_cast<std::size_t>(correct_rank_size - 1) * dims + dim];
+                }
+            }
+        }
+
+        return buffer;
+    }
+
+    template <typename Options, typename T>
+    void binary_parser<Options, T>::write_content(const id_type total_size, const index_type dims, const std::vector<parsing_type>& buffer) const {
         mpi::timer t(base_type::comm_);
 
+        const auto [rank_offset, correct_rank_size] = this->prepare_write_content(total_size, dims, buffer.size());
+
+        // write actual content using a collective write (a data point is a single element such that the count doesn't overflow)
+        MPI_Datatype point_type;
+        MPI_Type_contiguous(dims, type_cast<parsing_type>(), &point_type);
+        MPI_Type_commit(&point_type);
+        MPI_File_write_at_all(base_type::file_.get(), rank_offset, buffer.data(), correct_rank_size, point_type, MPI_STATUS_IGNORE);
+        MPI_Type_free(&point_type);
+
+        base_type::logger_.log("Wrote content to file in {}.\n", t.elapsed());
+    }
+
+    template <typename Options, typename T>
+    void binary_parser<Options, T>::start_write_content(const id_type total_size, const index_type dims, std::vector<parsing_type> buffer) {
+        // only one write may be pending at any time
+        this->finish_write_content();
+
+        const auto [rank_offset, correct_rank_size] = this->prepare_write_content(total_size, dims, buffer.size());
+
+        // start writing the actual content using a non-blocking collective write
+        write_buffer_ = std::move(buffer);
+        MPI_Datatype point_type;
+        MPI_Type_contiguous(dims, type_cast<parsing_type>(), &point_type);
+        MPI_Type_commit(&point_type);
+        MPI_File_iwrite_at_all(base_type::file_.get(), rank_offset, write_buffer_.data(), correct_rank_size, point_type, &write_request_);
+        // the data type is only deallocated after the pending write has been finished
+        MPI_Type_free(&point_type);
+    }
+
+    template <typename Options, typename T>
+    void binary_parser<Options, T>::finish_write_content() {
+        if (write_request_ != MPI_REQUEST_NULL) {
+            MPI_Wait(&write_request_, MPI_STATUS_IGNORE);
+            write_buffer_.clear();
+            write_buffer_.shrink_to_fit();
+        }
+    }
+
+    template <typename Options, typename T>
+    [[nodiscard]]
+    std::pair<MPI_Offset, int> binary_parser<Options, T>::prepare_write_content(const id_type total_size, const index_type dims, const std::size_t buffer_size) const {
         // throw if file has been opened in the wrong mode
         if (base_type::mode_ == mpi::file::mode::read) {
             if (base_type::comm_.rank() == 0) {
@@ -230,20 +477,18 @@ namespace sycl_lsh::mpi {
 
         // write header information
         if (base_type::comm_.master_rank()) {
-            MPI_File_write(base_type::file_.get(), &total_size, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
-            MPI_File_write(base_type::file_.get(), &dims, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
+            MPI_File_write_at(base_type::file_.get(), 0, &total_size, 1, type_cast<id_type>(), MPI_STATUS_IGNORE);
+            MPI_File_write_at(base_type::file_.get(), sizeof(id_type), &dims, 1, type_cast<index_type>(), MPI_STATUS_IGNORE);
         }
-        base_type::comm_.wait();
-        MPI_File_seek_shared(base_type::file_.get(), 0, MPI_SEEK_END);
 
-        // write actual content
-        index_type correct_rank_size = buffer.size() / dims;
-        if (base_type::comm_.rank() == base_type::comm_.size() - 1) {
-            correct_rank_size = total_size - ((base_type::comm_.size() - 1) * correct_rank_size);
-        }
-        MPI_File_write_ordered(base_type::file_.get(), buffer.data(), correct_rank_size * dims, type_cast<parsing_type>(), MPI_STATUS_IGNORE);
+        // calculate the byte offset of the current MPI rank explicitly instead of serializing the MPI ranks using the shared file pointer
+        const int comm_size = base_type::comm_.size();
+        const int comm_rank = base_type::comm_.rank();
+        const index_type rank_size = buffer_size / dims;
+        const MPI_Offset rank_offset = header_offset + static_cast<MPI_Offset>(comm_rank) * rank_size * dims * sizeof(parsing_type);
+        const index_type correct_rank_size = comm_rank == comm_size - 1 ? (total_size - static_cast<id_type>(comm_size - 1) * rank_size) : rank_size;
 
-        base_type::logger_.log("Wrote content to file in {}.\n", t.elapsed());
+        return std::make_pair(rank_offset, static_cast<int>(correct_rank_size));
     }
 
 }
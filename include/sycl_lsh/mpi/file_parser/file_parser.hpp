@@ -45,25 +45,29 @@ namespace sycl_lsh::mpi {
     inline std::unique_ptr<file_parser<Options, parsing_type>> make_file_parser(const std::string_view file_name, const argv_parser& parser,
                                                                                 const file::mode mode, const communicator& comm, const logger& logger)
     {
-        std::string file_parser_name;
+        std::unique_ptr<file_parser<Options, parsing_type>> file_parser_ptr;
         // try getting the file parser name, if not provided fall back to the 'binary_parser'
-        try {
-            file_parser_name = parser.argv_as<std::string>("file_parser");
-        } catch (const std::invalid_argument&) {
+        if (!parser.has_argv("file_parser")) {
             logger.log("\nNo file parser type specified! Using the 'binary_parser' as fall back.\n");
-            return std::make_unique<binary_parser<Options, parsing_type>>(file_name, mode, comm, logger);
-        }
-
-        if (file_parser_name == "arff_parser") {
-            // using the arff file parser
-            return std::make_unique<arff_parser<Options, parsing_type>>(file_name, mode, comm, logger);
-        } else if (file_parser_name == "binary_parser") {
-            // using the binary file parser
-            return std::make_unique<binary_parser<Options, parsing_type>>(file_name, mode, comm, logger);
+            file_parser_ptr = std::make_unique<binary_parser<Options, parsing_type>>(file_name, mode, comm, logger);
         } else {
-            throw std::invalid_argument(fmt::format("Unrecognized file parser type '{}'!", file_parser_name));
+            const std::string file_parser_name = parser.argv_as<std::string>("file_parser");
+            if (file_parser_name == "arff_parser") {
+                // using the arff file parser
+                file_parser_ptr = std::make_unique<arff_parser<Options, parsing_type>>(file_name, mode, comm, logger);
+            } else if (file_parser_name == "binary_parser") {
+                // using the binary file parser
+                file_parser_ptr = std::make_unique<binary_parser<Options, parsing_type>>(file_name, mode, comm, logger);
+            } else {
+                throw std::invalid_argument(fmt::format("Unrecognized file parser type '{}'!", file_parser_name));
+            }
         }
 
+        // optionally tune the MPI IO of the file
+        if (parser.has_argv("mpi_io_hints")) {
+            file_parser_ptr->set_hints(parser.argv_as<std::string>("mpi_io_hints"));
+        }
+        return file_parser_ptr;
     }
 
 }
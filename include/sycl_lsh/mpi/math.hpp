@@ -14,6 +14,8 @@
 
 #include <mpi.h>
 
+#include <vector>
+
 namespace sycl_lsh::mpi {
 
     /**
@@ -32,6 +34,21 @@ namespace sycl_lsh::mpi {
         return sums;
     }
 
+    /**
+     * @brief Sums the given @p values element-wise over all MPI ranks.
+     * @details Returns the result on **all** MPI ranks. All MPI ranks must pass the same number of @p values.
+     * @tparam T the type of the @p values to sum
+     * @param[in] values the values to sum
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @return the resulting element-wise sums
+     */
+    template <typename T>
+    [[nodiscard]]
+    inline std::vector<T> sum(std::vector<T> values, const communicator& comm) {
+        MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), type_cast<T>(), MPI_SUM, comm.get());
+        return values;
+    }
+
     /**
      * @brief Averages the given @p value over all MPI ranks.
      * @details Returns the result on **all** MPI ranks.
@@ -47,6 +64,38 @@ namespace sycl_lsh::mpi {
         return sums / comm.size();
     }
 
+    /**
+     * @brief Calculates the minimum of the given @p value over all MPI ranks.
+     * @details Returns the result on **all** MPI ranks.
+     * @tparam T the type of the @p value
+     * @param[in] value the value
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @return the resulting minimum
+     */
+    template <typename T>
+    [[nodiscard]]
+    inline T min(T value, const communicator& comm) {
+        T minimum;
+        MPI_Allreduce(&value, &minimum, 1, type_cast<T>(), MPI_MIN, comm.get());
+        return minimum;
+    }
+
+    /**
+     * @brief Calculates the maximum of the given @p value over all MPI ranks.
+     * @details Returns the result on **all** MPI ranks.
+     * @tparam T the type of the @p value
+     * @param[in] value the value
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @return the resulting maximum
+     */
+    template <typename T>
+    [[nodiscard]]
+    inline T max(T value, const communicator& comm) {
+        T maximum;
+        MPI_Allreduce(&value, &maximum, 1, type_cast<T>(), MPI_MAX, comm.get());
+        return maximum;
+    }
+
 }
 
 #endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_MATH_HPP
@@ -9,6 +9,7 @@
 #ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SORT_HPP
 #define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_SORT_HPP
 
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 #include <sycl_lsh/mpi/type_cast.hpp>
 
@@ -32,6 +33,7 @@ namespace sycl_lsh::mpi {
         std::vector<real_type> all(2 * data.size());
         constexpr int merge_tag = 1;
         constexpr int sorted_tag = 2;
+        const auto exchange_start = communication_profiler::clock::now();
 
         if (comm.rank() == sendrank) {
             MPI_Send(data.data(), data.size(), type_cast<real_type>(), recvrank, merge_tag, comm.get());
@@ -47,6 +49,8 @@ namespace sycl_lsh::mpi {
             MPI_Send(all.data() + theirstart, data.size(), type_cast<real_type>(), sendrank, sorted_tag, comm.get());
             std::copy(all.begin() + mystart, all.begin() + mystart + data.size(), data.begin());
         }
+        // the blocking exchange sends and receives the data once (the time includes the local merge of the receiving MPI rank)
+        communication_profiler::record_blocking(communication_kind::sort, data.size() * sizeof(real_type), data.size() * sizeof(real_type), exchange_start);
     }
 
     // https://stackoverflow.com/questions/23633916/how-does-mpi-odd-even-sort-work
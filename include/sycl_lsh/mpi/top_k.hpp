@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2021-01-03
+ *
+ * @brief Implements a distributed merge of partial k-nearest-neighbor lists using `MPI_Reduce_scatter_block` with a custom top-k reduction.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
+
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace sycl_lsh::mpi {
+
+    /**
+     * @brief One nearest-neighbor candidate of a partial k-nearest-neighbor list.
+     * @tparam real_type the used floating point type
+     * @tparam index_type the used integral type
+     */
+    template <typename real_type, typename index_type>
+    struct top_k_candidate {
+        /// The distance of the candidate.
+        real_type dist;
+        /// The ID of the candidate.
+        index_type id;
+
+        /**
+         * @brief Orders the candidates by their distance (ties are broken using the smaller ID).
+         * @param[in] other the other candidate
+         * @return `true` if `*this` is nearer than @p other (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        bool operator<(const top_k_candidate& other) const noexcept {
+            return std::tie(dist, id) < std::tie(other.dist, other.id);
+        }
+    };
+
+    namespace detail {
+
+        /**
+         * @brief The user-defined MPI reduction merging two arrays of sorted k-nearest-neighbor lists keeping the k best candidates per list.
+         * @details The number of candidates per list is derived from the size of @p type (a contiguous type of one list).
+         * @tparam Candidate the type of a @ref sycl_lsh::mpi::top_k_candidate
+         * @param[in] in the first lists
+         * @param[in,out] inout the second lists (overwritten with the merged lists)
+         * @param[in] len the number of lists
+         * @param[in] type the MPI type of one list
+         */
+        template <typename Candidate>
+        void merge_top_k_lists(void* in, void* inout, int* len, MPI_Datatype* type) {
+            int type_size = 0;
+            MPI_Type_size(*type, &type_size);
+            const std::size_t k = type_size / sizeof(Candidate);
+
+            const Candidate* in_lists = static_cast<const Candidate*>(in);
+            Candidate* inout_lists = static_cast<Candidate*>(inout);
+            std::vector<Candidate> merged(k);
+            for (int list = 0; list < *len; ++list) {
+                const Candidate* first = in_lists + list * k;
+                Candidate* second = inout_lists + list * k;
+                // merge only the k best candidates of both sorted lists
+                std::size_t i = 0, j = 0;
+                for (std::size_t nn = 0; nn < k; ++nn) {
+                    merged[nn] = second[j] < first[i] ? second[j++] : first[i++];
+                }
+                std::copy(merged.begin(), merged.end(), second);
+            }
+        }
+
+    }
+
+    /**
+     * @brief Merges the partial k-nearest-neighbor lists of all MPI ranks at the MPI ranks owning the respective queries (collective
+     *        operation).
+     * @details @p partial_knns contains the lists of the queries of all MPI ranks grouped by their owning MPI rank, i.e. the lists
+     *          `[rank * count, (rank + 1) * count)` belong to MPI rank `rank`. Each list **must** be sorted in ascending order. \n
+     *          The lists are merged using `MPI_Reduce_scatter_block` with a custom commutative top-k reduction, i.e. only k candidates per
+     *          query are ever sent between two MPI ranks.
+     * @tparam Candidate the type of a @ref sycl_lsh::mpi::top_k_candidate
+     * @param[in] partial_knns the sorted partial k-nearest-neighbor lists of all queries
+     * @param[in] k the number of candidates per list
+     * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+     * @return the merged (sorted) k-nearest-neighbor lists of the queries owned by the current MPI rank (`[[nodiscard]]`)
+     */
+    template <typename Candidate>
+    [[nodiscard]]
+    inline std::vector<Candidate> reduce_scatter_top_k(const std::vector<Candidate>& partial_knns, const std::size_t k, const communicator& comm) {
+        // the number of lists per MPI rank
+        const std::size_t count = partial_knns.size() / (comm.size() * k);
+
+        MPI_Datatype list_type;
+        MPI_Type_contiguous(k * sizeof(Candidate), MPI_BYTE, &list_type);
+        MPI_Type_commit(&list_type);
+        MPI_Op top_k_op;
+        MPI_Op_create(&detail::merge_top_k_lists<Candidate>, 1, &top_k_op);
+
+        std::vector<Candidate> merged_knns(count * k);
+        const auto merge_start = communication_profiler::clock::now();
+        MPI_Reduce_scatter_block(partial_knns.data(), merged_knns.data(), count, list_type, top_k_op, comm.get());
+        // each MPI rank contributes the lists of all foreign queries and receives the contributions for its own queries
+        const std::size_t bytes = (comm.size() - 1) * count * k * sizeof(Candidate);
+        communication_profiler::record_blocking(communication_kind::top_k_merge, bytes, bytes, merge_start);
+
+        MPI_Op_free(&top_k_op);
+        MPI_Type_free(&list_type);
+        return merged_knns;
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_TOP_K_HPP
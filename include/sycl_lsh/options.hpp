@@ -23,10 +23,12 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include <cstdint>
 #include <fstream>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 
@@ -56,8 +58,9 @@ namespace sycl_lsh {
      * @tparam hash_value_t an unsigned type (used for hash values)
      * @tparam blocking_size_v the blocking size used in SYCL kernels
      * @tparam used_hash_functions_t the type of the used hash functions in the LSH algorithm
+     * @tparam dims_v the number of dimensions of each data point if known at compile time, `0` if only known at runtime (default)
      */
-    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type used_hash_functions_t>
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type used_hash_functions_t, index_t dims_v = 0>
     struct options final : private detail::options_base {
         // ---------------------------------------------------------------------------------------------------------- //
         //                                      template parameter sanity checks                                      //
@@ -77,11 +80,21 @@ namespace sycl_lsh {
         using index_type = index_t;
         /// The used unsigned type for hash values.
         using hash_value_type = hash_value_t;
+        /// The used integral type for the global IDs of the data points and the total sizes (the index_type is used for all indices local
+        /// to a MPI rank, e.g. inside the hash tables).
+#if defined(SYCL_LSH_64BIT_IDS)
+        using id_type = std::uint64_t;
+#else
+        using id_type = index_t;
+#endif
+        static_assert(sizeof(id_type) >= sizeof(index_type), "The id_type must be at least as wide as the index_type!");
 
         /// The blocking size used in the SYCL kernels.
         static constexpr index_type blocking_size = blocking_size_v;
         /// The used hash functions type in the LSH algorithm.
         static constexpr hash_functions_type used_hash_functions_type = used_hash_functions_t;
+        /// The number of dimensions of each data point if known at compile time (enables specialized SYCL kernels), `0` otherwise.
+        static constexpr index_type dims = dims_v;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -99,6 +112,25 @@ namespace sycl_lsh {
         real_type w = 1.0;
         /// The number of cut-off points for the entropy-based hash functions.
         index_type num_cut_off_points = 6;
+        /// The maximum number of data points per hash bucket on each device (oversized buckets are subsampled during the hash tables creation),
+        /// `0` means unlimited.
+        index_type max_bucket_size = 0;
+        /// The number of additionally probed neighboring hash buckets per hash table during the k-nearest-neighbor search (multi-probe LSH,
+        /// not supported by the entropy-based hash functions), `0` means only the hash bucket of the query itself.
+        index_type num_probes = 0;
+        /// The maximum number of differing signature bits (summed over all hash tables) of a query and a candidate for which the distance
+        /// is calculated (only supported by the simhash hash functions), `0` disables the Hamming distance prefilter.
+        index_type max_hamming_distance = 0;
+        /// The number of consecutive hash tables without any change to the k-nearest-neighbors of a query after which no further hash
+        /// tables are searched for this query (adaptive early termination), `0` means all hash tables are always searched.
+        index_type early_termination_tables = 0;
+        /// The distance of the k-th nearest-neighbor of a query below which no further hash tables are searched for this query (adaptive
+        /// early termination), `0` means all hash tables are always searched.
+        real_type early_termination_distance = 0.0;
+        /// The seed used to generate the hash functions independently but identically on all MPI ranks using a counter-based random number
+        /// generator (reproducible and without broadcasting the hash functions), `0` means randomly created hash functions broadcasted
+        /// by the MPI master rank.
+        std::uint64_t seed = 0;
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -122,6 +154,21 @@ namespace sycl_lsh {
          * @throws std::invalid_argument if any parsed value is illegal.
          */
         options(const argv_parser& parser, const mpi::logger& logger);
+        /**
+         * @brief Construct a @ref sycl_lsh::options class reading all options from the options file @p options_file (instead of the one
+         *        given by the command line argument `options_file`).
+         * @details Afterwards overrides all read options by options directly given to the command line via (`--your_opt your_val`), e.g.
+         *          to evaluate multiple options files one after another (command line argument `options_sweep_files`). \n
+         *          Uses the @ref sycl_lsh::mpi::logger @p logger to log additional information.
+         * @param[in] parser the @ref sycl_lsh::argv_parser
+         * @param[in] options_file the options file to read (no file is read if empty)
+         * @param[in] logger the @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if @p options_file doesn't exist or isn't a regular file.
+         * @throws std::invalid_argument if any command line argument in the file is illegal.
+         * @throws std::invalid_argument if any parsed value is illegal.
+         */
+        options(const argv_parser& parser, std::string_view options_file, const mpi::logger& logger);
 
 
         // ---------------------------------------------------------------------------------------------------------- //
@@ -139,6 +186,16 @@ namespace sycl_lsh {
          * @throws std::runtime_error if the file couldn't be written
          */
         void save(const argv_parser& parser, const mpi::communicator& comm, const mpi::logger& logger) const;
+        /**
+         * @brief Saves the currently set compile time and runtime options only on the MPI master rank to the file @p file_name. \n
+         *        Uses the @ref sycl_lsh::mpi::logger @p logger to log additional information.
+         * @param[in] file_name the file to save the options to
+         * @param[in] comm the @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::runtime_error if the file couldn't be written
+         */
+        void save(std::string_view file_name, const mpi::communicator& comm, const mpi::logger& logger) const;
         /**
          * @brief Saves the currently set runtime options only on the MPI master rank to the benchmark file **iff** benchmarking has been
          *        enabled.
@@ -159,36 +216,52 @@ namespace sycl_lsh {
      * @tparam hash_value_t an unsigned type (used for hash values)
      * @tparam blocking_size_v the blocking size used in SYCL kernels
      * @tparam hash_functions_t the type of the used hash functions in the LSH algorithm
+     * @tparam dims_v the number of dimensions of each data point if known at compile time, `0` otherwise
      * @param[in,out] out the output stream
      * @param[in] opt the @ref sycl_lsh::options
      * @return the output stream
      */
-    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t>
-    std::ostream& operator<<(std::ostream& out, const options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t>& opt) {
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    std::ostream& operator<<(std::ostream& out, const options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>& opt) {
         // get types
-        using options_type = options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t>;
+        using options_type = options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>;
         using real_type = typename options_type::real_type;
         using index_type = typename options_type::index_type;
         using hash_value_type = typename options_type::hash_value_type;
+        using id_type = typename options_type::id_type;
 
         // compile time options
         out << fmt::format("real_type '{}' ({} byte)\n", detail::arithmetic_type_name<real_type>(), sizeof(real_type));
         out << fmt::format("index_type '{}' ({} byte)\n", detail::arithmetic_type_name<index_type>(), sizeof(index_type));
         out << fmt::format("hash_value_type '{}' ({} byte)\n", detail::arithmetic_type_name<hash_value_type>(), sizeof(hash_value_type));
+        out << fmt::format("id_type '{}' ({} byte)\n", detail::arithmetic_type_name<id_type>(), sizeof(id_type));
         out << fmt::format("blocking_size {}\n", options_type::blocking_size);
-        out << fmt::format("hash_functions_type '{}'\n\n", options_type::used_hash_functions_type);
+        out << fmt::format("hash_functions_type '{}'\n", options_type::used_hash_functions_type);
+        out << fmt::format("dims {}\n\n", options_type::dims);
 
         // runtime options
         out << fmt::format("hash_pool_size {}\n", opt.hash_pool_size);
         out << fmt::format("num_hash_functions {}\n", opt.num_hash_functions);
         out << fmt::format("num_hash_tables {}\n", opt.num_hash_tables);
         out << fmt::format("hash_table_size {}\n", opt.hash_table_size);
-        if constexpr (options_type::used_hash_functions_type != hash_functions_type::entropy_based) {
+        if constexpr (options_type::used_hash_functions_type == hash_functions_type::random_projections
+                      || options_type::used_hash_functions_type == hash_functions_type::mixed_hash_functions) {
             out << fmt::format("w {}\n", opt.w);
         }
-        if constexpr (options_type::used_hash_functions_type != hash_functions_type::random_projections) {
+        if constexpr (options_type::used_hash_functions_type == hash_functions_type::entropy_based
+                      || options_type::used_hash_functions_type == hash_functions_type::mixed_hash_functions) {
             out << fmt::format("num_cut_off_points {}\n", opt.num_cut_off_points);
         }
+        out << fmt::format("max_bucket_size {}\n", opt.max_bucket_size);
+        if constexpr (supports_multi_probe(options_type::used_hash_functions_type)) {
+            out << fmt::format("num_probes {}\n", opt.num_probes);
+        }
+        if constexpr (options_type::used_hash_functions_type == hash_functions_type::simhash) {
+            out << fmt::format("max_hamming_distance {}\n", opt.max_hamming_distance);
+        }
+        out << fmt::format("early_termination_tables {}\n", opt.early_termination_tables);
+        out << fmt::format("early_termination_distance {}\n", opt.early_termination_distance);
+        out << fmt::format("seed {}\n", opt.seed);
 
         return out;
     }
@@ -197,11 +270,16 @@ namespace sycl_lsh {
     // ---------------------------------------------------------------------------------------------------------- //
     //                                                constructor                                                 //
     // ---------------------------------------------------------------------------------------------------------- //
-    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t>
-    options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t>::options(const argv_parser& parser, const mpi::logger& logger) {
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>::options(const argv_parser& parser, const mpi::logger& logger)
+            : options(parser, parser.has_argv("options_file") ? parser.argv_as<std::string>("options_file") : std::string{}, logger) { }
+
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>::options(const argv_parser& parser, const std::string_view options_file,
+                                                                                               const mpi::logger& logger) {
         // parse command line options given through the (optionally) specified file
-        if (parser.has_argv("options_file")) {
-            const std::string& file = parser.argv_as<std::string>("options_file");
+        if (!options_file.empty()) {
+            const std::string file(options_file);
             // check if file exists and is a regular file
             if (!fs::exists(file) || !fs::is_regular_file(file)) {
                 throw std::invalid_argument(fmt::format("Illegal options file '{}'!", file));
@@ -233,7 +311,7 @@ namespace sycl_lsh {
                 const std::string opt = line.substr(0, pos);
                 const std::string value = line.substr(pos + 1, line.size());
 
-                if (opt == "real_type" || opt == "index_type" || opt == "hash_value_type" || opt == "blocking_size") {
+                if (opt == "real_type" || opt == "index_type" || opt == "hash_value_type" || opt == "id_type" || opt == "blocking_size" || opt == "dims") {
                     // can't read compile time options from file
                     continue;
                 } else if (opt == "hash_functions_type") {
@@ -255,6 +333,18 @@ namespace sycl_lsh {
                     w = detail::convert_to<decltype(w)>(value);
                 } else if (opt == "num_cut_off_points") {
                     num_cut_off_points = detail::convert_to<decltype(num_cut_off_points)>(value);
+                } else if (opt == "max_bucket_size") {
+                    max_bucket_size = detail::convert_to<decltype(max_bucket_size)>(value);
+                } else if (opt == "num_probes") {
+                    num_probes = detail::convert_to<decltype(num_probes)>(value);
+                } else if (opt == "max_hamming_distance") {
+                    max_hamming_distance = detail::convert_to<decltype(max_hamming_distance)>(value);
+                } else if (opt == "early_termination_tables") {
+                    early_termination_tables = detail::convert_to<decltype(early_termination_tables)>(value);
+                } else if (opt == "early_termination_distance") {
+                    early_termination_distance = detail::convert_to<decltype(early_termination_distance)>(value);
+                } else if (opt == "seed") {
+                    seed = detail::convert_to<decltype(seed)>(value);
                 } else {
                     // option not recognized
                     throw std::invalid_argument(fmt::format("Invalid option in line {} '{} {}' in file '{}'!", lineno, opt, value, file));
@@ -263,31 +353,43 @@ namespace sycl_lsh {
         }
 
         // parse command line options given directly through the command line arguments and perform sanity checks
-        SYCL_LSH_PARSE_OPTION(parser, hash_pool_size,     hash_pool_size > 0);
-        SYCL_LSH_PARSE_OPTION(parser, num_hash_functions, num_hash_functions > 0);
-        SYCL_LSH_PARSE_OPTION(parser, num_hash_tables,    num_hash_tables > 0);
-        SYCL_LSH_PARSE_OPTION(parser, hash_table_size,    hash_table_size > 0);
-        SYCL_LSH_PARSE_OPTION(parser, w,                  w > 0);
-        SYCL_LSH_PARSE_OPTION(parser, num_cut_off_points, num_cut_off_points > 0);
+        SYCL_LSH_PARSE_OPTION(parser, hash_pool_size,             hash_pool_size > 0);
+        SYCL_LSH_PARSE_OPTION(parser, num_hash_functions,         num_hash_functions > 0);
+        SYCL_LSH_PARSE_OPTION(parser, num_hash_tables,            num_hash_tables > 0);
+        SYCL_LSH_PARSE_OPTION(parser, hash_table_size,            hash_table_size > 0);
+        SYCL_LSH_PARSE_OPTION(parser, w,                          w > 0);
+        SYCL_LSH_PARSE_OPTION(parser, num_cut_off_points,         num_cut_off_points > 0);
+        SYCL_LSH_PARSE_OPTION(parser, max_bucket_size,            true);
+        SYCL_LSH_PARSE_OPTION(parser, num_probes,                 num_probes <= 2 * num_hash_functions);
+        SYCL_LSH_PARSE_OPTION(parser, max_hamming_distance,       max_hamming_distance <= num_hash_functions * num_hash_tables);
+        SYCL_LSH_PARSE_OPTION(parser, early_termination_tables,   early_termination_tables <= num_hash_tables);
+        SYCL_LSH_PARSE_OPTION(parser, early_termination_distance, early_termination_distance >= 0);
+        SYCL_LSH_PARSE_OPTION(parser, seed,                       true);
     }
 
 
     // ---------------------------------------------------------------------------------------------------------- //
     //                                                save options                                                //
     // ---------------------------------------------------------------------------------------------------------- //
-    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t>
-    void options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t>::save(const argv_parser& parser,
-                                                                                         const mpi::communicator& comm,
-                                                                                         const mpi::logger& logger) const
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    void options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>::save(const argv_parser& parser,
+                                                                                                 const mpi::communicator& comm,
+                                                                                                 const mpi::logger& logger) const
     {
-        const std::string& file_name = parser.argv_as<std::string>("options_save_file");
+        // check if the required command line argument is present
+        if (!parser.has_argv("options_save_file")) {
+            throw std::invalid_argument("Required command line argument 'options_save_file' not provided!");
+        }
+        this->save(parser.argv_as<std::string>("options_save_file"), comm, logger);
+    }
 
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    void options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>::save(const std::string_view file_name,
+                                                                                                 const mpi::communicator& comm,
+                                                                                                 const mpi::logger& logger) const
+    {
         if (comm.master_rank()) {
-            if (!parser.has_argv("options_save_file")) {
-                throw std::invalid_argument("Required command line argument 'options_save_file' not provided!");
-            }
-
-            std::ofstream out(file_name, std::ofstream::trunc);
+            std::ofstream out(std::string(file_name), std::ofstream::trunc);
             if (out.bad()) {
                 // something went wrong while opening/creating the file
                 throw std::runtime_error(fmt::format("Can't write to file '{}'!", file_name));
@@ -298,12 +400,13 @@ namespace sycl_lsh {
         logger.log("Saved options to: '{}'\n\n", file_name);
     }
 
-    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t>
-    void options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t>::save_benchmark_options([[maybe_unused]] const mpi::communicator& comm) const {
+    template <typename real_t, typename index_t, typename hash_value_t, index_t blocking_size_v, hash_functions_type hash_functions_t, index_t dims_v>
+    void options<real_t, index_t, hash_value_t, blocking_size_v, hash_functions_t, dims_v>::save_benchmark_options([[maybe_unused]] const mpi::communicator& comm) const {
         #if defined(SYCL_LSH_BENCHMARK)
             if (comm.master_rank()) {
                 mpi::timer::benchmark_out() << hash_pool_size << ',' << num_hash_functions << ',' << num_hash_tables << ','
-                                            << hash_table_size << ',' << w << ',' << num_cut_off_points << '\n';
+                                            << hash_table_size << ',' << w << ',' << num_cut_off_points << ',' << max_bucket_size << ',' << num_probes << ',' << seed << ','
+                                            << max_hamming_distance << ',' << early_termination_tables << ',' << early_termination_distance << '\n';
             }
         #endif
     }
@@ -0,0 +1,429 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-10-28
+ *
+ * @brief Implements the @ref sycl_lsh::query_server class answering k-nearest-neighbor queries using already created hash tables.
+ */
+
+#ifndef DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_QUERY_SERVER_HPP
+#define DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_QUERY_SERVER_HPP
+
+#include <sycl_lsh/argv_parser.hpp>
+#include <sycl_lsh/data.hpp>
+#include <sycl_lsh/detail/socket.hpp>
+#include <sycl_lsh/knn.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <fmt/format.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sycl_lsh {
+
+    /**
+     * @brief Resident server answering k-nearest-neighbor queries sent over TCP using the already created hash tables.
+     * @details The hash tables (and all device buffers) are created only once and kept alive for all queries. MPI rank 0 accepts the
+     *          connections and collects the requests, all MPI ranks together search the nearest-neighbors of each batch of requests. \n
+     *          Protocol (all values in the native byte order of the server):
+     *          - after connecting, the server sends the number of dimensions and `k` (two `std::uint32_t`)
+     *          - a request consists of the number of queries `n` (`std::uint32_t`, at most `server_max_batch_size`) followed by the
+     *            `n * dims` values of the queries (`real_type`); `n == std::numeric_limits<std::uint32_t>::max()` shuts the server down
+     *          - the answer consists of the `n * k` nearest-neighbor IDs (`id_type`, i.e. `std::uint64_t` if `SYCL_LSH_64BIT_IDS` is
+     *            defined) followed by their `n * k` distances (`real_type`); the `k` nearest-neighbors of each query are sorted by
+     *            distance in ascending order; IDs of nearest-neighbors that couldn't be found are `std::numeric_limits<id_type>::max()`
+     *
+     *          Batching adapts to the load: a batch is dispatched as soon as it contains `server_max_batch_size` queries or its oldest
+     *          request has waited for the batching window. The window is the (smoothed) processing time of the previous batches, capped
+     *          at `server_max_delay` milliseconds, i.e. waiting for more requests never takes longer than processing them. \n
+     *          Invalid requests (e.g. more than `server_max_batch_size` queries) and clients that stall for more than
+     *          @ref io_timeout_ms while sending a request or receiving an answer are disconnected, i.e. a single client can't block the
+     *          other clients (and all MPI ranks waiting for the next batch).
+     * @tparam HashTables the used @ref sycl_lsh::hash_tables type
+     */
+    template <typename HashTables>
+    class query_server {
+    public:
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                type aliases                                                //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /// The type of the @ref sycl_lsh::hash_tables object.
+        using hash_tables_type = HashTables;
+        /// The used floating point type.
+        using real_type = typename hash_tables_type::real_type;
+        /// The used integral type (used for indices).
+        using index_type = typename hash_tables_type::index_type;
+        /// The integral type used for the global IDs of the data points.
+        using id_type = typename hash_tables_type::id_type;
+        /// The type of the @ref sycl_lsh::knn object as the result of the k-nearest-neighbor search.
+        using knn_type = typename hash_tables_type::knn_type;
+
+        /// The maximum time in milliseconds a client may stall while sending a request or receiving an answer.
+        static constexpr int io_timeout_ms = 1000;
+        /// The number of most recent requests whose latencies are used to calculate the logged latency percentiles.
+        static constexpr std::size_t latency_window_size = 10000;
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                         constructor and destructor                                         //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Construct a new @ref sycl_lsh::query_server object using the command line arguments `server_port`, `k`,
+         *        `server_max_batch_size` (default: 4096) and `server_max_delay` (in milliseconds, default: 5).
+         * @details Only MPI rank 0 opens the listening socket.
+         * @param[in] parser the used @ref sycl_lsh::argv_parser
+         * @param[in] hash_tables the already created hash tables
+         * @param[in] comm the used @ref sycl_lsh::mpi::communicator
+         * @param[in] logger the used @ref sycl_lsh::mpi::logger
+         *
+         * @throws std::invalid_argument if the command line argument `server_port` isn't present in @p parser.
+         * @throws std::invalid_argument if `server_max_batch_size` is `0`.
+         * @throws std::runtime_error if the listening socket can't be opened.
+         */
+        query_server(const argv_parser& parser, hash_tables_type& hash_tables, const mpi::communicator& comm, const mpi::logger& logger);
+        /**
+         * @brief Closes all open connections and the listening socket.
+         */
+        ~query_server();
+        query_server(const query_server&) = delete;
+        query_server& operator=(const query_server&) = delete;
+
+
+        // ---------------------------------------------------------------------------------------------------------- //
+        //                                                  serving                                                   //
+        // ---------------------------------------------------------------------------------------------------------- //
+        /**
+         * @brief Answers requests until a shutdown request has been received. Must be called on **all** MPI ranks.
+         * @details Logs the number of served requests and the p50 and p99 latencies (time between receiving a request and sending its
+         *          answer) of the last @ref latency_window_size requests every 100 batches and on shutdown.
+         */
+        void run();
+
+    private:
+        /// A single request of a client.
+        struct request {
+            /// The file descriptor of the connection the request has been received on.
+            int client;
+            /// The ID of the connection (file descriptors may be reused after a connection has been closed).
+            std::uint64_t connection;
+            /// The queries of the request in *Array of Structs* layout.
+            std::vector<real_type> queries;
+            /// The time the request has been received.
+            std::chrono::steady_clock::time_point arrival;
+        };
+
+        /**
+         * @brief Collects the requests of the next batch (only called on MPI rank 0).
+         * @param[out] batch the requests of the next batch
+         * @return `false` if the server should shut down, `true` otherwise (`[[nodiscard]]`)
+         */
+        [[nodiscard]]
+        bool collect_batch(std::vector<request>& batch);
+        /**
+         * @brief Receives the request of @p client and appends it to the pending requests (only called on MPI rank 0).
+         * @details Closes the connection if the client disconnected, sent an invalid request (no or more than `server_max_batch_size`
+         *          queries) or stalled for more than @ref io_timeout_ms.
+         * @param[in] client the file descriptor of the connection
+         */
+        void receive_request(int client);
+        /**
+         * @brief Closes the connection @p client (only called on MPI rank 0).
+         * @param[in] client the file descriptor of the connection
+         */
+        void close_connection(int client);
+        /**
+         * @brief Logs the number of served requests and the p50 and p99 latencies of the last @ref latency_window_size requests.
+         */
+        void log_statistics() const;
+
+        hash_tables_type& hash_tables_;
+        const mpi::communicator& comm_;
+        const mpi::logger& logger_;
+
+        const index_type k_;
+        const index_type dims_;
+        const index_type max_batch_size_;
+        const std::chrono::duration<double, std::milli> max_delay_;
+
+        int listening_fd_ = -1;
+        // open connections and their connection IDs
+        std::map<int, std::uint64_t> connections_;
+        std::uint64_t next_connection_ = 0;
+        std::deque<request> pending_;
+        index_type num_pending_queries_ = 0;
+        bool shutdown_requested_ = false;
+
+        // the current batching window (smoothed batch processing time, capped at max_delay_)
+        std::chrono::duration<double, std::milli> batch_window_;
+        // the latencies of the last latency_window_size requests (ring buffer, the oldest entry is overwritten)
+        std::vector<double> latencies_;
+        std::uint64_t num_requests_ = 0;
+        std::uint64_t num_batches_ = 0;
+        std::uint64_t num_queries_ = 0;
+    };
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                         constructor and destructor                                         //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <typename HashTables>
+    query_server<HashTables>::query_server(const argv_parser& parser, hash_tables_type& hash_tables, const mpi::communicator& comm, const mpi::logger& logger)
+            : hash_tables_(hash_tables), comm_(comm), logger_(logger),
+              k_(parser.argv_as<index_type>("k")),
+              dims_(hash_tables.get_data().get_original_dims()),
+              max_batch_size_(parser.has_argv("server_max_batch_size") ? parser.argv_as<index_type>("server_max_batch_size") : 4096),
+              max_delay_(parser.has_argv("server_max_delay") ? parser.argv_as<double>("server_max_delay") : 5.0),
+              batch_window_(max_delay_)
+    {
+        // check if the required command line argument is present
+        if (!parser.has_argv("server_port")) {
+            throw std::invalid_argument("Required command line argument 'server_port' not provided!");
+        }
+        if (max_batch_size_ == 0) {
+            throw std::invalid_argument("server_max_batch_size must be greater than 0!");
+        }
+
+        if (comm_.master_rank()) {
+            const auto port = parser.argv_as<std::uint16_t>("server_port");
+            listening_fd_ = detail::open_listening_socket(port);
+            logger_.log("\nListening for queries on port {} (max batch size: {}, max delay: {}ms).\n", port, max_batch_size_, max_delay_.count());
+        }
+    }
+
+    template <typename HashTables>
+    query_server<HashTables>::~query_server() {
+        for (const auto& [client, connection] : connections_) {
+            detail::close_socket(client);
+        }
+        if (listening_fd_ >= 0) {
+            detail::close_socket(listening_fd_);
+        }
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                                  serving                                                   //
+    // ---------------------------------------------------------------------------------------------------------- //
+    template <typename HashTables>
+    void query_server<HashTables>::run() {
+        using clock = std::chrono::steady_clock;
+
+        while (true) {
+            // MPI rank 0 collects the next batch
+            std::vector<request> batch;
+            unsigned long long num_batch_queries = 0;
+            if (comm_.master_rank()) {
+                if (this->collect_batch(batch)) {
+                    for (const request& req : batch) {
+                        num_batch_queries += req.queries.size() / dims_;
+                    }
+                }
+            }
+            // a batch without queries shuts all MPI ranks down
+            MPI_Bcast(&num_batch_queries, 1, mpi::type_cast<unsigned long long>(), 0, comm_.get());
+            if (num_batch_queries == 0) {
+                break;
+            }
+            const auto batch_start = clock::now();
+
+            // distribute the queries of the batch to all MPI ranks
+            std::vector<real_type> queries(num_batch_queries * dims_);
+            if (comm_.master_rank()) {
+                auto it = queries.begin();
+                for (const request& req : batch) {
+                    it = std::copy(req.queries.begin(), req.queries.end(), it);
+                }
+            }
+            MPI_Bcast(queries.data(), queries.size(), mpi::type_cast<real_type>(), 0, comm_.get());
+
+            // search the nearest-neighbors of the batch
+            auto query_data = make_query_data(queries, hash_tables_.get_options(), hash_tables_.get_data(), comm_, logger_);
+            knn_type knns = hash_tables_.get_k_nearest_neighbors(query_data, k_);
+
+            // gather the nearest-neighbors of all real queries on MPI rank 0
+            const auto attr = knns.get_attributes();
+            const index_type rank_size = attr.correct_rank_size(comm_.rank());
+            std::vector<id_type> rank_ids(rank_size * k_);
+            std::vector<real_type> rank_dists(rank_size * k_);
+            for (index_type point = 0; point < rank_size; ++point) {
+                // the nearest-neighbors of each query are answered sorted by distance
+                const auto point_ids = knns.get_knn_ids(point, k_);
+                const auto point_dists = knns.get_knn_dists(point, k_);
+                for (index_type nn = 0; nn < k_; ++nn) {
+                    rank_ids[point * k_ + nn] = point_ids[nn];
+                    rank_dists[point * k_ + nn] = std::sqrt(point_dists[nn]);
+                }
+            }
+            std::vector<int> counts(comm_.size());
+            std::vector<int> displs(comm_.size());
+            for (int rank = 0; rank < comm_.size(); ++rank) {
+                counts[rank] = attr.correct_rank_size(rank) * k_;
+            }
+            std::exclusive_scan(counts.begin(), counts.end(), displs.begin(), 0);
+            std::vector<id_type> ids(comm_.master_rank() ? num_batch_queries * k_ : 0);
+            std::vector<real_type> dists(comm_.master_rank() ? num_batch_queries * k_ : 0);
+            MPI_Gatherv(rank_ids.data(), rank_ids.size(), mpi::type_cast<id_type>(), ids.data(), counts.data(), displs.data(),
+                        mpi::type_cast<id_type>(), 0, comm_.get());
+            MPI_Gatherv(rank_dists.data(), rank_dists.size(), mpi::type_cast<real_type>(), dists.data(), counts.data(), displs.data(),
+                        mpi::type_cast<real_type>(), 0, comm_.get());
+
+            if (comm_.master_rank()) {
+                // answer each request with its part of the nearest-neighbors
+                std::size_t offset = 0;
+                for (const request& req : batch) {
+                    const std::size_t count = (req.queries.size() / dims_) * k_;
+                    const auto connection = connections_.find(req.client);
+                    if (connection != connections_.end() && connection->second == req.connection) {
+                        if (!detail::send_all(req.client, ids.data() + offset, count * sizeof(id_type), io_timeout_ms)
+                            || !detail::send_all(req.client, dists.data() + offset, count * sizeof(real_type), io_timeout_ms)) {
+                            this->close_connection(req.client);
+                        }
+                    }
+                    offset += count;
+                    const double latency = std::chrono::duration<double, std::milli>(clock::now() - req.arrival).count();
+                    if (latencies_.size() < latency_window_size) {
+                        latencies_.push_back(latency);
+                    } else {
+                        latencies_[num_requests_ % latency_window_size] = latency;
+                    }
+                    ++num_requests_;
+                }
+
+                // adapt the batching window to the processing time of the batches
+                const std::chrono::duration<double, std::milli> batch_time = clock::now() - batch_start;
+                batch_window_ = std::min(max_delay_, num_batches_ == 0 ? batch_time : 0.8 * batch_window_ + 0.2 * batch_time);
+            }
+            ++num_batches_;
+            num_queries_ += num_batch_queries;
+
+            if (num_batches_ % 100 == 0) {
+                this->log_statistics();
+            }
+        }
+
+        this->log_statistics();
+        logger_.log("Query server shut down.\n");
+    }
+
+    template <typename HashTables>
+    [[nodiscard]]
+    bool query_server<HashTables>::collect_batch(std::vector<request>& batch) {
+        using clock = std::chrono::steady_clock;
+
+        while (!shutdown_requested_ || !pending_.empty()) {
+            int timeout_ms = -1;
+            if (!pending_.empty()) {
+                // dispatch the batch if it's full or its oldest request waited long enough
+                const std::chrono::duration<double, std::milli> waited = clock::now() - pending_.front().arrival;
+                if (shutdown_requested_ || num_pending_queries_ >= max_batch_size_ || waited >= batch_window_) {
+                    break;
+                }
+                timeout_ms = static_cast<int>(std::ceil((batch_window_ - waited).count()));
+            }
+
+            // wait for new connections or requests
+            std::vector<int> fds{ listening_fd_ };
+            for (const auto& [client, connection] : connections_) {
+                fds.push_back(client);
+            }
+            for (const int fd : detail::wait_readable(fds, timeout_ms)) {
+                if (fd == listening_fd_) {
+                    const int client = detail::accept_connection(listening_fd_);
+                    if (client < 0) {
+                        continue;
+                    }
+                    // tell the client the number of dimensions and k
+                    const std::uint32_t header[2] = { static_cast<std::uint32_t>(dims_), static_cast<std::uint32_t>(k_) };
+                    if (detail::send_all(client, header, sizeof(header), io_timeout_ms)) {
+                        connections_.emplace(client, next_connection_++);
+                    } else {
+                        detail::close_socket(client);
+                    }
+                } else {
+                    this->receive_request(fd);
+                }
+            }
+        }
+
+        if (pending_.empty()) {
+            return false;
+        }
+        // take the pending requests until the batch is full (a single request never exceeds the maximum batch size)
+        index_type num_batch_queries = 0;
+        do {
+            num_batch_queries += pending_.front().queries.size() / dims_;
+            num_pending_queries_ -= pending_.front().queries.size() / dims_;
+            batch.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        } while (!pending_.empty() && num_batch_queries + pending_.front().queries.size() / dims_ <= max_batch_size_);
+        return true;
+    }
+
+    template <typename HashTables>
+    void query_server<HashTables>::receive_request(const int client) {
+        std::uint32_t num_queries;
+        if (!detail::receive_all(client, &num_queries, sizeof(num_queries), io_timeout_ms)) {
+            // the client disconnected or stalled
+            this->close_connection(client);
+            return;
+        }
+        if (num_queries == std::numeric_limits<std::uint32_t>::max()) {
+            shutdown_requested_ = true;
+            return;
+        }
+        // reject invalid sizes before allocating anything for the queries
+        if (num_queries == 0 || num_queries > max_batch_size_) {
+            this->close_connection(client);
+            return;
+        }
+
+        request req{ client, connections_.at(client), std::vector<real_type>(static_cast<std::size_t>(num_queries) * dims_), std::chrono::steady_clock::now() };
+        if (!detail::receive_all(client, req.queries.data(), req.queries.size() * sizeof(real_type), io_timeout_ms)) {
+            this->close_connection(client);
+            return;
+        }
+        num_pending_queries_ += num_queries;
+        pending_.push_back(std::move(req));
+    }
+
+    template <typename HashTables>
+    void query_server<HashTables>::close_connection(const int client) {
+        connections_.erase(client);
+        detail::close_socket(client);
+    }
+
+    template <typename HashTables>
+    void query_server<HashTables>::log_statistics() const {
+        if (latencies_.empty()) {
+            logger_.log("Served 0 requests.\n");
+            return;
+        }
+        // only the bounded window of the most recent latencies is copied
+        std::vector<double> sorted_latencies(latencies_);
+        const auto percentile = [&](const double p) {
+            const std::size_t pos = std::min<std::size_t>(std::ceil(p * sorted_latencies.size()), sorted_latencies.size()) - 1;
+            std::nth_element(sorted_latencies.begin(), sorted_latencies.begin() + pos, sorted_latencies.end());
+            return sorted_latencies[pos];
+        };
+        logger_.log("Served {} requests ({} queries) in {} batches (mean batch size: {:.1f} queries): p50 latency {:.3f}ms, p99 latency {:.3f}ms (last {} requests)\n",
+                    num_requests_, num_queries_, num_batches_, static_cast<double>(num_queries_) / num_batches_, percentile(0.5), percentile(0.99),
+                    latencies_.size());
+    }
+
+}
+
+#endif // DISTRIBUTED_GPU_LSH_IMPLEMENTATION_USING_SYCL_QUERY_SERVER_HPP
@@ -0,0 +1,425 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-29
+ *
+ * @brief Reproducible benchmark suite sweeping over synthetic data sets, k, the hash functions types and the options.
+ * @details Usage: `./sycl_lsh_bench [output_file] [max_size]` \n
+ *          For each synthetic data set (isotropic Gaussian clusters like `data_sets/generate_data.py`, generated using a fixed seed
+ *          independent of the number of MPI ranks) the correct k-nearest-neighbors are calculated using a brute-force search. Afterwards
+ *          the hash tables are created and the k-nearest-neighbors are searched for every hash functions type and options set. \n
+ *          The labelled results (phase timings, recall, error ratio, bytes sent over MPI, MPI communication per kind and round of the
+ *          k-nearest-neighbor ring, used device) are written as JSON to
+ *          @p output_file (default: `sycl_lsh_bench.json`), the log output of the library to `output_file.log`. Data sets with more than
+ *          @p max_size data points are skipped.
+ */
+
+#include <sycl_lsh/core.hpp>
+#include <sycl_lsh/device_selector.hpp>
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/file_parser/binary_parser.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+
+#include <fmt/format.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using real_type = float;
+    using index_type = std::uint32_t;
+    template <sycl_lsh::hash_functions_type type>
+    using options_type = sycl_lsh::options<real_type, index_type, std::uint32_t, 10, type>;
+
+    /*
+     * @brief A synthetic data set consisting of isotropic Gaussian clusters.
+     */
+    struct data_set {
+        index_type size;
+        index_type dims;
+        index_type num_cluster;
+        real_type cluster_std;
+    };
+    /*
+     * @brief The options explicitly set per run (all other options use their default values).
+     */
+    struct options_set {
+        index_type num_hash_tables;
+        index_type num_hash_functions;
+        std::uint32_t hash_table_size;
+    };
+
+    // the swept configurations
+    const std::vector<data_set> data_sets = { { 16384, 16, 8, 1.0 }, { 65536, 32, 16, 1.0 }, { 65536, 128, 16, 2.0 } };
+    const std::vector<index_type> ks = { 10, 50 };
+    const std::vector<options_set> options_sets = { { 4, 4, 105613 }, { 8, 4, 105613 }, { 16, 6, 209503 } };
+    constexpr std::uint64_t seed = 42;
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                          count the sent bytes                                              //
+    // ---------------------------------------------------------------------------------------------------------- //
+    // the number of bytes sent by the current MPI rank using point-to-point or all-to-all communication
+    std::uint64_t sent_bytes = 0;
+
+    std::uint64_t type_size(const MPI_Datatype type) {
+        int size = 0;
+        PMPI_Type_size(type, &size);
+        return static_cast<std::uint64_t>(size);
+    }
+
+}
+
+// intercept the MPI calls transferring data points and k-nearest-neighbors using the MPI profiling interface
+extern "C" {
+
+    int MPI_Send(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+        sent_bytes += count * type_size(datatype);
+        return PMPI_Send(buf, count, datatype, dest, tag, comm);
+    }
+    int MPI_Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm, MPI_Request* request) {
+        sent_bytes += count * type_size(datatype);
+        return PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+    }
+    int MPI_Alltoall(const void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+        int comm_size = 0;
+        PMPI_Comm_size(comm, &comm_size);
+        // the data sent to the own MPI rank isn't counted
+        if (sendbuf == MPI_IN_PLACE) {
+            sent_bytes += (comm_size - 1) * recvcount * type_size(recvtype);
+        } else {
+            sent_bytes += (comm_size - 1) * sendcount * type_size(sendtype);
+        }
+        return PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    }
+    int MPI_Alltoallv(const void* sendbuf, const int sendcounts[], const int sdispls[], MPI_Datatype sendtype,
+                      void* recvbuf, const int recvcounts[], const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm)
+    {
+        int comm_size = 0;
+        int comm_rank = 0;
+        PMPI_Comm_size(comm, &comm_size);
+        PMPI_Comm_rank(comm, &comm_rank);
+        // the data sent to the own MPI rank isn't counted
+        const bool in_place = sendbuf == MPI_IN_PLACE;
+        const int* counts = in_place ? recvcounts : sendcounts;
+        const std::uint64_t size = type_size(in_place ? recvtype : sendtype);
+        for (int rank = 0; rank < comm_size; ++rank) {
+            if (rank != comm_rank) {
+                sent_bytes += counts[rank] * size;
+            }
+        }
+        return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+    }
+
+}
+
+namespace {
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                              measure phases                                                //
+    // ---------------------------------------------------------------------------------------------------------- //
+    /*
+     * @brief The wall time (from the first MPI rank entering to the last MPI rank leaving) and the bytes sent by all MPI ranks of a phase.
+     */
+    struct phase {
+        double time_ms;
+        std::uint64_t bytes_sent;
+    };
+
+    /*
+     * @brief Measures a phase independent of the configured *SYCL_LSH_TIMER* (collective operation).
+     */
+    class phase_timer {
+    public:
+        explicit phase_timer(const sycl_lsh::mpi::communicator& comm) : comm_(comm) {
+            comm_.wait();
+            start_bytes_ = sent_bytes;
+            start_ = std::chrono::steady_clock::now();
+        }
+        phase stop() const {
+            comm_.wait();
+            const double time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+            return phase{ time_ms, sycl_lsh::mpi::sum(sent_bytes - start_bytes_, comm_) };
+        }
+
+    private:
+        const sycl_lsh::mpi::communicator& comm_;
+        std::uint64_t start_bytes_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                             generate data sets                                             //
+    // ---------------------------------------------------------------------------------------------------------- //
+    /*
+     * @brief Generates the data set @p ds and writes it to @p file_name using the binary file format (collective operation).
+     * @details Each data point is generated using its own seeded random number generator, i.e. the data set is independent of the
+     *          number of MPI ranks.
+     */
+    void generate_data_set(const data_set& ds, const std::string& file_name, const sycl_lsh::mpi::communicator& comm, const sycl_lsh::mpi::logger& logger) {
+        // the cluster centers are drawn uniformly from [-10, 10] (identically on all MPI ranks)
+        std::mt19937_64 center_gen(seed);
+        std::uniform_real_distribution<real_type> center_dist(-10.0, 10.0);
+        std::vector<real_type> centers(ds.num_cluster * ds.dims);
+        for (real_type& c : centers) {
+            c = center_dist(center_gen);
+        }
+
+        // generate the data points of the current MPI rank (the last MPI rank may contain less data points)
+        const index_type rank_size = (ds.size + comm.size() - 1) / comm.size();
+        const index_type first_point = comm.rank() * rank_size;
+        const index_type last_point = std::min<index_type>(first_point + rank_size, ds.size);
+        std::vector<real_type> buffer(rank_size * ds.dims);
+        for (index_type point = first_point; point < last_point; ++point) {
+            std::mt19937_64 gen(seed ^ (static_cast<std::uint64_t>(point + 1) * 0x9E3779B97F4A7C15ULL));
+            const index_type cluster = std::uniform_int_distribution<index_type>(0, ds.num_cluster - 1)(gen);
+            std::normal_distribution<real_type> dist(0.0, ds.cluster_std);
+            for (index_type dim = 0; dim < ds.dims; ++dim) {
+                buffer[(point - first_point) * ds.dims + dim] = centers[cluster * ds.dims + dim] + dist(gen);
+            }
+        }
+
+        sycl_lsh::mpi::binary_parser<options_type<sycl_lsh::hash_functions_type::random_projections>, real_type>
+                parser(file_name, sycl_lsh::mpi::file::mode::write, comm, logger);
+        parser.write_content(ds.size, ds.dims, std::move(buffer));
+    }
+
+    /*
+     * @brief Creates a @ref sycl_lsh::argv_parser from the [key, value]-pairs @p args.
+     */
+    sycl_lsh::argv_parser make_argv_parser(const std::vector<std::pair<std::string, std::string>>& args) {
+        std::vector<std::string> strings = { "sycl_lsh_bench" };
+        for (const auto& [key, value] : args) {
+            strings.push_back("--" + key);
+            strings.push_back(value);
+        }
+        std::vector<char*> argv;
+        for (std::string& str : strings) {
+            argv.push_back(str.data());
+        }
+        return sycl_lsh::argv_parser(static_cast<int>(argv.size()), argv.data());
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------- //
+    //                                               JSON output                                                  //
+    // ---------------------------------------------------------------------------------------------------------- //
+    /*
+     * @brief Returns @p str as quoted JSON string.
+     */
+    std::string json_string(const std::string_view str) {
+        std::string res = "\"";
+        for (const char c : str) {
+            if (c == '"' || c == '\\') {
+                res += '\\';
+                res += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                res += fmt::format("\\u{:04x}", static_cast<int>(c));
+            } else {
+                res += c;
+            }
+        }
+        return res + '"';
+    }
+
+    /*
+     * @brief Returns the compile time configuration of the library as JSON object.
+     */
+    std::string build_configuration() {
+        constexpr std::string_view distribution = SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_RING ? "RING"
+                                                : SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_ROUTING ? "ROUTING"
+                                                : SYCL_LSH_DISTRIBUTION == SYCL_LSH_DISTRIBUTION_HIERARCHICAL_RING ? "HIERARCHICAL_RING" : "STATIONARY_RING";
+        constexpr std::string_view knn_kernel = SYCL_LSH_KNN_KERNEL == SYCL_LSH_KNN_KERNEL_QUERY ? "QUERY" : "BUCKET";
+        constexpr std::string_view top_k = SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_BUBBLE ? "BUBBLE"
+                                         : SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_SORTED ? "SORTED"
+                                         : SYCL_LSH_TOP_K == SYCL_LSH_TOP_K_HEAP ? "HEAP" : "MERGE";
+        constexpr std::string_view storage = SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_FLOAT ? "FLOAT"
+                                           : SYCL_LSH_STORAGE == SYCL_LSH_STORAGE_HALF ? "HALF" : "INT8";
+        return fmt::format(R"({{ "distribution": "{}", "knn_kernel": "{}", "top_k": "{}", "storage": "{}" }})",
+                           distribution, knn_kernel, top_k, storage);
+    }
+
+    /*
+     * @brief Returns the MPI communication recorded until the last report of the @ref sycl_lsh::mpi::communication_profiler aggregated
+     *        over all MPI ranks as JSON array (collective operation).
+     */
+    std::string communication_json(const sycl_lsh::mpi::communicator& comm) {
+        const auto& stats = sycl_lsh::mpi::communication_profiler::last_report();
+        std::string res = "[";
+        for (std::size_t kind = 0; kind < stats.size(); ++kind) {
+            const std::uint64_t num_rounds = sycl_lsh::mpi::max<std::uint64_t>(stats[kind].size(), comm);
+            for (std::uint64_t round = 0; round < num_rounds; ++round) {
+                const sycl_lsh::mpi::communication_statistics s = round < stats[kind].size() ? stats[kind][round] : sycl_lsh::mpi::communication_statistics{};
+                if (sycl_lsh::mpi::sum(s.num_calls, comm) == 0) continue;
+                res += fmt::format(R"({}{{ "kind": {}, "round": {}, "bytes_sent": {}, "bytes_received": {}, "max_mpi_time_ms": {:.3f}, )"
+                                   R"("avg_mpi_time_ms": {:.3f}, "max_wait_time_ms": {:.3f}, "avg_wait_time_ms": {:.3f}, "avg_bandwidth_mib_s": {:.2f} }})",
+                                   res.size() > 1 ? ", " : "", json_string(sycl_lsh::mpi::communication_kind_names[kind]), round + 1,
+                                   sycl_lsh::mpi::sum(s.bytes_sent, comm), sycl_lsh::mpi::sum(s.bytes_received, comm),
+                                   sycl_lsh::mpi::max(s.mpi_time, comm), sycl_lsh::mpi::average(s.mpi_time, comm),
+                                   sycl_lsh::mpi::max(s.wait_time, comm), sycl_lsh::mpi::average(s.wait_time, comm),
+                                   sycl_lsh::mpi::average(s.bandwidth(), comm));
+            }
+        }
+        return res + ']';
+    }
+
+    /*
+     * @brief Creates the hash tables using the hash functions type @p type, searches the k-nearest-neighbors and returns the results
+     *        as JSON object.
+     */
+    template <sycl_lsh::hash_functions_type type>
+    std::string run(const data_set& ds, const index_type k, const options_set& os, const std::string& data_file, const std::string& knn_file,
+                    const std::string& knn_dist_file, const sycl_lsh::mpi::communicator& comm, const sycl_lsh::mpi::logger& logger)
+    {
+        const sycl_lsh::argv_parser parser = make_argv_parser({
+                { "data_file", data_file }, { "k", std::to_string(k) }, { "seed", std::to_string(seed) },
+                { "num_hash_tables", std::to_string(os.num_hash_tables) }, { "num_hash_functions", std::to_string(os.num_hash_functions) },
+                { "hash_table_size", std::to_string(os.hash_table_size) },
+                { "evaluate_knn_file", knn_file }, { "evaluate_knn_dist_file", knn_dist_file } });
+        const options_type<type> opt(parser, logger);
+
+        phase_timer pt_parse(comm);
+        auto data = sycl_lsh::make_data<sycl_lsh::memory_layout::aos>(parser, opt, comm, logger);
+        const phase parse_data = pt_parse.stop();
+
+        phase_timer pt_create(comm);
+        auto lsh_tables = sycl_lsh::make_hash_tables<sycl_lsh::memory_layout::aos>(parser, opt, data, comm, logger);
+        const phase create_hash_tables = pt_create.stop();
+        const std::string create_hash_tables_communication = communication_json(comm);
+
+        phase_timer pt_knn(comm);
+        auto knns = lsh_tables.get_k_nearest_neighbors(k);
+        const phase calculate_knn = pt_knn.stop();
+        const std::string calculate_knn_communication = communication_json(comm);
+
+        phase_timer pt_evaluate(comm);
+        const real_type recall = knns.recall(parser);
+        const auto [error_ratio, num_points_not_found, num_knn_not_found] = knns.error_ratio(parser);
+        const phase evaluate = pt_evaluate.stop();
+
+        return fmt::format(R"({{ "data_set": {{ "size": {}, "dims": {}, "num_cluster": {}, "cluster_std": {} }}, "k": {}, )"
+                           R"("hash_functions_type": "{}", "options": {{ "hash_pool_size": {}, "num_hash_functions": {}, "num_hash_tables": {}, )"
+                           R"("hash_table_size": {}, "w": {}, "num_cut_off_points": {}, "seed": {} }}, )"
+                           R"("timings_ms": {{ "parse_data": {:.3f}, "create_hash_tables": {:.3f}, "calculate_knn": {:.3f}, "evaluate": {:.3f} }}, )"
+                           R"("bytes_sent": {{ "parse_data": {}, "create_hash_tables": {}, "calculate_knn": {} }}, )"
+                           R"("communication": {{ "create_hash_tables": {}, "calculate_knn": {} }}, )"
+                           R"("recall": {}, "error_ratio": {}, "num_points_not_found": {}, "num_knn_not_found": {} }})",
+                           ds.size, ds.dims, ds.num_cluster, ds.cluster_std, k,
+                           type, opt.hash_pool_size, opt.num_hash_functions, opt.num_hash_tables,
+                           opt.hash_table_size, opt.w, opt.num_cut_off_points, opt.seed,
+                           parse_data.time_ms, create_hash_tables.time_ms, calculate_knn.time_ms, evaluate.time_ms,
+                           parse_data.bytes_sent, create_hash_tables.bytes_sent, calculate_knn.bytes_sent,
+                           create_hash_tables_communication, calculate_knn_communication,
+                           recall, error_ratio, num_points_not_found, num_knn_not_found);
+    }
+
+}
+
+int custom_main(int argc, char** argv) {
+    // create MPI communicator
+    sycl_lsh::mpi::communicator comm;
+    // create default logger (logs to std::cout)
+    sycl_lsh::mpi::logger logger(comm);
+
+    try {
+        const std::string output_file = argc > 1 ? argv[1] : "sycl_lsh_bench.json";
+        const index_type max_size = argc > 2 ? sycl_lsh::detail::convert_to<index_type>(argv[2]) : std::numeric_limits<index_type>::max();
+
+        // the log output of the library is only written to file
+        std::ofstream library_log;
+        if (comm.master_rank()) {
+            library_log.open(output_file + ".log");
+        }
+        sycl_lsh::mpi::logger library_logger(comm, library_log);
+
+        const std::string device = sycl_lsh::detail::select_devices(comm).front().get_info<sycl_lsh::sycl::info::device::name>();
+        logger.log("Device: {}\n", device);
+        logger.log("Writing the results to '{}'.\n\n", output_file);
+
+        std::vector<std::string> results;
+        for (const data_set& ds : data_sets) {
+            if (ds.size > max_size) {
+                logger.log("Skipping data set with {} data points (more than {}).\n", ds.size, max_size);
+                continue;
+            }
+            const std::string prefix = fmt::format("{}.{}x{}", output_file, ds.size, ds.dims);
+            const std::string data_file = prefix + ".bin";
+            generate_data_set(ds, data_file, comm, library_logger);
+
+            for (const index_type k : ks) {
+                // calculate the correct k-nearest-neighbors
+                const std::string knn_file = fmt::format("{}.k{}.knn", prefix, k);
+                const std::string knn_dist_file = fmt::format("{}.k{}.dist", prefix, k);
+                {
+                    const sycl_lsh::argv_parser parser = make_argv_parser({ { "data_file", data_file }, { "k", std::to_string(k) },
+                                                                            { "knn_save_file", knn_file }, { "knn_dist_save_file", knn_dist_file } });
+                    const options_type<sycl_lsh::hash_functions_type::random_projections> opt(parser, library_logger);
+                    auto data = sycl_lsh::make_data<sycl_lsh::memory_layout::aos>(parser, opt, comm, library_logger);
+                    sycl_lsh::brute_force exact(opt, data, comm, library_logger);
+                    auto knns = exact.get_k_nearest_neighbors(parser);
+                    knns.save_knns(parser);
+                    knns.save_distances(parser);
+                    knns.finish_saving();
+                }
+
+                for (const options_set& os : options_sets) {
+                    logger.log("size: {:>7}, dims: {:>4}, k: {:>3}, num_hash_tables: {:>3}, num_hash_functions: {:>3}, hash_table_size: {:>7} ... ",
+                               ds.size, ds.dims, k, os.num_hash_tables, os.num_hash_functions, os.hash_table_size);
+                    results.push_back(run<sycl_lsh::hash_functions_type::random_projections>(ds, k, os, data_file, knn_file, knn_dist_file, comm, library_logger));
+                    results.push_back(run<sycl_lsh::hash_functions_type::entropy_based>(ds, k, os, data_file, knn_file, knn_dist_file, comm, library_logger));
+                    results.push_back(run<sycl_lsh::hash_functions_type::mixed_hash_functions>(ds, k, os, data_file, knn_file, knn_dist_file, comm, library_logger));
+                    results.push_back(run<sycl_lsh::hash_functions_type::simhash>(ds, k, os, data_file, knn_file, knn_dist_file, comm, library_logger));
+                    logger.log("done.\n");
+                }
+
+                if (comm.master_rank()) {
+                    std::remove(knn_file.c_str());
+                    std::remove(knn_dist_file.c_str());
+                }
+            }
+
+            if (comm.master_rank()) {
+                std::remove(data_file.c_str());
+            }
+        }
+
+        // write the labelled results
+        if (comm.master_rank()) {
+            std::ofstream out(output_file, std::ofstream::trunc);
+            if (!out) {
+                throw std::runtime_error(fmt::format("Can't write to file '{}'!", output_file));
+            }
+            out << fmt::format("{{\n  \"device\": {},\n  \"mpi_ranks\": {},\n  \"build\": {},\n  \"results\": [\n",
+                               json_string(device), comm.size(), build_configuration());
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                out << "    " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+            }
+            out << "  ]\n}\n";
+        }
+        logger.log("\nWrote {} results to '{}'.\n", results.size(), output_file);
+    } catch (const std::exception& e) {
+        logger.log("Exception thrown on rank {}: {}\n", comm.rank(), e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char** argv) {
+    return sycl_lsh::mpi::main(argc, argv, &custom_main);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-12-16
+ *
+ * @brief Benchmarks the different data structures to maintain the k-nearest-neighbors inside a SYCL kernel.
+ * @details Usage: `./sycl_lsh_top_k_bench [num_queries] [num_candidates] [k...]` \n
+ *          Each query is compared against a synthetic stream of @p num_candidates candidates with pseudo-random distances. Every
+ *          candidate ID occurs twice in the stream (as it would in multiple hash tables) to also benchmark the duplicate detection.
+ */
+
+#include <sycl_lsh/core.hpp>
+#include <sycl_lsh/detail/top_k.hpp>
+#include <sycl_lsh/device_selector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using options_type = sycl_lsh::options<float, std::uint32_t, std::uint32_t, 10, sycl_lsh::hash_functions_type::random_projections>;
+    using real_type = typename options_type::real_type;
+    using index_type = typename options_type::index_type;
+
+    // SYCL kernel name needed to silence ComputeCpp warnings
+    template <int top_k_type>
+    class kernel_top_k_benchmark;
+
+    /*
+     * @brief Maps the `SYCL_LSH_TOP_K_*` values to the respective top-k data structure.
+     */
+    template <int top_k_type>
+    struct top_k_data_structure;
+    template <>
+    struct top_k_data_structure<SYCL_LSH_TOP_K_BUBBLE> {
+        template <typename Options, typename IdAccessor, typename DistAccessor>
+        using type = sycl_lsh::detail::top_k_bubble<Options, IdAccessor, DistAccessor>;
+        static constexpr const char* name = "BUBBLE";
+    };
+    template <>
+    struct top_k_data_structure<SYCL_LSH_TOP_K_SORTED> {
+        template <typename Options, typename IdAccessor, typename DistAccessor>
+        using type = sycl_lsh::detail::top_k_sorted<Options, IdAccessor, DistAccessor>;
+        static constexpr const char* name = "SORTED";
+    };
+    template <>
+    struct top_k_data_structure<SYCL_LSH_TOP_K_HEAP> {
+        template <typename Options, typename IdAccessor, typename DistAccessor>
+        using type = sycl_lsh::detail::top_k_heap<Options, IdAccessor, DistAccessor>;
+        static constexpr const char* name = "HEAP";
+    };
+    template <>
+    struct top_k_data_structure<SYCL_LSH_TOP_K_MERGE> {
+        template <typename Options, typename IdAccessor, typename DistAccessor>
+        using type = sycl_lsh::detail::top_k_merge<Options, IdAccessor, DistAccessor>;
+        static constexpr const char* name = "MERGE";
+    };
+
+    /*
+     * @brief Pseudo-random distance in [0, 1) for the candidate @p id of the query @p query (the same pair always results in the same distance).
+     */
+    inline real_type synthetic_distance(const index_type query, const index_type id) {
+        std::uint32_t h = query * 0x9e3779b9U ^ (id + 0x7f4a7c15U);
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+        return static_cast<real_type>(h >> 8) / static_cast<real_type>(1U << 24);
+    }
+
+    /*
+     * @brief Runs the benchmark for the top-k data structure @p top_k_type and returns the elapsed time in milliseconds.
+     */
+    template <int top_k_type>
+    double benchmark(sycl_lsh::sycl::queue& queue, const index_type num_queries, const index_type num_candidates, const index_type k,
+                     std::vector<real_type>& knn_dist)
+    {
+        namespace sycl = sycl_lsh::sycl;
+
+        const index_type local_mem_size = queue.get_device().template get_info<sycl::info::device::local_mem_size>();
+        const index_type max_local_size = local_mem_size / (k * (sizeof(index_type) + sizeof(real_type)));
+        const index_type max_work_group_size = queue.get_device().template get_info<sycl::info::device::max_work_group_size>();
+        const index_type local_size = std::min<index_type>(std::pow(2, std::floor(std::log2(max_local_size))), max_work_group_size);
+        const index_type global_size = ((num_queries + local_size - 1) / local_size) * local_size;
+
+        sycl::buffer<real_type, 1> knn_dist_buffer(knn_dist.data(), knn_dist.size());
+
+        const auto start = std::chrono::steady_clock::now();
+        queue.submit([&](sycl::handler& cgh) {
+            auto acc_knn_dist = knn_dist_buffer.template get_access<sycl::access::mode::discard_write>(cgh);
+
+            sycl::accessor<index_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_local_mem(sycl::range<>(local_size * k), cgh);
+            sycl::accessor<real_type, 1, sycl::access::mode::read_write, sycl::access::target::local>
+                    knn_dist_local_mem(sycl::range<>(local_size * k), cgh);
+
+            const auto execution_range = sycl::nd_range<>(sycl::range<>(global_size), sycl::range<>(local_size));
+
+            cgh.parallel_for<kernel_top_k_benchmark<top_k_type>>(execution_range, [=](sycl::nd_item<> item) {
+                const index_type global_idx = item.get_global_linear_id();
+                const index_type local_idx  = item.get_local_linear_id();
+
+                if (global_idx >= num_queries) return;
+
+                for (index_type nn = 0; nn < k; ++nn) {
+                    knn_local_mem[local_idx * k + nn] = global_idx;
+                    knn_dist_local_mem[local_idx * k + nn] = std::numeric_limits<real_type>::max();
+                }
+                auto knn_list = sycl_lsh::detail::make_top_k<options_type, top_k_data_structure<top_k_type>::template type>(
+                        knn_local_mem, knn_dist_local_mem, local_idx * k, k);
+
+                for (index_type candidate = 0; candidate < num_candidates; ++candidate) {
+                    // every ID occurs twice
+                    const index_type id = candidate % (num_candidates / 2 + 1);
+                    const real_type dist = synthetic_distance(global_idx, id);
+                    if (dist < knn_list.max_distance()) {
+                        knn_list.add(id, dist);
+                    }
+                }
+                knn_list.finalize();
+
+                for (index_type nn = 0; nn < k; ++nn) {
+                    acc_knn_dist[global_idx * k + nn] = knn_dist_local_mem[local_idx * k + nn];
+                }
+            });
+        });
+        queue.wait_and_throw();
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    /*
+     * @brief Sorts the k-nearest-neighbor distances of each query to be able to compare the results of the different data structures.
+     */
+    std::vector<real_type> sort_per_query(std::vector<real_type> knn_dist, const index_type k) {
+        for (auto it = knn_dist.begin(); it != knn_dist.end(); it += k) {
+            std::sort(it, it + k);
+        }
+        return knn_dist;
+    }
+
+}
+
+int custom_main(int argc, char** argv) {
+    // create MPI communicator
+    sycl_lsh::mpi::communicator comm;
+    // create default logger (logs to std::cout)
+    sycl_lsh::mpi::logger logger(comm);
+
+    try {
+        const index_type num_queries = argc > 1 ? sycl_lsh::detail::convert_to<index_type>(argv[1]) : 65536;
+        const index_type num_candidates = argc > 2 ? sycl_lsh::detail::convert_to<index_type>(argv[2]) : 4096;
+        std::vector<index_type> ks;
+        for (int i = 3; i < argc; ++i) {
+            ks.push_back(sycl_lsh::detail::convert_to<index_type>(argv[i]));
+        }
+        if (ks.empty()) {
+            ks = { 1, 10, 32, 64, 100 };
+        }
+
+        sycl_lsh::sycl::queue queue(sycl_lsh::device_selector{comm}, sycl_lsh::sycl::async_handler(&sycl_lsh::sycl_exception_handler));
+        logger.log("Device: {}\n", queue.get_device().template get_info<sycl_lsh::sycl::info::device::name>());
+        logger.log("{} queries with {} candidates each (every candidate ID occurs twice)\n\n", num_queries, num_candidates);
+        logger.log("{:>5} | {:>12} | {:>12} | {:>12} | {:>12}\n", "k",
+                   top_k_data_structure<SYCL_LSH_TOP_K_BUBBLE>::name, top_k_data_structure<SYCL_LSH_TOP_K_SORTED>::name,
+                   top_k_data_structure<SYCL_LSH_TOP_K_HEAP>::name, top_k_data_structure<SYCL_LSH_TOP_K_MERGE>::name);
+
+        for (const index_type k : ks) {
+            if (k == 0 || k > num_candidates / 2) {
+                throw std::invalid_argument(fmt::format("k ({}) must be in the range [1, num_candidates / 2 ({})]!", k, num_candidates / 2));
+            }
+            std::vector<real_type> knn_dist_bubble(num_queries * k);
+            std::vector<real_type> knn_dist_sorted(num_queries * k);
+            std::vector<real_type> knn_dist_heap(num_queries * k);
+            std::vector<real_type> knn_dist_merge(num_queries * k);
+
+            const double time_bubble = benchmark<SYCL_LSH_TOP_K_BUBBLE>(queue, num_queries, num_candidates, k, knn_dist_bubble);
+            const double time_sorted = benchmark<SYCL_LSH_TOP_K_SORTED>(queue, num_queries, num_candidates, k, knn_dist_sorted);
+            const double time_heap = benchmark<SYCL_LSH_TOP_K_HEAP>(queue, num_queries, num_candidates, k, knn_dist_heap);
+            const double time_merge = benchmark<SYCL_LSH_TOP_K_MERGE>(queue, num_queries, num_candidates, k, knn_dist_merge);
+
+            // all data structures must find the same k-nearest-neighbors
+            const std::vector<real_type> correct = sort_per_query(knn_dist_bubble, k);
+            if (sort_per_query(knn_dist_sorted, k) != correct || sort_per_query(knn_dist_heap, k) != correct || sort_per_query(knn_dist_merge, k) != correct) {
+                throw std::runtime_error(fmt::format("The top-k data structures calculated different k-nearest-neighbors for k = {}!", k));
+            }
+
+            logger.log("{:>5} | {:>10.2f}ms | {:>10.2f}ms | {:>10.2f}ms | {:>10.2f}ms\n", k, time_bubble, time_sorted, time_heap, time_merge);
+        }
+    } catch (const std::exception& e) {
+        logger.log("Exception thrown on rank {}: {}\n", comm.rank(), e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char** argv) {
+    return sycl_lsh::mpi::main(argc, argv, &custom_main);
+}
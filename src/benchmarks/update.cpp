@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2021-01-12
+ *
+ * @brief Checks inserting, deleting and compacting data points of existing hash tables (the library logs the elapsed times).
+ * @details Usage: `./sycl_lsh_update_bench --data_file <file> --k <k> [options...]` (the same command line arguments as the main
+ *          executable) \n
+ *          Each MPI rank inserts exact copies of its first data points, such that each copy must be found as a nearest-neighbor of
+ *          its original, once in the delta segment and once folded into the hash tables by `compact()`. Afterwards the copies are
+ *          deleted again and must neither be found as tombstones nor after the next compaction.
+ */
+
+#include <sycl_lsh/core.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using options_type = sycl_lsh::options<float, std::uint32_t, std::uint32_t, 10, sycl_lsh::hash_functions_type::random_projections>;
+    using real_type = typename options_type::real_type;
+    using index_type = typename options_type::index_type;
+
+    // the maximum number of data points copied per MPI rank
+    constexpr index_type max_num_inserted = 1024;
+
+    /*
+     * @brief Checks whether the copy @p ids[point] of each data point `point` is (@p expect_found is `true`) or isn't (@p expect_found is
+     *        `false`) one of its @p k nearest-neighbors (collective operation).
+     *
+     * @throws std::runtime_error if the k-nearest-neighbors of any data point on any MPI rank don't match the expectation.
+     */
+    template <typename Knns, typename Ids>
+    void check_copies(const Knns& knns, const index_type k, const Ids& ids, const bool expect_found, const std::string_view phase,
+                      const sycl_lsh::mpi::communicator& comm, const sycl_lsh::mpi::logger& logger)
+    {
+        index_type num_mismatches = 0;
+        for (index_type point = 0; point < ids.size(); ++point) {
+            const auto knn_ids = knns.get_knn_ids(point, k);
+            bool found = false;
+            for (index_type nn = 0; nn < k; ++nn) {
+                found = found || knn_ids[nn] == ids[point];
+            }
+            if (found != expect_found) {
+                ++num_mismatches;
+            }
+        }
+
+        const index_type total_num_mismatches = sycl_lsh::mpi::sum(num_mismatches, comm);
+        if (total_num_mismatches > 0) {
+            throw std::runtime_error(fmt::format("{}: {} inserted data points were unexpectedly {}found!", phase, total_num_mismatches, expect_found ? "not " : ""));
+        }
+        logger.log("{}: passed\n", phase);
+    }
+
+}
+
+int custom_main(int argc, char** argv) {
+    // create MPI communicator
+    sycl_lsh::mpi::communicator comm;
+    // create default logger (logs to std::cout)
+    sycl_lsh::mpi::logger logger(comm);
+
+    try {
+        // parse command line arguments, options and data
+        sycl_lsh::argv_parser parser(argc, argv);
+        const options_type opt(parser, logger);
+        auto data = sycl_lsh::make_data<sycl_lsh::memory_layout::aos>(parser, opt, comm, logger);
+        const auto attr = data.get_attributes();
+        const index_type k = parser.argv_as<index_type>("k");
+
+        auto lsh_tables = sycl_lsh::make_hash_tables<sycl_lsh::memory_layout::aos>(parser, opt, data, comm, logger);
+
+        // insert exact copies of the first data points of the current MPI rank
+        const index_type num_inserted = std::min<index_type>(max_num_inserted, attr.correct_rank_size(comm.rank()));
+        const auto& host_buffer = data.get_host_buffer();
+        std::vector<real_type> points(num_inserted * attr.dims);
+        std::transform(host_buffer.begin(), host_buffer.begin() + points.size(), points.begin(), [](const auto val) { return static_cast<real_type>(val); });
+        const auto ids = lsh_tables.insert(points);
+        check_copies(lsh_tables.get_k_nearest_neighbors(k), k, ids, true, "inserted (delta segment)", comm, logger);
+
+        lsh_tables.compact();
+        check_copies(lsh_tables.get_k_nearest_neighbors(k), k, ids, true, "inserted (compacted)", comm, logger);
+
+        lsh_tables.erase(ids);
+        check_copies(lsh_tables.get_k_nearest_neighbors(k), k, ids, false, "deleted (tombstones)", comm, logger);
+
+        lsh_tables.compact();
+        check_copies(lsh_tables.get_k_nearest_neighbors(k), k, ids, false, "deleted (compacted)", comm, logger);
+    } catch (const std::exception& e) {
+        logger.log("Exception thrown on rank {}: {}\n", comm.rank(), e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char** argv) {
+    return sycl_lsh::mpi::main(argc, argv, &custom_main);
+}
@@ -34,7 +34,12 @@ int custom_main(int argc, char** argv) {
         logger.log("MPI_Comm_size: {}\n\n", comm.size());
 
         // parse options and print
-        const sycl_lsh::options<float, std::uint32_t, std::uint32_t, 10, sycl_lsh::hash_functions_type::random_projections> opt(parser, logger);
+#if defined(SYCL_LSH_DIMS)
+        using options_type = sycl_lsh::options<float, std::uint32_t, std::uint32_t, 10, sycl_lsh::hash_functions_type::random_projections, SYCL_LSH_DIMS>;
+#else
+        using options_type = sycl_lsh::options<float, std::uint32_t, std::uint32_t, 10, sycl_lsh::hash_functions_type::random_projections>;
+#endif
+        const options_type opt(parser, logger);
         logger.log("Used options: \n{}\n", opt);
 
         // optionally save generated options to file
@@ -46,33 +51,102 @@ int custom_main(int argc, char** argv) {
         auto data = sycl_lsh::make_data<sycl_lsh::memory_layout::aos>(parser, opt, comm, logger);
         logger.log("\nUsed data set:\n{}\n", data);
 
-        // generate LSH hash tables
-        auto lsh_tables = sycl_lsh::make_hash_tables<sycl_lsh::memory_layout::aos>(opt, data, comm, logger);
-        // calculate k-nearest-neighbors
-        auto knns = lsh_tables.get_k_nearest_neighbors(parser);
+        // evaluate the calculated k-nearest-neighbors as requested by the command line arguments
+        const auto evaluate = [&](auto& knns) {
+            // optionally calculate the recall of the calculated k-nearest-neighbors
+            if (parser.has_argv("evaluate_knn_file")) {
+                logger.log("recall: {}%\n", knns.recall(parser));
+            }
+            // optionally calculate the error ration of the calculated k-nearest-neighbors
+            if (parser.has_argv("evaluate_knn_dist_file")) {
+                const auto [error_ratio, num_points, num_knn_not_found] = knns.error_ratio(parser);
+                if (num_points == 0) {
+                    logger.log("error ratio: {}\n", error_ratio);
+                } else {
+                    logger.log("error ratio: {} (for {} points a total of {} nearest-neighbors couldn't be found)\n", error_ratio, num_points, num_knn_not_found);
+                }
+            }
+        };
+        // save and evaluate the calculated k-nearest-neighbors as requested by the command line arguments
+        const auto save_and_evaluate = [&](auto& knns) {
+            // optionally save calculated k-nearest-neighbor IDs
+            if (parser.has_argv("knn_save_file")) {
+                knns.save_knns(parser);
+            }
+            // optionally save calculated k-nearest-neighbor distances
+            if (parser.has_argv("knn_dist_save_file")) {
+                knns.save_distances(parser);
+            }
 
-        // optionally save calculated k-nearest-neighbor IDs
-        if (parser.has_argv("knn_save_file")) {
-            knns.save_knns(parser);
-        }
-        // optionally save calculated k-nearest-neighbor distances
-        if (parser.has_argv("knn_dist_save_file")) {
-            knns.save_distances(parser);
+            evaluate(knns);
+
+            // wait until the k-nearest-neighbors have been saved (overlapped with the evaluation)
+            knns.finish_saving();
+        };
+
+        // optionally search options with a good recall/time trade-off instead of calculating the k-nearest-neighbors
+        if (parser.has_argv("autotune_num_trials")) {
+            sycl_lsh::autotuner tuner(parser, opt, data, comm, logger);
+            tuner.run();
+            return EXIT_SUCCESS;
         }
 
-        // optionally calculate the recall of the calculated k-nearest-neighbors
-        if (parser.has_argv("evaluate_knn_file")) {
-            logger.log("recall: {}%\n", knns.recall(parser));
+        // optionally calculate the exact k-nearest-neighbors using a brute-force search instead of the LSH hash tables
+        if (parser.has_argv("exact_knn")) {
+            sycl_lsh::brute_force exact(opt, data, comm, logger);
+            auto knns = exact.get_k_nearest_neighbors(parser);
+            save_and_evaluate(knns);
+            return EXIT_SUCCESS;
         }
-        // optionally calculate the error ration of the calculated k-nearest-neighbors
-        if (parser.has_argv("evaluate_knn_dist_file")) {
-            const auto [error_ratio, num_points, num_knn_not_found] = knns.error_ratio(parser);
-            if (num_points == 0) {
-                logger.log("error ratio: {}\n", error_ratio);
-            } else {
-                logger.log("error ratio: {} (for {} points a total of {} nearest-neighbors couldn't be found)\n", error_ratio, num_points, num_knn_not_found);
+
+        // optionally evaluate multiple options files one after another reusing the already loaded data set
+        if (parser.has_argv("options_sweep_files")) {
+            const std::string files = parser.argv_as<std::string>("options_sweep_files");
+            std::vector<std::string> options_files;
+            std::size_t pos = 0;
+            while (pos < files.size()) {
+                const std::size_t end = std::min(files.find(',', pos), files.size());
+                options_files.push_back(files.substr(pos, end - pos));
+                pos = end + 1;
+            }
+            if (options_files.empty()) {
+                throw std::invalid_argument("No options files given for the options sweep!");
+            } else if (parser.has_argv("hash_tables_load_file")) {
+                throw std::invalid_argument("Can't rebuild the hash tables per options file if they are loaded from a file!");
             }
+
+            for (std::size_t i = 0; i < options_files.size(); ++i) {
+                // parse the options of the current configuration (command line arguments override the values of the file)
+                const options_type sweep_opt(parser, options_files[i], logger);
+                logger.log("\nOptions sweep {}/{} ('{}'): \n{}\n", i + 1, options_files.size(), options_files[i], sweep_opt);
+
+                // only the hash functions and hash tables are rebuilt, the data set (and its device buffers) is reused
+                auto lsh_tables = sycl_lsh::make_hash_tables<sycl_lsh::memory_layout::aos>(parser, sweep_opt, data, comm, logger);
+                auto knns = lsh_tables.get_k_nearest_neighbors(parser);
+                evaluate(knns);
+
+                // if benchmarking is enabled, output the used options after the timings of the current configuration
+                sweep_opt.save_benchmark_options(comm);
+            }
+            return EXIT_SUCCESS;
+        }
+
+        // generate (or load) LSH hash tables
+        auto lsh_tables = sycl_lsh::make_hash_tables<sycl_lsh::memory_layout::aos>(parser, opt, data, comm, logger);
+        // optionally save the hash tables to file
+        if (parser.has_argv("hash_tables_save_file")) {
+            lsh_tables.save(parser);
+        }
+        // optionally keep the hash tables alive and answer queries sent over TCP
+        if (parser.has_argv("server_port")) {
+            sycl_lsh::query_server server(parser, lsh_tables, comm, logger);
+            server.run();
+            return EXIT_SUCCESS;
         }
+        // calculate k-nearest-neighbors
+        auto knns = lsh_tables.get_k_nearest_neighbors(parser);
+
+        save_and_evaluate(knns);
 
         // if benchmarking is enabled, also output the used options to the benchmark file (as last entry)
         opt.save_benchmark_options(comm);
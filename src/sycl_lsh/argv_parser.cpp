@@ -20,20 +20,41 @@
 const std::map<std::string, std::pair<std::string, bool>> sycl_lsh::argv_parser::list_of_argvs_ = {
         { "help",                   { "help screen", false } },
         { "data_file",              { "path to the data file", true } },
+        { "query_file",             { "path to the query file (if not present, the nearest-neighbors of all data points are searched)", false } },
         { "file_parser",            { "type of the file parser", false } },
+        { "mpi_io_hints",           { "comma separated key=value MPI IO hints used for all files (e.g. cb_nodes=4,cb_buffer_size=16777216)", false } },
         { "k",                      { "the number of nearest-neighbors to search for", true } },
         { "options_file",           { "path to options file", false } },
         { "options_save_file",      { "save the currently used options to the given path", false } },
+        { "options_sweep_files",    { "comma separated list of options files evaluated one after another on the already loaded data set", false } },
+        { "hash_tables_save_file",  { "save the created hash functions and hash tables to path", false } },
+        { "hash_tables_load_file",  { "load the hash functions and hash tables from path instead of creating them", false } },
         { "knn_save_file",          { "save the calculated nearest-neighbors to path", false } },
         { "knn_dist_save_file",     { "save the calculated nearest-neighbor distances to path", false } },
+        { "knn_tuning_file",        { "tune the kNN kernel and cache the best work-group and blocking sizes per device in path", false } },
+        { "device_memory_budget",   { "maximum device memory per MPI rank in MiB (0 uses the global memory size of the device)", false } },
+        { "exact_knn",              { "calculate the exact nearest-neighbors using a brute-force search instead of the hash tables", false } },
         { "evaluate_knn_file",      { "read the correct nearest-neighbors for calculating the resulting recall", false } },
         { "evaluate_knn_dist_file", { "read the correct nearest-neighbor distances for calculating the error ratio", false } },
+        { "evaluate_recall_at",     { "comma separated list of additional k' <= k to calculate the recall@k' for (e.g. 1,10)", false } },
         { "hash_pool_size",         { "number of hash functions in the hash pool", false } },
         { "num_hash_functions",     { "number of hash functions per hash table", false } },
         { "num_hash_tables",        { "number of hash tables to create", false } },
         { "hash_table_size",        { "size of each hash table", false } },
         { "w",                      { "segment size for the random projections hash functions", false } },
-        { "num_cut_off_points",     { "number of cut-off points for the entropy-based hash functions", false } }
+        { "num_cut_off_points",     { "number of cut-off points for the entropy-based hash functions", false } },
+        { "max_bucket_size",        { "maximum number of data points per hash bucket (0 means unlimited)", false } },
+        { "num_probes",             { "number of additionally probed neighboring hash buckets per hash table", false } },
+        { "max_hamming_distance",   { "maximum number of differing signature bits of a query and a candidate (simhash only, 0 disables the filter)", false } },
+        { "early_termination_tables", { "stop searching further hash tables after this many consecutive unchanged ones (0 disables)", false } },
+        { "early_termination_distance", { "stop searching further hash tables once the k-th nearest-neighbor is closer (0 disables)", false } },
+        { "seed",                   { "seed to generate identical hash functions on all MPI ranks (0 means random)", false } },
+        { "server_port",            { "keep the hash tables alive and answer queries sent to the given TCP port", false } },
+        { "server_max_batch_size",  { "maximum number of queries per batch of the query server (default: 4096)", false } },
+        { "autotune_num_trials",    { "search the options for a good recall/time trade-off using the given number of trials", false } },
+        { "autotune_sample_size",   { "number of data points sampled as queries during the autotuning (default: 1000)", false } },
+        { "autotune_save_prefix",   { "save the Pareto optimal options of the autotuning to prefix_i (default: autotune_options)", false } },
+        { "server_max_delay",       { "maximum time in ms a request waits for further requests to batch with (default: 5)", false } }
 };
 
 
@@ -62,8 +83,8 @@ sycl_lsh::argv_parser::argv_parser(const int argc, char** argv) {
             throw std::invalid_argument(fmt::format("Duplicate command line argument key {}!", key));
         }
 
-        if (key == "help") {
-            // if the current key equals 'help' continue parsing the next [key, value]-pair
+        if (key == "help" || key == "exact_knn") {
+            // if the current key equals 'help' or 'exact_knn' continue parsing the next [key, value]-pair
             // -> DON'T read a value because none will be provided!
             argvs_.emplace(std::move(key), "");
         } else {
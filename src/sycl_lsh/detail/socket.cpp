@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2020-10-28
+ */
+
+#include <sycl_lsh/detail/socket.hpp>
+
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+
+[[nodiscard]]
+int sycl_lsh::detail::open_listening_socket(const std::uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("Can't create socket: {}!", std::strerror(errno)));
+    }
+    // allow restarting the server immediately on the same port
+    const int enable = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::runtime_error(fmt::format("Can't listen on port {}: {}!", port, std::strerror(error)));
+    }
+    return fd;
+}
+
+[[nodiscard]]
+int sycl_lsh::detail::accept_connection(const int listening_fd) noexcept {
+    return ::accept(listening_fd, nullptr, nullptr);
+}
+
+void sycl_lsh::detail::close_socket(const int fd) noexcept {
+    ::close(fd);
+}
+
+
+[[nodiscard]]
+std::vector<int> sycl_lsh::detail::wait_readable(const std::vector<int>& fds, const int timeout_ms) {
+    std::vector<pollfd> poll_fds(fds.size());
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        poll_fds[i].fd = fds[i];
+        poll_fds[i].events = POLLIN;
+    }
+
+    std::vector<int> readable;
+    if (::poll(poll_fds.data(), poll_fds.size(), timeout_ms) > 0) {
+        for (const pollfd& pfd : poll_fds) {
+            if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+                readable.push_back(pfd.fd);
+            }
+        }
+    }
+    return readable;
+}
+
+
+namespace {
+
+    // waits until fd is ready for events or the deadline expired (a negative timeout waits indefinitely)
+    [[nodiscard]]
+    bool wait_until_ready(const int fd, const short events, const int timeout_ms, const std::chrono::steady_clock::time_point deadline) noexcept {
+        pollfd pfd{ fd, events, 0 };
+        while (true) {
+            int remaining_ms = -1;
+            if (timeout_ms >= 0) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                if (remaining <= 0) {
+                    return false;
+                }
+                remaining_ms = static_cast<int>(remaining);
+            }
+            const int ready = ::poll(&pfd, 1, remaining_ms);
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            return ready > 0;
+        }
+    }
+
+}
+
+[[nodiscard]]
+bool sycl_lsh::detail::receive_all(const int fd, void* buffer, std::size_t size, const int timeout_ms) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    auto* ptr = static_cast<char*>(buffer);
+    while (size > 0) {
+        // a stalled peer must not block the caller longer than the timeout
+        if (!wait_until_ready(fd, POLLIN, timeout_ms, deadline)) {
+            return false;
+        }
+        const ssize_t received = ::recv(fd, ptr, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        } else if (received <= 0) {
+            return false;
+        }
+        ptr += received;
+        size -= received;
+    }
+    return true;
+}
+
+[[nodiscard]]
+bool sycl_lsh::detail::send_all(const int fd, const void* buffer, std::size_t size, const int timeout_ms) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    const auto* ptr = static_cast<const char*>(buffer);
+    while (size > 0) {
+        // a peer that doesn't read its answers must not block the caller longer than the timeout
+        if (!wait_until_ready(fd, POLLOUT, timeout_ms, deadline)) {
+            return false;
+        }
+        const ssize_t sent = ::send(fd, ptr, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        } else if (sent <= 0) {
+            return false;
+        }
+        ptr += sent;
+        size -= sent;
+    }
+    return true;
+}
@@ -13,9 +13,11 @@
 
 #include <fmt/format.h>
 
+#include <cstddef>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 
 void sycl_lsh::detail::setup_devices(const sycl_lsh::mpi::communicator& comm, const std::string& env_var_name) {
@@ -25,7 +27,11 @@ void sycl_lsh::detail::setup_devices(const sycl_lsh::mpi::communicator& comm, co
     MPI_Comm_split_type(comm.get(), MPI_COMM_TYPE_SHARED, comm.size(), MPI_INFO_NULL, &node_comm.get());
 
     // set a CUDA_VISIBLE_DEVICES for each MPI process on the current rank
-    int err = setenv(env_var_name.c_str(), std::to_string(node_comm.rank()).c_str(), 1);
+    std::string visible_devices = std::to_string(node_comm.rank() * devices_per_rank);
+    for (std::size_t device = 1; device < devices_per_rank; ++device) {
+        visible_devices += fmt::format(",{}", node_comm.rank() * devices_per_rank + device);
+    }
+    int err = setenv(env_var_name.c_str(), visible_devices.c_str(), 1);
     if (err != 0) {
         throw std::logic_error("Error while setting CUDA_VISIBLE_DEVICES environment variable!");
     }
@@ -35,6 +41,26 @@ void sycl_lsh::detail::setup_devices(const sycl_lsh::mpi::communicator& comm, co
 }
 
 
+[[nodiscard]]
+std::vector<sycl_lsh::sycl::device> sycl_lsh::detail::select_devices(const sycl_lsh::mpi::communicator& comm) {
+    const sycl_lsh::device_selector selector{comm};
+    if constexpr (devices_per_rank == 1) {
+        return { selector.select_device() };
+    }
+
+    std::vector<sycl::device> devices;
+    for (const sycl::device& device : sycl::device::get_devices()) {
+        if (devices.size() < devices_per_rank && selector(device) >= 0) {
+            devices.push_back(device);
+        }
+    }
+    if (devices.empty()) {
+        throw std::runtime_error(fmt::format("No suitable SYCL device found on MPI rank {}!", comm.rank()));
+    }
+    return devices;
+}
+
+
 [[nodiscard]]
 bool sycl_lsh::detail::compare_devices(const sycl_lsh::sycl::device& lhs, const sycl_lsh::sycl::device& rhs) {
     #if SYCL_LSH_IMPLEMENTATION == SYCL_LSH_IMPLEMENTATION_HIPSYCL
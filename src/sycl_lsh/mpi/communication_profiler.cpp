@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @author Marcel Breyer
+ * @date 2021-01-02
+ */
+
+#include <sycl_lsh/mpi/communication_profiler.hpp>
+#include <sycl_lsh/mpi/communicator.hpp>
+#include <sycl_lsh/mpi/logger.hpp>
+#include <sycl_lsh/mpi/math.hpp>
+#include <sycl_lsh/mpi/type_cast.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+std::size_t sycl_lsh::mpi::communication_profiler::round_ = 0;
+sycl_lsh::mpi::communication_profiler::statistics_type sycl_lsh::mpi::communication_profiler::statistics_{};
+sycl_lsh::mpi::communication_profiler::statistics_type sycl_lsh::mpi::communication_profiler::last_report_{};
+
+
+// ---------------------------------------------------------------------------------------------------------- //
+//                                                 recording                                                  //
+// ---------------------------------------------------------------------------------------------------------- //
+void sycl_lsh::mpi::communication_profiler::set_round(const std::size_t round) noexcept {
+    round_ = round;
+}
+
+void sycl_lsh::mpi::communication_profiler::record(const communication_kind kind, const std::size_t bytes_sent, const std::size_t bytes_received,
+                                                   const double mpi_time, const double wait_time, const double transfer_time)
+{
+    // only the k-nearest-neighbor ring is recorded per round
+    const std::size_t round = kind == communication_kind::ring_data || kind == communication_kind::ring_knn ? round_ : 0;
+    std::vector<communication_statistics>& rounds = statistics_[static_cast<std::size_t>(kind)];
+    if (rounds.size() <= round) {
+        rounds.resize(round + 1);
+    }
+    communication_statistics& stats = rounds[round];
+    ++stats.num_calls;
+    stats.bytes_sent += bytes_sent;
+    stats.bytes_received += bytes_received;
+    stats.mpi_time += mpi_time;
+    stats.wait_time += wait_time;
+    stats.transfer_time += transfer_time;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------- //
+//                                                 reporting                                                  //
+// ---------------------------------------------------------------------------------------------------------- //
+void sycl_lsh::mpi::communication_profiler::report(const std::string_view phase, const communicator& comm, const logger& logger) {
+    constexpr std::size_t num_kinds = communication_kind_names.size();
+
+    // the same number of rounds per kind on all MPI ranks
+    std::vector<std::uint64_t> num_rounds(num_kinds);
+    for (std::size_t kind = 0; kind < num_kinds; ++kind) {
+        num_rounds[kind] = statistics_[kind].size();
+    }
+    MPI_Allreduce(MPI_IN_PLACE, num_rounds.data(), num_rounds.size(), type_cast<std::uint64_t>(), MPI_MAX, comm.get());
+    std::vector<std::size_t> first_slot(num_kinds + 1, 0);
+    for (std::size_t kind = 0; kind < num_kinds; ++kind) {
+        first_slot[kind + 1] = first_slot[kind] + num_rounds[kind];
+    }
+    const std::size_t num_slots = first_slot.back();
+
+    if (num_slots > 0) {
+        // flatten the statistics of the current MPI rank (rounds not recorded on the current MPI rank are ignored during the min/max reduction)
+        std::vector<std::uint64_t> bytes(2 * num_slots, 0);
+        std::vector<int> recorded(num_slots, 0);
+        std::vector<double> min_times(2 * num_slots, std::numeric_limits<double>::max());
+        std::vector<double> max_times(2 * num_slots, std::numeric_limits<double>::lowest());
+        std::vector<double> sum_times(3 * num_slots, 0.0);
+        for (std::size_t kind = 0; kind < num_kinds; ++kind) {
+            for (std::size_t round = 0; round < statistics_[kind].size(); ++round) {
+                const communication_statistics& stats = statistics_[kind][round];
+                const std::size_t slot = first_slot[kind] + round;
+                if (stats.num_calls == 0) continue;
+                recorded[slot] = 1;
+                bytes[2 * slot] = stats.bytes_sent;
+                bytes[2 * slot + 1] = stats.bytes_received;
+                min_times[2 * slot] = max_times[2 * slot] = sum_times[3 * slot] = stats.mpi_time;
+                min_times[2 * slot + 1] = max_times[2 * slot + 1] = sum_times[3 * slot + 1] = stats.wait_time;
+                sum_times[3 * slot + 2] = stats.bandwidth();
+            }
+        }
+
+        // aggregate over all MPI ranks
+        bytes = sum(std::move(bytes), comm);
+        recorded = sum(std::move(recorded), comm);
+        sum_times = sum(std::move(sum_times), comm);
+        MPI_Allreduce(MPI_IN_PLACE, min_times.data(), min_times.size(), type_cast<double>(), MPI_MIN, comm.get());
+        MPI_Allreduce(MPI_IN_PLACE, max_times.data(), max_times.size(), type_cast<double>(), MPI_MAX, comm.get());
+
+        logger.log("MPI communication of {} (MPI and wait times in ms: min/avg/max over all MPI ranks):\n", phase);
+        for (std::size_t kind = 0; kind < num_kinds; ++kind) {
+            for (std::size_t round = 0; round < num_rounds[kind]; ++round) {
+                const std::size_t slot = first_slot[kind] + round;
+                if (recorded[slot] == 0) continue;
+                logger.log("  {:<24} round {:>4}: sent {:10.2f} MiB, received {:10.2f} MiB, MPI {:9.3f} / {:9.3f} / {:9.3f}, "
+                           "waited {:9.3f} / {:9.3f} / {:9.3f}, {:10.2f} MiB/s\n",
+                           communication_kind_names[kind], round + 1,
+                           bytes[2 * slot] / (1024.0 * 1024.0), bytes[2 * slot + 1] / (1024.0 * 1024.0),
+                           min_times[2 * slot], sum_times[3 * slot] / recorded[slot], max_times[2 * slot],
+                           min_times[2 * slot + 1], sum_times[3 * slot + 1] / recorded[slot], max_times[2 * slot + 1],
+                           sum_times[3 * slot + 2] / recorded[slot]);
+            }
+        }
+    }
+
+    last_report_ = std::move(statistics_);
+    statistics_ = statistics_type{};
+}
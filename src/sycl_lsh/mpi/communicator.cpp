@@ -4,6 +4,7 @@
  * @date 2020-10-28
  */
 
+#include <sycl_lsh/mpi/communication_profiler.hpp>
 #include <sycl_lsh/mpi/communicator.hpp>
 
 #include <mpi.h>
@@ -107,7 +108,9 @@ bool sycl_lsh::mpi::communicator::master_rank() const {
     return this->rank() == 0;
 }
 void sycl_lsh::mpi::communicator::wait() const {
+    const auto start = communication_profiler::clock::now();
     MPI_Barrier(comm_);
+    communication_profiler::record_blocking(communication_kind::barrier, 0, 0, start);
 }
 
 
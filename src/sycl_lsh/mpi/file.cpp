@@ -9,7 +9,9 @@
 
 #include <mpi.h>
 
+#include <algorithm>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -63,4 +65,30 @@ void sycl_lsh::mpi::file::attach_errhandler(const sycl_lsh::mpi::errhandler& han
         throw std::logic_error("Illegal errhandler type!");
     }
     MPI_File_set_errhandler(file_, handler.get());
-}
\ No newline at end of file
+}
+
+
+// ---------------------------------------------------------------------------------------------------------- //
+//                                                MPI IO hints                                                //
+// ---------------------------------------------------------------------------------------------------------- //
+void sycl_lsh::mpi::file::set_hints(const std::string_view hints) {
+    MPI_Info info;
+    MPI_Info_create(&info);
+
+    std::size_t pos = 0;
+    while (pos < hints.size()) {
+        const std::size_t end = std::min(hints.find(',', pos), hints.size());
+        const std::string_view hint = hints.substr(pos, end - pos);
+        pos = end + 1;
+
+        const std::size_t sep = hint.find('=');
+        if (sep == std::string_view::npos || sep == 0) {
+            MPI_Info_free(&info);
+            throw std::invalid_argument(fmt::format("Illegal MPI IO hint '{}'! Must be of the form 'key=value'.", hint));
+        }
+        MPI_Info_set(info, std::string(hint.substr(0, sep)).c_str(), std::string(hint.substr(sep + 1)).c_str());
+    }
+
+    MPI_File_set_info(file_, info);
+    MPI_Info_free(&info);
+}